@@ -42,6 +42,30 @@ namespace clan
 class IODeviceProvider;
 class IODevice_Impl;
 
+/// \brief Read-only view of a block of memory owned by an I/O device
+class MappedSpan
+{
+public:
+	/// \brief Constructs a null span
+	MappedSpan() : data(nullptr), size(0) { }
+
+	/// \brief Constructs a span
+	MappedSpan(const char *data, int size) : data(data), size(size) { }
+
+	/// \brief Returns true if the device had no memory to expose
+	bool is_null() const { return data == nullptr; }
+
+	/// \brief Returns a pointer to the first byte
+	const char *get_data() const { return data; }
+
+	/// \brief Returns the size in bytes
+	int get_size() const { return size; }
+
+private:
+	const char *data;
+	int size;
+};
+
 /// \brief I/O Device interface.
 ///
 /// This class can store basic datatypes and retain portability (using the specified endian mode)\n
@@ -106,6 +130,13 @@ public:
 	/** \return true if little endian*/
 	bool is_little_endian() const;
 
+	/// \brief Returns the entire content of the device, if it is directly accessible in memory
+	///
+	/// Parsers can use this to avoid reading the data into a temporary buffer.
+	/// The span is independent of the current position and stays valid until the device is destroyed or written to.
+	/// \return The mapped data, or a null span if the device does not support it
+	MappedSpan get_mapped_span() const;
+
 	/// \brief Returns the provider for this object
 	const IODeviceProvider *get_provider() const;
 
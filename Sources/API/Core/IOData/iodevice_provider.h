@@ -58,6 +58,10 @@ public:
 	/** <p>Returns -1 if the position is unknown.</p>*/
 	virtual int get_position() const { return -1; }
 
+	/// \brief Returns the entire content of the device, if it is directly accessible in memory.
+	/** <p>Returns a null span if the device does not support it.</p>*/
+	virtual MappedSpan get_mapped_span() const { return MappedSpan(); }
+
 /// \}
 /// \name Operations
 /// \{
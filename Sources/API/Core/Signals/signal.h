@@ -32,6 +32,7 @@
 #include <memory>
 #include <functional>
 #include <vector>
+#include <algorithm>
 
 namespace clan
 {
@@ -67,7 +68,85 @@ namespace clan
 	class SignalImpl
 	{
 	public:
-		std::vector<std::weak_ptr<SlotImplType>> slots;
+		SignalImpl() : emit_depth(0), has_removed_slots(false) { }
+
+		~SignalImpl()
+		{
+			for (SlotImplType *slot : deferred_deletes)
+				delete slot;
+		}
+
+		/// \brief Removes a slot that is being destroyed
+		///
+		/// While the signal is emitting the slot is only cleared from the list, and deleted when the outermost emit has finished.
+		/// This allows a callback to disconnect itself or any other slot.
+		void remove(SlotImplType *slot)
+		{
+			for (auto it = slots.begin(); it != slots.end(); ++it)
+			{
+				if (*it == slot)
+				{
+					if (emit_depth > 0)
+					{
+						*it = nullptr;
+						has_removed_slots = true;
+					}
+					else
+					{
+						slots.erase(it);
+					}
+					break;
+				}
+			}
+
+			if (emit_depth > 0)
+				deferred_deletes.push_back(slot);
+			else
+				delete slot;
+		}
+
+		/// \brief Keeps the slot list stable while a signal is emitting
+		class EmitScope
+		{
+		public:
+			EmitScope(SignalImpl *signal) : signal(signal) { signal->emit_depth++; }
+
+			~EmitScope()
+			{
+				if (--signal->emit_depth == 0)
+					signal->end_emit();
+			}
+
+		private:
+			EmitScope(const EmitScope &) = delete;
+			EmitScope &operator=(const EmitScope &) = delete;
+
+			SignalImpl *signal;
+		};
+
+		std::vector<SlotImplType *> slots;
+
+	private:
+		void end_emit()
+		{
+			if (has_removed_slots)
+			{
+				slots.erase(std::remove(slots.begin(), slots.end(), nullptr), slots.end());
+				has_removed_slots = false;
+			}
+
+			// Deleting a slot may destroy objects owning other slots, which may in turn add more deferred slots
+			while (!deferred_deletes.empty())
+			{
+				SlotImplType *slot = deferred_deletes.back();
+				deferred_deletes.pop_back();
+				delete slot;
+			}
+		}
+
+		int emit_depth;
+		bool has_removed_slots;
+		std::vector<SlotImplType *> deferred_deletes;
 	};
 
 	template<typename FuncType>
@@ -78,22 +157,14 @@ namespace clan
 		{
 		}
 
-		~SlotImplT()
+		/// \brief Deleter used by the shared pointer of the slot
+		static void destroy(SlotImplT *slot)
 		{
-			std::shared_ptr<SignalImpl<SlotImplT>> sig = signal.lock();
+			std::shared_ptr<SignalImpl<SlotImplT>> sig = slot->signal.lock();
 			if (sig)
-			{
-				for (auto it = sig->slots.begin(); it != sig->slots.end(); ++it)
-				{
-					// todo: investigate if "it->lock().get() == this" is required
-					if (it->expired() || it->lock().get() == this)
-					{
-						it = sig->slots.erase(it);
-						if (it == sig->slots.end())
-							break;
-					}
-				}
-			}
+				sig->remove(slot);
+			else
+				delete slot;
 		}
 
 		std::weak_ptr<SignalImpl<SlotImplT>> signal;
@@ -106,24 +177,31 @@ namespace clan
 	public:
 		Signal() : impl(std::make_shared<SignalImpl<SlotImplT<FuncType>>>()) { }
 
+		/// \brief Invokes all connected callbacks
+		///
+		/// Emitting does not allocate memory. Callbacks may connect and disconnect slots and emit the signal again.
+		/// Slots connected by a callback are first invoked by the next emit.
+		/// Arguments are passed by reference to every callback, so they are not copied for each emit.
 		template<typename... Args>
-		void operator()(Args... args)
+		void operator()(Args&&... args)
 		{
-			std::vector<std::weak_ptr<SlotImplT<FuncType>>> slots = impl->slots;
-			for (std::weak_ptr<SlotImplT<FuncType>> &weak_slot : slots)
+			// A callback may destroy the Signal object itself
+			std::shared_ptr<SignalImpl<SlotImplT<FuncType>>> signal = impl;
+			typename SignalImpl<SlotImplT<FuncType>>::EmitScope emit_scope(signal.get());
+
+			size_t count = signal->slots.size();
+			for (size_t i = 0; i < count; i++)
 			{
-				std::shared_ptr<SlotImplT<FuncType>> slot = weak_slot.lock();
+				SlotImplT<FuncType> *slot = signal->slots[i];
 				if (slot)
-				{
 					slot->callback(args...);
-				}
 			}
 		}
 
 		Slot connect(const std::function<FuncType> &func)
 		{
-			auto slot_impl = std::make_shared<SlotImplT<FuncType>>(impl, func);
-			impl->slots.push_back(slot_impl);
+			std::shared_ptr<SlotImplT<FuncType>> slot_impl(new SlotImplT<FuncType>(impl, func), &SlotImplT<FuncType>::destroy);
+			impl->slots.push_back(slot_impl.get());
 			return Slot(slot_impl);
 		}
 
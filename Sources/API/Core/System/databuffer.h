@@ -98,6 +98,68 @@ public:
 /// \{
 private:
 	std::shared_ptr<DataBuffer_Impl> impl;
+
+	friend class DataBufferSlice;
+/// \}
+};
+
+/// \brief Read-only range of a data buffer that shares the storage of the buffer instead of copying it.
+///
+/// The slice keeps the storage alive. If the parent buffer is resized, the slice reflects the new content at the same offset.
+class DataBufferSlice
+{
+/// \name Construction
+/// \{
+public:
+	/// \brief Constructs a slice of 0 size.
+	DataBufferSlice();
+
+	/// \brief Constructs a slice covering the entire buffer.
+	DataBufferSlice(const DataBuffer &buffer);
+
+	/// \brief Constructs a slice covering part of a buffer.
+	DataBufferSlice(const DataBuffer &buffer, unsigned int pos, unsigned int size);
+
+	/// \brief Constructs a slice covering part of another slice.
+	DataBufferSlice(const DataBufferSlice &slice, unsigned int pos, unsigned int size);
+/// \}
+
+/// \name Attributes
+/// \{
+public:
+	/// \brief Returns a pointer to the first byte of the slice.
+	const char *get_data() const;
+
+	template<typename Type>
+	const Type *get_data() const { return reinterpret_cast<const Type*>(get_data()); }
+
+	/// \brief Returns the size of the slice.
+	unsigned int get_size() const { return size; }
+
+	/// \brief Returns the offset of the slice in the parent buffer.
+	unsigned int get_position() const { return pos; }
+
+	/// \brief Returns a char in the slice.
+	const char &operator[](int i) const { return get_data()[i]; }
+	const char &operator[](unsigned int i) const { return get_data()[i]; }
+
+	/// \brief Returns true if the slice is 0 in size.
+	bool is_null() const { return size == 0; }
+/// \}
+
+/// \name Operations
+/// \{
+public:
+	/// \brief Copies the slice into a new data buffer.
+	DataBuffer copy() const;
+/// \}
+
+/// \name Implementation
+/// \{
+private:
+	std::shared_ptr<DataBuffer_Impl> impl;
+	unsigned int pos;
+	unsigned int size;
 /// \}
 };
 
@@ -53,7 +53,7 @@ public:
 	/// \brief Get the current time microseconds.
 	static uint64_t get_microseconds();
 
-    enum CPU_ExtensionX86 { mmx, mmx_ex, _3d_now, _3d_now_ex, sse, sse2, sse3, ssse3, sse4_a, sse4_1, sse4_2, xop, avx, aes, fma3, fma4 };
+    enum CPU_ExtensionX86 { mmx, mmx_ex, _3d_now, _3d_now_ex, sse, sse2, sse3, ssse3, sse4_a, sse4_1, sse4_2, xop, avx, aes, fma3, fma4, pclmul };
     enum CPU_ExtensionPPC { altivec };
 
     static bool detect_cpu_extension(CPU_ExtensionX86 ext);
@@ -31,6 +31,10 @@
 
 #include <memory>
 #include <functional>
+#include <vector>
+#include <type_traits>
+#include <utility>
+#include <new>
 
 namespace clan
 {
@@ -51,8 +55,47 @@ public:
 };
 
 class WorkQueue_Impl;
+class WorkItemInline;
+class WorkTask_Impl;
+
+/// \brief Handle to a task queued with WorkQueue::queue_task
+///
+/// A task can be waited on and used as a dependency for other tasks.
+class WorkTask
+{
+public:
+	/// \brief Constructs a null instance
+	WorkTask();
+
+	/// \brief Returns true if this object is invalid
+	bool is_null() const { return !impl; }
+
+	/// \brief Returns true if the task has finished running, or failed
+	bool is_completed() const;
+
+	/// \brief Blocks until the task has finished running
+	///
+	/// If the task, or any task it depends on, threw an exception it is rethrown here.
+	/// Do not wait on a task from a worker thread of a serial queue.
+	void wait() const;
+
+	/// \brief Blocks until the task has finished or the timeout expired
+	///
+	/// \return true if the task completed
+	bool wait(int timeout_ms) const;
+
+private:
+	WorkTask(const std::shared_ptr<WorkTask_Impl> &impl);
+
+	std::shared_ptr<WorkTask_Impl> impl;
+
+	friend class WorkQueue;
+};
 
 /// \brief Thread pool for worker threads
+///
+/// Each worker thread owns a work stealing deque. Work queued from a worker thread is placed on its own deque,
+/// while work queued from other threads goes through a shared injection queue. Idle workers steal from the others.
 class WorkQueue
 {
 public:
@@ -69,9 +112,54 @@ public:
 	/// \brief Queue some work to be executed on a worker thread
 	void queue(const std::function<void()> &func);
 
+	/// \brief Max size in bytes of a callable passed to queue_inline
+	static const int max_inline_callable_size = 64;
+
+	/// \brief Queue some work to be executed on a worker thread without any heap allocations
+	///
+	/// The callable is moved into a recycled work item, so move-only callables are supported.
+	/// It must fit in max_inline_callable_size bytes and is destroyed on the worker thread right after it ran.
+	/// Unlike the other queue functions, nothing needs to be completed by process_work_completed.
+	template<typename Func>
+	void queue_inline(Func &&func)
+	{
+		typedef typename std::decay<Func>::type FuncType;
+		static_assert(sizeof(FuncType) <= max_inline_callable_size, "Callable is too large for queue_inline");
+		static_assert(std::alignment_of<FuncType>::value <= std::alignment_of<InlineStorage>::value, "Callable alignment is too large for queue_inline");
+
+		WorkItemInline *item = nullptr;
+		void *storage = alloc_inline_item(item);
+		try
+		{
+			new (storage) FuncType(std::forward<Func>(func));
+		}
+		catch (...)
+		{
+			free_inline_item(item);
+			throw;
+		}
+		queue_inline_item(item, &invoke_inline<FuncType>, &destroy_inline<FuncType>);
+	}
+
+	/// \brief Queue a task that runs on a worker thread once all its dependencies have completed
+	///
+	/// Dependent tasks are queued directly from the worker thread that finished their last dependency,
+	/// so chains of tasks do not have to wait for process_work_completed.
+	/// If a dependency fails, the task is not run and the exception is forwarded to its own waiters.
+	/// The WorkQueue must outlive all tasks queued on it.
+	WorkTask queue_task(const std::function<void()> &func, const std::vector<WorkTask> &dependencies = std::vector<WorkTask>());
+
 	/// \brief Queue some work to be executed on the main WorkQueue thread
 	void work_completed(const std::function<void()> &func);
 
+	/// \brief Processes the range [begin, end) in chunks on the worker threads
+	///
+	/// The calling thread also processes chunks and the function returns when the entire range has been processed.
+	/// If func throws an exception the remaining chunks are skipped and the first exception is rethrown.
+	/// \param func Function called with the sub range [begin, end) of each chunk
+	/// \param grain_size Number of indices per chunk, or 0 to pick one automatically
+	void parallel_for(int begin, int end, const std::function<void(int begin, int end)> &func, int grain_size = 0);
+
 	/// \brief Returns the number of items currently queued
 	int get_items_queued() const;
 
@@ -81,6 +169,18 @@ public:
 	void process_work_completed();
 
 private:
+	typedef std::aligned_storage<max_inline_callable_size>::type InlineStorage;
+
+	/// \brief Takes an item from the pool and returns the storage for its callable
+	void *alloc_inline_item(WorkItemInline *&out_item);
+	void free_inline_item(WorkItemInline *item);
+	void queue_inline_item(WorkItemInline *item, void(*invoke)(void *data), void(*destroy)(void *data));
+
+	template<typename FuncType>
+	static void invoke_inline(void *data) { (*static_cast<FuncType*>(data))(); }
+
+	template<typename FuncType>
+	static void destroy_inline(void *data) { static_cast<FuncType*>(data)->~FuncType(); }
 
 	std::shared_ptr<WorkQueue_Impl> impl;
 };
@@ -64,11 +64,19 @@ public:
 	/// \brief Log text to file.
 	void log(const std::string &type, const std::string &text) override;
 
+	/// \brief Log a batch of messages with a single write.
+	void log_batch(const std::vector<LogMessage> &messages) override;
+
 /// \}
 /// \name Implementation
 /// \{
 
+protected:
+	void log(const DateTime &time, const std::string &type, const std::string &text) override;
+
 private:
+	void write_text(const std::string &text);
+
 	File *file;
 /// \}
 };
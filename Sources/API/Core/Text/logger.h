@@ -31,13 +31,39 @@
 
 #include "string_format.h"
 #include "string_help.h"
+#include "../System/datetime.h"
 #include <mutex>
+#include <vector>
 
 namespace clan
 {
 /// \addtogroup clanCore_Text clanCore Text
 /// \{
 
+/// \brief What log_event does when the asynchronous log queue is full
+enum class LogQueuePolicy
+{
+	/// \brief Discard the message and count it as dropped
+	drop,
+
+	/// \brief Wait for the logger thread to make room for the message
+	block
+};
+
+/// \brief Log message passed to loggers in batches.
+class LogMessage
+{
+public:
+	/// \brief Time the message was logged
+	DateTime time;
+
+	/// \brief Log type
+	std::string type;
+
+	/// \brief Log text
+	std::string text;
+};
+
 /// \brief Logger interface.
 class Logger
 {
@@ -75,18 +101,53 @@ public:
 	/// \brief Log text.
 	virtual void log(const std::string &type, const std::string &text) = 0;
 
+	/// \brief Log a batch of messages queued by the asynchronous logger thread.
+	///
+	/// The default implementation calls log() with the time each message was logged.
+	virtual void log_batch(const std::vector<LogMessage> &messages);
+
+	/// \brief Makes log_event queue messages for a background thread that passes them to the enabled loggers in batches.
+	///
+	/// \param queue_size = Max number of queued messages, rounded up to a power of two
+	/// \param policy = What log_event does when the queue is full
+	static void start_async(int queue_size = 4096, LogQueuePolicy policy = LogQueuePolicy::drop);
+
+	/// \brief Writes all queued messages, stops the logger thread and makes log_event call the loggers directly again.
+	static void stop_async();
+
+	/// \brief Waits until all messages queued so far have been passed to the loggers.
+	static void flush();
+
+	/// \brief Returns the number of messages dropped because the asynchronous log queue was full.
+	static uint64_t get_dropped_count();
+
 /// \}
 /// \name Implementation
 /// \{
 
 protected:
+	/// \brief Log text that was logged at the given time.
+	///
+	/// log_event and the default log_batch call this, so synchronous and asynchronous logging pass the same time.
+	/// The default implementation calls log(type, text). Override it to use the time in the log line.
+	virtual void log(const DateTime &time, const std::string &type, const std::string &text);
+
 	static StringFormat get_log_string(const std::string &type, const std::string &text);
 
+	/// \brief Formats a log line for a message logged at the given time.
+	static StringFormat get_log_string(const DateTime &time, const std::string &type, const std::string &text);
+
+	/// \brief Appends a formatted log line to a string.
+	static void append_log_string(std::string &output, const DateTime &time, const std::string &type, const std::string &text);
+
 /// \}
+
+	friend void log_event(const std::string &type, const std::string &text);
 };
 
 /// \brief Log text to logger.
 ///
+/// When Logger::start_async has been called the text is queued and written by the logger thread.
 void log_event(const std::string &type, const std::string &text);
 
 template <class Arg1>
@@ -123,9 +123,17 @@ public:
 	    </ul>*/
 	DomString get_node_name() const;
 
+	/// \brief Returns the node name without copying it.
+	/** <p>The view is valid until the node is modified or the document is destroyed.
+	    Names are shared by all nodes in the document with the same name.</p>*/
+	DomStringView get_node_name_view() const;
+
 	/// \brief Returns the namespace URI of this node.
 	DomString get_namespace_uri() const;
 
+	/// \brief Returns the namespace URI of this node without copying it.
+	DomStringView get_namespace_uri_view() const;
+
 	/// \brief Returns the namespace prefix of the node.
 	/** <p>For nodes of any type other than ELEMENT_NODE and ATTRIBUTE_NODE and
 	    nodes created with a DOM Level 1 method, such as create_element from the
@@ -148,6 +156,9 @@ public:
 	    Document interface, this is always an empty string.</p>*/
 	DomString get_local_name() const;
 
+	/// \brief Returns local part of the qualified name of this node without copying it.
+	DomStringView get_local_name_view() const;
+
 	/// \brief Returns the node value.
 	/** <p>The return value vary according to the node type as follows:</p>
 	    <ul>
@@ -166,6 +177,10 @@ public:
 	    </ul>*/
 	DomString get_node_value() const;
 
+	/// \brief Returns the node value without copying it.
+	/** <p>The view is valid until the node is modified or the document is destroyed.</p>*/
+	DomStringView get_node_value_view() const;
+
 	/// \brief Sets the node value.
 	void set_node_value(const DomString &value);
 
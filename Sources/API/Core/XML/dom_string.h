@@ -29,6 +29,9 @@
 
 #pragma once
 
+#include <string>
+#include <cstring>
+
 namespace clan
 {
 /// \addtogroup clanCore_XML clanCore XML
@@ -36,6 +39,93 @@ namespace clan
 
 typedef std::string DomString;
 
+/// \brief Read-only view of a string stored in a DOM document.
+///
+/// The view does not own the characters. It stays valid until the node it was
+/// returned from is modified or the document is destroyed.
+class DomStringView
+{
+/// \name Construction
+/// \{
+
+public:
+	DomStringView() : str(nullptr), len(0) { }
+	DomStringView(const char *str, size_t length) : str(str), len(length) { }
+	DomStringView(const char *str) : str(str), len(std::strlen(str)) { }
+	DomStringView(const DomString &str) : str(str.data()), len(str.length()) { }
+
+/// \}
+/// \name Attributes
+/// \{
+
+public:
+	static const size_t npos = (size_t)-1;
+
+	const char *data() const { return str; }
+	size_t size() const { return len; }
+	size_t length() const { return len; }
+	bool empty() const { return len == 0; }
+
+	const char *begin() const { return str; }
+	const char *end() const { return str + len; }
+
+	char operator[](size_t index) const { return str[index]; }
+
+/// \}
+/// \name Operations
+/// \{
+
+public:
+	/// \brief Returns the position of the first occurrence of c, or npos.
+	size_t find(char c, size_t pos = 0) const
+	{
+		for (size_t i = pos; i < len; i++)
+		{
+			if (str[i] == c)
+				return i;
+		}
+		return npos;
+	}
+
+	/// \brief Returns a view of a part of this string.
+	DomStringView substr(size_t pos, size_t count = npos) const
+	{
+		if (pos > len)
+			pos = len;
+		if (count > len - pos)
+			count = len - pos;
+		return DomStringView(str + pos, count);
+	}
+
+	/// \brief Compares the characters of two strings like std::string::compare.
+	int compare(const DomStringView &other) const
+	{
+		size_t common = len < other.len ? len : other.len;
+		int result = common ? std::memcmp(str, other.str, common) : 0;
+		if (result != 0)
+			return result;
+		return len < other.len ? -1 : (len > other.len ? 1 : 0);
+	}
+
+	/// \brief Copies the characters into a DomString.
+	DomString to_string() const { return len ? DomString(str, len) : DomString(); }
+
+	operator DomString() const { return to_string(); }
+
+/// \}
+/// \name Implementation
+/// \{
+
+private:
+	const char *str;
+	size_t len;
+/// \}
+};
+
+inline bool operator==(const DomStringView &a, const DomStringView &b) { return a.size() == b.size() && a.compare(b) == 0; }
+inline bool operator!=(const DomStringView &a, const DomStringView &b) { return !(a == b); }
+inline bool operator<(const DomStringView &a, const DomStringView &b) { return a.compare(b) < 0; }
+
 }
 
 /// \}
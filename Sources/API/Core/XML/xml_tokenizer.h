@@ -59,6 +59,14 @@ public:
 	/// \param input = IODevice
 	XMLTokenizer(IODevice &input);
 
+	/// \brief Constructs a XMLTokenizer that streams the input instead of loading the whole document
+	///
+	/// Only a window of the input holding the current token is kept in memory.
+	/// The window is refilled from the input in chunks as tokens are consumed.
+	/// \param input = IODevice
+	/// \param chunk_size Number of bytes to read from the input device at a time
+	XMLTokenizer(IODevice &input, int chunk_size);
+
 	virtual ~XMLTokenizer();
 
 /// \}
@@ -39,6 +39,7 @@ namespace clan
 
 class DomNode;
 class XPathEvaluator_Impl;
+class XPathExpression;
 
 /// \brief XPath evaluator.
 class XPathEvaluator
@@ -63,6 +64,14 @@ public:
 	/// \return XPath Object
 	XPathObject evaluate(const std::string &expression, const DomNode &context_node) const;
 
+	/// \brief Evaluate a compiled expression
+	///
+	/// \param expression = XPath Expression
+	/// \param context_node = Dom Node
+	///
+	/// \return XPath Object
+	XPathObject evaluate(const XPathExpression &expression, const DomNode &context_node) const;
+
 /// \}
 /// \name Implementation
 /// \{
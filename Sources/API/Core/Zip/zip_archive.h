@@ -40,6 +40,8 @@ namespace clan
 /// \{
 
 class IODevice;
+class DataBuffer;
+class WorkQueue;
 class ZipArchive_Impl;
 
 /// \brief Zip archive.
@@ -89,6 +91,15 @@ public:
 	/// \brief Opens a file in the archive.
 	IODevice open_file(const std::string &filename);
 
+	/// \brief Reads and decompresses several files in the archive concurrently.
+	///
+	/// Each file is decompressed on its own duplicate of the archive input device.
+	/// The call blocks until all files have been read. If a file is missing or fails to decompress, the first exception is rethrown.
+	/// \param filenames Files to read
+	/// \param work_queue Work queue used to run the decompression
+	/// \return The contents of each file, in the same order as filenames
+	std::vector<DataBuffer> read_files(const std::vector<std::string> &filenames, WorkQueue &work_queue);
+
 	/// \brief Get full path to source:
 	std::string get_pathname(const std::string &filename);
 
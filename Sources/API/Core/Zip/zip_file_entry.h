@@ -105,6 +105,8 @@ private:
 
 	friend class ZipArchive;
 
+	friend class ZipArchive_Impl;
+
 	friend class ZipIODevice_FileEntry;
 /// \}
 };
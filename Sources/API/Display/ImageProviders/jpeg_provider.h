@@ -39,6 +39,7 @@ namespace clan
 /// \{
 
 class FileSystem;
+class WorkQueue;
 
 /// \brief Image provider that can load JPEG (.jpg) files.
 class JPEGProvider
@@ -64,6 +65,20 @@ public:
 		IODevice &file,
 		bool srgb = false);
 
+	/// \brief Loads an image using the worker threads of a work queue
+	///
+	/// Baseline images with restart intervals are entropy decoded in parallel. IDCT, upsampling
+	/// and color conversion run in parallel for all images.
+	static PixelBuffer load(
+		const std::string &fullname,
+		bool srgb,
+		WorkQueue &work_queue);
+
+	static PixelBuffer load(
+		IODevice &file,
+		bool srgb,
+		WorkQueue &work_queue);
+
 	/// \brief Save the given PixelBuffer into a JPEG
 	///
 	/// \param buffer The PixelBuffer to save, format doesn't matter its converted if needed
@@ -41,14 +41,29 @@ namespace clan
 class NetGameEvent;
 class NetGameConnection;
 class NetGameClient_Impl;
+class NetGameReactor;
+class NetGameEventSchema;
+class NetGameConnectionStats;
 
 /// \brief NetGameClient
 class NetGameClient : NetGameConnectionSite
 {
 public:
 	NetGameClient();
+
+	/// \brief Constructs a client where the connection is processed by the I/O threads of a reactor
+	///
+	/// \param reactor = Net Game Reactor
+	NetGameClient(const NetGameReactor &reactor);
 	~NetGameClient();
 
+	/// \brief Sets the schema used to compactly encode events if the server has the same schema
+	///
+	/// Must be called before connecting.
+	///
+	/// \param schema = Net Game Event Schema
+	void set_event_schema(const NetGameEventSchema &schema);
+
 	/// \brief Connect
 	///
 	/// \param server = String
@@ -65,6 +80,12 @@ public:
 	///
 	/// \param game_event = Net Game Event
 	void send_event(const NetGameEvent &game_event);
+
+	/// \brief Returns a snapshot of the counters of the connection to the server
+	///
+	/// All counters are zero when the client is not connected.
+	NetGameConnectionStats get_stats() const;
+
 	Signal<void(const NetGameEvent &)> &sig_event_received();
 
 	/// \brief Sig connected
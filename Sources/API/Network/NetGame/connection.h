@@ -31,7 +31,10 @@
 
 #include <vector>
 #include <string>
+#include <memory>
 #include "event.h"
+#include "connection_stats.h"
+#include "send_budget.h"
 
 namespace clan
 {
@@ -40,6 +43,7 @@ namespace clan
 
 class NetGameConnectionSite;
 class NetGameConnection_Impl;
+class NetGameReactor;
 class SocketName;
 class TCPConnection;
 
@@ -55,6 +59,14 @@ public:
 	NetGameConnection(NetGameConnectionSite *site, const TCPConnection &connection);
 	NetGameConnection(NetGameConnectionSite *site, const SocketName &socket_name);
 
+	/// \brief Constructs a NetGameConnection processed by the I/O threads of a reactor
+	///
+	/// \param site = Net Game Connection Site
+	/// \param connection = TCPConnection
+	/// \param reactor = Net Game Reactor
+	NetGameConnection(NetGameConnectionSite *site, const TCPConnection &connection, const NetGameReactor &reactor);
+	NetGameConnection(NetGameConnectionSite *site, const SocketName &socket_name, const NetGameReactor &reactor);
+
 	~NetGameConnection();
 
 	/// \brief Set data
@@ -78,17 +90,31 @@ public:
 	/// \brief Disconnects a client
 	void disconnect();
 
+	/// \brief Limits the number of messages waiting to be sent on this connection
+	///
+	/// \param budget = Watermarks and the policy applied to new messages while over budget
+	void set_send_budget(const NetGameSendBudget &budget);
+
 	/// \brief Get Remote name
 	///
 	/// \return remote_name
 	SocketName get_remote_name() const;
 
+	/// \brief Returns a snapshot of the bandwidth, queue and latency counters of the connection
+	///
+	/// The counters are updated by the I/O thread of the connection and can be read from any thread.
+	NetGameConnectionStats get_stats() const;
+
 private:
 	/// \brief Disallow copy constructors
 	NetGameConnection(NetGameConnection &other);
 	NetGameConnection &operator =(const NetGameConnection &other);
 
-	NetGameConnection_Impl *impl;
+	std::shared_ptr<NetGameConnection_Impl> impl;
+
+	friend class NetGameServer;
+	friend class NetGameServer_Impl;
+	friend class NetGameClient;
 };
 
 }
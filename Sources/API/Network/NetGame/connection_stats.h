@@ -0,0 +1,115 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include <cstdint>
+
+namespace clan
+{
+/// \addtogroup clanNetwork_NetGame clanNetwork NetGame
+/// \{
+
+/// \brief Histogram of samples in power of two buckets
+///
+/// Bucket 0 counts samples of value 0 and bucket N counts samples in the range [2^(N-1), 2^N).
+/// The last bucket also counts all larger samples.
+class NetGameHistogram
+{
+public:
+	NetGameHistogram();
+
+	enum { num_buckets = 24 };
+
+	/// \brief Returns the bucket a sample value is counted in
+	static int get_bucket(uint64_t value);
+
+	/// \brief Returns the largest value counted in a bucket
+	static uint64_t get_bucket_limit(int bucket);
+
+	/// \brief Returns the average of all samples, or 0 if there are none
+	uint64_t get_average() const;
+
+	/// \brief Returns the bucket limit that the given percentage of the samples are at or below
+	///
+	/// \param percentile = Percentage in the range 0 to 100
+	uint64_t get_percentile(double percentile) const;
+
+	/// \brief Adds the samples of another histogram to this one
+	void add(const NetGameHistogram &other);
+
+	uint64_t buckets[num_buckets];
+	uint64_t count;
+	uint64_t total;
+	uint64_t max;
+};
+
+/// \brief Snapshot of the counters of a NetGameConnection
+///
+/// All counters start when the connection object is created.
+class NetGameConnectionStats
+{
+public:
+	NetGameConnectionStats();
+
+	/// \brief Bytes written to and read from the socket
+	uint64_t bytes_sent;
+	uint64_t bytes_received;
+
+	/// \brief Events and pre-encoded packets written to the send buffer, and events received
+	uint64_t events_sent;
+	uint64_t events_received;
+
+	/// \brief Events dropped or replaced by a newer event because the connection was over its send budget
+	uint64_t events_dropped;
+	uint64_t events_coalesced;
+
+	/// \brief Messages waiting to be encoded into the send buffer
+	int send_queue_depth;
+	int max_send_queue_depth;
+
+	/// \brief Encoded bytes waiting for the socket to accept them
+	///
+	/// A client that does not keep up with the data sent to it shows up as a growing send buffer.
+	int send_buffer_size;
+	int max_send_buffer_size;
+
+	/// \brief Smoothed round trip time reported by the operating system in microseconds, or -1 if not available
+	int round_trip_time;
+
+	/// \brief Microseconds from a message being queued until it is encoded into the send buffer
+	NetGameHistogram queue_time;
+
+	/// \brief Microseconds spent writing to the socket for each flush of the send buffer
+	NetGameHistogram write_time;
+};
+
+}
+
+/// \}
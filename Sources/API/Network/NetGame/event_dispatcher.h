@@ -30,18 +30,46 @@
 #pragma once
 
 #include "event.h"
-#include <map>
+#include <deque>
+#include <vector>
+#include <functional>
 
 namespace clan
 {
 
+/// \brief Dispatches NetGameEvent objects to handlers registered by event name
+///
+/// Handler names are hashed once when registered. Dispatching hashes the event name and
+/// probes a flat open addressing table, only comparing strings when the hashes match.
 template<class... Params>
 class NetGameEventDispatcher
 {
 public:
 	typedef std::function< void (const NetGameEvent &, Params... ) > CallbackClass;
 
-	CallbackClass &func_event(const std::string &name) { return event_handlers[name]; }
+	CallbackClass &func_event(const std::string &name) { return handlers[get_event_id(name)].callback; }
+
+	/// \brief Returns the id of the handler for an event name, adding an empty handler if none exists
+	///
+	/// Ids are stable for the lifetime of the dispatcher and can be passed to dispatch() to skip the name lookup.
+	int get_event_id(const std::string &name)
+	{
+		unsigned int hash = hash_name(name);
+		int id = find_handler(name, hash);
+		if (id == -1)
+		{
+			id = (int)handlers.size();
+			handlers.push_back(Handler(name, hash));
+			if (handlers.size() * 2 > slots.size())
+				rehash(slots.empty() ? 16 : slots.size() * 2);
+			else
+				insert_slot(hash, id);
+		}
+		return id;
+	}
+
+	/// \brief Returns the id of the handler for an event name, or -1 if none has been registered
+	int find_event_id(const std::string &name) const { return find_handler(name, hash_name(name)); }
 
 	/** \brief Dispatches the event object.
 	 *  \return true if the event handler is invoked and false if the
@@ -49,10 +77,18 @@ public:
 	 */
 	bool dispatch(const NetGameEvent &game_event, Params... params)
 	{
-		auto it = event_handlers.find(game_event.get_name());
-		if (it != event_handlers.end() && (bool)it->second)
+		return dispatch(find_event_id(game_event.get_name()), game_event, params...);
+	}
+
+	/** \brief Dispatches the event object to the handler with the given id.
+	 *  \return true if the event handler is invoked and false if the
+	 *          event handler is not found.
+	 */
+	bool dispatch(int event_id, const NetGameEvent &game_event, Params... params)
+	{
+		if (event_id >= 0 && event_id < (int)handlers.size() && (bool)handlers[event_id].callback)
 		{
-			it->second(game_event, params...);
+			handlers[event_id].callback(game_event, params...);
 			return true;
 		}
 		else
@@ -62,8 +98,70 @@ public:
 	}
 
 private:
-	std::map<std::string, CallbackClass> event_handlers;
+	struct Handler
+	{
+		Handler(const std::string &name, unsigned int hash) : name(name), hash(hash) { }
+
+		std::string name;
+		unsigned int hash;
+		CallbackClass callback;
+	};
+
+	struct Slot
+	{
+		Slot() : hash(0), id(-1) { }
+
+		unsigned int hash;
+		int id;
+	};
+
+	static unsigned int hash_name(const std::string &name)
+	{
+		unsigned int hash = 2166136261u;
+		for (size_t i = 0; i < name.length(); i++)
+		{
+			hash ^= (unsigned char)name[i];
+			hash *= 16777619u;
+		}
+		return hash;
+	}
+
+	int find_handler(const std::string &name, unsigned int hash) const
+	{
+		if (slots.empty())
+			return -1;
+
+		size_t mask = slots.size() - 1;
+		for (size_t i = hash & mask; ; i = (i + 1) & mask)
+		{
+			const Slot &slot = slots[i];
+			if (slot.id == -1)
+				return -1;
+			if (slot.hash == hash && handlers[slot.id].name == name)
+				return slot.id;
+		}
+	}
+
+	void insert_slot(unsigned int hash, int id)
+	{
+		size_t mask = slots.size() - 1;
+		size_t i = hash & mask;
+		while (slots[i].id != -1)
+			i = (i + 1) & mask;
+		slots[i].hash = hash;
+		slots[i].id = id;
+	}
+
+	void rehash(size_t new_size)
+	{
+		slots.assign(new_size, Slot());
+		for (size_t i = 0; i < handlers.size(); i++)
+			insert_slot(handlers[i].hash, (int)i);
+	}
 
+	// A deque keeps references returned by func_event valid when more handlers are added
+	std::deque<Handler> handlers;
+	std::vector<Slot> slots;
 };
 
 }
@@ -0,0 +1,91 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+namespace clan
+{
+/// \addtogroup clanNetwork_NetGame clanNetwork NetGame
+/// \{
+
+class DataBuffer;
+class NetGameEvent;
+class NetGameEventSchema_Impl;
+
+/// \brief Registry of event names known to both ends of a connection
+///
+/// By default every event is sent with its name and self-describing arguments. When a server and a client
+/// have been given schemas with the same names registered in the same order, they agree on this when the
+/// connection is established. Registered events are then sent with a small integer id instead of the name,
+/// and integer arguments are sent as variable length integers.
+///
+/// All events must be registered before the schema is given to a server or client.
+class NetGameEventSchema
+{
+public:
+	NetGameEventSchema();
+
+	/// \brief Registers an event name
+	///
+	/// \return The id of the event. Registering a name twice returns the same id.
+	int register_event(const std::string &name);
+
+	/// \brief Returns the id of an event name, or -1 if it is not registered
+	int find_event(const std::string &name) const;
+
+	/// \brief Returns the number of registered events
+	int get_event_count() const;
+
+	/// \brief Returns a hash of the registered names, used to verify that both ends have the same schema
+	unsigned int get_hash() const;
+
+	/// \brief Encodes an event the way it is sent to a connection using this schema
+	///
+	/// Events that are not registered are encoded with their name.
+	DataBuffer encode_event(const NetGameEvent &game_event) const;
+
+	/// \brief Decodes an encoded event
+	///
+	/// The name and argument storage of out_event are reused, so decoding into the same event object
+	/// repeatedly does not allocate memory for events of a similar shape.
+	void decode_event(const DataBuffer &data, NetGameEvent &out_event) const;
+
+private:
+	std::shared_ptr<NetGameEventSchema_Impl> impl;
+
+	friend class NetGameServer;
+	friend class NetGameServer_Impl;
+	friend class NetGameClient;
+};
+
+}
+
+/// \}
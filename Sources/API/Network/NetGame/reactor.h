@@ -0,0 +1,65 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include <memory>
+
+namespace clan
+{
+/// \addtogroup clanNetwork_NetGame clanNetwork NetGame
+/// \{
+
+class NetGameReactor_Impl;
+
+/// \brief Fixed pool of I/O threads shared by NetGame connections
+///
+/// By default every NetGameConnection runs its own thread. Servers and clients constructed with a reactor
+/// instead have all their sockets multiplexed by the reactor threads using epoll.
+/// On platforms without epoll the connections fall back to a thread each.
+class NetGameReactor
+{
+public:
+	/// \brief Constructs a reactor
+	///
+	/// \param num_threads = Number of I/O threads. Zero picks one per core, up to four.
+	NetGameReactor(int num_threads = 0);
+
+	/// \brief Returns the number of I/O threads, or 0 if connections use a thread each
+	int get_thread_count() const;
+
+private:
+	std::shared_ptr<NetGameReactor_Impl> impl;
+
+	friend class NetGameConnection;
+};
+
+}
+
+/// \}
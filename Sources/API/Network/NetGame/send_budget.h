@@ -0,0 +1,74 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+namespace clan
+{
+/// \addtogroup clanNetwork_NetGame clanNetwork NetGame
+/// \{
+
+/// \brief What a connection does with new messages while it is over its send budget
+enum class NetGameSendPolicy
+{
+	/// \brief Keep queuing all messages
+	queue,
+
+	/// \brief Drop new events until the connection is within its budget again
+	drop,
+
+	/// \brief Replace the queued event with the same name, so only the latest event per name is sent
+	coalesce
+};
+
+/// \brief Limits the number of messages that may wait to be sent on a connection
+///
+/// A connection goes over its budget when the messages waiting to be sent reach the high watermark.
+/// It stays over budget until the waiting messages have drained down to the low watermark.
+/// Disconnects are never dropped or coalesced.
+class NetGameSendBudget
+{
+public:
+	/// \brief Constructs a send budget
+	///
+	/// \param high_watermark = Waiting messages that put the connection over budget, or 0 for no budget
+	/// \param low_watermark = Waiting messages at or below which the connection is within budget again
+	/// \param policy = What to do with new messages while over budget
+	NetGameSendBudget(int high_watermark = 0, int low_watermark = 0, NetGameSendPolicy policy = NetGameSendPolicy::queue)
+	: high_watermark(high_watermark), low_watermark(low_watermark), policy(policy)
+	{
+	}
+
+	int high_watermark;
+	int low_watermark;
+	NetGameSendPolicy policy;
+};
+
+}
+
+/// \}
@@ -30,7 +30,9 @@
 #pragma once
 
 
+#include <vector>
 #include "connection_site.h"	// TODO: Remove
+#include "send_budget.h"
 #include "../../Core/Signals/signal.h"
 
 namespace clan
@@ -41,12 +43,20 @@ namespace clan
 class NetGameEvent;
 class NetGameConnection;
 class NetGameServer_Impl;
+class NetGameReactor;
+class NetGameEventSchema;
+class NetGameConnectionStats;
 
 /// \brief NetGameServer
 class NetGameServer : NetGameConnectionSite
 {
 public:
 	NetGameServer();
+
+	/// \brief Constructs a server where all client connections are processed by the I/O threads of a reactor
+	///
+	/// \param reactor = Net Game Reactor
+	NetGameServer(const NetGameReactor &reactor);
 	~NetGameServer();
 
 	/// \brief Start
@@ -60,21 +70,59 @@ public:
 	/// \param port = String
 	void start(const std::string &address, const std::string &port);
 
+	/// \brief Sets the schema used to compactly encode events for clients that have the same schema
+	///
+	/// Must be called before the server is started.
+	///
+	/// \param schema = Net Game Event Schema
+	void set_event_schema(const NetGameEventSchema &schema);
+
+	/// \brief Limits the number of messages waiting to be sent on each client connection
+	///
+	/// Applies to connected clients and to clients that connect later.
+	///
+	/// \param budget = Watermarks and the policy applied to new messages while a connection is over budget
+	void set_send_budget(const NetGameSendBudget &budget);
+
 	/// \brief Process events
 	void process_events();
 
 	/// \brief Stop
 	void stop();
 
-	/// \brief Send event
+	/// \brief Send event to all connected clients
+	///
+	/// The event is encoded once and the result is shared by all the connections.
 	///
 	/// \param game_event = Net Game Event
 	void send_event(const NetGameEvent &game_event);
 
+	/// \brief Send event to a group of clients
+	///
+	/// The event is encoded once and the result is shared by all the connections.
+	///
+	/// \param game_event = Net Game Event
+	/// \param connections = Connections of this server
+	void send_event(const NetGameEvent &game_event, const std::vector<NetGameConnection *> &connections);
+
 	Signal<void(NetGameConnection *)> &sig_client_connected();
 	Signal<void(NetGameConnection *, const std::string &)> &sig_client_disconnected();
 	Signal<void(NetGameConnection *, const NetGameEvent &)> &sig_event_received();
 
+	/// \brief Invoked when a connection reaches the high watermark of its send budget
+	Signal<void(NetGameConnection *)> &sig_client_over_budget();
+
+	/// \brief Invoked when a connection that was over budget has drained to the low watermark
+	Signal<void(NetGameConnection *)> &sig_client_within_budget();
+
+	/// \brief Sets how often sig_connection_stats() is invoked by process_events()
+	///
+	/// \param milliseconds = Interval between reports, or 0 to disable them (the default)
+	void set_stats_interval(int milliseconds);
+
+	/// \brief Invoked for every connection with a snapshot of its counters, at the interval set by set_stats_interval()
+	Signal<void(NetGameConnection *, const NetGameConnectionStats &)> &sig_connection_stats();
+
 private:
 
 	/// \brief Listen thread main
@@ -0,0 +1,95 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "udp_connection.h"
+#include "../../Core/Signals/signal.h"
+
+namespace clan
+{
+/// \addtogroup clanNetwork_NetGame clanNetwork NetGame
+/// \{
+
+class NetGameEvent;
+class NetGameUDPClient_Impl;
+
+/// \brief NetGame client using UDP
+///
+/// All socket I/O happens in process_events(). The client is connected when the first packet from the server arrives.
+class NetGameUDPClient
+{
+public:
+	NetGameUDPClient();
+	~NetGameUDPClient();
+
+	/// \brief Connect
+	///
+	/// \param server = String
+	/// \param port = String
+	void connect(const std::string &server, const std::string &port);
+
+	/// \brief Disconnect
+	void disconnect();
+
+	/// \brief Process events
+	void process_events();
+
+	/// \brief Send event
+	///
+	/// \param game_event = Net Game Event
+	/// \param reliability = Delivery guarantee
+	void send_event(const NetGameEvent &game_event, NetGameReliability reliability = NetGameReliability::reliable_ordered);
+
+	/// \brief Returns the smoothed round trip time in milliseconds
+	float get_round_trip_time() const;
+
+	/// \brief Drops outgoing packets at random, for testing
+	///
+	/// \param probability = Chance from 0 to 1 that a packet is dropped
+	void set_simulated_packet_loss(float probability);
+
+	Signal<void(const NetGameEvent &)> &sig_event_received();
+
+	/// \brief Sig connected
+	///
+	/// \return Signal<void()>
+	Signal<void()> &sig_connected();
+
+	/// \brief Sig disconnected
+	///
+	/// \return Signal<void()>
+	Signal<void()> &sig_disconnected();
+
+private:
+	std::shared_ptr<NetGameUDPClient_Impl> impl;
+};
+
+}
+
+/// \}
@@ -0,0 +1,113 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <string>
+#include <memory>
+#include "event.h"
+
+namespace clan
+{
+/// \addtogroup clanNetwork_NetGame clanNetwork NetGame
+/// \{
+
+class SocketName;
+class NetGameUDPConnection_Impl;
+
+/// \brief Delivery guarantee for an event sent over UDP
+enum class NetGameReliability
+{
+	/// \brief Sent once. The event may be lost or arrive out of order
+	unreliable,
+
+	/// \brief Sent once. The event may be lost, and is dropped if a newer sequenced event already arrived
+	unreliable_sequenced,
+
+	/// \brief Resent until acknowledged. Events arrive in the order they were sent
+	reliable_ordered
+};
+
+/// \brief Connection to a remote end of a NetGameUDPServer or NetGameUDPClient
+///
+/// Events are queued and sent the next time the owning server or client processes its events.
+class NetGameUDPConnection
+{
+public:
+	~NetGameUDPConnection();
+
+	/// \brief Set data
+	///
+	/// \param name = String Ref
+	/// \param data = void
+	void set_data(const std::string &name, void *data);
+
+	/// \brief Get data
+	///
+	/// \param name = String Ref
+	///
+	/// \return void
+	void *get_data(const std::string &name) const;
+
+	/// \brief Send event
+	///
+	/// \param game_event = Net Game Event
+	/// \param reliability = Delivery guarantee
+	void send_event(const NetGameEvent &game_event, NetGameReliability reliability = NetGameReliability::reliable_ordered);
+
+	/// \brief Disconnects the remote end
+	///
+	/// Reliable events not yet acknowledged when the disconnect is sent may be lost.
+	void disconnect();
+
+	/// \brief Get Remote name
+	///
+	/// \return remote_name
+	SocketName get_remote_name() const;
+
+	/// \brief Returns the smoothed round trip time in milliseconds
+	float get_round_trip_time() const;
+
+private:
+	NetGameUDPConnection(const SocketName &remote_name);
+
+	/// \brief Disallow copy constructors
+	NetGameUDPConnection(NetGameUDPConnection &other);
+	NetGameUDPConnection &operator =(const NetGameUDPConnection &other);
+
+	std::shared_ptr<NetGameUDPConnection_Impl> impl;
+
+	friend class NetGameUDPServer;
+	friend class NetGameUDPServer_Impl;
+	friend class NetGameUDPClient;
+	friend class NetGameUDPClient_Impl;
+};
+
+}
+
+/// \}
@@ -0,0 +1,94 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <vector>
+#include "udp_connection.h"
+#include "../../Core/Signals/signal.h"
+
+namespace clan
+{
+/// \addtogroup clanNetwork_NetGame clanNetwork NetGame
+/// \{
+
+class NetGameEvent;
+class NetGameUDPServer_Impl;
+
+/// \brief NetGame server using UDP
+///
+/// Unlike NetGameServer, a lost packet only delays the reliable events it carried. All socket I/O happens in
+/// process_events(), which receives the waiting packets, emits the signals and then sends the queued events
+/// to each client, packed into as few packets as possible.
+class NetGameUDPServer
+{
+public:
+	NetGameUDPServer();
+	~NetGameUDPServer();
+
+	/// \brief Start
+	///
+	/// \param port = String
+	void start(const std::string &port);
+
+	/// \brief Start
+	///
+	/// \param address = String
+	/// \param port = String
+	void start(const std::string &address, const std::string &port);
+
+	/// \brief Process events
+	void process_events();
+
+	/// \brief Stop
+	void stop();
+
+	/// \brief Send event to all connected clients
+	///
+	/// The event is encoded once and the result is shared by all the connections.
+	///
+	/// \param game_event = Net Game Event
+	/// \param reliability = Delivery guarantee
+	void send_event(const NetGameEvent &game_event, NetGameReliability reliability = NetGameReliability::reliable_ordered);
+
+	/// \brief Drops outgoing packets at random, for testing
+	///
+	/// \param probability = Chance from 0 to 1 that a packet is dropped
+	void set_simulated_packet_loss(float probability);
+
+	Signal<void(NetGameUDPConnection *)> &sig_client_connected();
+	Signal<void(NetGameUDPConnection *, const std::string &)> &sig_client_disconnected();
+	Signal<void(NetGameUDPConnection *, const NetGameEvent &)> &sig_event_received();
+
+private:
+	std::shared_ptr<NetGameUDPServer_Impl> impl;
+};
+
+}
+
+/// \}
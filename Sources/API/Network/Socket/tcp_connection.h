@@ -47,6 +47,10 @@ namespace clan
 		/// \return Bytes read, 0 if remote closed connection, or -1 if buffer is empty
 		int read(void *data, int size);
 
+		/// \brief Returns the smoothed round trip time measured by the operating system
+		/// \return Round trip time in microseconds, or -1 if it is not available on this platform
+		int get_round_trip_time();
+
 		/// \internal Constructs a TCPConnection instance based on a socket handle
 		TCPConnection(const std::shared_ptr<TCPSocket> &impl);
 
@@ -88,6 +88,32 @@ public:
 
 	/// \brief Mixes many float channels into one float channel with individual volumes for each channel
 	static void mix_many_to_one(float **input, float *volume, int channels, int size, float *output);
+
+	/// \brief Number of taps in the filters used by resample_sinc
+	static const int sinc_taps = 16;
+
+	/// \brief Resamples a channel using linear interpolation
+	///
+	/// Writes input interpolated at position, position + step, position + 2 * step and so on to output.
+	/// The input must hold one sample after the last position.
+	static void resample_linear(const float *input, double position, double step, int size, float *output);
+
+	/// \brief Resamples a channel using Catmull-Rom cubic interpolation
+	///
+	/// The input must hold one sample before the first position and two after the last.
+	static void resample_cubic(const float *input, double position, double step, int size, float *output);
+
+	/// \brief Resamples a channel using a windowed sinc polyphase filter
+	///
+	/// The filter holds phases + 1 rows of sinc_taps coefficients, created by build_sinc_filter.
+	/// The input must hold sinc_taps / 2 - 1 samples before the first position and sinc_taps / 2 after the last.
+	static void resample_sinc(const float *input, double position, double step, int size, const float *filter, int phases, float *output);
+
+	/// \brief Creates the polyphase filter used by resample_sinc
+	///
+	/// \param filter Receives (phases + 1) * sinc_taps coefficients
+	/// \param cutoff Cutoff frequency relative to the input Nyquist frequency. Use less than 1 when step is larger than 1.
+	static void build_sinc_filter(float *filter, int phases, float cutoff);
 /// \}
 };
 
@@ -42,6 +42,19 @@ class SoundBuffer;
 class SoundBuffer_Session_Impl;
 class SoundOutput;
 
+/// \brief Interpolation used when a session plays at a different frequency than the mixer
+enum class SoundResampleQuality
+{
+	/// \brief Linear interpolation between two samples
+	linear,
+
+	/// \brief Catmull-Rom cubic interpolation over four samples
+	cubic,
+
+	/// \brief Windowed sinc polyphase filter over 16 samples, band-limited when the pitch is raised
+	sinc
+};
+
 /// \brief SoundBuffer_Session provides control over a playing soundeffect.
 ///
 ///    <p>Whenever a soundbuffer is played, it returns a SoundBuffer_Session
@@ -106,6 +119,12 @@ public:
 	/// \return true if session should loop, false otherwise
 	bool get_looping() const;
 
+	/// \brief Returns the interpolation used to convert to the mixing frequency.
+	SoundResampleQuality get_resample_quality() const;
+
+	/// \brief Returns how many times the mixer ran out of decoded samples for this session.
+	int get_underrun_count() const;
+
 	/// \brief Returns true if the session is playing
 	bool is_playing();
 
@@ -142,6 +161,11 @@ public:
 	/// \param new_freq New frequency of session.
 	void set_frequency(int new_freq);
 
+	/// \brief Sets the interpolation used to convert to the mixing frequency.
+	///
+	/// Defaults to linear. Sinc gives the least aliasing, but costs the most.
+	void set_resample_quality(SoundResampleQuality quality);
+
 	/// \brief Sets the volume of the session in a relative measure (0->1)
 	///
 	/// A value of 0 will effectively mute the sound (although it will
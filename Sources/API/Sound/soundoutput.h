@@ -93,6 +93,11 @@ public:
 	/// \brief Returns the main panning position of the sound output.
 	float get_global_pan() const;
 
+	/// \brief Returns how many times a playing session ran out of decoded samples.
+	///
+	/// A rising count means the decoder workers cannot keep up with the sessions being played.
+	int get_underrun_count() const;
+
 /// \}
 /// \name Operations
 /// \{
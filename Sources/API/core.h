@@ -109,6 +109,7 @@
 #include "Core/XML/xml_writer.h"
 #include "Core/XML/xml_token.h"
 #include "Core/XML/xpath_evaluator.h"
+#include "Core/XML/xpath_expression.h"
 #include "Core/XML/xpath_object.h"
 #include "Core/IOData/file.h"
 #include "Core/IOData/file_help.h"
@@ -122,6 +123,7 @@
 #include "Core/IOData/file_system_provider.h"
 #include "Core/IOData/directory_listing.h"
 #include "Core/IOData/memory_device.h"
+#include "Core/IOData/mapped_file.h"
 #include "Core/IOData/html_url.h"
 #include "Core/Zip/zip_archive.h"
 #include "Core/Zip/zip_writer.h"
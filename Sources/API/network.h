@@ -48,10 +48,17 @@
 
 #include "Network/NetGame/client.h"
 #include "Network/NetGame/connection.h"
+#include "Network/NetGame/connection_stats.h"
 #include "Network/NetGame/event.h"
 #include "Network/NetGame/event_dispatcher.h"
+#include "Network/NetGame/event_schema.h"
 #include "Network/NetGame/event_value.h"
+#include "Network/NetGame/reactor.h"
+#include "Network/NetGame/send_budget.h"
 #include "Network/NetGame/server.h"
+#include "Network/NetGame/udp_client.h"
+#include "Network/NetGame/udp_connection.h"
+#include "Network/NetGame/udp_server.h"
 
 #ifdef __cplusplus_cli
 #pragma managed(pop)
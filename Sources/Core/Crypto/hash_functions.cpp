@@ -32,6 +32,7 @@
 #include "API/Core/Crypto/hash_functions.h"
 #include "API/Core/System/databuffer.h"
 #include "Core/Zip/miniz.h"
+#include "Core/Zip/zip_crc32.h"
 
 namespace clan
 {
@@ -47,11 +48,7 @@ namespace clan
 
 uint32_t HashFunctions::crc32( const void *data, int size, uint32_t running_crc/*=0*/ )
 {
-	uint32_t crc = running_crc;
-	if (crc == 0)
-		crc = mz_crc32(0L, nullptr, 0);
-
-	return mz_crc32(running_crc, (const unsigned char*)data, size);;
+	return ~ZipCRC32::update(~running_crc, data, size);
 }
 
 uint32_t HashFunctions::adler32( const void *data, int size, uint32_t running_adler32/*=0*/ )
@@ -0,0 +1,84 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Core/precomp.h"
+#include "file_mapping_unix.h"
+#include "API/Core/System/exception.h"
+#include "API/Core/Text/string_help.h"
+#include "API/Core/Text/string_format.h"
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <climits>
+
+namespace clan
+{
+
+FileMapping_Unix::FileMapping_Unix(const std::string &filename)
+: data(""), size(0), mapped(false)
+{
+	std::string filename_a = StringHelp::text_to_local8(filename);
+	int handle = ::open(filename_a.c_str(), O_RDONLY);
+	if (handle == -1)
+		throw Exception(string_format("Unable to open file '%1'", filename));
+
+	struct stat file_stat;
+	if (fstat(handle, &file_stat) == -1 || file_stat.st_size > INT_MAX)
+	{
+		::close(handle);
+		throw Exception(string_format("Unable to get size of file '%1'", filename));
+	}
+
+	// mmap does not accept zero length, so empty files are represented by an empty string
+	if (file_stat.st_size > 0)
+	{
+		void *address = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, handle, 0);
+		if (address == MAP_FAILED)
+		{
+			::close(handle);
+			throw Exception(string_format("Unable to map file '%1'", filename));
+		}
+
+		data = static_cast<const char*>(address);
+		size = (int)file_stat.st_size;
+		mapped = true;
+	}
+
+	// The mapping keeps its own reference to the file
+	::close(handle);
+}
+
+FileMapping_Unix::~FileMapping_Unix()
+{
+	if (mapped)
+		munmap(const_cast<char*>(data), size);
+}
+
+}
@@ -0,0 +1,86 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Core/precomp.h"
+#include "file_mapping_win32.h"
+#include "API/Core/System/exception.h"
+#include "API/Core/Text/string_help.h"
+#include "API/Core/Text/string_format.h"
+#include <climits>
+
+namespace clan
+{
+
+FileMapping_Win32::FileMapping_Win32(const std::string &filename)
+: file_handle(INVALID_HANDLE_VALUE), mapping_handle(0), data(""), size(0), mapped(false)
+{
+	file_handle = CreateFile(StringHelp::utf8_to_ucs2(filename).c_str(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+	if (file_handle == INVALID_HANDLE_VALUE)
+		throw Exception(string_format("Unable to open file '%1'", filename));
+
+	LARGE_INTEGER file_size;
+	if (GetFileSizeEx(file_handle, &file_size) == FALSE || file_size.QuadPart > INT_MAX)
+	{
+		CloseHandle(file_handle);
+		throw Exception(string_format("Unable to get size of file '%1'", filename));
+	}
+
+	// CreateFileMapping does not accept empty files, so they are represented by an empty string
+	if (file_size.QuadPart > 0)
+	{
+		mapping_handle = CreateFileMapping(file_handle, 0, PAGE_READONLY, 0, 0, 0);
+		if (mapping_handle == 0)
+		{
+			CloseHandle(file_handle);
+			throw Exception(string_format("Unable to map file '%1'", filename));
+		}
+
+		void *address = MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+		if (address == 0)
+		{
+			CloseHandle(mapping_handle);
+			CloseHandle(file_handle);
+			throw Exception(string_format("Unable to map file '%1'", filename));
+		}
+
+		data = static_cast<const char*>(address);
+		size = (int)file_size.QuadPart;
+		mapped = true;
+	}
+}
+
+FileMapping_Win32::~FileMapping_Win32()
+{
+	if (mapped)
+		UnmapViewOfFile(data);
+	if (mapping_handle)
+		CloseHandle(mapping_handle);
+	CloseHandle(file_handle);
+}
+
+}
@@ -81,6 +81,13 @@ bool IODevice::is_little_endian() const
 	return impl->little_endian_mode;
 }
 
+MappedSpan IODevice::get_mapped_span() const
+{
+	if (impl)
+		return impl->provider->get_mapped_span();
+	return MappedSpan();
+}
+
 const IODeviceProvider *IODevice::get_provider() const
 {
 	throw_if_null();
@@ -244,12 +244,12 @@ int IODeviceProvider_File::read(void *buffer, int size, bool read_all)
 {
 	if (size == 0)
 		return 0;
-	if (peeked_data.get_size() > 0)
+	if (peeked.get_size() > 0)
 	{
-		int peek_amount = min(size, peeked_data.get_size());
-		memcpy(buffer, peeked_data.get_data(), peek_amount);
-		memmove(peeked_data.get_data(), peeked_data.get_data()+peek_amount, peeked_data.get_size()-peek_amount);
-		peeked_data.set_size(peeked_data.get_size()-peek_amount);
+		// Consume from the front of the peeked window without moving the remaining data
+		int peek_amount = min(size, (int)peeked.get_size());
+		memcpy(buffer, peeked.get_data(), peek_amount);
+		peeked = DataBufferSlice(peeked, peek_amount, peeked.get_size()-peek_amount);
 		if (peek_amount <= size)
 			return peek_amount + read((char*) buffer+peek_amount, size-peek_amount, read_all);
 	}
@@ -287,25 +287,30 @@ int IODeviceProvider_File::receive(void *data, int len, bool receive_all)
 
 int IODeviceProvider_File::peek(void *data, int len)
 {
-	if (peeked_data.get_size() >= len)
+	if (peeked.get_size() >= (unsigned int)len)
 	{
-		memcpy(data, peeked_data.get_data(), len);
+		memcpy(data, peeked.get_data(), len);
 		return len;
 	}
 	else
 	{
-		int old_size = peeked_data.get_size();
+		// Move the unread part of the window to the start of the storage before reading more
+		int old_size = peeked.get_size();
+		if (peeked.get_position() > 0)
+			memmove(peeked_data.get_data(), peeked.get_data(), old_size);
 		try
 		{
 			peeked_data.set_size(len);
 			int bytes_read = lowlevel_read(peeked_data.get_data()+old_size, len-old_size, false);
 			peeked_data.set_size(old_size+bytes_read);
+			peeked = DataBufferSlice(peeked_data);
 			memcpy(data, peeked_data.get_data(), peeked_data.get_size());
 			return peeked_data.get_size();
 		}
 		catch (const Exception& e)
 		{
 			peeked_data.set_size(old_size);
+			peeked = DataBufferSlice(peeked_data);
 			throw;
 		}
 	}
@@ -111,6 +111,7 @@ private:
 	int handle;
 #endif
 	DataBuffer peeked_data;
+	DataBufferSlice peeked;
 /// \}
 };
 
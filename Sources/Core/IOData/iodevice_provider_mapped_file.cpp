@@ -0,0 +1,144 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Core/precomp.h"
+#include "iodevice_provider_mapped_file.h"
+#include "API/Core/System/exception.h"
+
+#ifdef WIN32
+#include "Win32/file_mapping_win32.h"
+#else
+#include "Unix/file_mapping_unix.h"
+#endif
+
+namespace clan
+{
+
+/////////////////////////////////////////////////////////////////////////////
+// FileMapping Construction:
+
+FileMapping *FileMapping::create(const std::string &filename)
+{
+#ifdef WIN32
+	return new FileMapping_Win32(filename);
+#else
+	return new FileMapping_Unix(filename);
+#endif
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// IODeviceProvider_MappedFile Construction:
+
+IODeviceProvider_MappedFile::IODeviceProvider_MappedFile(const std::string &filename)
+: mapping(FileMapping::create(filename)), position(0)
+{
+}
+
+IODeviceProvider_MappedFile::IODeviceProvider_MappedFile(const std::shared_ptr<FileMapping> &mapping)
+: mapping(mapping), position(0)
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// IODeviceProvider_MappedFile Attributes:
+
+int IODeviceProvider_MappedFile::get_size() const
+{
+	return mapping->get_size();
+}
+
+int IODeviceProvider_MappedFile::get_position() const
+{
+	return position;
+}
+
+MappedSpan IODeviceProvider_MappedFile::get_mapped_span() const
+{
+	return MappedSpan(mapping->get_data(), mapping->get_size());
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// IODeviceProvider_MappedFile Operations:
+
+int IODeviceProvider_MappedFile::send(const void *data, int len, bool send_all)
+{
+	throw Exception("IODeviceProvider_MappedFile::send(): Mapped files are read only");
+}
+
+int IODeviceProvider_MappedFile::receive(void *data, int len, bool receive_all)
+{
+	len = peek(data, len);
+	position += len;
+	return len;
+}
+
+int IODeviceProvider_MappedFile::peek(void *data, int len)
+{
+	int data_available = mapping->get_size() - position;
+	if (len > data_available)
+		len = data_available;
+	memcpy(data, mapping->get_data() + position, len);
+	return len;
+}
+
+bool IODeviceProvider_MappedFile::seek(int requested_position, IODevice::SeekMode mode)
+{
+	int new_position = position;
+	switch (mode)
+	{
+	case IODevice::seek_set:
+		new_position = requested_position;
+		break;
+	case IODevice::seek_cur:
+		new_position += requested_position;
+		break;
+	case IODevice::seek_end:
+		new_position = mapping->get_size() + requested_position;
+		break;
+	default:
+		return false;
+	}
+
+	if (new_position >= 0 && new_position <= mapping->get_size())
+	{
+		position = new_position;
+		return true;
+	}
+	else
+	{
+		return false;
+	}
+}
+
+IODeviceProvider *IODeviceProvider_MappedFile::duplicate()
+{
+	// The mapping is read only, so it can safely be shared
+	return new IODeviceProvider_MappedFile(mapping);
+}
+
+}
@@ -61,6 +61,11 @@ int IODeviceProvider_Memory::get_position() const
 	return position;
 }
 
+MappedSpan IODeviceProvider_Memory::get_mapped_span() const
+{
+	return MappedSpan(data.get_data(), data.get_size());
+}
+
 const DataBuffer &IODeviceProvider_Memory::get_data() const
 {
 	return data;
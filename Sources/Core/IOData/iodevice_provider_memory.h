@@ -54,6 +54,8 @@ public:
 
 	virtual int get_position() const override;
 
+	virtual MappedSpan get_mapped_span() const override;
+
 	const DataBuffer &get_data() const;
 
 	DataBuffer &get_data();
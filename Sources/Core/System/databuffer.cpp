@@ -177,4 +177,47 @@ bool DataBuffer::is_null() const
 /////////////////////////////////////////////////////////////////////////////
 // DataBuffer Implementation:
 
+/////////////////////////////////////////////////////////////////////////////
+// DataBufferSlice Construction:
+
+DataBufferSlice::DataBufferSlice()
+: pos(0), size(0)
+{
+}
+
+DataBufferSlice::DataBufferSlice(const DataBuffer &buffer)
+: impl(buffer.impl), pos(0), size(buffer.get_size())
+{
+}
+
+DataBufferSlice::DataBufferSlice(const DataBuffer &buffer, unsigned int new_pos, unsigned int new_size)
+: impl(buffer.impl), pos(new_pos), size(new_size)
+{
+	if (new_pos > buffer.get_size() || new_size > buffer.get_size() - new_pos)
+		throw Exception("DataBufferSlice range is outside the buffer");
+}
+
+DataBufferSlice::DataBufferSlice(const DataBufferSlice &slice, unsigned int new_pos, unsigned int new_size)
+: impl(slice.impl), pos(slice.pos + new_pos), size(new_size)
+{
+	if (new_pos > slice.size || new_size > slice.size - new_pos)
+		throw Exception("DataBufferSlice range is outside the slice");
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// DataBufferSlice Attributes:
+
+const char *DataBufferSlice::get_data() const
+{
+	return impl ? impl->data + pos : nullptr;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// DataBufferSlice Operations:
+
+DataBuffer DataBufferSlice::copy() const
+{
+	return DataBuffer(get_data(), size);
+}
+
 }
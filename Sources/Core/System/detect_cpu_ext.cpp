@@ -182,6 +182,11 @@ bool System::detect_cpu_extension(CPU_ExtensionX86 ext)
 		__cpuid((int*)cpuinfo, 0x80000001);
 		return ((cpuinfo[2] & (1 << 16)) != 0);
 	}
+	else if(ext == pclmul)
+	{
+		__cpuid((int*)cpuinfo, 0x1);
+		return ((cpuinfo[2] & (1 << 1)) != 0);
+	}
 	return false;
 }
 
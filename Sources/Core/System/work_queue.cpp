@@ -31,9 +31,13 @@
 #include "API/Core/System/system.h"
 #include <algorithm>
 #include "API/Core/Math/cl_math.h"
+#include "work_queue_impl.h"
 #include <atomic>
 #include <thread>
 #include <condition_variable>
+#include <exception>
+#include <chrono>
+#include <typeinfo>
 
 namespace clan
 {
@@ -61,30 +65,49 @@ private:
 	std::function<void()> func;
 };
 
-class WorkQueue_Impl
+class WorkTask_Impl
 {
 public:
-	WorkQueue_Impl(bool serial_queue);
-	~WorkQueue_Impl();
+	WorkTask_Impl(WorkQueue_Impl *work_queue, const std::function<void()> &func) : work_queue(work_queue), func(func), unfinished_dependencies(1) { }
 
-	void queue(WorkItem *item); // transfers ownership
-	void work_completed(WorkItem *item); // transfers ownership
+	void add_dependency(const std::shared_ptr<WorkTask_Impl> &self, WorkTask_Impl *dependency);
+	void dependency_finished(const std::shared_ptr<WorkTask_Impl> &self, const std::exception_ptr &dependency_exception);
+	void run();
 
-	int get_items_queued() const { return items_queued; }
+	WorkQueue_Impl *work_queue;
+	std::function<void()> func;
+	std::atomic_int unfinished_dependencies;
 
-	void process_work_completed();
+	std::mutex mutex;
+	std::condition_variable completed_event;
+	bool completed = false;
+	std::exception_ptr exception;
+	std::vector<std::shared_ptr<WorkTask_Impl>> successors;
+};
 
-private:
-	void worker_main();
+class ParallelForState
+{
+public:
+	ParallelForState(int begin, int end, int grain_size, const std::function<void(int, int)> &func)
+		: next(begin), end(end), grain_size(grain_size), func(&func), remaining(end - begin), failed(false)
+	{
+	}
+
+	void run();
+	void wait();
 
-	bool serial_queue = false;
-	std::vector<std::thread> threads;
+	std::exception_ptr exception;
+
+private:
+	std::atomic<int64_t> next;
+	int end;
+	int grain_size;
+	const std::function<void(int, int)> *func; // Only valid while remaining > 0
+	std::atomic_int remaining;
+	std::atomic_bool failed;
 	std::mutex mutex;
-	std::condition_variable worker_event;
-	bool stop_flag = false;
-	std::vector<WorkItem *> queued_items;
-	std::vector<WorkItem *> finished_items;
-	std::atomic_int items_queued;
+	std::condition_variable done_event;
+	bool done = false;
 };
 
 WorkQueue::WorkQueue(bool serial_queue)
@@ -106,11 +129,47 @@ void WorkQueue::queue(const std::function<void()> &func)
 	impl->queue(new WorkItemProcess(func));
 }
 
+WorkTask WorkQueue::queue_task(const std::function<void()> &func, const std::vector<WorkTask> &dependencies)
+{
+	auto task = std::make_shared<WorkTask_Impl>(impl.get(), func);
+	for (const auto &dependency : dependencies)
+	{
+		if (dependency.impl)
+			task->add_dependency(task, dependency.impl.get());
+	}
+
+	// Release the reference that kept the task from starting while its dependencies were being registered
+	task->dependency_finished(task, std::exception_ptr());
+	return WorkTask(task);
+}
+
 void WorkQueue::work_completed(const std::function<void()> &func)
 {
 	impl->work_completed(new WorkItemWorkCompleted(func));
 }
 
+void WorkQueue::parallel_for(int begin, int end, const std::function<void(int begin, int end)> &func, int grain_size)
+{
+	impl->parallel_for(begin, end, grain_size, func);
+}
+
+void *WorkQueue::alloc_inline_item(WorkItemInline *&out_item)
+{
+	out_item = impl->alloc_inline_item();
+	return out_item->get_storage();
+}
+
+void WorkQueue::free_inline_item(WorkItemInline *item)
+{
+	impl->free_inline_item(item);
+}
+
+void WorkQueue::queue_inline_item(WorkItemInline *item, void(*invoke)(void *data), void(*destroy)(void *data))
+{
+	item->set_functions(invoke, destroy);
+	impl->queue(item);
+}
+
 int WorkQueue::get_items_queued() const
 {
 	return impl->get_items_queued();
@@ -124,7 +183,7 @@ void WorkQueue::process_work_completed()
 /////////////////////////////////////////////////////////////////////////////
 
 WorkQueue_Impl::WorkQueue_Impl(bool serial_queue)
-	: serial_queue(serial_queue)
+	: serial_queue(serial_queue), stop_flag(false), injection_size(0), pending_items(0), sleeping_workers(0), items_queued(0)
 {
 }
 
@@ -135,42 +194,197 @@ WorkQueue_Impl::~WorkQueue_Impl()
 	mutex_lock.unlock();
 	worker_event.notify_all();
 
-	for (auto & elem : threads)
-		elem.join();
-	for (auto & elem : queued_items)
-		delete elem;
+	for (auto & elem : workers)
+		elem->thread.join();
+	for (auto & elem : workers)
+	{
+		while (WorkItem *item = elem->deque.pop())
+			discard_item(item);
+	}
+	while (!injection_queue.empty())
+		discard_item(injection_queue.pop_front());
 	for (auto & elem : finished_items)
 		delete elem;
 }
 
-void WorkQueue_Impl::queue(WorkItem *item) // transfers ownership
+void WorkQueue_Impl::discard_item(WorkItem *item)
+{
+	if (typeid(*item) == typeid(WorkItemInline))
+		static_cast<WorkItemInline*>(item)->clear_callable();
+	else
+		delete item;
+}
+
+void WorkQueue_Impl::start_threads()
 {
-	if (threads.empty())
+	// Workers wait for the mutex before touching the worker list, so the list is complete before any of them runs
+	std::unique_lock<std::mutex> mutex_lock(mutex);
+
+	int num_cores = serial_queue ? 1 : clan::max(System::get_num_cores() - 1, 1);
+	for (int i = 0; i < num_cores; i++)
 	{
-		int num_cores = serial_queue ? 1 : clan::max(System::get_num_cores() - 1, 1);
-		for (int i = 0; i < num_cores; i++)
-		{
-			threads.push_back(std::thread(&WorkQueue_Impl::worker_main, this));
-		}
+		workers.push_back(std::unique_ptr<Worker>(new Worker()));
+		workers.back()->steal_seed = 0x9e3779b9u * (i + 1);
 	}
 
-	std::unique_lock<std::mutex> mutex_lock(mutex);
-	queued_items.push_back(item);
+	for (int i = 0; i < num_cores; i++)
+	{
+		workers[i]->thread = std::thread(&WorkQueue_Impl::worker_main, this, i);
+		workers[i]->thread_id = workers[i]->thread.get_id();
+	}
+}
+
+void WorkQueue_Impl::queue(WorkItem *item) // transfers ownership
+{
+	if (workers.empty())
+		start_threads();
+
 	++items_queued;
-	mutex_lock.unlock();
-	worker_event.notify_one();
+
+	// Work queued from a worker thread goes onto its own deque where it is cheap to pop and other workers can steal it
+	int worker_index = serial_queue ? -1 : find_current_worker();
+	if (worker_index != -1)
+	{
+		workers[worker_index]->deque.push(item);
+		++pending_items;
+		if (sleeping_workers.load() > 0)
+			wake_worker();
+	}
+	else
+	{
+		std::unique_lock<std::mutex> mutex_lock(mutex);
+		injection_queue.push_back(item);
+		++injection_size;
+		++pending_items;
+		bool has_sleepers = sleeping_workers.load() > 0;
+		mutex_lock.unlock();
+		if (has_sleepers)
+			worker_event.notify_one();
+	}
 }
 
 void WorkQueue_Impl::work_completed(WorkItem *item) // transfers ownership
 {
-	std::unique_lock<std::mutex> mutex_lock(mutex);
+	std::unique_lock<std::mutex> mutex_lock(finished_mutex);
 	finished_items.push_back(item);
 	++items_queued;
 }
 
+WorkItemInline *WorkQueue_Impl::alloc_inline_item()
+{
+	// Worker threads refill their own cache in batches, so only other threads take the pool mutex for every item
+	int worker_index = find_current_worker();
+	Worker *worker = worker_index != -1 ? workers[worker_index].get() : nullptr;
+	if (!worker || !worker->free_inline_items)
+	{
+		std::unique_lock<std::mutex> mutex_lock(inline_pool_mutex);
+		if (!free_inline_items)
+		{
+			inline_item_blocks.push_back(std::unique_ptr<WorkItemInline[]>(new WorkItemInline[inline_item_block_size]));
+			WorkItemInline *block = inline_item_blocks.back().get();
+			for (int i = 0; i < inline_item_block_size; i++)
+			{
+				block[i].next_free = free_inline_items;
+				free_inline_items = &block[i];
+			}
+		}
+
+		if (!worker)
+		{
+			WorkItemInline *item = free_inline_items;
+			free_inline_items = item->next_free;
+			item->next_free = nullptr;
+			return item;
+		}
+
+		while (free_inline_items && worker->num_free_inline_items < inline_item_cache_size / 2)
+		{
+			WorkItemInline *item = free_inline_items;
+			free_inline_items = item->next_free;
+			item->next_free = worker->free_inline_items;
+			worker->free_inline_items = item;
+			worker->num_free_inline_items++;
+		}
+	}
+
+	WorkItemInline *item = worker->free_inline_items;
+	worker->free_inline_items = item->next_free;
+	worker->num_free_inline_items--;
+	item->next_free = nullptr;
+	return item;
+}
+
+void WorkQueue_Impl::free_inline_item(WorkItemInline *item)
+{
+	int worker_index = find_current_worker();
+	if (worker_index != -1)
+	{
+		release_inline_item(workers[worker_index].get(), item);
+	}
+	else
+	{
+		std::unique_lock<std::mutex> mutex_lock(inline_pool_mutex);
+		item->next_free = free_inline_items;
+		free_inline_items = item;
+	}
+}
+
+void WorkQueue_Impl::release_inline_item(Worker *worker, WorkItemInline *item)
+{
+	item->next_free = worker->free_inline_items;
+	worker->free_inline_items = item;
+	worker->num_free_inline_items++;
+
+	// Hand half of a full cache back to the pool, where threads that are not workers allocate from
+	if (worker->num_free_inline_items > inline_item_cache_size)
+	{
+		WorkItemInline *first = worker->free_inline_items;
+		WorkItemInline *last = first;
+		for (int i = 1; i < inline_item_cache_size / 2; i++)
+			last = last->next_free;
+		worker->free_inline_items = last->next_free;
+		worker->num_free_inline_items -= inline_item_cache_size / 2;
+
+		std::unique_lock<std::mutex> mutex_lock(inline_pool_mutex);
+		last->next_free = free_inline_items;
+		free_inline_items = first;
+	}
+}
+
+void WorkQueue_Impl::parallel_for(int begin, int end, int grain_size, const std::function<void(int, int)> &func)
+{
+	if (end <= begin)
+		return;
+
+	if (workers.empty())
+		start_threads();
+
+	int count = end - begin;
+	if (grain_size <= 0)
+		grain_size = clan::max(count / ((int)workers.size() * 8), 1);
+
+	auto state = std::make_shared<ParallelForState>(begin, end, grain_size, func);
+
+	// The calling thread works on chunks too, so the helpers only speed things up if they get scheduled in time
+	int num_chunks = (count + grain_size - 1) / grain_size;
+	int num_helpers = clan::min(num_chunks - 1, (int)workers.size());
+	for (int i = 0; i < num_helpers; i++)
+	{
+		WorkItemInline *item = alloc_inline_item();
+		item->set_callable([state]() { state->run(); });
+		queue(item);
+	}
+
+	state->run();
+	state->wait();
+
+	if (state->exception)
+		std::rethrow_exception(state->exception);
+}
+
 void WorkQueue_Impl::process_work_completed()
 {
-	std::unique_lock<std::mutex> mutex_lock(mutex);
+	std::unique_lock<std::mutex> mutex_lock(finished_mutex);
 	std::vector<WorkItem *> items;
 	items.swap(finished_items);
 	mutex_lock.unlock();
@@ -191,26 +405,301 @@ void WorkQueue_Impl::process_work_completed()
 	}
 }
 
-void WorkQueue_Impl::worker_main()
+int WorkQueue_Impl::find_current_worker() const
 {
-	while (true)
+	std::thread::id current_id = std::this_thread::get_id();
+	for (size_t i = 0; i < workers.size(); i++)
+	{
+		if (workers[i]->thread_id == current_id)
+			return (int)i;
+	}
+	return -1;
+}
+
+WorkItem *WorkQueue_Impl::find_work(int worker_index)
+{
+	Worker *worker = workers[worker_index].get();
+
+	WorkItem *item = serial_queue ? nullptr : worker->deque.pop();
+
+	if (!item && injection_size.load() > 0)
 	{
 		std::unique_lock<std::mutex> mutex_lock(mutex);
-		worker_event.wait(mutex_lock, [&]() { return stop_flag || !queued_items.empty(); });
+		if (!injection_queue.empty())
+		{
+			item = injection_queue.pop_front();
+			--injection_size;
+
+			// Grab a fair share of the remaining items to spread them without everyone going through the mutex
+			if (!serial_queue)
+			{
+				int batch = clan::min((int)injection_queue.size() / (int)workers.size(), (int)max_injection_batch);
+				for (int i = 0; i < batch; i++)
+				{
+					worker->deque.push(injection_queue.pop_front());
+					--injection_size;
+				}
+			}
+		}
+	}
 
-		if (stop_flag)
-			break;
+	if (!item && !serial_queue)
+		item = steal_work(worker_index);
 
-		WorkItem *item = queued_items.front();
-		queued_items.erase(queued_items.begin());
-		mutex_lock.unlock();
+	if (item)
+		--pending_items;
+	return item;
+}
+
+WorkItem *WorkQueue_Impl::steal_work(int worker_index)
+{
+	int num_workers = (int)workers.size();
+	if (num_workers < 2)
+		return nullptr;
 
-		item->process_work();
+	Worker *worker = workers[worker_index].get();
+	worker->steal_seed ^= worker->steal_seed << 13;
+	worker->steal_seed ^= worker->steal_seed >> 17;
+	worker->steal_seed ^= worker->steal_seed << 5;
 
-		mutex_lock.lock();
-		finished_items.push_back(item);
-		mutex_lock.unlock();
+	int start = (int)(worker->steal_seed % (unsigned int)num_workers);
+	for (int i = 0; i < num_workers; i++)
+	{
+		int victim = (start + i) % num_workers;
+		if (victim == worker_index)
+			continue;
+		WorkItem *item = workers[victim]->deque.steal();
+		if (item)
+			return item;
+	}
+	return nullptr;
+}
+
+void WorkQueue_Impl::wake_worker()
+{
+	// Taking the mutex guarantees a worker cannot be between its sleep predicate check and its wait
+	std::unique_lock<std::mutex> mutex_lock(mutex);
+	mutex_lock.unlock();
+	worker_event.notify_one();
+}
+
+void WorkQueue_Impl::worker_main(int worker_index)
+{
+	std::unique_lock<std::mutex> mutex_lock(mutex);
+	mutex_lock.unlock();
+
+	while (!stop_flag)
+	{
+		WorkItem *item = find_work(worker_index);
+		if (item)
+		{
+			item->process_work();
+
+			// Inline items have nothing to complete on the main thread and go straight back to the pool
+			if (typeid(*item) == typeid(WorkItemInline))
+			{
+				release_inline_item(workers[worker_index].get(), static_cast<WorkItemInline*>(item));
+				--items_queued;
+			}
+			else
+			{
+				std::unique_lock<std::mutex> finished_lock(finished_mutex);
+				finished_items.push_back(item);
+			}
+		}
+		else if (pending_items.load() > 0)
+		{
+			// Some item is in transit between queues, or we lost a steal race
+			std::this_thread::yield();
+		}
+		else
+		{
+			mutex_lock.lock();
+			++sleeping_workers;
+			worker_event.wait(mutex_lock, [&]() { return stop_flag || pending_items.load() > 0; });
+			--sleeping_workers;
+			mutex_lock.unlock();
+		}
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void WorkItemInline::process_work()
+{
+	// Destroys the callable even if it throws, so a failed job does not keep its captured objects alive in the pool
+	struct ClearGuard
+	{
+		~ClearGuard() { item->clear_callable(); }
+		WorkItemInline *item;
+	} guard = { this };
+
+	invoke(&storage);
+}
+
+void WorkItemInline::clear_callable()
+{
+	if (destroy)
+		destroy(&storage);
+	invoke = nullptr;
+	destroy = nullptr;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+WorkTask::WorkTask()
+{
+}
+
+WorkTask::WorkTask(const std::shared_ptr<WorkTask_Impl> &impl) : impl(impl)
+{
+}
+
+bool WorkTask::is_completed() const
+{
+	if (!impl)
+		throw Exception("WorkTask is null");
+
+	std::unique_lock<std::mutex> mutex_lock(impl->mutex);
+	return impl->completed;
+}
+
+void WorkTask::wait() const
+{
+	if (!impl)
+		throw Exception("WorkTask is null");
+
+	std::unique_lock<std::mutex> mutex_lock(impl->mutex);
+	impl->completed_event.wait(mutex_lock, [&]() { return impl->completed; });
+	if (impl->exception)
+		std::rethrow_exception(impl->exception);
+}
+
+bool WorkTask::wait(int timeout_ms) const
+{
+	if (!impl)
+		throw Exception("WorkTask is null");
+
+	std::unique_lock<std::mutex> mutex_lock(impl->mutex);
+	if (!impl->completed_event.wait_for(mutex_lock, std::chrono::milliseconds(timeout_ms), [&]() { return impl->completed; }))
+		return false;
+	if (impl->exception)
+		std::rethrow_exception(impl->exception);
+	return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void WorkTask_Impl::add_dependency(const std::shared_ptr<WorkTask_Impl> &self, WorkTask_Impl *dependency)
+{
+	std::unique_lock<std::mutex> mutex_lock(dependency->mutex);
+	if (dependency->completed)
+	{
+		if (dependency->exception)
+		{
+			std::unique_lock<std::mutex> self_lock(mutex);
+			if (!exception)
+				exception = dependency->exception;
+		}
+	}
+	else
+	{
+		++unfinished_dependencies;
+		dependency->successors.push_back(self);
+	}
+}
+
+void WorkTask_Impl::dependency_finished(const std::shared_ptr<WorkTask_Impl> &self, const std::exception_ptr &dependency_exception)
+{
+	if (dependency_exception)
+	{
+		std::unique_lock<std::mutex> mutex_lock(mutex);
+		if (!exception)
+			exception = dependency_exception;
 	}
+
+	if (--unfinished_dependencies == 0)
+	{
+		WorkItemInline *item = work_queue->alloc_inline_item();
+		item->set_callable([self]() { self->run(); });
+		work_queue->queue(item);
+	}
+}
+
+void WorkTask_Impl::run()
+{
+	std::unique_lock<std::mutex> mutex_lock(mutex);
+	bool dependency_failed = !!exception;
+	mutex_lock.unlock();
+
+	std::exception_ptr run_exception;
+	if (!dependency_failed)
+	{
+		try
+		{
+			func();
+		}
+		catch (...)
+		{
+			run_exception = std::current_exception();
+		}
+	}
+	func = std::function<void()>();
+
+	mutex_lock.lock();
+	if (run_exception)
+		exception = run_exception;
+	completed = true;
+	std::exception_ptr task_exception = exception;
+	std::vector<std::shared_ptr<WorkTask_Impl>> finished_successors;
+	finished_successors.swap(successors);
+	mutex_lock.unlock();
+	completed_event.notify_all();
+
+	for (auto &successor : finished_successors)
+		successor->dependency_finished(successor, task_exception);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void ParallelForState::run()
+{
+	while (true)
+	{
+		int64_t chunk_begin = next.fetch_add(grain_size);
+		if (chunk_begin >= end)
+			break;
+
+		int chunk_end = (int)clan::min(chunk_begin + grain_size, (int64_t)end);
+		if (!failed)
+		{
+			try
+			{
+				(*func)((int)chunk_begin, chunk_end);
+			}
+			catch (...)
+			{
+				std::unique_lock<std::mutex> mutex_lock(mutex);
+				if (!exception)
+					exception = std::current_exception();
+				failed = true;
+			}
+		}
+
+		int chunk_size = chunk_end - (int)chunk_begin;
+		if (remaining.fetch_sub(chunk_size) == chunk_size)
+		{
+			std::unique_lock<std::mutex> mutex_lock(mutex);
+			done = true;
+			done_event.notify_all();
+		}
+	}
+}
+
+void ParallelForState::wait()
+{
+	std::unique_lock<std::mutex> mutex_lock(mutex);
+	done_event.wait(mutex_lock, [&]() { return done; });
 }
 
 }
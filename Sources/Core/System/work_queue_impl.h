@@ -0,0 +1,187 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "API/Core/System/work_queue.h"
+#include "work_stealing_deque.h"
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <vector>
+
+namespace clan
+{
+
+/// \brief Recycled work item used by WorkQueue::queue_inline
+///
+/// The callable is stored inside the item instead of on the heap. Items are owned by the pool of their WorkQueue_Impl.
+class WorkItemInline : public WorkItem
+{
+public:
+	typedef void(*Function)(void *data);
+
+	void process_work() override;
+
+	/// \brief Storage for a callable of WorkQueue::max_inline_callable_size bytes
+	void *get_storage() { return &storage; }
+
+	/// \brief Sets the functions calling and destroying the callable constructed in the storage
+	void set_functions(Function new_invoke, Function new_destroy) { invoke = new_invoke; destroy = new_destroy; }
+
+	/// \brief Moves or copies a callable into the item
+	template<typename Func>
+	void set_callable(Func &&func)
+	{
+		typedef typename std::decay<Func>::type FuncType;
+		static_assert(sizeof(FuncType) <= sizeof(Storage), "Callable is too large for WorkItemInline");
+		static_assert(std::alignment_of<FuncType>::value <= std::alignment_of<Storage>::value, "Callable alignment is too large for WorkItemInline");
+		new (&storage) FuncType(std::forward<Func>(func));
+		set_functions(&invoke_callable<FuncType>, &destroy_callable<FuncType>);
+	}
+
+	/// \brief Destroys the stored callable without calling it
+	void clear_callable();
+
+	WorkItemInline *next_free = nullptr;
+
+private:
+	typedef std::aligned_storage<WorkQueue::max_inline_callable_size>::type Storage;
+
+	template<typename FuncType>
+	static void invoke_callable(void *data) { (*static_cast<FuncType*>(data))(); }
+
+	template<typename FuncType>
+	static void destroy_callable(void *data) { static_cast<FuncType*>(data)->~FuncType(); }
+
+	Storage storage;
+	Function invoke = nullptr;
+	Function destroy = nullptr;
+};
+
+/// \brief Growable FIFO ring of work items that never gives memory back
+class WorkItemRing
+{
+public:
+	WorkItemRing() : items(256) { }
+
+	bool empty() const { return head == tail; }
+	size_t size() const { return tail - head; }
+
+	void push_back(WorkItem *item)
+	{
+		if (size() == items.size())
+			grow();
+		items[tail++ & (items.size() - 1)] = item;
+	}
+
+	WorkItem *pop_front()
+	{
+		return items[head++ & (items.size() - 1)];
+	}
+
+private:
+	void grow()
+	{
+		std::vector<WorkItem *> new_items(items.size() * 2);
+		size_t count = size();
+		for (size_t i = 0; i < count; i++)
+			new_items[i] = items[(head + i) & (items.size() - 1)];
+		items.swap(new_items);
+		head = 0;
+		tail = count;
+	}
+
+	std::vector<WorkItem *> items;
+	size_t head = 0;
+	size_t tail = 0;
+};
+
+class WorkQueue_Impl
+{
+public:
+	WorkQueue_Impl(bool serial_queue);
+	~WorkQueue_Impl();
+
+	void queue(WorkItem *item); // transfers ownership
+	void work_completed(WorkItem *item); // transfers ownership
+	WorkItemInline *alloc_inline_item();
+	void free_inline_item(WorkItemInline *item);
+	void parallel_for(int begin, int end, int grain_size, const std::function<void(int, int)> &func);
+
+	int get_items_queued() const { return items_queued; }
+
+	void process_work_completed();
+
+private:
+	struct Worker
+	{
+		WorkStealingDeque<WorkItem *> deque;
+		std::thread thread;
+		std::thread::id thread_id;
+		unsigned int steal_seed = 0;
+
+		// Inline items freed or allocated on this worker thread without going through the pool mutex
+		WorkItemInline *free_inline_items = nullptr;
+		int num_free_inline_items = 0;
+	};
+
+	void start_threads();
+	int find_current_worker() const;
+	WorkItem *find_work(int worker_index);
+	WorkItem *steal_work(int worker_index);
+	void wake_worker();
+	void worker_main(int worker_index);
+	void discard_item(WorkItem *item);
+	void release_inline_item(Worker *worker, WorkItemInline *item);
+
+	bool serial_queue = false;
+	std::vector<std::unique_ptr<Worker>> workers;
+	std::mutex mutex;
+	std::condition_variable worker_event;
+	std::atomic_bool stop_flag;
+	WorkItemRing injection_queue;
+	std::atomic_int injection_size;
+	std::atomic_int pending_items;
+	std::atomic_int sleeping_workers;
+	std::mutex finished_mutex;
+	std::vector<WorkItem *> finished_items;
+	std::atomic_int items_queued;
+
+	std::mutex inline_pool_mutex;
+	WorkItemInline *free_inline_items = nullptr;
+	std::vector<std::unique_ptr<WorkItemInline[]>> inline_item_blocks;
+
+	static const int max_injection_batch = 32;
+	static const int inline_item_block_size = 256;
+	static const int inline_item_cache_size = 64;
+};
+
+}
@@ -0,0 +1,158 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+namespace clan
+{
+
+/// \brief Lock-free Chase-Lev work stealing deque
+///
+/// The owning thread pushes and pops at the bottom end, while any other thread may steal from the top end.
+/// Only pointer types are supported. A null pointer is returned when the deque is empty or a steal lost a race.
+template<typename T>
+class WorkStealingDeque
+{
+public:
+	WorkStealingDeque(int initial_capacity = 256) : top(0), bottom(0)
+	{
+		int capacity = 1;
+		while (capacity < initial_capacity)
+			capacity <<= 1;
+		buffers.push_back(std::unique_ptr<Buffer>(new Buffer(capacity)));
+		buffer.store(buffers.back().get(), std::memory_order_relaxed);
+	}
+
+	/// \brief Pushes an item at the bottom end (owner thread only)
+	void push(T item)
+	{
+		int64_t b = bottom.load(std::memory_order_relaxed);
+		int64_t t = top.load(std::memory_order_acquire);
+		Buffer *a = buffer.load(std::memory_order_relaxed);
+		if (b - t > a->mask)
+		{
+			a = grow(a, b, t);
+			buffer.store(a, std::memory_order_release);
+		}
+		a->put(b, item);
+		std::atomic_thread_fence(std::memory_order_release);
+		bottom.store(b + 1, std::memory_order_relaxed);
+	}
+
+	/// \brief Pops the most recently pushed item (owner thread only)
+	T pop()
+	{
+		int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+		Buffer *a = buffer.load(std::memory_order_relaxed);
+		bottom.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t t = top.load(std::memory_order_relaxed);
+
+		T item = nullptr;
+		if (t <= b)
+		{
+			item = a->get(b);
+			if (t == b)
+			{
+				// Last item - race against thieves for it
+				if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+					item = nullptr;
+				bottom.store(b + 1, std::memory_order_relaxed);
+			}
+		}
+		else
+		{
+			bottom.store(b + 1, std::memory_order_relaxed);
+		}
+		return item;
+	}
+
+	/// \brief Steals the oldest item (any thread)
+	T steal()
+	{
+		int64_t t = top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t b = bottom.load(std::memory_order_acquire);
+
+		T item = nullptr;
+		if (t < b)
+		{
+			Buffer *a = buffer.load(std::memory_order_acquire);
+			item = a->get(t);
+			if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				return nullptr;
+		}
+		return item;
+	}
+
+	/// \brief Returns true if the deque looked empty at the time of the call
+	bool empty() const
+	{
+		int64_t b = bottom.load(std::memory_order_relaxed);
+		int64_t t = top.load(std::memory_order_relaxed);
+		return b <= t;
+	}
+
+private:
+	WorkStealingDeque(const WorkStealingDeque &) = delete;
+	WorkStealingDeque &operator=(const WorkStealingDeque &) = delete;
+
+	class Buffer
+	{
+	public:
+		Buffer(int capacity) : mask(capacity - 1), items(new std::atomic<T>[capacity]) { }
+
+		T get(int64_t index) const { return items[index & mask].load(std::memory_order_relaxed); }
+		void put(int64_t index, T item) { items[index & mask].store(item, std::memory_order_relaxed); }
+
+		int64_t mask;
+		std::unique_ptr<std::atomic<T>[]> items;
+	};
+
+	Buffer *grow(Buffer *old_buffer, int64_t b, int64_t t)
+	{
+		// Old buffers are kept alive until the deque is destroyed since a thief may still be reading from them
+		std::unique_ptr<Buffer> new_buffer(new Buffer((int)(old_buffer->mask + 1) * 2));
+		for (int64_t i = t; i < b; i++)
+			new_buffer->put(i, old_buffer->get(i));
+		buffers.push_back(std::move(new_buffer));
+		return buffers.back().get();
+	}
+
+	std::atomic<int64_t> top;
+	std::atomic<int64_t> bottom;
+	std::atomic<Buffer *> buffer;
+	std::vector<std::unique_ptr<Buffer>> buffers;
+};
+
+}
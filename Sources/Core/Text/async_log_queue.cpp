@@ -0,0 +1,269 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "Core/precomp.h"
+#include "async_log_queue.h"
+#include "API/Core/Text/string_format.h"
+#include <chrono>
+
+namespace clan
+{
+
+AsyncLogQueue::AsyncLogQueue()
+: mask(0), policy(LogQueuePolicy::drop), enqueue_pos(0), dequeue_pos(0), active(false), active_producers(0), worker_waiting(false),
+  dropped_count(0), reported_dropped_count(0), written_pos(0), stop_flag(false)
+{
+}
+
+AsyncLogQueue::~AsyncLogQueue()
+{
+	stop();
+}
+
+void AsyncLogQueue::start(int queue_size, LogQueuePolicy new_policy)
+{
+	stop();
+
+	size_t capacity = 2;
+	while (capacity < (size_t)queue_size)
+		capacity <<= 1;
+
+	slots.reset(new Slot[capacity]);
+	for (size_t i = 0; i < capacity; i++)
+		slots[i].sequence.store(i, std::memory_order_relaxed);
+	mask = capacity - 1;
+	policy = new_policy;
+
+	enqueue_pos.store(0, std::memory_order_relaxed);
+	dequeue_pos = 0;
+	written_pos = 0;
+	stop_flag = false;
+	batch.reserve(max_batch_size + 1);
+	free_messages.reserve(max_batch_size + 1);
+
+	worker = std::thread(&AsyncLogQueue::worker_main, this);
+	worker_id = worker.get_id();
+	active.store(true);
+}
+
+void AsyncLogQueue::stop()
+{
+	if (!worker.joinable())
+		return;
+
+	// Wait for producers that already saw the queue as active before telling the worker to finish
+	active.store(false);
+	while (active_producers.load() != 0)
+		std::this_thread::yield();
+
+	{
+		std::unique_lock<std::mutex> lock(wake_mutex);
+		stop_flag = true;
+	}
+	wake_event.notify_one();
+	worker.join();
+	worker_id = std::thread::id();
+
+	slots.reset();
+	batch.clear();
+	free_messages.clear();
+}
+
+void AsyncLogQueue::flush()
+{
+	if (!active.load() || std::this_thread::get_id() == worker_id)
+		return;
+
+	size_t target = enqueue_pos.load();
+	std::unique_lock<std::mutex> lock(wake_mutex);
+	wake_event.notify_one();
+	while (written_pos < target)
+		written_event.wait(lock);
+}
+
+bool AsyncLogQueue::push(const std::string &type, const std::string &text)
+{
+	active_producers++;
+
+	// Loggers that log from the logger thread write directly, otherwise a full queue would block forever
+	if (!active.load() || std::this_thread::get_id() == worker_id)
+	{
+		active_producers--;
+		return false;
+	}
+
+	DateTime time = DateTime::get_current_utc_time();
+	bool queued = try_push(time, type, text);
+	if (!queued)
+	{
+		if (policy == LogQueuePolicy::block)
+		{
+			while (!queued)
+			{
+				wake_event.notify_one();
+				std::this_thread::yield();
+				queued = try_push(time, type, text);
+			}
+		}
+		else
+		{
+			dropped_count.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	if (queued && worker_waiting.load(std::memory_order_relaxed))
+		wake_event.notify_one();
+
+	active_producers--;
+	return true;
+}
+
+bool AsyncLogQueue::try_push(const DateTime &time, const std::string &type, const std::string &text)
+{
+	size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+	Slot *slot;
+	while (true)
+	{
+		slot = &slots[pos & mask];
+		size_t sequence = slot->sequence.load(std::memory_order_acquire);
+		intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+		if (diff == 0)
+		{
+			if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				break;
+		}
+		else if (diff < 0)
+		{
+			return false; // Queue is full
+		}
+		else
+		{
+			pos = enqueue_pos.load(std::memory_order_relaxed);
+		}
+	}
+
+	slot->message.time = time;
+	slot->message.type.assign(type);
+	slot->message.text.assign(text);
+	slot->sequence.store(pos + 1, std::memory_order_release);
+	return true;
+}
+
+size_t AsyncLogQueue::pop_batch()
+{
+	while (batch.size() < (size_t)max_batch_size)
+	{
+		Slot &slot = slots[dequeue_pos & mask];
+		if (slot.sequence.load(std::memory_order_acquire) != dequeue_pos + 1)
+			break;
+
+		// Swap strings with a previously written message so the slot gets its capacity back
+		LogMessage message;
+		if (!free_messages.empty())
+		{
+			message = std::move(free_messages.back());
+			free_messages.pop_back();
+		}
+		message.time = slot.message.time;
+		message.type.swap(slot.message.type);
+		message.text.swap(slot.message.text);
+		batch.push_back(std::move(message));
+
+		slot.sequence.store(dequeue_pos + mask + 1, std::memory_order_release);
+		dequeue_pos++;
+	}
+	return batch.size();
+}
+
+void AsyncLogQueue::write_batch()
+{
+	uint64_t dropped = dropped_count.load(std::memory_order_relaxed);
+	if (dropped != reported_dropped_count)
+	{
+		LogMessage message;
+		message.time = DateTime::get_current_utc_time();
+		message.type = "log";
+		message.text = string_format("%1 log messages dropped", (unsigned int)(dropped - reported_dropped_count));
+		batch.push_back(std::move(message));
+		reported_dropped_count = dropped;
+	}
+
+	if (!batch.empty())
+	{
+		std::unique_lock<std::recursive_mutex> mutex_lock(Logger::mutex);
+		for (auto &instance : Logger::instances)
+		{
+			try
+			{
+				instance->log_batch(batch);
+			}
+			catch (...)
+			{
+				// There is nowhere to report a failing logger from the logger thread
+			}
+		}
+	}
+
+	for (auto &message : batch)
+		free_messages.push_back(std::move(message));
+	batch.clear();
+}
+
+void AsyncLogQueue::worker_main()
+{
+	bool stopping = false;
+	while (true)
+	{
+		if (pop_batch() > 0 || dropped_count.load(std::memory_order_relaxed) != reported_dropped_count)
+		{
+			write_batch();
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(wake_mutex);
+		written_pos = dequeue_pos;
+		written_event.notify_all();
+
+		if (stopping)
+			break;
+
+		if (stop_flag)
+		{
+			// All producers finished before stop_flag was set, so one more pass drains the queue
+			stopping = true;
+			continue;
+		}
+
+		worker_waiting.store(true, std::memory_order_relaxed);
+		wake_event.wait_for(lock, std::chrono::milliseconds(poll_interval));
+		worker_waiting.store(false, std::memory_order_relaxed);
+	}
+}
+
+}
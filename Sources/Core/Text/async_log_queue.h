@@ -0,0 +1,106 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include "API/Core/Text/logger.h"
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace clan
+{
+
+/// \brief Queue of log messages written by a background thread
+///
+/// Messages are stored in a bounded lock-free multi-producer single-consumer ring.
+/// Each slot carries a sequence number telling producers and the logger thread who owns it.
+/// The logger thread swaps the strings out of the slots, so their capacity is recycled and
+/// logging short messages does not allocate once the queue has warmed up.
+class AsyncLogQueue
+{
+public:
+	AsyncLogQueue();
+	~AsyncLogQueue();
+
+	void start(int queue_size, LogQueuePolicy policy);
+	void stop();
+	void flush();
+
+	/// \brief Queues a message, returns false if async logging is not active on this thread
+	bool push(const std::string &type, const std::string &text);
+
+	uint64_t get_dropped_count() const { return dropped_count.load(std::memory_order_relaxed); }
+
+private:
+	AsyncLogQueue(const AsyncLogQueue &) = delete;
+	AsyncLogQueue &operator=(const AsyncLogQueue &) = delete;
+
+	struct Slot
+	{
+		std::atomic<size_t> sequence;
+		LogMessage message;
+	};
+
+	bool try_push(const DateTime &time, const std::string &type, const std::string &text);
+	size_t pop_batch();
+	void write_batch();
+	void worker_main();
+
+	std::unique_ptr<Slot[]> slots;
+	size_t mask;
+	LogQueuePolicy policy;
+
+	std::atomic<size_t> enqueue_pos;
+	size_t dequeue_pos;
+
+	std::atomic_bool active;
+	std::atomic_int active_producers;
+	std::atomic_bool worker_waiting;
+	std::atomic<uint64_t> dropped_count;
+	uint64_t reported_dropped_count;
+
+	std::vector<LogMessage> batch;
+	std::vector<LogMessage> free_messages;
+	std::thread worker;
+	std::thread::id worker_id;
+
+	std::mutex wake_mutex;
+	std::condition_variable wake_event;
+	std::condition_variable written_event;
+	size_t written_pos;
+	bool stop_flag;
+
+	static const int max_batch_size = 256;
+	static const int poll_interval = 20;
+};
+
+}
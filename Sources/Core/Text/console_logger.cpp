@@ -57,21 +57,39 @@ ConsoleLogger::~ConsoleLogger()
 
 void ConsoleLogger::log(const std::string &type, const std::string &text)
 {
-	StringFormat format = get_log_string(type, text);
+	log(DateTime::get_current_utc_time(), type, text);
+}
+
+void ConsoleLogger::log_batch(const std::vector<LogMessage> &messages)
+{
+	std::string log_lines;
+	for (auto &message : messages)
+		append_log_string(log_lines, message.time, message.type, message.text);
+	write_text(log_lines);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// ConsoleLogger Implementation:
 
+void ConsoleLogger::log(const DateTime &time, const std::string &type, const std::string &text)
+{
+	std::string log_line;
+	append_log_string(log_line, time, type, text);
+	write_text(log_line);
+}
+
+void ConsoleLogger::write_text(const std::string &text)
+{
 #ifdef WIN32
-	std::wstring log_line = StringHelp::utf8_to_ucs2(format.get_result());
+	std::wstring log_line = StringHelp::utf8_to_ucs2(text);
 
 	DWORD bytesWritten = 0;
 
 	WriteConsole(GetStdHandle(STD_OUTPUT_HANDLE), log_line.data(), log_line.size(), &bytesWritten, 0);
 #else
-	std::string log_line = StringHelp::text_to_local8(format.get_result());
+	std::string log_line = StringHelp::text_to_local8(text);
 	write(1, log_line.data(), log_line.length());
 #endif
 }
 
-/////////////////////////////////////////////////////////////////////////////
-// FileLogger Implementation:
-
 }
@@ -56,14 +56,32 @@ FileLogger::~FileLogger()
 
 void FileLogger::log(const std::string &type, const std::string &text)
 {
-	StringFormat format = get_log_string(type, text);
-	std::string log_line = StringHelp::text_to_local8(format.get_result());
+	log(DateTime::get_current_utc_time(), type, text);
+}
 
-	file->seek(0, File::seek_end);
-	file->write(log_line.data(), (int) log_line.length());
+void FileLogger::log_batch(const std::vector<LogMessage> &messages)
+{
+	std::string log_lines;
+	for (auto &message : messages)
+		append_log_string(log_lines, message.time, message.type, message.text);
+	write_text(log_lines);
 }
 
 /////////////////////////////////////////////////////////////////////////////
 // FileLogger Implementation:
 
+void FileLogger::log(const DateTime &time, const std::string &type, const std::string &text)
+{
+	std::string log_line;
+	append_log_string(log_line, time, type, text);
+	write_text(log_line);
+}
+
+void FileLogger::write_text(const std::string &text)
+{
+	std::string local8_text = StringHelp::text_to_local8(text);
+	file->seek(0, File::seek_end);
+	file->write(local8_text.data(), (int) local8_text.length());
+}
+
 }
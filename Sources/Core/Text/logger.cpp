@@ -30,6 +30,7 @@
 #include "API/Core/System/datetime.h"
 #include "API/Core/Text/logger.h"
 #include "API/Core/Text/string_format.h"
+#include "async_log_queue.h"
 #include <algorithm>
 #include <mutex>
 
@@ -56,6 +57,9 @@ std::vector<Logger*> Logger::instances;
 
 std::recursive_mutex Logger::mutex;
 
+// Defined after Logger::mutex so it is destroyed first, writing any remaining messages
+static AsyncLogQueue async_log_queue;
+
 /////////////////////////////////////////////////////////////////////////////
 // Logger Operations:
 
@@ -74,45 +78,50 @@ void Logger::disable()
 		instances.erase(il);
 }
 
+void Logger::log_batch(const std::vector<LogMessage> &messages)
+{
+	for (auto &message : messages)
+		log(message.time, message.type, message.text);
+}
+
+void Logger::start_async(int queue_size, LogQueuePolicy policy)
+{
+	async_log_queue.start(queue_size, policy);
+}
+
+void Logger::stop_async()
+{
+	async_log_queue.stop();
+}
+
+void Logger::flush()
+{
+	async_log_queue.flush();
+}
+
+uint64_t Logger::get_dropped_count()
+{
+	return async_log_queue.get_dropped_count();
+}
+
+static const char *log_month_names[] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+static const char *log_day_names[] = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+
 StringFormat Logger::get_log_string(const std::string &type, const std::string &text)
 {
-	std::string months[] =
-	{
-		"Jan",
-		"Feb",
-		"Mar",
-		"Apr",
-		"May",
-		"Jun",
-		"Jul",
-		"Aug",
-		"Sep",
-		"Oct",
-		"Nov",
-		"Dec"
-	};
-
-	std::string days[] =
-	{
-		"Sun",
-		"Mon",
-		"Tue",
-		"Wed",
-		"Thu",
-		"Fri",
-		"Sat"
-	};
+	return get_log_string(DateTime::get_current_utc_time(), type, text);
+}
 
+StringFormat Logger::get_log_string(const DateTime &cur_time, const std::string &type, const std::string &text)
+{
 	// Tue Nov 16 11:34:15 CET 2004
-	DateTime cur_time = DateTime::get_current_utc_time();
-
 #ifdef WIN32
 	StringFormat format("%1 %2 %3 %4:%5:%6 %7 UTC [%8] %9\r\n");
 #else
 	StringFormat format("%1 %2 %3 %4:%5:%6 %7 UTC [%8] %9\n");
 #endif
-	format.set_arg(1, days[cur_time.get_day_of_week()]);
-	format.set_arg(2, months[cur_time.get_month() - 1]);
+	format.set_arg(1, log_day_names[cur_time.get_day_of_week()]);
+	format.set_arg(2, log_month_names[cur_time.get_month() - 1]);
 	format.set_arg(3, cur_time.get_day());
 	format.set_arg(4, cur_time.get_hour(), 2);
 	format.set_arg(5, cur_time.get_minutes(), 2);
@@ -124,16 +133,68 @@ StringFormat Logger::get_log_string(const std::string &type, const std::string &
 	return format;
 }
 
+static void append_log_number(std::string &output, int value, int min_length)
+{
+	char digits[16];
+	int length = 0;
+	do
+	{
+		digits[length++] = '0' + value % 10;
+		value /= 10;
+	} while (value > 0 && length < 16);
+
+	for (int i = length; i < min_length; i++)
+		output.push_back('0');
+	while (length > 0)
+		output.push_back(digits[--length]);
+}
+
+void Logger::append_log_string(std::string &output, const DateTime &time, const std::string &type, const std::string &text)
+{
+	// Same format as get_log_string, without going through StringFormat
+	output.append(log_day_names[time.get_day_of_week()]);
+	output.push_back(' ');
+	output.append(log_month_names[time.get_month() - 1]);
+	output.push_back(' ');
+	append_log_number(output, time.get_day(), 1);
+	output.push_back(' ');
+	append_log_number(output, time.get_hour(), 2);
+	output.push_back(':');
+	append_log_number(output, time.get_minutes(), 2);
+	output.push_back(':');
+	append_log_number(output, time.get_seconds(), 2);
+	output.push_back(' ');
+	append_log_number(output, time.get_year(), 1);
+	output.append(" UTC [");
+	output.append(type);
+	output.append("] ");
+	output.append(text);
+#ifdef WIN32
+	output.append("\r\n");
+#else
+	output.push_back('\n');
+#endif
+}
+
 void log_event(const std::string &type, const std::string &text)
 {
+	if (async_log_queue.push(type, text))
+		return;
+
 	std::unique_lock<std::recursive_mutex> mutex_lock(Logger::mutex);
 	if (Logger::instances.empty())
 		return;
+	DateTime time = DateTime::get_current_utc_time();
 	for(auto & instance : Logger::instances)
-		(instance)->log(type, text);
+		(instance)->log(time, type, text);
 }
 
 /////////////////////////////////////////////////////////////////////////////
 // Logger Implementation:
 
+void Logger::log(const DateTime &time, const std::string &type, const std::string &text)
+{
+	log(type, text);
+}
+
 }
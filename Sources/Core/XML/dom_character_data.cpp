@@ -78,8 +78,9 @@ void DomCharacterData::append_data(const DomString &arg)
 {
 	if (impl)
 	{
+		DomDocument_Impl *doc_impl = (DomDocument_Impl *) impl->owner_document.lock().get();
 		DomString value = impl->get_tree_node()->get_node_value();
-		impl->get_tree_node()->node_value += arg;
+		impl->get_tree_node()->set_node_value(doc_impl, value + arg);
 	}
 }
 
@@ -87,10 +88,11 @@ void DomCharacterData::insert_data(unsigned long offset, const DomString &arg)
 {
 	if (impl)
 	{
+		DomDocument_Impl *doc_impl = (DomDocument_Impl *) impl->owner_document.lock().get();
 		DomString value = impl->get_tree_node()->get_node_value();
 		if (offset > value.length())
 			offset = value.length();
-		impl->get_tree_node()->node_value = value.substr(0, offset) + arg + value.substr(offset);
+		impl->get_tree_node()->set_node_value(doc_impl, value.substr(0, offset) + arg + value.substr(offset));
 	}
 }
 
@@ -98,6 +100,7 @@ void DomCharacterData::delete_data(unsigned long offset, unsigned long count)
 {
 	if (impl)
 	{
+		DomDocument_Impl *doc_impl = (DomDocument_Impl *) impl->owner_document.lock().get();
 		DomString value = impl->get_tree_node()->get_node_value();
 		if (offset > value.length())
 			offset = value.length();
@@ -114,7 +117,7 @@ void DomCharacterData::delete_data(unsigned long offset, unsigned long count)
 		{
 			value = DomString();
 		}
-		impl->get_tree_node()->node_value = value;
+		impl->get_tree_node()->set_node_value(doc_impl, value);
 	}
 }
 
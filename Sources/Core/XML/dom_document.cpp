@@ -43,6 +43,7 @@
 #include "API/Core/XML/xml_tokenizer.h"
 #include "API/Core/XML/xml_writer.h"
 #include "API/Core/XML/xml_token.h"
+#include "API/Core/IOData/iodevice.h"
 #include "dom_document_generic.h"
 #include <stack>
 
@@ -268,7 +269,8 @@ std::vector<DomNode> DomDocument::load(
 {
 	clear_all();
 
-	XMLTokenizer tokenizer(input);
+	// Mapped devices are tokenized in place, everything else is streamed in chunks
+	XMLTokenizer tokenizer = input.get_mapped_span().is_null() ? XMLTokenizer(input, 64 * 1024) : XMLTokenizer(input);
 	tokenizer.set_eat_whitespace(eat_whitespace);
 
 	if (insert_point.is_element() == false)
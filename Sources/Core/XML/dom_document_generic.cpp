@@ -103,6 +103,28 @@ DomString DomDocument_Impl::find_namespace_uri(
 	return search_node.find_namespace_uri(qualified_name);
 }
 
+const DomStringView *DomDocument_Impl::intern_string(const DomStringView &str)
+{
+	if (str.empty())
+		return nullptr;
+
+	auto it = string_table.find(str);
+	if (it == string_table.end())
+	{
+		char *data = allocate_string(str.size());
+		memcpy(data, str.data(), str.size());
+		it = string_table.insert(DomStringView(data, str.size())).first;
+	}
+
+	// Elements of an unordered_set never move, so the pointer stays valid until the document is destroyed
+	return &*it;
+}
+
+char *DomDocument_Impl::allocate_string(unsigned int length)
+{
+	return static_cast<char *>(string_allocator.allocate(length));
+}
+
 unsigned int DomDocument_Impl::allocate_tree_node()
 {
 	if (free_nodes.empty())
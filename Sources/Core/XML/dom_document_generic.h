@@ -32,6 +32,7 @@
 #include "API/Core/System/block_allocator.h"
 #include <vector>
 #include <stack>
+#include <unordered_set>
 
 namespace clan
 {
@@ -55,11 +56,25 @@ public:
 /// \{
 
 public:
+	struct StringHash
+	{
+		size_t operator()(const DomStringView &str) const
+		{
+			// FNV-1a
+			unsigned int hash = 2166136261U;
+			for (char c : str)
+				hash = (hash ^ (unsigned char)c) * 16777619U;
+			return hash;
+		}
+	};
+
 	std::string qualified_name;
 	std::string public_id;
 	std::string system_id;
 	std::string internal_subset;
 	BlockAllocator node_allocator;
+	BlockAllocator string_allocator;
+	std::unordered_set<DomStringView, StringHash> string_table;
 	std::vector<DomTreeNode *> nodes;
 	std::vector<int> free_nodes;
 	std::vector<DomNode_Impl *> free_dom_nodes;
@@ -75,6 +90,12 @@ public:
 		const XMLToken &search_token,
 		const DomNode &search_node);
 
+	/// \brief Returns the shared copy of a node name or namespace URI, or null for an empty string
+	const DomStringView *intern_string(const DomStringView &str);
+
+	/// \brief Allocates storage for a node value that lives as long as the document
+	char *allocate_string(unsigned int length);
+
 	unsigned int allocate_tree_node();
 	void free_tree_node(unsigned int node_index);
 	DomNode_Impl *allocate_dom_node();
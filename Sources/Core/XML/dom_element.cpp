@@ -164,9 +164,9 @@ DomString DomElement::get_attribute_ns(
 		const DomTreeNode *cur_attribute = tree_node->get_first_attribute(doc_impl);
 		while (cur_attribute)
 		{
-			std::string lname = cur_attribute->get_node_name();
-			std::string::size_type lpos = lname.find_first_of(':');
-			if (lpos != std::string::npos)
+			DomStringView lname = cur_attribute->get_node_name();
+			size_t lpos = lname.find(':');
+			if (lpos != DomStringView::npos)
 				lname = lname.substr(lpos + 1);
 
 			if (cur_attribute->get_namespace_uri() == namespace_uri && lname == local_name)
@@ -193,9 +193,9 @@ DomString DomElement::get_attribute_ns(
 		const DomTreeNode *cur_attribute = tree_node->get_first_attribute(doc_impl);
 		while (cur_attribute)
 		{
-			std::string lname = cur_attribute->get_node_name();
-			std::string::size_type lpos = lname.find_first_of(':');
-			if (lpos != std::string::npos)
+			DomStringView lname = cur_attribute->get_node_name();
+			size_t lpos = lname.find(':');
+			if (lpos != DomStringView::npos)
 				lname = lname.substr(lpos + 1);
 
 			if (cur_attribute->get_namespace_uri() == namespace_uri && lname == local_name)
@@ -115,9 +115,9 @@ DomNode DomNamedNodeMap::get_named_item_ns(
 	const DomTreeNode *cur_attribute = tree_node->get_first_attribute(doc_impl);
 	while (cur_attribute)
 	{
-		std::string lname = cur_attribute->get_node_name();
-		std::string::size_type lpos = lname.find_first_of(':');
-		if (lpos != std::string::npos)
+		DomStringView lname = cur_attribute->get_node_name();
+		size_t lpos = lname.find(':');
+		if (lpos != DomStringView::npos)
 			lname = lname.substr(lpos + 1);
 
 		if (cur_attribute->get_namespace_uri() == namespace_uri && lname == local_name)
@@ -200,9 +200,9 @@ DomNode DomNamedNodeMap::set_named_item_ns(const DomNode &node)
 	DomTreeNode *cur_attribute = tree_node->get_first_attribute(doc_impl);
 	while (cur_attribute)
 	{
-		std::string lname = cur_attribute->get_node_name();
-		std::string::size_type lpos = lname.find_first_of(':');
-		if (lpos != std::string::npos)
+		DomStringView lname = cur_attribute->get_node_name();
+		size_t lpos = lname.find(':');
+		if (lpos != DomStringView::npos)
 			lname = lname.substr(lpos + 1);
 
 		if (cur_attribute->get_namespace_uri() == namespace_uri && lname == local_name)
@@ -290,9 +290,9 @@ DomNode DomNamedNodeMap::remove_named_item_ns(
 	DomTreeNode *cur_attribute = tree_node->get_first_attribute(doc_impl);
 	while (cur_attribute)
 	{
-		std::string lname = cur_attribute->get_node_name();
-		std::string::size_type lpos = lname.find_first_of(':');
-		if (lpos != std::string::npos)
+		DomStringView lname = cur_attribute->get_node_name();
+		size_t lpos = lname.find(':');
+		if (lpos != DomStringView::npos)
 			lname = lname.substr(lpos + 1);
 
 		if (cur_attribute->get_namespace_uri() == namespace_uri && lname == local_name)
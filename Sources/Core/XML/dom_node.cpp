@@ -88,6 +88,11 @@ DomNode::~DomNode()
 // DomNode attributes:
 
 DomString DomNode::get_node_name() const
+{
+	return get_node_name_view();
+}
+
+DomStringView DomNode::get_node_name_view() const
 {
 	if (impl)
 	{
@@ -115,10 +120,15 @@ DomString DomNode::get_node_name() const
 			return tree_node->get_node_name();
 		}
 	}
-	return DomString();
+	return DomStringView();
 }
 
 DomString DomNode::get_node_value() const
+{
+	return get_node_value_view();
+}
+
+DomStringView DomNode::get_node_value_view() const
 {
 	if (impl)
 	{
@@ -132,7 +142,7 @@ DomString DomNode::get_node_value() const
 		case ENTITY_NODE:
 		case ENTITY_REFERENCE_NODE:
 		case NOTATION_NODE:
-			return DomString();
+			return DomStringView();
 
 		case TEXT_NODE:
 		case ATTRIBUTE_NODE:
@@ -141,23 +151,28 @@ DomString DomNode::get_node_value() const
 			return tree_node->get_node_value();
 		}
 	}
-	return DomString();
+	return DomStringView();
 }
 
 DomString DomNode::get_namespace_uri() const
+{
+	return get_namespace_uri_view();
+}
+
+DomStringView DomNode::get_namespace_uri_view() const
 {
 	if (impl)
 		return impl->get_tree_node()->get_namespace_uri();
-	return DomString();
+	return DomStringView();
 }
 
 DomString DomNode::get_prefix() const
 {
 	if (impl)
 	{
-		DomString node_name = impl->get_tree_node()->get_node_name();
-		DomString::size_type pos = node_name.find(':');
-		if (pos != DomString::npos)
+		DomStringView node_name = impl->get_tree_node()->get_node_name();
+		size_t pos = node_name.find(':');
+		if (pos != DomStringView::npos)
 			return node_name.substr(0, pos);
 	}
 	return DomString();
@@ -178,17 +193,22 @@ void DomNode::set_prefix(const DomString &prefix)
 }
 
 DomString DomNode::get_local_name() const
+{
+	return get_local_name_view();
+}
+
+DomStringView DomNode::get_local_name_view() const
 {
 	if (impl)
 	{
-		DomString node_name = impl->get_tree_node()->get_node_name();
-		DomString::size_type pos = node_name.find(':');
-		if (pos != DomString::npos)
+		DomStringView node_name = impl->get_tree_node()->get_node_name();
+		size_t pos = node_name.find(':');
+		if (pos != DomStringView::npos)
 			return node_name.substr(pos + 1);
 		else
 			return node_name;
 	}
-	return DomString();
+	return DomStringView();
 }
 
 void DomNode::set_node_value(const DomString &value)
@@ -678,7 +698,7 @@ DomString DomNode::find_namespace_uri(const DomString &qualified_name) const
 		const DomTreeNode *cur_attr = cur->get_first_attribute(doc_impl);
 		while (cur_attr)
 		{
-			std::string node_name = cur_attr->get_node_name();
+			DomStringView node_name = cur_attr->get_node_name();
 			if (prefix.empty())
 			{
 				if (node_name == xmlns_xmlns)
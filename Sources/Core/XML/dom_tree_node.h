@@ -44,7 +44,8 @@ class DomTreeNode : public BlockAllocated
 /// \{
 public:
 	DomTreeNode()
-	: node_type(0), parent(cl_null_node_index), first_child(cl_null_node_index),
+	: node_name(nullptr), namespace_uri(nullptr), node_value(nullptr), node_value_length(0), node_value_capacity(0),
+	  node_type(0), parent(cl_null_node_index), first_child(cl_null_node_index),
 	  last_child(cl_null_node_index), previous_sibling(cl_null_node_index),
 	  next_sibling(cl_null_node_index), first_attribute(cl_null_node_index)
 	{
@@ -58,9 +59,15 @@ public:
 /// \name Attributes
 /// \{
 public:
-	std::string node_name;
-	std::string node_value;
-	std::string namespace_uri;
+	/// \brief Interned in the string table of the owner document, or null if empty
+	const DomStringView *node_name;
+	const DomStringView *namespace_uri;
+
+	/// \brief Allocated from the string allocator of the owner document
+	char *node_value;
+	unsigned int node_value_length;
+	unsigned int node_value_capacity;
+
 	unsigned short node_type;
 	unsigned int parent;
 	unsigned int first_child;
@@ -75,9 +82,9 @@ public:
 public:
 	void reset()
 	{
-		node_name.clear();
-		node_value.clear();
-		namespace_uri.clear();
+		node_name = nullptr;
+		namespace_uri = nullptr;
+		node_value_length = 0;
 		node_type = 0;
 		parent = cl_null_node_index;
 		first_child = cl_null_node_index;
@@ -87,34 +94,42 @@ public:
 		first_attribute = cl_null_node_index;
 	}
 
-	std::string get_node_name() const
+	DomStringView get_node_name() const
 	{
-		return node_name;
+		return node_name ? *node_name : DomStringView();
 	}
 
-	std::string get_node_value() const
+	DomStringView get_node_value() const
 	{
-		return node_value;
+		return DomStringView(node_value, node_value_length);
 	}
 
-	std::string get_namespace_uri() const
+	DomStringView get_namespace_uri() const
 	{
-		return namespace_uri;
+		return namespace_uri ? *namespace_uri : DomStringView();
 	}
 
-	void set_node_name(DomDocument_Impl *owner_document, const DomString &str)
+	void set_node_name(DomDocument_Impl *owner_document, const DomStringView &str)
 	{
-		node_name = str;
+		node_name = owner_document->intern_string(str);
 	}
 
-	void set_node_value(DomDocument_Impl *owner_document, const DomString &str)
+	void set_node_value(DomDocument_Impl *owner_document, const DomStringView &str)
 	{
-		node_value = str;
+		// The old buffer is reused when the new value fits. Otherwise it stays in the allocator until the document is destroyed.
+		if (str.size() > node_value_capacity)
+		{
+			node_value = owner_document->allocate_string(str.size());
+			node_value_capacity = str.size();
+		}
+		if (!str.empty())
+			memmove(node_value, str.data(), str.size());
+		node_value_length = str.size();
 	}
 
-	void set_namespace_uri(DomDocument_Impl *owner_document, const DomString &str)
+	void set_namespace_uri(DomDocument_Impl *owner_document, const DomStringView &str)
 	{
-		namespace_uri = str;
+		namespace_uri = owner_document->intern_string(str);
 	}
 
 	DomTreeNode *get_parent(DomDocument_Impl *owner_document)
@@ -56,15 +56,32 @@ XMLTokenizer::XMLTokenizer(IODevice &input) : impl(std::make_shared<XMLTokenizer
 	impl->size = input.get_size();
 	impl->pos = 0;
 
-	DataBuffer buffer(impl->size);
-	input.receive(buffer.get_data(), buffer.get_size(), true);
+	// Memory mapped devices can be parsed in place without reading them into a temporary buffer first
+	DataBuffer buffer;
+	const char *input_data = nullptr;
+	int input_size = 0;
+	MappedSpan span = input.get_mapped_span();
+	if (!span.is_null())
+	{
+		int position = input.get_position();
+		input_data = span.get_data() + position;
+		input_size = span.get_size() - position;
+		input.seek(0, IODevice::seek_end);
+	}
+	else
+	{
+		buffer = DataBuffer(impl->size);
+		input.receive(buffer.get_data(), buffer.get_size(), true);
+		input_data = buffer.get_data();
+		input_size = buffer.get_size();
+	}
 
-	StringHelp::BOMType bom_type = StringHelp::detect_bom(buffer.get_data(), buffer.get_size());
+	StringHelp::BOMType bom_type = StringHelp::detect_bom(input_data, input_size);
 	switch (bom_type)
 	{
 	default:
 	case StringHelp::bom_none:
-		impl->data = StringHelp::utf8_to_text(std::string(buffer.get_data(), buffer.get_size()));
+		impl->data = StringHelp::utf8_to_text(std::string(input_data, input_size));
 		break;
 	case StringHelp::bom_utf32_be:
 	case StringHelp::bom_utf32_le:
@@ -75,12 +92,45 @@ XMLTokenizer::XMLTokenizer(IODevice &input) : impl(std::make_shared<XMLTokenizer
 		throw Exception("UTF-32 XML files not supported yet");
 		break;
 	case StringHelp::bom_utf8:
-		impl->data = StringHelp::utf8_to_text(std::string(buffer.get_data()+3, buffer.get_size()-3));
+		impl->data = StringHelp::utf8_to_text(std::string(input_data + 3, input_size - 3));
 		break;
 	}
 
 }
 
+XMLTokenizer::XMLTokenizer(IODevice &input, int chunk_size) : impl(std::make_shared<XMLTokenizer_Impl>())
+{
+	if (chunk_size <= 0)
+		throw Exception("XMLTokenizer chunk size must be greater than zero");
+
+	impl->input = input;
+	impl->chunk_size = chunk_size;
+	impl->end_of_input = false;
+
+	// Make sure the window is large enough to detect the byte order mark
+	while (impl->data.size() < 4 && !impl->end_of_input)
+		impl->read_more();
+
+	StringHelp::BOMType bom_type = StringHelp::detect_bom(impl->data.data(), impl->data.size());
+	switch (bom_type)
+	{
+	default:
+	case StringHelp::bom_none:
+		break;
+	case StringHelp::bom_utf32_be:
+	case StringHelp::bom_utf32_le:
+		throw Exception("UTF-16 XML files not supported yet");
+		break;
+	case StringHelp::bom_utf16_be:
+	case StringHelp::bom_utf16_le:
+		throw Exception("UTF-32 XML files not supported yet");
+		break;
+	case StringHelp::bom_utf8:
+		impl->pos = 3;
+		break;
+	}
+}
+
 XMLTokenizer::~XMLTokenizer()
 {
 }
@@ -111,9 +161,34 @@ void XMLTokenizer::next(XMLToken *out_token)
 
 	if (impl)
 	{
-		if (impl->next_text_node(out_token))
-			return;
-		impl->next_tag_node(out_token);
+		while (true)
+		{
+			if (impl->pos == impl->size && !impl->end_of_input)
+			{
+				impl->read_more();
+				continue;
+			}
+
+			std::string::size_type token_start = impl->pos;
+			try
+			{
+				if (impl->next_text_node(out_token))
+					return;
+				impl->next_tag_node(out_token);
+				return;
+			}
+			catch (const XMLTokenizer_Impl::NeedMoreData &)
+			{
+				// Parse the token again once the window holds more of the input
+				impl->pos = token_start;
+				impl->read_more();
+
+				out_token->type = XMLToken::NULL_TOKEN;
+				out_token->variant = XMLToken::SINGLE;
+				while (!out_token->attributes.empty())
+					out_token->attributes.pop_back();
+			}
+		}
 	}
 }
 
@@ -133,7 +208,12 @@ bool XMLTokenizer_Impl::next_text_node(XMLToken *out_token)
 	{
 		std::string::size_type start_pos = pos;
 		std::string::size_type end_pos = data.find('<', start_pos);
-		if (end_pos == data.npos) end_pos = size;
+		if (end_pos == data.npos)
+		{
+			if (!end_of_input)
+				throw NeedMoreData();
+			end_pos = size;
+		}
 		pos = end_pos;
 
 		std::string text;
@@ -160,7 +240,7 @@ bool XMLTokenizer_Impl::next_tag_node(XMLToken *out_token)
 
 	pos++;
 	if (pos == size)
-		XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
+		throw_premature_end();
 
 	// Try to early predict what sort of node it might be:
 	bool closing = (data[pos] == '/');
@@ -171,7 +251,7 @@ bool XMLTokenizer_Impl::next_tag_node(XMLToken *out_token)
 	{
 		pos++;
 		if (pos == size)
-			XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
+			throw_premature_end();
 	}
 
 	if (exclamationMark) // check for cdata section, comments or doctype
@@ -184,7 +264,7 @@ bool XMLTokenizer_Impl::next_tag_node(XMLToken *out_token)
 	std::string::size_type start_pos = pos;
 	std::string::size_type end_pos = data.find_first_of(" \r\n\t?/>", start_pos);
 	if (end_pos == data.npos)
-		XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
+		throw_premature_end();
 	pos = end_pos;
 
 	out_token->type = questionMark ? XMLToken::PROCESSING_INSTRUCTION_TOKEN : XMLToken::ELEMENT_TOKEN;
@@ -196,11 +276,11 @@ bool XMLTokenizer_Impl::next_tag_node(XMLToken *out_token)
 		// Strip whitespace:
 		pos = data.find_first_not_of(" \r\n\t", pos);
 		if (pos == data.npos)
-			XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
+			throw_premature_end();
 
 		end_pos = data.find_first_of("?", pos);
 		if (end_pos == data.npos)
-			XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
+			throw_premature_end();
 		out_token->value = data.substr(pos, end_pos - pos);
 		pos = end_pos;
 	}
@@ -212,7 +292,7 @@ bool XMLTokenizer_Impl::next_tag_node(XMLToken *out_token)
 			// Strip whitespace:
 			pos = data.find_first_not_of(" \r\n\t", pos);
 			if (pos == data.npos)
-				XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
+				throw_premature_end();
 
 			// End of tag, stop searching for more attributes:
 			if (data[pos] == '/' || data[pos] == '?' || data[pos] == '>')
@@ -222,7 +302,7 @@ bool XMLTokenizer_Impl::next_tag_node(XMLToken *out_token)
 			std::string::size_type start_pos = pos;
 			std::string::size_type end_pos = data.find_first_of(" \r\n\t=", start_pos);
 			if (end_pos == data.npos)
-				XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
+				throw_premature_end();
 			pos = end_pos;
 
 			std::string attributeName = data.substr(start_pos, end_pos-start_pos);
@@ -230,14 +310,14 @@ bool XMLTokenizer_Impl::next_tag_node(XMLToken *out_token)
 			// Find seperator:
 			pos = data.find_first_not_of(" \r\n\t", pos);
 			if (pos == data.npos || pos == size-1)
-				XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
+				throw_premature_end();
 			if (data[pos++] != '=')
 				XMLTokenizer_Impl::throw_exception(string_format("XML error(s), parser confused at line %1 (tag=%2, attributeName=%3)", get_line_number(), out_token->name, attributeName));
 
 			// Strip whitespace:
 			pos = data.find_first_not_of(" \r\n\t", pos);
 			if (pos == data.npos)
-				XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
+				throw_premature_end();
 
 			// Extract attribute value:
 			std::string::value_type const * first_of = " \r\n\t";
@@ -246,7 +326,7 @@ bool XMLTokenizer_Impl::next_tag_node(XMLToken *out_token)
 				first_of = "\"";
 				pos++;
 				if (pos == size)
-					XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
+					throw_premature_end();
 			}
 			else
 				if (data[pos] == '\'')
@@ -254,13 +334,13 @@ bool XMLTokenizer_Impl::next_tag_node(XMLToken *out_token)
 					first_of = "'";
 					pos++;
 					if (pos == size)
-						XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
+						throw_premature_end();
 				}
 
 				start_pos = pos;
 				end_pos = data.find_first_of(first_of, start_pos);
 				if (end_pos == data.npos)
-					XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
+					throw_premature_end();
 
 				std::string attributeValue;
 				std::string attributeValueOrig = data.substr(start_pos, end_pos-start_pos);
@@ -268,7 +348,7 @@ bool XMLTokenizer_Impl::next_tag_node(XMLToken *out_token)
 
 				pos = end_pos + 1;
 				if (pos == size)
-					XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
+					throw_premature_end();
 
 				// Finally apply attribute to token:
 				out_token->attributes.push_back(XMLToken::Attribute(attributeName, attributeValue));
@@ -281,7 +361,7 @@ bool XMLTokenizer_Impl::next_tag_node(XMLToken *out_token)
 		out_token->variant = XMLToken::SINGLE;
 		pos++;
 		if (pos == size)
-			XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
+			throw_premature_end();
 	}
 
 	// Data stream should be ending now.
@@ -295,14 +375,14 @@ bool XMLTokenizer_Impl::next_tag_node(XMLToken *out_token)
 bool XMLTokenizer_Impl::next_exclamation_mark_node(XMLToken *out_token)
 {
 	if (pos+2 >= size)
-		XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
+		throw_premature_end();
 	
 	if (data.compare(pos, 2, "--") == 0) // comment block
 	{
 		std::string::size_type start_pos = pos+2;
 		std::string::size_type end_pos = data.find("-->", start_pos);
 		if (end_pos == data.npos)
-			XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
+			throw_premature_end();
 		pos = end_pos+3;
 
 		std::string text;
@@ -318,26 +398,26 @@ bool XMLTokenizer_Impl::next_exclamation_mark_node(XMLToken *out_token)
 	}
 
 	if (pos+7 >= size)
-		XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
+		throw_premature_end();
 	
 	if (data.compare(pos, 7, "DOCTYPE") == 0)
 	{
 		// Strip whitespace:
 		pos = data.find_first_not_of(" \r\n\t", pos+7);
 		if (pos == data.npos)
-			XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
+			throw_premature_end();
 
 		// Find doctype name:				
 		std::string::size_type name_start = pos;
 		std::string::size_type name_end = data.find_first_of(" \r\n\t?/>", name_start);
 		if (name_end == data.npos)
-			XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
+			throw_premature_end();
 		pos = name_end;
 		
 		// Strip whitespace:
 		pos = data.find_first_not_of(" \r\n\t", pos);
 		if (pos == data.npos)
-			XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
+			throw_premature_end();
 
 		std::string::size_type public_start = data.npos;
 		std::string::size_type public_end = data.npos;
@@ -350,73 +430,73 @@ bool XMLTokenizer_Impl::next_exclamation_mark_node(XMLToken *out_token)
 		if (data[pos] != '[' && data[pos] != '>')
 		{
 			if (pos+6 >= size)
-				XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
+				throw_premature_end();
 
 			if (data.compare(pos, 6, "SYSTEM") == 0)
 			{
 				pos+=6;
 				if (pos == size)
-					XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
+					throw_premature_end();
 
 				// Strip whitespace:
 				pos = data.find_first_not_of(" \r\n\t", pos);
 				if (pos == data.npos)
-					XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
+					throw_premature_end();
 
 				// Read system literal:
 				std::string::value_type literal_char = data[pos];
 				if (literal_char != '\'' && literal_char != '"')
-					XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
+					throw_premature_end();
 
 				system_start = pos+1;
 				system_end = data.find(literal_char, system_start);
 				if (system_end == data.npos)
-					XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
+					throw_premature_end();
 				pos = system_end + 1;
 				if (pos >= size)
-					XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
+					throw_premature_end();
 			}
 			else if (data.compare(pos, 6, "PUBLIC") == 0)
 			{
 				pos+=6;
 				if (pos == size)
-					XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
+					throw_premature_end();
 
 				// Strip whitespace:
 				pos = data.find_first_not_of(" \r\n\t", pos);
 				if (pos == data.npos)
-					XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
+					throw_premature_end();
 
 				// Read public literal:
 				std::string::value_type literal_char = data[pos];
 				if (literal_char != '\'' && literal_char != '"')
-					XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
+					throw_premature_end();
 
 				public_start = pos+1;
 				public_end = data.find(literal_char, public_start);
 				if (public_end == data.npos)
-					XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
+					throw_premature_end();
 				pos = public_end + 1;
 				if (pos >= size)
-					XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
+					throw_premature_end();
 
 				// Strip whitespace:
 				pos = data.find_first_not_of(" \r\n\t", pos);
 				if (pos == data.npos)
-					XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
+					throw_premature_end();
 
 				// Read system literal:
 				literal_char = data[pos];
 				if (literal_char != '\'' && literal_char != '"')
-					XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
+					throw_premature_end();
 
 				system_start = pos+1;
 				system_end = data.find(literal_char, system_start);
 				if (system_end == data.npos)
-					XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
+					throw_premature_end();
 				pos = system_end + 1;
 				if (pos >= size)
-					XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
+					throw_premature_end();
 			}
 			else
 				XMLTokenizer_Impl::throw_exception(string_format("Error in XML stream, line %1 (unknown external identifier type in DOCTYPE)", get_line_number()));
@@ -424,7 +504,7 @@ bool XMLTokenizer_Impl::next_exclamation_mark_node(XMLToken *out_token)
 			// Strip whitespace:
 			pos = data.find_first_not_of(" \r\n\t", pos);
 			if (pos == data.npos)
-				XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
+				throw_premature_end();
 		}
 		
 		// Look for possible internal subset:
@@ -436,7 +516,7 @@ bool XMLTokenizer_Impl::next_exclamation_mark_node(XMLToken *out_token)
 			// (to avoid parsing it, we search backwards)
 			std::string::size_type end_pos = data.find('>', pos+1);
 			if (end_pos == data.npos)
-				XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
+				throw_premature_end();
 			
 			subset_end = data.rfind(']', end_pos);
 			if (subset_end == data.npos)
@@ -458,7 +538,7 @@ bool XMLTokenizer_Impl::next_exclamation_mark_node(XMLToken *out_token)
 		std::string::size_type start_pos = pos+7;
 		std::string::size_type end_pos = data.find("]]>", start_pos);
 		if (end_pos == data.npos)
-			XMLTokenizer_Impl::throw_exception("Premature end of XML data!");
+			throw_premature_end();
 		pos = end_pos+3;
 
 		std::string value = data.substr(start_pos, end_pos-start_pos);
@@ -470,7 +550,7 @@ bool XMLTokenizer_Impl::next_exclamation_mark_node(XMLToken *out_token)
 	}
 	else
 	{
-		XMLTokenizer_Impl::throw_exception(string_format("Error in XML stream at position %1", static_cast<int>(pos)));
+		XMLTokenizer_Impl::throw_exception(string_format("Error in XML stream at position %1", static_cast<int>(window_offset + pos)));
 		return false;
 	}
 }
@@ -480,9 +560,41 @@ void XMLTokenizer_Impl::throw_exception(const std::string &str)
 	throw Exception(str);
 }
 
+void XMLTokenizer_Impl::throw_premature_end()
+{
+	if (!end_of_input)
+		throw NeedMoreData();
+	throw_exception("Premature end of XML data!");
+}
+
+void XMLTokenizer_Impl::read_more()
+{
+	// Discard the tokens already returned
+	if (pos > 0)
+	{
+		window_lines += std::count(data.begin(), data.begin() + pos, '\n');
+		window_offset += pos;
+		data.erase(0, pos);
+		pos = 0;
+	}
+
+	// Grow geometrically so that a token much larger than the chunk size isn't rescanned for every chunk
+	std::string::size_type old_size = data.size();
+	std::string::size_type read_size = std::max(old_size, (std::string::size_type)chunk_size);
+	data.resize(old_size + read_size);
+	int received = input.receive(&data[old_size], (int)read_size, true);
+	if (received < 0)
+		received = 0;
+	data.resize(old_size + received);
+	size = data.size();
+
+	if (received < (int)read_size)
+		end_of_input = true;
+}
+
 int XMLTokenizer_Impl::get_line_number()
 {
-	int line = 1;
+	int line = 1 + window_lines;
 	std::string::size_type tmp_pos = 0;
 
 	std::string::const_iterator it;
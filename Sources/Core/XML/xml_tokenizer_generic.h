@@ -38,7 +38,7 @@ class XMLTokenizer_Impl
 /// \name Construction
 /// \{
 public:
-	XMLTokenizer_Impl() : pos(0), size(0), eat_whitespace(true) { }
+	XMLTokenizer_Impl() : pos(0), size(0), eat_whitespace(true), end_of_input(true), chunk_size(0), window_offset(0), window_lines(0) { }
 /// \}
 
 /// \name Attributes
@@ -48,12 +48,25 @@ public:
 	std::string::size_type pos, size;
 	std::string data;
 	bool eat_whitespace;
+
+	// Streaming state. data only holds a window of the input starting at window_offset
+	bool end_of_input;
+	int chunk_size;
+	std::string::size_type window_offset;
+	int window_lines;
 /// \}
 
 /// \name Operations
 /// \{
 public:
 	static void throw_exception(const std::string &str);
+
+	/// \brief Signals that the current token continues past the end of the data window
+	void throw_premature_end();
+
+	/// \brief Discards data before pos and reads more data from the input into the window
+	void read_more();
+
 	bool next_text_node(XMLToken *out_token);
 	bool next_tag_node(XMLToken *out_token);
 	bool next_exclamation_mark_node(XMLToken *out_token);
@@ -69,6 +82,13 @@ public:
 /// \name Implementation
 /// \{
 private:
+	/// \brief Thrown internally when a token needs more data than the window holds
+	class NeedMoreData
+	{
+	};
+
+	// XMLTokenizer::next catches NeedMoreData to refill the window and retry the token
+	friend class XMLTokenizer;
 /// \}
 };
 
@@ -30,8 +30,10 @@
 #include "Core/precomp.h"
 #include "API/Core/XML/xpath_evaluator.h"
 #include "API/Core/XML/xpath_exception.h"
+#include "API/Core/XML/xpath_expression.h"
 #include "API/Core/XML/dom_node.h"
 #include "xpath_evaluator_impl.h"
+#include "xpath_expression_impl.h"
 #include "xpath_token.h"
 
 namespace clan
@@ -50,11 +52,19 @@ XPathEvaluator::XPathEvaluator()
 
 XPathObject XPathEvaluator::evaluate(const std::string &expression, const DomNode &context_node) const
 {
-	XPathToken prev_token;
+	return evaluate(XPathExpression(expression), context_node);
+}
+
+XPathObject XPathEvaluator::evaluate(const XPathExpression &expression, const DomNode &context_node) const
+{
+	if (expression.is_null())
+		throw XPathException("Null XPath expression");
+
+	XPathTokenRange tokens(expression.impl.get());
 	std::vector<DomNode> nodelist(1, context_node);
-	XPathEvaluateResult result = impl->evaluate(expression, nodelist, 0, prev_token);
+	XPathEvaluateResult result = impl->evaluate(tokens, nodelist, 0, tokens.start_token());
 	if (result.next_token.type != XPathToken::type_none)
-		throw XPathException("Expected end of expression", expression, result.next_token);
+		throw XPathException("Expected end of expression", tokens, result.next_token);
 	return result.result;
 }
 
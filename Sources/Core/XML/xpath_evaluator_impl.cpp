@@ -51,7 +51,7 @@ namespace clan
 
 
 XPathEvaluateResult XPathEvaluator_Impl::evaluate(
-	const std::string &expression,
+	const XPathTokenRange &expression,
 	const XPathNodeSet &context,
 	XPathNodeSet::size_type context_node_index,
 	XPathToken prev_token) const
@@ -104,7 +104,7 @@ XPathEvaluateResult XPathEvaluator_Impl::evaluate(
 		}
 		else if (cur_token.type == XPathToken::type_number)
 		{
-			operand_stack.push_back(XPathObject(StringHelp::text_to_double(cur_token.value.str)));
+			operand_stack.push_back(XPathObject(cur_token.value.number));
 		}
 		else if (cur_token.type == XPathToken::type_function_name)
 		{
@@ -152,8 +152,8 @@ XPathEvaluateResult XPathEvaluator_Impl::evaluate(
 				throw XPathException("Missing matching ']' in expression", expression, cur_token);
 
 			XPathLocationStep::Predicate predicate;
-			predicate.pos = cur_token.pos + cur_token.length;
-			predicate.length = end_token.pos - predicate.pos;
+			predicate.first_token = cur_token.index + 1;
+			predicate.end_token = end_token.index;
 
 			XPathNodeSet filtered_nodes;
 			XPathNodeSet nodes = cur_operand.get_node_set();
@@ -866,7 +866,7 @@ bool XPathEvaluator_Impl::compare_string(const Operand &a, const Operand &b, Ope
 }
 
 XPathToken XPathEvaluator_Impl::read_location_path(
-	const std::string &expression,
+	const XPathTokenRange &expression,
 	XPathToken cur_token,
 	const XPathNodeSet &context,
 	XPathNodeSet::size_type context_node_index,
@@ -925,7 +925,7 @@ XPathToken XPathEvaluator_Impl::read_location_path(
 }
 
 XPathToken XPathEvaluator_Impl::read_location_steps(
-	const std::string &expression,
+	const XPathTokenRange &expression,
 	XPathToken cur_token,
 	const XPathNodeSet &context,
 	XPathNodeSet::size_type context_node_index,
@@ -971,7 +971,7 @@ XPathToken XPathEvaluator_Impl::read_location_steps(
 }
 
 XPathToken XPathEvaluator_Impl::read_location_step(
-	const std::string &expression,
+	const XPathTokenRange &expression,
 	XPathToken cur_token,
 	XPathLocationStep &step) const
 {
@@ -999,19 +999,19 @@ XPathToken XPathEvaluator_Impl::read_location_step(
 */
 	if (cur_token.type == XPathToken::type_dot)
 	{
-		step.axis = "self";
+		step.axis = XPathLocationStep::axis_self;
 		step.test_type = XPathLocationStep::type_node;
 		step.node_type = XPathToken::node_type_node;
 	}
 	else if (cur_token.type == XPathToken::type_double_dot)
 	{
-		step.axis = "parent";
+		step.axis = XPathLocationStep::axis_parent;
 		step.test_type = XPathLocationStep::type_node;
 		step.node_type = XPathToken::node_type_node;
 	}
 	else if (cur_token.type == XPathToken::type_operator && cur_token.value.oper == XPathToken::operator_double_slash)
 	{
-		step.axis = "descendant-or-self";
+		step.axis = XPathLocationStep::axis_descendant_or_self;
 		step.test_type = XPathLocationStep::type_node;
 		step.node_type = XPathToken::node_type_node;
 	}
@@ -1020,7 +1020,7 @@ XPathToken XPathEvaluator_Impl::read_location_step(
 		// Read AxisSpecifier:
 		if (cur_token.type == XPathToken::type_axis_name)
 		{
-			step.axis = cur_token.value.str;
+			step.axis = to_axis(cur_token.value.str, expression, cur_token);
 			cur_token = read_token(expression, cur_token);
 			if (cur_token.type != XPathToken::type_double_colon)
 				throw XPathException("Expected '::' after axis name", expression, cur_token);
@@ -1028,12 +1028,12 @@ XPathToken XPathEvaluator_Impl::read_location_step(
 		}
 		else if (cur_token.type == XPathToken::type_at_sign) // Abbreviated axis specifier
 		{
-			step.axis = "attribute";
+			step.axis = XPathLocationStep::axis_attribute;
 			cur_token = read_token(expression, cur_token);
 		}
 		else // Abbreviated syntax
 		{
-			step.axis = "child";
+			step.axis = XPathLocationStep::axis_child;
 		}
 
 		// Read Node Test:
@@ -1067,9 +1067,9 @@ XPathToken XPathEvaluator_Impl::read_location_step(
 		while (next_token.type == XPathToken::type_bracket_begin)
 		{
 			XPathLocationStep::Predicate predicate;
-			predicate.pos = next_token.pos + next_token.length;
+			predicate.first_token = next_token.index + 1;
 			cur_token = skip_predicate_expression(expression, next_token);
-			predicate.length = cur_token.pos - predicate.pos;
+			predicate.end_token = cur_token.index;
 			step.predicates.push_back(predicate);
 			next_token = read_token(expression, cur_token);
 		}
@@ -1077,7 +1077,7 @@ XPathToken XPathEvaluator_Impl::read_location_step(
 	return cur_token;
 }
 
-XPathToken XPathEvaluator_Impl::skip_predicate_expression(const std::string &expression, const XPathToken &previous_token) const
+XPathToken XPathEvaluator_Impl::skip_predicate_expression(const XPathTokenRange &expression, const XPathToken &previous_token) const
 {
 	int bracket_count = 1;
 	XPathToken cur_token = previous_token;
@@ -1102,38 +1102,84 @@ XPathToken XPathEvaluator_Impl::skip_predicate_expression(const std::string &exp
 	return cur_token;
 }
 
-void XPathEvaluator_Impl::evaluate_location_step(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+XPathLocationStep::Axis XPathEvaluator_Impl::to_axis(const std::string &name, const XPathTokenRange &expression, const XPathToken &cur_token) const
+{
+	if (name == "ancestor")
+		return XPathLocationStep::axis_ancestor;
+	else if (name == "ancestor-or-self")
+		return XPathLocationStep::axis_ancestor_or_self;
+	else if (name == "attribute")
+		return XPathLocationStep::axis_attribute;
+	else if (name == "child")
+		return XPathLocationStep::axis_child;
+	else if (name == "descendant")
+		return XPathLocationStep::axis_descendant;
+	else if (name == "descendant-or-self")
+		return XPathLocationStep::axis_descendant_or_self;
+	else if (name == "following")
+		return XPathLocationStep::axis_following;
+	else if (name == "following-sibling")
+		return XPathLocationStep::axis_following_sibling;
+	else if (name == "namespace")
+		return XPathLocationStep::axis_namespace;
+	else if (name == "parent")
+		return XPathLocationStep::axis_parent;
+	else if (name == "preceding")
+		return XPathLocationStep::axis_preceding;
+	else if (name == "preceding-sibling")
+		return XPathLocationStep::axis_preceding_sibling;
+	else if (name == "self")
+		return XPathLocationStep::axis_self;
+	else
+		throw XPathException(string_format("Unknown location step axis '%1'", name), expression, cur_token);
+}
+
+void XPathEvaluator_Impl::evaluate_location_step(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathTokenRange &expression, XPathNodeSet &nodes) const
 {
 	if (step_index < steps.size())
 	{
-		if (steps[step_index].axis == "ancestor")
+		switch (steps[step_index].axis)
+		{
+		case XPathLocationStep::axis_ancestor:
 			select_nodes_ancestor(context, context_node_index, steps, step_index, expression, nodes);
-		else if (steps[step_index].axis == "ancestor-or-self")
+			break;
+		case XPathLocationStep::axis_ancestor_or_self:
 			select_nodes_ancestor_or_self(context, context_node_index, steps, step_index, expression, nodes);
-		else if (steps[step_index].axis == "attribute")
+			break;
+		case XPathLocationStep::axis_attribute:
 			select_nodes_attribute(context, context_node_index, steps, step_index, expression, nodes);
-		else if (steps[step_index].axis == "child")
+			break;
+		case XPathLocationStep::axis_child:
 			select_nodes_child(context, context_node_index, steps, step_index, expression, nodes);
-		else if (steps[step_index].axis == "descendant")
+			break;
+		case XPathLocationStep::axis_descendant:
 			select_nodes_descendant(context, context_node_index, steps, step_index, expression, nodes);
-		else if (steps[step_index].axis == "descendant-or-self")
+			break;
+		case XPathLocationStep::axis_descendant_or_self:
 			select_nodes_descendant_or_self(context, context_node_index, steps, step_index, expression, nodes);
-		else if (steps[step_index].axis == "following")
+			break;
+		case XPathLocationStep::axis_following:
 			select_nodes_following(context, context_node_index, steps, step_index, expression, nodes);
-		else if (steps[step_index].axis == "follwing-sibling")
+			break;
+		case XPathLocationStep::axis_following_sibling:
 			select_nodes_following_sibling(context, context_node_index, steps, step_index, expression, nodes);
-		else if (steps[step_index].axis == "namespace")
+			break;
+		case XPathLocationStep::axis_namespace:
 			select_nodes_namespace(context, context_node_index, steps, step_index, expression, nodes);
-		else if (steps[step_index].axis == "parent")
+			break;
+		case XPathLocationStep::axis_parent:
 			select_nodes_parent(context, context_node_index, steps, step_index, expression, nodes);
-		else if (steps[step_index].axis == "preceding")
+			break;
+		case XPathLocationStep::axis_preceding:
 			select_nodes_preceding(context, context_node_index, steps, step_index, expression, nodes);
-		else if (steps[step_index].axis == "preceding-sibling")
+			break;
+		case XPathLocationStep::axis_preceding_sibling:
 			select_nodes_preceding_sibling(context, context_node_index, steps, step_index, expression, nodes);
-		else if (steps[step_index].axis == "self")
+			break;
+		case XPathLocationStep::axis_self:
 			select_nodes_self(context, context_node_index, steps, step_index, expression, nodes);
-		else
-			throw XPathException(string_format("Unknown location step axis", steps[step_index].axis), expression);
+			break;
+		}
 	}
 	else
 	{
@@ -1141,7 +1187,7 @@ void XPathEvaluator_Impl::evaluate_location_step(const XPathNodeSet &context, XP
 	}
 }
 
-void XPathEvaluator_Impl::select_nodes_ancestor(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+void XPathEvaluator_Impl::select_nodes_ancestor(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathTokenRange &expression, XPathNodeSet &nodes) const
 {
 	XPathNodeSet nodeset;
 	DomNode parent = context[context_node_index].get_parent_node();
@@ -1156,7 +1202,7 @@ void XPathEvaluator_Impl::select_nodes_ancestor(const XPathNodeSet &context, XPa
 	evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
 }
 
-void XPathEvaluator_Impl::select_nodes_ancestor_or_self(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+void XPathEvaluator_Impl::select_nodes_ancestor_or_self(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathTokenRange &expression, XPathNodeSet &nodes) const
 {
 	XPathNodeSet nodeset;
 	DomNode parent = context[context_node_index];
@@ -1171,7 +1217,7 @@ void XPathEvaluator_Impl::select_nodes_ancestor_or_self(const XPathNodeSet &cont
 	evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
 }
 
-void XPathEvaluator_Impl::select_nodes_attribute(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+void XPathEvaluator_Impl::select_nodes_attribute(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathTokenRange &expression, XPathNodeSet &nodes) const
 {
 	XPathNodeSet nodeset;
 	DomNamedNodeMap attributes = context[context_node_index].get_attributes();
@@ -1186,7 +1232,7 @@ void XPathEvaluator_Impl::select_nodes_attribute(const XPathNodeSet &context, XP
 	evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
 }
 
-void XPathEvaluator_Impl::select_nodes_child(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+void XPathEvaluator_Impl::select_nodes_child(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathTokenRange &expression, XPathNodeSet &nodes) const
 {
 	XPathNodeSet nodeset;
 	DomNode cur_node = context[context_node_index].get_first_child();
@@ -1200,7 +1246,7 @@ void XPathEvaluator_Impl::select_nodes_child(const XPathNodeSet &context, XPathN
 	evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
 }
 
-void XPathEvaluator_Impl::select_nodes_descendant(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+void XPathEvaluator_Impl::select_nodes_descendant(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathTokenRange &expression, XPathNodeSet &nodes) const
 {
 	XPathNodeSet parentNodes;
 	XPathNodeSet nodeset;
@@ -1226,7 +1272,7 @@ void XPathEvaluator_Impl::select_nodes_descendant(const XPathNodeSet &context, X
 	evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
 }
 
-void XPathEvaluator_Impl::select_nodes_descendant_or_self(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+void XPathEvaluator_Impl::select_nodes_descendant_or_self(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathTokenRange &expression, XPathNodeSet &nodes) const
 {
 	XPathNodeSet parentNodes;
 	XPathNodeSet nodeset;
@@ -1252,7 +1298,7 @@ void XPathEvaluator_Impl::select_nodes_descendant_or_self(const XPathNodeSet &co
 	evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
 }
 
-void XPathEvaluator_Impl::select_nodes_following(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+void XPathEvaluator_Impl::select_nodes_following(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathTokenRange &expression, XPathNodeSet &nodes) const
 {
 	XPathNodeSet nodeset;
 
@@ -1288,7 +1334,7 @@ void XPathEvaluator_Impl::select_nodes_following(const XPathNodeSet &context, XP
 	evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
 }
 
-void XPathEvaluator_Impl::select_nodes_following_sibling(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+void XPathEvaluator_Impl::select_nodes_following_sibling(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathTokenRange &expression, XPathNodeSet &nodes) const
 {
 	XPathNodeSet nodeset;
 	DomNode cur_node = context[context_node_index].get_next_sibling();
@@ -1302,11 +1348,11 @@ void XPathEvaluator_Impl::select_nodes_following_sibling(const XPathNodeSet &con
 	evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
 }
 
-void XPathEvaluator_Impl::select_nodes_namespace(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+void XPathEvaluator_Impl::select_nodes_namespace(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathTokenRange &expression, XPathNodeSet &nodes) const
 {
 }
 
-void XPathEvaluator_Impl::select_nodes_parent(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+void XPathEvaluator_Impl::select_nodes_parent(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathTokenRange &expression, XPathNodeSet &nodes) const
 {
 	XPathNodeSet nodeset;
 	DomNode parent = context[context_node_index].get_parent_node();
@@ -1319,7 +1365,7 @@ void XPathEvaluator_Impl::select_nodes_parent(const XPathNodeSet &context, XPath
 	evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
 }
 
-void XPathEvaluator_Impl::select_nodes_preceding(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+void XPathEvaluator_Impl::select_nodes_preceding(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathTokenRange &expression, XPathNodeSet &nodes) const
 {
 	XPathNodeSet nodeset;
 
@@ -1355,7 +1401,7 @@ void XPathEvaluator_Impl::select_nodes_preceding(const XPathNodeSet &context, XP
 	evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
 }
 
-void XPathEvaluator_Impl::select_nodes_preceding_sibling(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+void XPathEvaluator_Impl::select_nodes_preceding_sibling(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathTokenRange &expression, XPathNodeSet &nodes) const
 {
 	XPathNodeSet nodeset;
 	DomNode cur_node = context[context_node_index].get_previous_sibling();
@@ -1369,7 +1415,7 @@ void XPathEvaluator_Impl::select_nodes_preceding_sibling(const XPathNodeSet &con
 	evaluate_location_step_predicates(nodeset, steps, step_index, expression, nodes);
 }
 
-void XPathEvaluator_Impl::select_nodes_self(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+void XPathEvaluator_Impl::select_nodes_self(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathTokenRange &expression, XPathNodeSet &nodes) const
 {
 	DomNode cur_node = context[context_node_index];
 	if (!cur_node.is_null())
@@ -1379,7 +1425,7 @@ void XPathEvaluator_Impl::select_nodes_self(const XPathNodeSet &context, XPathNo
 	}
 }
 
-bool XPathEvaluator_Impl::confirm_step_requirements(const DomNode &node, const XPathLocationStep &step, const std::string &expression) const
+bool XPathEvaluator_Impl::confirm_step_requirements(const DomNode &node, const XPathLocationStep &step, const XPathTokenRange &expression) const
 {
 	bool test_passed = false;
 	switch (step.test_type)
@@ -1389,7 +1435,7 @@ bool XPathEvaluator_Impl::confirm_step_requirements(const DomNode &node, const X
 		test_passed = true;
 		break;
 	case XPathLocationStep::type_name:
-		test_passed = (node.get_node_type() == DomNode::ELEMENT_NODE || node.get_node_type() == DomNode::ATTRIBUTE_NODE) && (step.test_str == "*" || node.get_node_name() == step.test_str);
+		test_passed = (node.get_node_type() == DomNode::ELEMENT_NODE || node.get_node_type() == DomNode::ATTRIBUTE_NODE) && (step.test_str == "*" || node.get_node_name_view() == step.test_str);
 		break;
 	case XPathLocationStep::type_node:
 		if (step.node_type != XPathToken::node_type_node)
@@ -1418,9 +1464,10 @@ bool XPathEvaluator_Impl::confirm_step_requirements(const DomNode &node, const X
 	return test_passed;
 }
 
-bool XPathEvaluator_Impl::confirm_step_predicate(XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const XPathLocationStep::Predicate &predicate, const std::string &expression) const
+bool XPathEvaluator_Impl::confirm_step_predicate(XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const XPathLocationStep::Predicate &predicate, const XPathTokenRange &expression) const
 {
-	XPathEvaluateResult result = evaluate(expression.substr(predicate.pos, predicate.length), context, context_node_index, XPathToken());
+	XPathTokenRange predicate_expression = expression.sub_range(predicate.first_token, predicate.end_token);
+	XPathEvaluateResult result = evaluate(predicate_expression, context, context_node_index, predicate_expression.start_token());
 	bool include_in_nodeset = false;
 	switch (result.result.get_type())
 	{
@@ -1442,7 +1489,7 @@ bool XPathEvaluator_Impl::confirm_step_predicate(XPathNodeSet &context, XPathNod
 	return include_in_nodeset;
 }
 
-void XPathEvaluator_Impl::evaluate_location_step_predicates(const XPathNodeSet &context, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &nodes) const
+void XPathEvaluator_Impl::evaluate_location_step_predicates(const XPathNodeSet &context, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathTokenRange &expression, XPathNodeSet &nodes) const
 {
 	XPathNodeSet nodeset = context;
 	for (const auto & elem : steps[step_index].predicates)
@@ -1461,8 +1508,15 @@ void XPathEvaluator_Impl::evaluate_location_step_predicates(const XPathNodeSet &
 }
 
 XPathToken XPathEvaluator_Impl::read_token(
-	const std::string &expression,
+	const XPathTokenRange &expression,
 	const XPathToken &previous_token) const
+{
+	return expression.next_token(previous_token);
+}
+
+XPathToken XPathEvaluator_Impl::tokenize(
+	const std::string &expression,
+	const XPathToken &previous_token)
 {
 	std::string::size_type pos = previous_token.pos + previous_token.length;
 	pos = expression.find_first_not_of(" \t\r\n", pos);
@@ -32,6 +32,7 @@
 #include "API/Core/XML/xpath_object.h"
 #include "xpath_token.h"
 #include "xpath_location_step.h"
+#include "xpath_expression_impl.h"
 
 namespace clan
 {
@@ -50,11 +51,16 @@ public:
 
 public:
 	XPathEvaluateResult evaluate(
-		const std::string &expression,
+		const XPathTokenRange &expression,
 		const XPathNodeSet &context,
 		XPathNodeSet::size_type context_node_index,
 		XPathToken prev_token) const;
 
+	/// \brief Reads the token following previous_token from the expression text
+	static XPathToken tokenize(
+		const std::string &expression,
+		const XPathToken &previous_token);
+
 private:
 	typedef XPathToken::Operator Operator;
 	typedef XPathObject Operand;
@@ -77,50 +83,52 @@ private:
 	bool compare_string(const Operand &a, const Operand &b, Operator oper) const;
 
 	XPathToken read_location_path(
-		const std::string &expression,
+		const XPathTokenRange &expression,
 		XPathToken cur_token,
 		const XPathNodeSet &context,
 		XPathNodeSet::size_type context_node_index,
 		std::vector<Operand> &operand_stack) const;
 
 	XPathToken read_location_steps(
-		const std::string &expression,
+		const XPathTokenRange &expression,
 		XPathToken cur_token,
 		const XPathNodeSet &context,
 		XPathNodeSet::size_type context_node_index,
 		std::vector<XPathEvaluator_Impl::Operand> &operand_stack) const;
 
 	XPathToken read_location_step(
-		const std::string &expression,
+		const XPathTokenRange &expression,
 		XPathToken cur_token,
 		XPathLocationStep &step) const;
 
 	XPathToken read_token(
-		const std::string &expression,
-		const XPathToken &previous_token = XPathToken()) const;
+		const XPathTokenRange &expression,
+		const XPathToken &previous_token) const;
+
+	XPathLocationStep::Axis to_axis(const std::string &name, const XPathTokenRange &expression, const XPathToken &cur_token) const;
 
 	XPathToken skip_predicate_expression(
-		const std::string &expression,
-		const XPathToken &previous_token = XPathToken()) const;
-
-	void evaluate_location_step(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &out_nodeset) const;
-	void evaluate_location_step_predicates(const XPathNodeSet &context, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string & expression, XPathNodeSet & nodes) const;
-
-	void select_nodes_ancestor(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &out_nodeset) const;
-	void select_nodes_ancestor_or_self(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &out_nodeset) const;
-	void select_nodes_attribute(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &out_nodeset) const;
-	void select_nodes_child(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &out_nodeset) const;
-	void select_nodes_descendant(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &out_nodeset) const;
-	void select_nodes_descendant_or_self(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &out_nodeset) const;
-	void select_nodes_following(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &out_nodeset) const;
-	void select_nodes_following_sibling(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &out_nodeset) const;
-	void select_nodes_namespace(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &out_nodeset) const;
-	void select_nodes_parent(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &out_nodeset) const;
-	void select_nodes_preceding(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &out_nodeset) const;
-	void select_nodes_preceding_sibling(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &out_nodeset) const;
-	void select_nodes_self(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const std::string &expression, XPathNodeSet &out_nodeset) const;
-	bool confirm_step_requirements(const DomNode &node, const XPathLocationStep &step, const std::string &expression) const;
-	bool confirm_step_predicate(XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const XPathLocationStep::Predicate &predicate, const std::string &expression) const;
+		const XPathTokenRange &expression,
+		const XPathToken &previous_token) const;
+
+	void evaluate_location_step(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathTokenRange &expression, XPathNodeSet &out_nodeset) const;
+	void evaluate_location_step_predicates(const XPathNodeSet &context, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathTokenRange &expression, XPathNodeSet & nodes) const;
+
+	void select_nodes_ancestor(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathTokenRange &expression, XPathNodeSet &out_nodeset) const;
+	void select_nodes_ancestor_or_self(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathTokenRange &expression, XPathNodeSet &out_nodeset) const;
+	void select_nodes_attribute(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathTokenRange &expression, XPathNodeSet &out_nodeset) const;
+	void select_nodes_child(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathTokenRange &expression, XPathNodeSet &out_nodeset) const;
+	void select_nodes_descendant(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathTokenRange &expression, XPathNodeSet &out_nodeset) const;
+	void select_nodes_descendant_or_self(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathTokenRange &expression, XPathNodeSet &out_nodeset) const;
+	void select_nodes_following(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathTokenRange &expression, XPathNodeSet &out_nodeset) const;
+	void select_nodes_following_sibling(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathTokenRange &expression, XPathNodeSet &out_nodeset) const;
+	void select_nodes_namespace(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathTokenRange &expression, XPathNodeSet &out_nodeset) const;
+	void select_nodes_parent(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathTokenRange &expression, XPathNodeSet &out_nodeset) const;
+	void select_nodes_preceding(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathTokenRange &expression, XPathNodeSet &out_nodeset) const;
+	void select_nodes_preceding_sibling(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathTokenRange &expression, XPathNodeSet &out_nodeset) const;
+	void select_nodes_self(const XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const std::vector<XPathLocationStep> &steps, std::vector<XPathLocationStep>::size_type step_index, const XPathTokenRange &expression, XPathNodeSet &out_nodeset) const;
+	bool confirm_step_requirements(const DomNode &node, const XPathLocationStep &step, const XPathTokenRange &expression) const;
+	bool confirm_step_predicate(XPathNodeSet &context, XPathNodeSet::size_type context_node_index, const XPathLocationStep::Predicate &predicate, const XPathTokenRange &expression) const;
 
 	XPathObject call_function(const XPathNodeSet& context, XPathNodeSet::size_type context_node_index, const std::string &name, const std::vector<XPathObject> &parameters) const;
 	XPathObject get_variable(const std::string &name) const;
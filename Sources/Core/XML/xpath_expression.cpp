@@ -0,0 +1,105 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Core/precomp.h"
+#include "API/Core/XML/xpath_expression.h"
+#include "API/Core/Text/string_help.h"
+#include "xpath_expression_impl.h"
+#include "xpath_evaluator_impl.h"
+
+namespace clan
+{
+
+/////////////////////////////////////////////////////////////////////////////
+// XPathExpression Construction:
+
+XPathExpression::XPathExpression()
+{
+}
+
+XPathExpression::XPathExpression(const std::string &expression)
+: impl(std::make_shared<XPathExpression_Impl>(expression))
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// XPathExpression Attributes:
+
+std::string XPathExpression::get_expression() const
+{
+	return impl ? impl->expression : std::string();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// XPathExpression_Impl Construction:
+
+XPathExpression_Impl::XPathExpression_Impl(const std::string &expression)
+: expression(expression)
+{
+	XPathToken prev_token;
+	while (true)
+	{
+		XPathToken token = XPathEvaluator_Impl::tokenize(expression, prev_token);
+		token.index = (int)tokens.size();
+		if (token.type == XPathToken::type_none)
+		{
+			end_token = token;
+			break;
+		}
+
+		if (token.type == XPathToken::type_number)
+			token.value.number = StringHelp::text_to_double(token.value.str);
+
+		tokens.push_back(token);
+		prev_token = token;
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// XPathTokenRange Operations:
+
+XPathToken XPathTokenRange::next_token(const XPathToken &previous_token) const
+{
+	int index = previous_token.index + 1;
+	if (index < end)
+		return compiled->tokens[index];
+
+	if (end < (int)compiled->tokens.size())
+	{
+		XPathToken token;
+		token.index = end;
+		token.pos = compiled->tokens[end].pos;
+		return token;
+	}
+	else
+	{
+		return compiled->end_token;
+	}
+}
+
+}
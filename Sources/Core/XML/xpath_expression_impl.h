@@ -0,0 +1,89 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "xpath_token.h"
+#include <vector>
+
+namespace clan
+{
+
+class XPathExpression_Impl
+{
+public:
+	XPathExpression_Impl(const std::string &expression);
+
+	std::string expression;
+
+	/// \brief All tokens in the expression, in order
+	std::vector<XPathToken> tokens;
+
+	/// \brief Token returned when reading past the last token
+	XPathToken end_token;
+};
+
+/// \brief Range of tokens in a compiled expression that is evaluated as an expression of its own
+class XPathTokenRange
+{
+public:
+	XPathTokenRange(const XPathExpression_Impl *compiled)
+	: compiled(compiled), begin(0), end((int)compiled->tokens.size())
+	{
+	}
+
+	XPathTokenRange(const XPathExpression_Impl *compiled, int begin, int end)
+	: compiled(compiled), begin(begin), end(end)
+	{
+	}
+
+	/// \brief Source text of the whole expression, used for error messages
+	operator const std::string &() const { return compiled->expression; }
+
+	/// \brief Returns the token that precedes the first token in the range
+	XPathToken start_token() const
+	{
+		XPathToken token;
+		token.index = begin - 1;
+		return token;
+	}
+
+	/// \brief Returns the range of tokens from first_token up to, but not including, end_token
+	XPathTokenRange sub_range(int first_token, int end_token) const
+	{
+		return XPathTokenRange(compiled, first_token, end_token);
+	}
+
+	/// \brief Returns the token following previous_token, or a type_none token at the end of the range
+	XPathToken next_token(const XPathToken &previous_token) const;
+
+	const XPathExpression_Impl *compiled;
+	int begin, end;
+};
+
+}
@@ -90,15 +90,20 @@ public:
 		NodeType node_type;
 		Operator oper;
 		std::string str;
+		double number;
 	};
 
 	Type type;
 	Value value;
 	std::string::size_type pos, length;
 
+	/// \brief Index of the token in its compiled expression
+	int index;
+
 	XPathToken()
-	: type(type_none), pos(0), length(0)
+	: type(type_none), pos(0), length(0), index(-1)
 	{
+		value.number = 0.0;
 	}
 };
 
@@ -31,6 +31,7 @@
 #include "API/Core/Zip/zip_file_entry.h"
 #include "API/Core/IOData/iodevice.h"
 #include "zip_flags.h"
+#include <unordered_map>
 
 namespace clan
 {
@@ -50,6 +51,9 @@ public:
 public:
 	std::vector<ZipFileEntry> files;
 
+	/// \brief Maps archive filenames (without leading slash) to their index in files
+	std::unordered_map<std::string, int> file_index;
+
 	IODevice input;
 
 
@@ -58,18 +62,19 @@ public:
 /// \{
 
 public:
-	static uint32_t calc_crc32(const void *data, int64_t size, uint32_t crc = ZIP_CRC_START_VALUE, bool last_block = true);
+	/// \brief Adds files[index] to the filename index
+	void add_to_index(int index);
 
-	static void calc_time_and_date(int16_t &out_date, int16_t &out_time);
+	/// \brief Returns the index of a file in files, or -1 if not found
+	int find_file(const std::string &filename) const;
 
+	/// \brief Opens a file entry for reading
+	IODevice open_entry(ZipFileEntry &entry, const std::string &filename);
 
-/// \}
-/// \name Implementation
-/// \{
+	static uint32_t calc_crc32(const void *data, int64_t size, uint32_t crc = ZIP_CRC_START_VALUE, bool last_block = true);
+
+	static void calc_time_and_date(int16_t &out_date, int16_t &out_time);
 
-private:
-	// crc32_table_quotient = 0xdebb20e3
-	static uint32_t crc32_table[256];
 /// \}
 };
 
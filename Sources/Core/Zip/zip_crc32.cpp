@@ -0,0 +1,238 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Core/precomp.h"
+#include "zip_crc32.h"
+#include "API/Core/System/system.h"
+#include <cstring>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define CL_ZIP_CRC32_PCLMUL
+#define CL_ZIP_CRC32_PCLMUL_TARGET
+#include <intrin.h>
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && !defined(CL_ARM)
+#define CL_ZIP_CRC32_PCLMUL
+#define CL_ZIP_CRC32_PCLMUL_TARGET __attribute__((target("sse4.2,pclmul")))
+#include <smmintrin.h>
+#include <wmmintrin.h>
+#endif
+
+namespace clan
+{
+
+namespace
+{
+	class ZipCRC32Tables
+	{
+	public:
+		ZipCRC32Tables()
+		{
+			// Reflected polynomial 0x04c11db7
+			for (uint32_t i = 0; i < 256; i++)
+			{
+				uint32_t crc = i;
+				for (int bit = 0; bit < 8; bit++)
+					crc = (crc & 1) ? (crc >> 1) ^ 0xedb88320 : (crc >> 1);
+				table[0][i] = crc;
+			}
+
+			for (uint32_t i = 0; i < 256; i++)
+			{
+				for (int slice = 1; slice < 8; slice++)
+					table[slice][i] = (table[slice - 1][i] >> 8) ^ table[0][table[slice - 1][i] & 0xff];
+			}
+
+#if defined(CL_ZIP_CRC32_PCLMUL)
+			pclmul = System::detect_cpu_extension(System::sse4_2) && System::detect_cpu_extension(System::pclmul);
+#else
+			pclmul = false;
+#endif
+		}
+
+		uint32_t table[8][256];
+		bool pclmul;
+	};
+
+	ZipCRC32Tables tables;
+}
+
+uint32_t ZipCRC32::update(uint32_t crc, const void *data, size_t size)
+{
+	if (tables.pclmul)
+		return update_pclmul(crc, data, size);
+	else
+		return update_slice_by_8(crc, data, size);
+}
+
+uint32_t ZipCRC32::update_table(uint32_t crc, const void *data, size_t size)
+{
+	const unsigned char *d = static_cast<const unsigned char *>(data);
+	for (size_t i = 0; i < size; i++)
+		crc = (crc >> 8) ^ tables.table[0][(crc ^ d[i]) & 0xff];
+	return crc;
+}
+
+uint32_t ZipCRC32::update_slice_by_8(uint32_t crc, const void *data, size_t size)
+{
+#ifdef USE_BIG_ENDIAN
+	return update_table(crc, data, size);
+#else
+	const unsigned char *d = static_cast<const unsigned char *>(data);
+	while (size >= 8)
+	{
+		uint32_t low, high;
+		memcpy(&low, d, 4);
+		memcpy(&high, d + 4, 4);
+		low ^= crc;
+		crc =
+			tables.table[7][low & 0xff] ^
+			tables.table[6][(low >> 8) & 0xff] ^
+			tables.table[5][(low >> 16) & 0xff] ^
+			tables.table[4][low >> 24] ^
+			tables.table[3][high & 0xff] ^
+			tables.table[2][(high >> 8) & 0xff] ^
+			tables.table[1][(high >> 16) & 0xff] ^
+			tables.table[0][high >> 24];
+		d += 8;
+		size -= 8;
+	}
+	return update_table(crc, d, size);
+#endif
+}
+
+bool ZipCRC32::is_pclmul_supported()
+{
+	return tables.pclmul;
+}
+
+#if defined(CL_ZIP_CRC32_PCLMUL)
+
+// Folding constants for the reflected polynomial, see "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction" (Intel, 2009)
+CL_ZIP_CRC32_PCLMUL_TARGET static uint32_t update_pclmul_blocks(uint32_t crc, const unsigned char *d, size_t size)
+{
+	const __m128i k1k2 = _mm_set_epi32(0x00000001, (int)0xc6e41596, 0x00000001, 0x54442bd4);
+	const __m128i k3k4 = _mm_set_epi32(0x00000000, (int)0xccaa009e, 0x00000001, 0x751997d0);
+	const __m128i k5k0 = _mm_set_epi32(0x00000000, 0x00000000, 0x00000001, 0x63cd6124);
+	const __m128i poly = _mm_set_epi32(0x00000001, (int)0xf7011641, 0x00000001, (int)0xdb710641);
+	const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+
+	__m128i x1 = _mm_loadu_si128((const __m128i *)(d + 0x00));
+	__m128i x2 = _mm_loadu_si128((const __m128i *)(d + 0x10));
+	__m128i x3 = _mm_loadu_si128((const __m128i *)(d + 0x20));
+	__m128i x4 = _mm_loadu_si128((const __m128i *)(d + 0x30));
+	x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128((int)crc));
+	d += 64;
+	size -= 64;
+
+	// Fold four 128 bit lanes in parallel
+	while (size >= 64)
+	{
+		__m128i x5 = _mm_clmulepi64_si128(x1, k1k2, 0x00);
+		__m128i x6 = _mm_clmulepi64_si128(x2, k1k2, 0x00);
+		__m128i x7 = _mm_clmulepi64_si128(x3, k1k2, 0x00);
+		__m128i x8 = _mm_clmulepi64_si128(x4, k1k2, 0x00);
+
+		x1 = _mm_clmulepi64_si128(x1, k1k2, 0x11);
+		x2 = _mm_clmulepi64_si128(x2, k1k2, 0x11);
+		x3 = _mm_clmulepi64_si128(x3, k1k2, 0x11);
+		x4 = _mm_clmulepi64_si128(x4, k1k2, 0x11);
+
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128((const __m128i *)(d + 0x00)));
+		x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128((const __m128i *)(d + 0x10)));
+		x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128((const __m128i *)(d + 0x20)));
+		x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128((const __m128i *)(d + 0x30)));
+
+		d += 64;
+		size -= 64;
+	}
+
+	// Fold the four lanes into one
+	__m128i x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+	x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+	x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+	x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+	x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+	x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+
+	x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+	x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+	x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+	// Fold the remaining 16 byte blocks
+	while (size >= 16)
+	{
+		x5 = _mm_clmulepi64_si128(x1, k3k4, 0x00);
+		x1 = _mm_clmulepi64_si128(x1, k3k4, 0x11);
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, _mm_loadu_si128((const __m128i *)d)), x5);
+		d += 16;
+		size -= 16;
+	}
+
+	// Fold 128 bits to 64 bits
+	x2 = _mm_clmulepi64_si128(x1, k3k4, 0x10);
+	x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+
+	x2 = _mm_srli_si128(x1, 4);
+	x1 = _mm_and_si128(x1, mask32);
+	x1 = _mm_clmulepi64_si128(x1, k5k0, 0x00);
+	x1 = _mm_xor_si128(x1, x2);
+
+	// Barrett reduction to 32 bits
+	x2 = _mm_and_si128(x1, mask32);
+	x2 = _mm_clmulepi64_si128(x2, poly, 0x10);
+	x2 = _mm_and_si128(x2, mask32);
+	x2 = _mm_clmulepi64_si128(x2, poly, 0x00);
+	x1 = _mm_xor_si128(x1, x2);
+
+	return (uint32_t)_mm_extract_epi32(x1, 1);
+}
+
+uint32_t ZipCRC32::update_pclmul(uint32_t crc, const void *data, size_t size)
+{
+	const unsigned char *d = static_cast<const unsigned char *>(data);
+	if (size >= 64)
+	{
+		size_t blocks_size = size & ~(size_t)15;
+		crc = update_pclmul_blocks(crc, d, blocks_size);
+		d += blocks_size;
+		size -= blocks_size;
+	}
+	return update_slice_by_8(crc, d, size);
+}
+
+#else
+
+uint32_t ZipCRC32::update_pclmul(uint32_t crc, const void *data, size_t size)
+{
+	return update_slice_by_8(crc, data, size);
+}
+
+#endif
+
+}
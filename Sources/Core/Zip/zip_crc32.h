@@ -0,0 +1,61 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace clan
+{
+
+/// \brief CRC-32 (ISO 3309, as used by zip) with runtime selected implementations
+///
+/// All functions operate on the raw crc register. Start with ZIP_CRC_START_VALUE and invert the result after the last block.
+class ZipCRC32
+{
+public:
+	/// \brief Updates the crc using the fastest implementation supported by the CPU
+	static uint32_t update(uint32_t crc, const void *data, size_t size);
+
+	/// \brief Updates the crc one byte at a time using a single 256 entry table
+	static uint32_t update_table(uint32_t crc, const void *data, size_t size);
+
+	/// \brief Updates the crc eight bytes at a time using eight 256 entry tables
+	static uint32_t update_slice_by_8(uint32_t crc, const void *data, size_t size);
+
+	/// \brief Updates the crc by folding 64 byte blocks with carry-less multiplication
+	///
+	/// Only available when is_pclmul_supported() returns true. Buffers shorter than 64 bytes are handled by update_slice_by_8.
+	static uint32_t update_pclmul(uint32_t crc, const void *data, size_t size);
+
+	/// \brief Returns true if the CPU supports the SSE4.2 and PCLMULQDQ instructions used by update_pclmul
+	static bool is_pclmul_supported();
+};
+
+}
@@ -42,7 +42,7 @@ namespace clan
 // ZipIODevice_FileEntry construction:
 
 ZipIODevice_FileEntry::ZipIODevice_FileEntry(IODevice iodevice, const ZipFileEntry &entry)
-: iodevice(iodevice), file_entry(entry), zstream_open(false), peeked_data(0)
+: iodevice(iodevice), file_entry(entry), data_offset(0), zstream_open(false), peeked_data(0)
 {
 	init();
 }
@@ -65,6 +65,19 @@ int ZipIODevice_FileEntry::get_position() const
 	return (int) pos;
 }
 
+MappedSpan ZipIODevice_FileEntry::get_mapped_span() const
+{
+	// Stored entries can be exposed directly from a memory mapped archive
+	if (file_header.compression_method != zip_compress_store)
+		return MappedSpan();
+
+	MappedSpan archive_span = iodevice.get_mapped_span();
+	if (archive_span.is_null() || data_offset + file_header.uncompressed_size > archive_span.get_size())
+		return MappedSpan();
+
+	return MappedSpan(archive_span.get_data() + data_offset, (int)file_header.uncompressed_size);
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // ZipIODevice_FileEntry operations:
 
@@ -77,12 +90,12 @@ int ZipIODevice_FileEntry::receive(void *buffer, int size, bool receive_all)
 {
 	if (size == 0)
 		return 0;
-	if (peeked_data.get_size() > 0)
+	if (peeked.get_size() > 0)
 	{
-		int peek_amount = min(size, peeked_data.get_size());
-		memcpy(buffer, peeked_data.get_data(), peek_amount);
-		memmove(peeked_data.get_data(), peeked_data.get_data()+peek_amount, peeked_data.get_size()-peek_amount);
-		peeked_data.set_size(peeked_data.get_size()-peek_amount);
+		// Consume from the front of the peeked window without moving the remaining data
+		int peek_amount = min(size, (int)peeked.get_size());
+		memcpy(buffer, peeked.get_data(), peek_amount);
+		peeked = DataBufferSlice(peeked, peek_amount, peeked.get_size()-peek_amount);
 		if (peek_amount <= size)
 			return peek_amount + receive((char*) buffer+peek_amount, size-peek_amount, receive_all);
 	}
@@ -92,25 +105,30 @@ int ZipIODevice_FileEntry::receive(void *buffer, int size, bool receive_all)
 
 int ZipIODevice_FileEntry::peek(void *data, int len)
 {
-	if (peeked_data.get_size() >= len)
+	if (peeked.get_size() >= (unsigned int)len)
 	{
-		memcpy(data, peeked_data.get_data(), len);
+		memcpy(data, peeked.get_data(), len);
 		return len;
 	}
 	else
 	{
-		int old_size = peeked_data.get_size();
+		// Move the unread part of the window to the start of the storage before reading more
+		int old_size = peeked.get_size();
+		if (peeked.get_position() > 0)
+			memmove(peeked_data.get_data(), peeked.get_data(), old_size);
 		try
 		{
 			peeked_data.set_size(len);
 			int bytes_read = lowlevel_read(peeked_data.get_data()+old_size, len-old_size, false);
 			peeked_data.set_size(old_size+bytes_read);
+			peeked = DataBufferSlice(peeked_data);
 			memcpy(data, peeked_data.get_data(), peeked_data.get_size());
 			return peeked_data.get_size();
 		}
 		catch (const Exception& e)
 		{
 			peeked_data.set_size(old_size);
+			peeked = DataBufferSlice(peeked_data);
 			throw;
 		}
 	}
@@ -184,6 +202,7 @@ void ZipIODevice_FileEntry::init()
 {
 	iodevice.seek(file_entry.impl->record.relative_offset_of_local_header, IODevice::seek_set);
 	file_header.load(iodevice);
+	data_offset = iodevice.get_position();
 
 	//This fix allows OS X created .zips to be opened - SAR
 	if (file_header.general_purpose_bit_flag  & ZIP_CRC32_IN_FILE_DESCRIPTOR) //if this bit is set, it means the local header data for sizes was not
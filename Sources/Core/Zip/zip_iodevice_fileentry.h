@@ -58,6 +58,8 @@ public:
 
 	virtual int get_position() const override;
 
+	virtual MappedSpan get_mapped_span() const override;
+
 
 /// \}
 /// \name Operations
@@ -94,6 +96,8 @@ private:
 
 	int64_t pos, compressed_pos;
 
+	int data_offset;
+
 	mz_stream zs;
 
 	char zbuffer[16*1024];
@@ -101,6 +105,8 @@ private:
 	bool zstream_open;
 
 	DataBuffer peeked_data;
+
+	DataBufferSlice peeked;
 /// \}
 };
 
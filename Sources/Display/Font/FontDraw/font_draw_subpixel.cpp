@@ -65,6 +65,9 @@ namespace clan
 	{
 		float offset_x = 0;
 		float offset_y = 0;
+		// Rasterize and upload missing glyphs before any of them is batched for drawing
+		glyph_cache->upload_glyphs(canvas, font_engine, text);
+
 		UTF8_Reader reader(text.data(), text.length());
 		RenderBatchTriangle *batcher = canvas.impl->batcher.get_triangle_batcher();
 
@@ -68,27 +68,20 @@ GlyphCache::~GlyphCache()
 
 Font_TextureGlyph *GlyphCache::get_glyph(Canvas &canvas, FontEngine *font_engine, unsigned int glyph)
 {
-	auto size = glyph_list.size();
-	for (int cnt=0; cnt<size; cnt++)
-	{
-		if (glyph_list[cnt]->glyph == glyph)
-			return &(*glyph_list[cnt]);
-	}
+	auto it = glyph_index.find(glyph);
+	if (it != glyph_index.end())
+		return it->second;
 
 	// If glyph does not exist, create one automatically
 	FontPixelBuffer pb = font_engine->get_font_glyph(glyph);
 	if (pb.glyph)	// Ignore invalid glyphs
 		insert_glyph(canvas, pb);
 
-	// Search for the glyph again
-	size = glyph_list.size();
-	for (int cnt=0; cnt<size; cnt++)
-	{
-		if (glyph_list[cnt]->glyph == glyph)
-			return &(*glyph_list[cnt]);
-	}
-
-	return nullptr;
+	// Remember invalid glyphs too, so they are not rasterized again on every lookup
+	Font_TextureGlyph *font_glyph = find_glyph(glyph);
+	if (!font_glyph)
+		glyph_index[glyph] = nullptr;
+	return font_glyph;
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -109,6 +102,38 @@ GlyphMetrics GlyphCache::get_metrics(FontEngine *font_engine, Canvas &canvas, un
 	return GlyphMetrics();
 }
 
+void GlyphCache::upload_glyphs(Canvas &canvas, FontEngine *font_engine, const std::string &text)
+{
+	UTF8_Reader reader(text.data(), text.length());
+	while (!reader.is_end())
+	{
+		unsigned int glyph = reader.get_char();
+		reader.next();
+		if (glyph != '\n')
+			get_glyph(canvas, font_engine, glyph);
+	}
+	upload_glyphs(canvas);
+}
+
+void GlyphCache::upload_glyphs(Canvas &canvas)
+{
+	if (staging_regions.empty())
+		return;
+
+	GraphicContext gc = canvas.get_gc();
+	for (auto &region : staging_regions)
+	{
+		if (region.dirty_rect.get_width() > 0)
+		{
+			region.texture.set_subimage(gc, region.geometry.left + region.dirty_rect.left, region.geometry.top + region.dirty_rect.top, region.pixels, region.dirty_rect);
+			region.dirty_rect = Rect();
+		}
+	}
+
+	// Only the last region can receive more glyphs
+	staging_regions.erase(staging_regions.begin(), staging_regions.end() - 1);
+}
+
 void GlyphCache::insert_glyph(Canvas &canvas, FontPixelBuffer &pb)
 {
 	auto font_glyph = std::unique_ptr<Font_TextureGlyph>(new Font_TextureGlyph());
@@ -117,8 +142,9 @@ void GlyphCache::insert_glyph(Canvas &canvas, FontPixelBuffer &pb)
 	font_glyph->offset = pb.offset;
 	font_glyph->metrics = pb.metrics;
 
-	if (!pb.empty_buffer)
+	if (!pb.empty_buffer && !stage_glyph(canvas, font_glyph.get(), pb))
 	{
+		// Too large for a staging region, upload it directly
 		PixelBuffer buffer_with_border = PixelBufferHelp::add_border(pb.buffer, glyph_border_size, pb.buffer_rect);
 		GraphicContext gc = canvas.get_gc();
 		Subtexture sub_texture = texture_group.add(gc, buffer_with_border.get_size());
@@ -128,7 +154,7 @@ void GlyphCache::insert_glyph(Canvas &canvas, FontPixelBuffer &pb)
 		sub_texture.get_texture().set_subimage(gc, sub_texture.get_geometry().left, sub_texture.get_geometry().top, buffer_with_border, buffer_with_border.get_size());
 	}
 
-	glyph_list.push_back(std::move(font_glyph));
+	add_glyph(std::move(font_glyph));
 }
 
 void GlyphCache::insert_glyph(Canvas &canvas, unsigned int glyph, Subtexture &sub_texture, const Pointf &offset, const Sizef &size, const GlyphMetrics &glyph_metrics)
@@ -146,10 +172,82 @@ void GlyphCache::insert_glyph(Canvas &canvas, unsigned int glyph, Subtexture &su
 		font_glyph->geometry = sub_texture.get_geometry();
 	}
 
-	glyph_list.push_back(std::move(font_glyph));
+	add_glyph(std::move(font_glyph));
 }
 
 /////////////////////////////////////////////////////////////////////////////
 // GlyphCache Implementation:
 
+Font_TextureGlyph *GlyphCache::find_glyph(unsigned int glyph) const
+{
+	auto it = glyph_index.find(glyph);
+	return it != glyph_index.end() ? it->second : nullptr;
+}
+
+void GlyphCache::add_glyph(std::unique_ptr<Font_TextureGlyph> font_glyph)
+{
+	// The first glyph inserted for a glyph code wins, like the linear search did
+	Font_TextureGlyph *&index_entry = glyph_index[font_glyph->glyph];
+	if (!index_entry)
+		index_entry = font_glyph.get();
+	glyph_list.push_back(std::move(font_glyph));
+}
+
+bool GlyphCache::stage_glyph(Canvas &canvas, Font_TextureGlyph *font_glyph, FontPixelBuffer &pb)
+{
+	Size size(pb.buffer_rect.get_width() + glyph_border_size * 2, pb.buffer_rect.get_height() + glyph_border_size * 2);
+	Size region_size(min(staging_region_size, texture_group.get_texture_sizes().width), min(staging_region_size, texture_group.get_texture_sizes().height));
+	if (size.width > region_size.width || size.height > region_size.height)
+		return false;
+
+	Point position;
+	if (staging_regions.empty() || !allocate(staging_regions.back(), size, position))
+	{
+		// The region is allocated from the texture group, so glyphs in it never overlap anything else in the texture
+		GraphicContext gc = canvas.get_gc();
+		Subtexture sub_texture = texture_group.add(gc, region_size);
+
+		StagingRegion region;
+		region.texture = sub_texture.get_texture();
+		region.geometry = sub_texture.get_geometry();
+		region.pixels = PixelBuffer(region_size.width, region_size.height, tf_rgba8);
+		memset(region.pixels.get_data(), 0, region.pixels.get_data_size());
+		staging_regions.push_back(region);
+		allocate(staging_regions.back(), size, position);
+	}
+
+	// The region is cleared to transparent, so copying the glyph inside its border is enough
+	StagingRegion &region = staging_regions.back();
+	region.pixels.set_subimage(pb.buffer, Point(position.x + glyph_border_size, position.y + glyph_border_size), pb.buffer_rect);
+
+	Rect glyph_rect(position, size);
+	if (region.dirty_rect.get_width() == 0)
+		region.dirty_rect = glyph_rect;
+	else
+		region.dirty_rect.bounding_rect(glyph_rect);
+
+	font_glyph->texture = region.texture;
+	font_glyph->geometry = Rect(region.geometry.left + position.x + glyph_border_size, region.geometry.top + position.y + glyph_border_size, pb.buffer_rect.get_size());
+	font_glyph->size = pb.size;
+	return true;
+}
+
+bool GlyphCache::allocate(StagingRegion &region, const Size &size, Point &out_position)
+{
+	// Shelf packing: glyphs are placed left to right, starting a new shelf below when a row is full
+	if (region.cursor_x + size.width > region.geometry.get_width())
+	{
+		region.cursor_x = 0;
+		region.cursor_y += region.shelf_height;
+		region.shelf_height = 0;
+	}
+	if (region.cursor_y + size.height > region.geometry.get_height())
+		return false;
+
+	out_position = Point(region.cursor_x, region.cursor_y);
+	region.cursor_x += size.width;
+	region.shelf_height = max(region.shelf_height, size.height);
+	return true;
+}
+
 }
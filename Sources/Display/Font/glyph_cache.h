@@ -35,8 +35,10 @@
 #include "API/Display/2D/texture_group.h"
 #include "API/Display/2D/subtexture.h"
 #include "API/Display/Render/texture_2d.h"
+#include "API/Display/Image/pixel_buffer.h"
 #include <list>
 #include <map>
+#include <unordered_map>
 
 namespace clan
 {
@@ -94,6 +96,8 @@ public:
 
 public:
 	/// \brief Get a glyph. Returns NULL if the glyph was not found
+	///
+	/// Newly rasterized glyphs are staged in CPU memory. Call upload_glyphs before drawing them.
 	Font_TextureGlyph *get_glyph(Canvas &canvas, FontEngine *font_engine, unsigned int glyph);
 
 /// \}
@@ -107,16 +111,47 @@ public:
 
 	void set_texture_group(TextureGroup &new_texture_group);
 
+	/// \brief Rasterizes the glyphs in text missing from the cache and uploads all staged glyphs
+	///
+	/// Each staging region is uploaded with a single set_subimage call, no matter how many glyphs were added to it.
+	void upload_glyphs(Canvas &canvas, FontEngine *font_engine, const std::string &text);
+
+	/// \brief Uploads glyphs staged since the last upload
+	void upload_glyphs(Canvas &canvas);
+
 /// \}
 /// \name Implementation
 /// \{
 private:
+	/// \brief Part of a texture group texture that glyphs are packed into before being uploaded
+	struct StagingRegion
+	{
+		StagingRegion() : cursor_x(0), cursor_y(0), shelf_height(0) { }
+
+		Texture2D texture;
+		Rect geometry;
+		PixelBuffer pixels;
+		int cursor_x, cursor_y, shelf_height;
+		Rect dirty_rect;
+	};
+
+	Font_TextureGlyph *find_glyph(unsigned int glyph) const;
+	void add_glyph(std::unique_ptr<Font_TextureGlyph> font_glyph);
+	bool stage_glyph(Canvas &canvas, Font_TextureGlyph *font_glyph, FontPixelBuffer &pb);
+	static bool allocate(StagingRegion &region, const Size &size, Point &out_position);
 
 	std::vector<std::unique_ptr<Font_TextureGlyph>> glyph_list;
 
+	/// \brief Glyphs in glyph_list by glyph code. Glyphs the font engine failed to create map to null.
+	std::unordered_map<unsigned int, Font_TextureGlyph *> glyph_index;
+
+	/// \brief Regions with staged glyphs. The last one receives new glyphs.
+	std::vector<StagingRegion> staging_regions;
+
 	TextureGroup texture_group;
 
 	static const int glyph_border_size = 1;
+	static const int staging_region_size = 256;
 
 /// \}
 };
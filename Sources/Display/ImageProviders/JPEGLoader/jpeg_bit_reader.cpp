@@ -29,55 +29,59 @@
 #include "Display/precomp.h"
 #include "jpeg_bit_reader.h"
 #include "jpeg_file_reader.h"
+#include "API/Core/Math/cl_math.h"
 
 namespace clan
 {
 
 JPEGBitReader::JPEGBitReader(JPEGFileReader *reader)
-: reader(reader), length(0), pos(0), bitpos(0)
+: reader(reader), data(nullptr), length(0), pos(0), bits(0), bit_count(0), padding_bits(0)
 {
 	buffer.resize(16*1024);
+	data = &buffer[0];
+}
+
+JPEGBitReader::JPEGBitReader(const unsigned char *data, int length)
+: reader(nullptr), data(data), length(length), pos(0), bits(0), bit_count(0), padding_bits(0)
+{
 }
 
 void JPEGBitReader::reset()
 {
-	length = 0;
+	if (reader)
+		length = 0;
 	pos = 0;
-	bitpos = 0;
-	buffer.resize(16*1024);
+	bits = 0;
+	bit_count = 0;
+	padding_bits = 0;
 }
 
-unsigned int JPEGBitReader::get_bit()
+void JPEGBitReader::fill()
 {
-	if (bitpos == 8)
-	{
-		pos++;
-		bitpos = 0;
-	}
-	if (pos == length)
+	while (bit_count <= 56)
 	{
-		length = reader->read_entropy_data(&buffer[0], buffer.size());
-		if (length == 0)
+		if (pos == length)
 		{
-			//JPEGMarker marker = reader->read_marker();
-			throw Exception("Premature end of JPEG entropy data");
+			if (reader && padding_bits == 0)
+			{
+				length = reader->read_entropy_data(&buffer[0], buffer.size());
+				pos = 0;
+			}
+			if (pos == length)
+			{
+				// End of the entropy coded segment
+				padding_bits += 64 - bit_count;
+				bit_count = 64;
+				break;
+			}
 		}
-		pos = 0;
-	}
-
-	unsigned int v = (buffer[pos] >> (7-bitpos)) & 0x01;
-	bitpos++;
-	return v;
-}
 
-unsigned int JPEGBitReader::get_bits(int count)
-{
-	int v = 0;
-	for (int i = 0; i < count; i++)
-	{
-		v = (v << 1)|get_bit();
+		int count = min((64 - bit_count) / 8, length - pos);
+		for (int i = 0; i < count; i++)
+			bits |= ((uint64_t)data[pos + i]) << (56 - bit_count - i * 8);
+		pos += count;
+		bit_count += count * 8;
 	}
-	return v;
 }
 
 }
@@ -33,21 +33,68 @@ namespace clan
 
 class JPEGFileReader;
 
+/// \brief Reads bits from JPEG entropy coded data
+///
+/// Bits are kept left aligned in a 64-bit register that is refilled a byte at a time only when
+/// fewer than 16 bits remain. Past the end of the entropy data the register is padded with zero
+/// bits, so a code near the end can be looked up, but consuming padding throws.
 class JPEGBitReader
 {
 public:
 	JPEGBitReader(JPEGFileReader *reader);
 
+	/// \brief Reads from entropy data already in memory, with byte stuffing removed
+	JPEGBitReader(const unsigned char *data, int length);
+
 	void reset();
-	unsigned int get_bit();
-	unsigned int get_bits(int count);
+
+	unsigned int get_bit()
+	{
+		if (bit_count < 1)
+			fill();
+		unsigned int v = (unsigned int)(bits >> 63);
+		skip_bits(1);
+		return v;
+	}
+
+	unsigned int get_bits(int count)
+	{
+		if (count == 0)
+			return 0;
+		if (bit_count < count)
+			fill();
+		unsigned int v = (unsigned int)(bits >> (64 - count));
+		skip_bits(count);
+		return v;
+	}
+
+	/// \brief Returns the next 16 bits without consuming them
+	unsigned int peek_bits16()
+	{
+		if (bit_count < 16)
+			fill();
+		return (unsigned int)(bits >> 48);
+	}
+
+	void skip_bits(int count)
+	{
+		if (count > bit_count - padding_bits)
+			throw Exception("Premature end of JPEG entropy data");
+		bits <<= count;
+		bit_count -= count;
+	}
 
 private:
+	void fill();
+
 	JPEGFileReader *reader;
 	std::vector<unsigned char> buffer;
+	const unsigned char *data;
 	int length;
 	int pos;
-	int bitpos;
+	uint64_t bits;
+	int bit_count;
+	int padding_bits;
 };
 
 }
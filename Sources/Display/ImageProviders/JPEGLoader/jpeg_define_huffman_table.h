@@ -31,13 +31,11 @@
 namespace clan
 {
 
-struct JPEGHuffmanNode;
-
 class JPEGHuffmanTable
 {
 public:
 	JPEGHuffmanTable() : table_class(dc_table), table_index(0) { for (auto & elem : bits) elem = 0; }
-	void build_tree();
+	void build_tables();
 
 	enum TableClass
 	{
@@ -52,53 +50,58 @@ public:
 	uint8_t bits[16];
 	std::vector<uint8_t> values;
 
-	std::vector<JPEGHuffmanNode> tree;
-};
+	// Number of bits resolved with a single lookup. Longer codes use max_code and value_offset.
+	enum { lookup_bits = 9 };
 
-typedef std::vector<JPEGHuffmanTable> JPEGDefineHuffmanTable;
+	// Indexed by the next lookup_bits bits of the stream. Holds the code length in the upper byte and
+	// the value in the lower byte, or zero when the code is longer than lookup_bits.
+	std::vector<uint16_t> lookup;
 
-struct JPEGHuffmanNode
-{
-	JPEGHuffmanNode() : leaf(false), value(0) { children[0] = 0; children[1] = 0; }
+	// Upper bound (exclusive) of the codes of each length, left aligned to 16 bits
+	uint32_t max_code[18];
 
-	bool leaf;
-	int children[2];
-	unsigned int value;
+	// Added to a code of each length to get its index in values
+	int value_offset[17];
 };
 
-inline void JPEGHuffmanTable::build_tree()
+typedef std::vector<JPEGHuffmanTable> JPEGDefineHuffmanTable;
+
+inline void JPEGHuffmanTable::build_tables()
 {
-	int num_levels;
-	for (num_levels = 16; num_levels > 0; num_levels--)
+	// Assign canonical codes as described in JPEG Annex C
+	std::vector<uint16_t> codes;
+	std::vector<uint8_t> code_lengths;
+	unsigned int code = 0;
+	for (int length = 1; length <= 16; length++)
 	{
-		if (bits[num_levels-1] != 0)
-			break;
+		value_offset[length] = (int)codes.size() - (int)code;
+		for (int i = 0; i < bits[length - 1]; i++)
+		{
+			codes.push_back(code);
+			code_lengths.push_back(length);
+			code++;
+		}
+		if (code > (1u << length))
+			throw Exception("Invalid JPEG File");
+		max_code[length] = code << (16 - length);
+		code <<= 1;
 	}
+	max_code[17] = 0xffffffff;
+
+	if (codes.size() > values.size())
+		throw Exception("Invalid JPEG File");
 
-	tree.clear();
-	tree.push_back(JPEGHuffmanNode());
-	size_t nodes = 1;
-	size_t values_index = 0;
-	for (int level = 0; level < num_levels; level++)
+	lookup.assign(1 << lookup_bits, 0);
+	for (size_t i = 0; i < codes.size(); i++)
 	{
-		size_t parents = tree.size()-nodes;
-		size_t child_nodes = nodes*2;
-		for (size_t c = 0; c < child_nodes; c++)
+		int length = code_lengths[i];
+		if (length <= lookup_bits)
 		{
-			JPEGHuffmanNode child;
-			if (c < bits[level])
-			{
-				if (values_index >= values.size())
-					throw Exception("Invalid JPEG File");
-				child.leaf = true;
-				child.value = values[values_index];
-				values_index++;
-			}
-			
-			tree[parents+c/2].children[c%2] = tree.size();
-			tree.push_back(child);
+			int shift = lookup_bits - length;
+			uint16_t entry = (length << 8) | values[i];
+			for (int j = 0; j < (1 << shift); j++)
+				lookup[(codes[i] << shift) + j] = entry;
 		}
-		nodes = child_nodes - bits[level];
 	}
 }
 
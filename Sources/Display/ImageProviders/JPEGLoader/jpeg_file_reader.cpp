@@ -245,7 +245,7 @@ JPEGDefineHuffmanTable JPEGFileReader::read_dht()
 
 		p += 17 + bindings;
 
-		table.build_tree();
+		table.build_tables();
 		tables.push_back(table);
 	}
 
@@ -368,4 +368,58 @@ int JPEGFileReader::read_entropy_data(void *d, int size)
 	return j;
 }
 
+void JPEGFileReader::read_restart_segments(std::vector<unsigned char> &data, std::vector<int> &segment_offsets)
+{
+	data.clear();
+	segment_offsets.clear();
+	segment_offsets.push_back(0);
+
+	std::vector<uint8_t> chunk(64*1024);
+	while (true)
+	{
+		int start = iodevice.get_position();
+		int len = iodevice.read(&chunk[0], chunk.size(), false);
+		if (len == 0)
+			break;
+
+		data.reserve(data.size() + len);
+		int i;
+		for (i = 0; i < len; i++)
+		{
+			if (chunk[i] != 0xff)
+			{
+				data.push_back(chunk[i]);
+			}
+			else if (i + 1 == len)
+			{
+				break; // Read the byte following FF with the next chunk
+			}
+			else if (chunk[i+1] == 0x00)
+			{
+				data.push_back(0xff);
+				i++;
+			}
+			else if (chunk[i+1] >= marker_rst0 && chunk[i+1] <= marker_rst7)
+			{
+				segment_offsets.push_back(data.size());
+				i++;
+			}
+			else if (chunk[i+1] != 0xff) // FF FF is fill before a marker
+			{
+				iodevice.seek(start + i);
+				segment_offsets.push_back(data.size());
+				return;
+			}
+		}
+
+		if (i < len)
+		{
+			if (len < (int)chunk.size())
+				break; // File ends with FF
+			iodevice.seek(start + i);
+		}
+	}
+	segment_offsets.push_back(data.size());
+}
+
 }
@@ -60,6 +60,11 @@ public:
 	std::string read_comment();
 	int read_entropy_data(void *d, int size);
 
+	/// \brief Reads the entropy data of a scan up to the first marker that is not a restart marker
+	///
+	/// Byte stuffing is removed. Restart interval i is stored in data from segment_offsets[i] to segment_offsets[i+1].
+	void read_restart_segments(std::vector<unsigned char> &data, std::vector<int> &segment_offsets);
+
 private:
 	IODevice iodevice;
 };
@@ -34,30 +34,22 @@
 namespace clan
 {
 
-unsigned int JPEGHuffmanDecoder::decode(JPEGBitReader &reader, const JPEGHuffmanTable &table)
+unsigned int JPEGHuffmanDecoder::decode_long_code(JPEGBitReader &reader, const JPEGHuffmanTable &table, unsigned int peek)
 {
-	int node = 0;
-	while (true)
+	int length = JPEGHuffmanTable::lookup_bits + 1;
+	while (peek >= table.max_code[length])
+		length++;
+
+	if (length <= 16)
 	{
-		unsigned int bit = reader.get_bit();
-		node = table.tree[node].children[bit];
-		if (node == 0 || node == table.tree.size())
-			break;
-		else if (table.tree[node].leaf)
-			return table.tree[node].value;
+		int index = (int)(peek >> (16 - length)) + table.value_offset[length];
+		if (index >= 0 && index < (int)table.values.size())
+		{
+			reader.skip_bits(length);
+			return table.values[index];
+		}
 	}
 	throw Exception("Invalid JPEG Huffman encoding");
 }
 
-short JPEGHuffmanDecoder::decode_number(JPEGBitReader &reader, int length)
-{
-	if (length == 0)
-		return 0;
-	int v = reader.get_bits(length);
-	if ((v) < (1 << ((length) - 1)))
-		return (v) + (((-1) << (length)) + 1);
-	else
-		return v;
-}
-
 }
@@ -28,17 +28,40 @@
 
 #pragma once
 
+#include "jpeg_bit_reader.h"
+#include "jpeg_define_huffman_table.h"
+
 namespace clan
 {
 
-class JPEGBitReader;
-class JPEGHuffmanTable;
-
 class JPEGHuffmanDecoder
 {
 public:
-	static unsigned int decode(JPEGBitReader &reader, const JPEGHuffmanTable &table);
-	static short decode_number(JPEGBitReader &reader, int length);
+	static unsigned int decode(JPEGBitReader &reader, const JPEGHuffmanTable &table)
+	{
+		unsigned int peek = reader.peek_bits16();
+		unsigned int entry = table.lookup[peek >> (16 - JPEGHuffmanTable::lookup_bits)];
+		if (entry != 0)
+		{
+			reader.skip_bits(entry >> 8);
+			return entry & 0xff;
+		}
+		return decode_long_code(reader, table, peek);
+	}
+
+	static short decode_number(JPEGBitReader &reader, int length)
+	{
+		if (length == 0)
+			return 0;
+		int v = reader.get_bits(length);
+		if (v < (1 << (length - 1)))
+			return v - ((1 << length) - 1);
+		else
+			return v;
+	}
+
+private:
+	static unsigned int decode_long_code(JPEGBitReader &reader, const JPEGHuffmanTable &table, unsigned int peek);
 };
 
 enum JPEGHuffmanCodes
@@ -32,30 +32,46 @@
 #include "jpeg_huffman_decoder.h"
 #include "jpeg_mcu_decoder.h"
 #include "jpeg_rgb_decoder.h"
+#include "API/Core/System/work_queue.h"
 
 namespace clan
 {
 
-PixelBuffer JPEGLoader::load(IODevice iodevice, bool srgb)
+PixelBuffer JPEGLoader::load(IODevice iodevice, bool srgb, WorkQueue *work_queue)
 {
-	JPEGLoader loader(iodevice);
-	JPEGMCUDecoder mcu_decoder(&loader);
-	JPEGRGBDecoder rgb_decoder(&loader);
+	JPEGLoader loader(iodevice, work_queue);
 
 	int image_width = loader.start_of_frame.width;
 	int image_height = loader.start_of_frame.height;
 	PixelBuffer image(image_width, image_height, srgb ? tf_srgb8_alpha8 : tf_rgba8);
+
+	if (work_queue)
+		work_queue->parallel_for(0, loader.mcu_height, [&](int begin, int end) { loader.decode_mcu_rows(begin, end, image); });
+	else
+		loader.decode_mcu_rows(0, loader.mcu_height, image);
+
+	return image;
+}
+
+void JPEGLoader::decode_mcu_rows(int begin_row, int end_row, PixelBuffer &image)
+{
+	// Each call has its own decoders so rows can be decoded on several threads
+	JPEGMCUDecoder mcu_decoder(this);
+	JPEGRGBDecoder rgb_decoder(this);
+
+	int image_width = start_of_frame.width;
+	int image_height = start_of_frame.height;
 	unsigned int *image_pixels = reinterpret_cast<unsigned int *>(image.get_data());
 
 	const unsigned int *block_pixels = rgb_decoder.get_pixels();
 	int block_width = rgb_decoder.get_width();
 	int block_height = rgb_decoder.get_height();
 
-	for (int curMcuY = 0, y = 0; curMcuY < loader.mcu_height; curMcuY++, y += block_height)
+	for (int curMcuY = begin_row, y = begin_row * block_height; curMcuY < end_row; curMcuY++, y += block_height)
 	{
-		for (int curMcuX = 0, x = 0; curMcuX < loader.mcu_width; curMcuX++, x += block_width)
+		for (int curMcuX = 0, x = 0; curMcuX < mcu_width; curMcuX++, x += block_width)
 		{
-			mcu_decoder.decode(curMcuX + curMcuY * loader.mcu_width);
+			mcu_decoder.decode(curMcuX + curMcuY * mcu_width);
 			rgb_decoder.decode(&mcu_decoder);
 
 			int w = min(block_width, image_width-x);
@@ -74,12 +90,10 @@ PixelBuffer JPEGLoader::load(IODevice iodevice, bool srgb)
 			}
 		}
 	}
-
-	return image;
 }
 
-JPEGLoader::JPEGLoader(IODevice iodevice)
-: progressive(false), scan_count(0), mcu_x(0), mcu_y(0), mcu_width(0), mcu_height(0), restart_interval(0), eobrun(0), is_jfif_jpeg(false), is_adobe_jpeg(false), adobe_app14_transform(1)
+JPEGLoader::JPEGLoader(IODevice iodevice, WorkQueue *work_queue)
+: work_queue(work_queue), progressive(false), scan_count(0), mcu_x(0), mcu_y(0), mcu_width(0), mcu_height(0), restart_interval(0), eobrun(0), is_jfif_jpeg(false), is_adobe_jpeg(false), adobe_app14_transform(1)
 {
 	JPEGFileReader reader(iodevice);
 
@@ -252,6 +266,8 @@ void JPEGLoader::process_sos(JPEGFileReader &reader)
 
 	if (progressive)
 		process_sos_progressive(start_of_scan, component_to_sof, reader);
+	else if (work_queue && restart_interval != 0)
+		process_sos_sequential_parallel(start_of_scan, component_to_sof, reader);
 	else
 		process_sos_sequential(start_of_scan, component_to_sof, reader);
 
@@ -262,7 +278,7 @@ void JPEGLoader::verify_dc_table_selector(const JPEGStartOfScan &start_of_scan)
 {
 	for (auto & elem : start_of_scan.components)
 	{
-		if (huffman_dc_tables[elem.dc_table_selector].tree.empty())
+		if (huffman_dc_tables[elem.dc_table_selector].lookup.empty())
 			throw Exception("Invalid JPEG file");
 	}
 }
@@ -271,7 +287,7 @@ void JPEGLoader::verify_ac_table_selector(const JPEGStartOfScan &start_of_scan)
 {
 	for (auto & elem : start_of_scan.components)
 	{
-		if (huffman_ac_tables[elem.ac_table_selector].tree.empty())
+		if (huffman_ac_tables[elem.ac_table_selector].lookup.empty())
 			throw Exception("Invalid JPEG file");
 	}
 }
@@ -325,46 +341,86 @@ void JPEGLoader::process_sos_sequential(JPEGStartOfScan &start_of_scan, std::vec
 		}
 		restart_counter++;
 
-		for (size_t c = 0; c < start_of_scan.components.size(); c++)
+		decode_sequential_mcu(bit_reader, start_of_scan, component_to_sof, mcu_block, last_dc_values.data());
+	}
+}
+
+void JPEGLoader::process_sos_sequential_parallel(JPEGStartOfScan &start_of_scan, std::vector<int> component_to_sof, JPEGFileReader &reader)
+{
+	verify_dc_table_selector(start_of_scan);
+	verify_ac_table_selector(start_of_scan);
+
+	// Restart intervals reset the DC predictions and start on a byte boundary, so each can be decoded on its own
+	std::vector<unsigned char> entropy_data;
+	std::vector<int> segment_offsets;
+	reader.read_restart_segments(entropy_data, segment_offsets);
+
+	int num_mcu_blocks = mcu_width*mcu_height;
+	int num_segments = (num_mcu_blocks + restart_interval - 1) / restart_interval;
+	if ((int)segment_offsets.size() - 1 < num_segments)
+		throw Exception("Restart marker missing between JPEG entropy data");
+
+	work_queue->parallel_for(0, num_segments, [&](int begin, int end)
+	{
+		std::vector<short> dc_values(start_of_frame.components.size());
+		for (int segment = begin; segment < end; segment++)
+		{
+			for (auto & elem : dc_values)
+				elem = 0;
+
+			JPEGBitReader bit_reader(entropy_data.data() + segment_offsets[segment], segment_offsets[segment + 1] - segment_offsets[segment]);
+			int mcu_end = min((segment + 1) * restart_interval, num_mcu_blocks);
+			for (int mcu_block = segment * restart_interval; mcu_block < mcu_end; mcu_block++)
+				decode_sequential_mcu(bit_reader, start_of_scan, component_to_sof, mcu_block, dc_values.data());
+		}
+	});
+
+	for (auto & elem : last_dc_values)
+		elem = 0;
+	eobrun = 0;
+}
+
+void JPEGLoader::decode_sequential_mcu(JPEGBitReader &bit_reader, const JPEGStartOfScan &start_of_scan, const std::vector<int> &component_to_sof, int mcu_block, short *dc_values)
+{
+	for (size_t c = 0; c < start_of_scan.components.size(); c++)
+	{
+		int c_sof = component_to_sof[c];
+		const JPEGHuffmanTable &dc_table = huffman_dc_tables[start_of_scan.components[c].dc_table_selector];
+		const JPEGHuffmanTable &ac_table = huffman_ac_tables[start_of_scan.components[c].ac_table_selector];
+		int scale_x = start_of_frame.components[c_sof].horz_sampling_factor;
+		int scale_y = start_of_frame.components[c_sof].vert_sampling_factor;
+		for (int i = 0; i < scale_x * scale_y; i++)
 		{
-			int c_sof = component_to_sof[c];
-			const JPEGHuffmanTable &dc_table = huffman_dc_tables[start_of_scan.components[c].dc_table_selector];
-			const JPEGHuffmanTable &ac_table = huffman_ac_tables[start_of_scan.components[c].ac_table_selector];
-			int scale_x = start_of_frame.components[c_sof].horz_sampling_factor;
-			int scale_y = start_of_frame.components[c_sof].vert_sampling_factor;
-			for (int i = 0; i < scale_x * scale_y; i++)
+			short *dct = component_dcts[c_sof].get(mcu_block*scale_x*scale_y+i);
+			for (int j = start_of_scan.start_dct_coefficient; j <= start_of_scan.end_dct_coefficient; j++)
 			{
-				short *dct = component_dcts[c_sof].get(mcu_block*scale_x*scale_y+i);
-				for (int j = start_of_scan.start_dct_coefficient; j <= start_of_scan.end_dct_coefficient; j++)
+				if (j == 0) // DCT DC coefficient
 				{
-					if (j == 0) // DCT DC coefficient
-					{
-						unsigned int code = JPEGHuffmanDecoder::decode(bit_reader, dc_table);
-						if (code != huffman_eob)
-							dct[0] = JPEGHuffmanDecoder::decode_number(bit_reader, code);
-						dct[0] <<= start_of_scan.point_transform;
+					unsigned int code = JPEGHuffmanDecoder::decode(bit_reader, dc_table);
+					if (code != huffman_eob)
+						dct[0] = JPEGHuffmanDecoder::decode_number(bit_reader, code);
+					dct[0] <<= start_of_scan.point_transform;
 
-						dct[0] += last_dc_values[c_sof];
-						last_dc_values[c_sof] = dct[0];
-					}
-					else // DCT AC coefficient
+					dct[0] += dc_values[c_sof];
+					dc_values[c_sof] = dct[0];
+				}
+				else // DCT AC coefficient
+				{
+					unsigned int code = JPEGHuffmanDecoder::decode(bit_reader, ac_table);
+					if (code != huffman_eob)
 					{
-						unsigned int code = JPEGHuffmanDecoder::decode(bit_reader, ac_table);
-						if (code != huffman_eob)
+						unsigned int zeros = (code>>4);
+						j += zeros;
+						if (j <= start_of_scan.end_dct_coefficient)
 						{
-							unsigned int zeros = (code>>4);
-							j += zeros;
-							if (j <= start_of_scan.end_dct_coefficient)
-							{
-								dct[zigzag_map[j]] = JPEGHuffmanDecoder::decode_number(bit_reader, code & 0x0f);
-								dct[zigzag_map[j]] <<= start_of_scan.point_transform;
-							}
-						}
-						else
-						{
-							break;
+							dct[zigzag_map[j]] = JPEGHuffmanDecoder::decode_number(bit_reader, code & 0x0f);
+							dct[zigzag_map[j]] <<= start_of_scan.point_transform;
 						}
 					}
+					else
+					{
+						break;
+					}
 				}
 			}
 		}
@@ -42,11 +42,16 @@ namespace clan
 {
 
 class JPEGBitReader;
+class WorkQueue;
 
 class JPEGLoader
 {
 public:
-	static PixelBuffer load(IODevice iodevice, bool srgb);
+	/// \brief Loads a JPEG image
+	///
+	/// With a work queue, baseline scans with restart intervals are entropy decoded one interval per task,
+	/// and IDCT, upsampling and color conversion run in parallel for rows of MCUs.
+	static PixelBuffer load(IODevice iodevice, bool srgb, WorkQueue *work_queue = nullptr);
 
 private:
 	enum ColorSpace
@@ -58,13 +63,17 @@ private:
 		colorspace_grayscale
 	};
 
-	JPEGLoader(IODevice iodevice);
+	JPEGLoader(IODevice iodevice, WorkQueue *work_queue);
+
+	void decode_mcu_rows(int begin_row, int end_row, PixelBuffer &image);
 
 	void process_app0(JPEGFileReader &reader);
 	void process_app14(JPEGFileReader &reader);
 	void process_dnl(JPEGFileReader &reader);
 	void process_sos(JPEGFileReader &reader);
 	void process_sos_sequential(JPEGStartOfScan &start_of_scan, std::vector<int> component_to_sof, JPEGFileReader &reader);
+	void process_sos_sequential_parallel(JPEGStartOfScan &start_of_scan, std::vector<int> component_to_sof, JPEGFileReader &reader);
+	void decode_sequential_mcu(JPEGBitReader &bit_reader, const JPEGStartOfScan &start_of_scan, const std::vector<int> &component_to_sof, int mcu_block, short *dc_values);
 	void process_sos_progressive(JPEGStartOfScan &start_of_scan, std::vector<int> component_to_sof, JPEGFileReader &reader);
 	void process_dqt(JPEGFileReader &reader);
 	void process_dht(JPEGFileReader &reader);
@@ -73,6 +82,7 @@ private:
 	void verify_ac_table_selector(const JPEGStartOfScan &start_of_scan);
 	ColorSpace get_colorspace() const;
 
+	WorkQueue *work_queue;
 	JPEGStartOfFrame start_of_frame;
 	JPEGHuffmanTable huffman_dc_tables[4];
 	JPEGHuffmanTable huffman_ac_tables[4];
@@ -68,6 +68,25 @@ PixelBuffer JPEGProvider::load(
 	return JPEGProvider::load(filename, vfs, srgb);
 }
 
+PixelBuffer JPEGProvider::load(
+	const std::string &fullname,
+	bool srgb,
+	WorkQueue &work_queue)
+{
+	std::string path = PathHelp::get_fullpath(fullname, PathHelp::path_type_file);
+	std::string filename = PathHelp::get_filename(fullname, PathHelp::path_type_file);
+	FileSystem vfs(path);
+	return JPEGLoader::load(vfs.open_file(filename), srgb, &work_queue);
+}
+
+PixelBuffer JPEGProvider::load(
+	IODevice &file,
+	bool srgb,
+	WorkQueue &work_queue)
+{
+	return JPEGLoader::load(file, srgb, &work_queue);
+}
+
 void JPEGProvider::save(
 	PixelBuffer buffer,
 	const std::string &fullname,
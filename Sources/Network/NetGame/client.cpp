@@ -30,9 +30,12 @@
 #include "API/Network/NetGame/client.h"
 #include "API/Network/NetGame/connection.h"
 #include "API/Network/NetGame/event.h"
+#include "API/Network/NetGame/reactor.h"
+#include "API/Network/NetGame/event_schema.h"
 #include "API/Network/Socket/socket_name.h"
 #include "network_event.h"
 #include "client_impl.h"
+#include "connection_impl.h"
 
 namespace clan
 {
@@ -42,6 +45,12 @@ NetGameClient::NetGameClient()
 {
 }
 
+NetGameClient::NetGameClient(const NetGameReactor &reactor)
+: impl(std::make_shared<NetGameClient_Impl>())
+{
+	impl->reactor.reset(new NetGameReactor(reactor));
+}
+
 NetGameClient::~NetGameClient()
 {
 	impl->connection.reset();
@@ -50,7 +59,18 @@ NetGameClient::~NetGameClient()
 void NetGameClient::connect(const std::string &server, const std::string &port)
 {
 	disconnect();
-	impl->connection.reset(new NetGameConnection(this, SocketName(server, port)));
+	if (impl->reactor)
+		impl->connection.reset(new NetGameConnection(this, SocketName(server, port), *impl->reactor));
+	else
+		impl->connection.reset(new NetGameConnection(this, SocketName(server, port)));
+
+	if (impl->schema)
+		impl->connection->impl->set_schema(impl->schema, true);
+}
+
+void NetGameClient::set_event_schema(const NetGameEventSchema &schema)
+{
+	impl->schema = schema.impl;
 }
 
 void NetGameClient::disconnect()
@@ -72,6 +92,14 @@ void NetGameClient::send_event(const NetGameEvent &game_event)
 		impl->connection->send_event(game_event);
 }
 
+NetGameConnectionStats NetGameClient::get_stats() const
+{
+	if (impl->connection.get() != nullptr)
+		return impl->connection->get_stats();
+	else
+		return NetGameConnectionStats();
+}
+
 Signal<void(const NetGameEvent &)> &NetGameClient::sig_event_received()
 {
 	return impl->sig_game_event_received;
@@ -30,10 +30,13 @@
 
 #include <memory>
 #include <mutex>
+#include "API/Network/NetGame/reactor.h"
 
 namespace clan
 {
 
+class NetGameEventSchema_Impl;
+
 class NetGameClient_Impl
 {
 public:
@@ -42,7 +45,9 @@ public:
 	std::recursive_mutex mutex;
 	std::vector<NetGameNetworkEvent> events;
 
+	std::unique_ptr<NetGameReactor> reactor;
 	std::unique_ptr<NetGameConnection> connection;
+	std::shared_ptr<const NetGameEventSchema_Impl> schema;
 	Signal<void(const NetGameEvent &)> sig_game_event_received;
 	Signal<void()> sig_game_connected;
 	Signal<void()> sig_game_disconnected;
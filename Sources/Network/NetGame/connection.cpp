@@ -29,6 +29,7 @@
 #include "Network/precomp.h"
 #include "API/Network/NetGame/connection.h"
 #include "API/Network/NetGame/connection_site.h"
+#include "API/Network/NetGame/reactor.h"
 #include "network_event.h"
 #include "network_data.h"
 #include "connection_impl.h"
@@ -37,20 +38,32 @@ namespace clan
 {
 
 NetGameConnection::NetGameConnection(NetGameConnectionSite *site, const TCPConnection &connection)
-: impl(new NetGameConnection_Impl)
+: impl(std::make_shared<NetGameConnection_Impl>())
 {
-	impl->start(this, site, connection);
+	impl->start(this, site, connection, std::shared_ptr<NetGameReactor_Impl>());
 }
 
 NetGameConnection::NetGameConnection(NetGameConnectionSite *site, const SocketName &socket_name)
-: impl(new NetGameConnection_Impl)
+: impl(std::make_shared<NetGameConnection_Impl>())
 {
-	impl->start(this, site, socket_name);
+	impl->start(this, site, socket_name, std::shared_ptr<NetGameReactor_Impl>());
+}
+
+NetGameConnection::NetGameConnection(NetGameConnectionSite *site, const TCPConnection &connection, const NetGameReactor &reactor)
+: impl(std::make_shared<NetGameConnection_Impl>())
+{
+	impl->start(this, site, connection, reactor.impl);
+}
+
+NetGameConnection::NetGameConnection(NetGameConnectionSite *site, const SocketName &socket_name, const NetGameReactor &reactor)
+: impl(std::make_shared<NetGameConnection_Impl>())
+{
+	impl->start(this, site, socket_name, reactor.impl);
 }
 
 NetGameConnection::~NetGameConnection()
 {
-	delete impl;
+	impl->stop();
 }
 
 void NetGameConnection::set_data(const std::string &name, void *new_data)
@@ -73,9 +86,19 @@ void NetGameConnection::disconnect()
 	impl->disconnect();
 }
 
+void NetGameConnection::set_send_budget(const NetGameSendBudget &budget)
+{
+	impl->set_send_budget(budget);
+}
+
 SocketName NetGameConnection::get_remote_name() const
 {
 	return impl->get_remote_name();
 }
 
+NetGameConnectionStats NetGameConnection::get_stats() const
+{
+	return impl->get_stats();
+}
+
 }
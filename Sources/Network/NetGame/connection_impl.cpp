@@ -31,43 +31,81 @@
 #include "API/Network/NetGame/connection.h"
 #include "API/Network/NetGame/connection_site.h"
 #include "API/Core/System/databuffer.h"
+#include "API/Core/Math/cl_math.h"
+#include "API/Core/System/system.h"
 #include "network_event.h"
 #include "network_data.h"
 #include "connection_impl.h"
+#include "reactor_impl.h"
+#include "event_schema_impl.h"
 
 namespace clan
 {
 
 NetGameConnection_Impl::NetGameConnection_Impl()
+: compact_events(false)
 {
 }
 
-void NetGameConnection_Impl::start(NetGameConnection *xbase, NetGameConnectionSite *xsite, const TCPConnection &xconnection)
+NetGameConnection_Impl::~NetGameConnection_Impl()
+{
+}
+
+void NetGameConnection_Impl::start(NetGameConnection *xbase, NetGameConnectionSite *xsite, const TCPConnection &xconnection, const std::shared_ptr<NetGameReactor_Impl> &xreactor)
 {
 	base = xbase;
 	site = xsite;
 	connection = xconnection;
 	socket_name = connection.get_remote_name();
 	is_connected = true;
-	thread = std::thread(&NetGameConnection_Impl::connection_main, this);
+	start_processing(xreactor);
 }
 
-void NetGameConnection_Impl::start(NetGameConnection *xbase, NetGameConnectionSite *xsite, const SocketName &xsocket_name)
+void NetGameConnection_Impl::start(NetGameConnection *xbase, NetGameConnectionSite *xsite, const SocketName &xsocket_name, const std::shared_ptr<NetGameReactor_Impl> &xreactor)
 {
 	base = xbase;
 	site = xsite;
 	socket_name = xsocket_name;
 	is_connected = false;
-	thread = std::thread(&NetGameConnection_Impl::connection_main, this);
+	start_processing(xreactor);
 }
 
-NetGameConnection_Impl::~NetGameConnection_Impl()
+void NetGameConnection_Impl::start_processing(const std::shared_ptr<NetGameReactor_Impl> &xreactor)
+{
+	if (xreactor && xreactor->get_thread_count() > 0)
+	{
+		reactor = xreactor;
+		reactor->add(shared_from_this());
+	}
+	else
+	{
+		worker_event.reset(new NetworkConditionVariable());
+		thread = std::thread(&NetGameConnection_Impl::connection_main, this);
+	}
+}
+
+void NetGameConnection_Impl::stop()
 {
+	// No events may reach the site once the connection object is gone
+	std::unique_lock<std::mutex> site_lock(site_mutex);
+	base = nullptr;
+	site_lock.unlock();
+
 	std::unique_lock<std::mutex> mutex_lock(mutex);
 	stop_flag = true;
 	mutex_lock.unlock();
-	worker_event.notify();
-	thread.join();
+
+	if (reactor)
+	{
+		// The I/O thread flushes and closes the socket, then releases its reference to this object
+		reactor->wake(this);
+		reactor.reset();
+	}
+	else if (thread.joinable())
+	{
+		worker_event->notify();
+		thread.join();
+	}
 }
 
 void NetGameConnection_Impl::set_data(const std::string &name, void *new_data)
@@ -98,23 +136,210 @@ void *NetGameConnection_Impl::get_data(const std::string &name) const
 
 void NetGameConnection_Impl::send_event(const NetGameEvent &game_event)
 {
-	std::unique_lock<std::mutex> mutex_lock(mutex);
 	Message message;
 	message.type = Message::type_message;
 	message.event = game_event;
-	send_queue.push_back(message);
-	mutex_lock.unlock();
-	worker_event.notify();
+	message.queue_time = System::get_microseconds();
+	if (queue_message(message))
+		wake();
 }
 
 void NetGameConnection_Impl::disconnect()
 {
-	std::unique_lock<std::mutex> mutex_lock(mutex);
 	Message message;
 	message.type = Message::type_disconnect;
+	message.queue_time = System::get_microseconds();
+	if (queue_message(message))
+		wake();
+}
+
+void NetGameConnection_Impl::send_packet(const std::vector<NetGameConnection_Impl *> &connections, const std::shared_ptr<const DataBuffer> &packet, const std::string &name)
+{
+	Message message;
+	message.type = Message::type_packet;
+	message.packet = packet;
+	message.name = name;
+	message.may_coalesce = true;
+	message.queue_time = System::get_microseconds();
+
+	std::vector<NetGameConnection_Impl *> woken_connections;
+	for (auto connection : connections)
+	{
+		if (connection->queue_message(message))
+			woken_connections.push_back(connection);
+	}
+
+	// Connections of a server share one reactor, so runs of connections are woken with a single call
+	size_t start = 0;
+	while (start < woken_connections.size())
+	{
+		NetGameReactor_Impl *reactor = woken_connections[start]->reactor.get();
+		size_t end = start + 1;
+		while (end < woken_connections.size() && woken_connections[end]->reactor.get() == reactor)
+			end++;
+
+		if (reactor)
+		{
+			reactor->wake(woken_connections.data() + start, end - start);
+		}
+		else
+		{
+			for (size_t i = start; i < end; i++)
+				woken_connections[i]->wake();
+		}
+		start = end;
+	}
+}
+
+void NetGameConnection_Impl::set_send_budget(const NetGameSendBudget &budget)
+{
+	std::unique_lock<std::mutex> mutex_lock(mutex);
+	send_budget = budget;
+	bool budget_restored = over_budget && (send_budget.high_watermark <= 0 || (int)send_queue.size() + write_batch_size <= send_budget.low_watermark);
+	if (budget_restored)
+		over_budget = false;
+	update_coalesce_index();
+	mutex_lock.unlock();
+
+	if (budget_restored)
+		add_network_event(NetGameNetworkEvent::send_budget_restored);
+}
+
+void NetGameConnection_Impl::set_schema(const std::shared_ptr<const NetGameEventSchema_Impl> &new_schema, bool send_handshake)
+{
+	std::unique_lock<std::mutex> mutex_lock(mutex);
+	schema = new_schema;
+	bool wake_needed = negotiate_schema(send_handshake);
+	mutex_lock.unlock();
+	if (wake_needed)
+		wake();
+}
+
+void NetGameConnection_Impl::schema_received(unsigned int hash)
+{
+	std::unique_lock<std::mutex> mutex_lock(mutex);
+	peer_schema_received = true;
+	peer_schema_hash = hash;
+	bool wake_needed = negotiate_schema(false);
+	mutex_lock.unlock();
+	if (wake_needed)
+		wake();
+}
+
+bool NetGameConnection_Impl::negotiate_schema(bool send_handshake)
+{
+	// Called with the mutex locked. The connecting end announces its schema and the accepting end replies with its own.
+	// A schema may arrive before the server has assigned its schema to the new connection
+	if (!schema)
+		return false;
+
+	bool wake_needed = false;
+	if (!schema_sent && (send_handshake || peer_schema_received))
+	{
+		Message message;
+		message.type = Message::type_packet;
+		message.packet = std::make_shared<DataBuffer>(NetGameNetworkData::send_schema(schema.get()));
+		message.queue_time = System::get_microseconds();
+		send_queue.push_back(message);
+		NetGameConnectionCounters::set(counters.send_queue_depth, counters.max_send_queue_depth, send_queue.size());
+		wake_needed = !wake_pending || !reactor;
+		wake_pending = true;
+		schema_sent = true;
+	}
+
+	if (peer_schema_received)
+		compact_events = (peer_schema_hash == schema->hash);
+
+	return wake_needed;
+}
+
+bool NetGameConnection_Impl::queue_message(const Message &message)
+{
+	// Returns true if the connection must be woken. An I/O thread only needs this once until it takes the queue
+	std::unique_lock<std::mutex> mutex_lock(mutex);
+	bool budget_exceeded = false;
+	if (send_budget.high_watermark > 0 && message.type != Message::type_disconnect)
+	{
+		if (!over_budget && (int)send_queue.size() + write_batch_size >= send_budget.high_watermark)
+		{
+			over_budget = true;
+			budget_exceeded = true;
+			update_coalesce_index();
+		}
+
+		if (over_budget && send_budget.policy != NetGameSendPolicy::queue)
+		{
+			// The counters are only written while holding the mutex
+			bool queued = false;
+			if (send_budget.policy == NetGameSendPolicy::drop)
+			{
+				NetGameConnectionCounters::add(counters.events_dropped, 1);
+			}
+			else
+			{
+				bool may_coalesce = message.type == Message::type_message || message.may_coalesce;
+				const std::string &name = message.type == Message::type_message ? message.event.get_name() : message.name;
+				auto it = may_coalesce ? coalesce_index.find(name) : coalesce_index.end();
+				if (it != coalesce_index.end())
+				{
+					// Replaces the older event in its place, so events of different names keep their order
+					send_queue[it->second] = message;
+					NetGameConnectionCounters::add(counters.events_coalesced, 1);
+				}
+				else
+				{
+					if (may_coalesce)
+						coalesce_index[name] = send_queue.size();
+					send_queue.push_back(message);
+					NetGameConnectionCounters::set(counters.send_queue_depth, counters.max_send_queue_depth, send_queue.size());
+					queued = true;
+				}
+			}
+
+			bool wake_needed = queued && (!wake_pending || !reactor);
+			wake_pending = wake_pending || queued;
+			mutex_lock.unlock();
+
+			if (budget_exceeded)
+				add_network_event(NetGameNetworkEvent::send_budget_exceeded);
+			return wake_needed;
+		}
+	}
+
 	send_queue.push_back(message);
+	NetGameConnectionCounters::set(counters.send_queue_depth, counters.max_send_queue_depth, send_queue.size());
+	bool wake_needed = !wake_pending || !reactor;
+	wake_pending = true;
 	mutex_lock.unlock();
-	worker_event.notify();
+
+	if (budget_exceeded)
+		add_network_event(NetGameNetworkEvent::send_budget_exceeded);
+	return wake_needed;
+}
+
+void NetGameConnection_Impl::update_coalesce_index()
+{
+	// Called with the mutex locked
+	coalesce_index.clear();
+	if (over_budget && send_budget.policy == NetGameSendPolicy::coalesce)
+	{
+		for (size_t i = 0; i < send_queue.size(); i++)
+		{
+			const Message &message = send_queue[i];
+			if (message.type == Message::type_message)
+				coalesce_index[message.event.get_name()] = i;
+			else if (message.may_coalesce)
+				coalesce_index[message.name] = i;
+		}
+	}
+}
+
+void NetGameConnection_Impl::wake()
+{
+	if (reactor)
+		reactor->wake(this);
+	else
+		worker_event->notify();
 }
 
 SocketName NetGameConnection_Impl::get_remote_name() const
@@ -122,13 +347,48 @@ SocketName NetGameConnection_Impl::get_remote_name() const
 	return socket_name;
 }
 
-bool NetGameConnection_Impl::read_connection_data(DataBuffer &receive_buffer, int &bytes_received)
+void NetGameConnection_Impl::add_network_event(NetGameNetworkEvent::Type type, const NetGameEvent &game_event)
 {
-	while (true)
+	std::unique_lock<std::mutex> site_lock(site_mutex);
+	if (base)
+		site->add_network_event(NetGameNetworkEvent(base, type, game_event));
+}
+
+NetGameConnectionStats NetGameConnection_Impl::get_stats() const
+{
+	NetGameConnectionStats stats;
+	counters.get(stats);
+	return stats;
+}
+
+bool NetGameConnection_Impl::process_io(DataBuffer &read_buffer)
+{
+	if (read_connection_data(read_buffer) || write_connection_data())
+		return true;
+
+	// The round trip time is read from the socket by the I/O thread, so get_stats() never touches the socket
+	uint64_t now = System::get_microseconds();
+	if (now - last_round_trip_sample >= round_trip_sample_interval)
+	{
+		last_round_trip_sample = now;
+		counters.round_trip_time.store(connection.get_round_trip_time(), std::memory_order_relaxed);
+	}
+	return false;
+}
+
+bool NetGameConnection_Impl::read_connection_data(DataBuffer &read_buffer)
+{
+	// Partial packets are kept in receive_buffer between calls, so idle connections only own the scratch buffer of their thread
+	int bytes_received = receive_buffer.get_size();
+	if (bytes_received > 0)
+		memcpy(read_buffer.get_data(), receive_buffer.get_data(), bytes_received);
+
+	bool exit = false;
+	while (!exit)
 	{
-		int bytes = connection.read(receive_buffer.get_data() + bytes_received, receive_buffer.get_size() - bytes_received);
+		int bytes = connection.read(read_buffer.get_data() + bytes_received, read_buffer.get_size() - bytes_received);
 		if (bytes < 0)
-			return false;
+			break;
 
 		if (bytes == 0)
 		{
@@ -137,47 +397,66 @@ bool NetGameConnection_Impl::read_connection_data(DataBuffer &receive_buffer, in
 		}
 
 		bytes_received += bytes;
+		NetGameConnectionCounters::add(counters.bytes_received, bytes);
 
 		int bytes_consumed = 0;
-		bool exit = read_data(receive_buffer.get_data(), bytes_received, bytes_consumed);
+		exit = read_data(read_buffer, bytes_received, bytes_consumed);
 
-		if (bytes_consumed >= 0)
-		{
-			memmove(receive_buffer.get_data(), receive_buffer.get_data() + bytes_consumed, bytes_received - bytes_consumed);
-			bytes_received -= bytes_consumed;
-		}
-
-		if (exit)
-			return exit;
+		memmove(read_buffer.get_data(), read_buffer.get_data() + bytes_consumed, bytes_received - bytes_consumed);
+		bytes_received -= bytes_consumed;
 	}
 
+	receive_buffer.set_size(bytes_received);
+	if (bytes_received > 0)
+		memcpy(receive_buffer.get_data(), read_buffer.get_data(), bytes_received);
+
+	return exit;
 }
 
-bool NetGameConnection_Impl::write_connection_data(DataBuffer &send_buffer, int &bytes_sent, bool &send_graceful_close)
+bool NetGameConnection_Impl::write_connection_data()
 {
+	uint64_t start_time = System::get_microseconds();
+	int bytes_written = 0;
+	bool closed = false;
 	while (true)
 	{
-		int bytes = connection.write(send_buffer.get_data() + bytes_sent, send_buffer.get_size() - bytes_sent);
-		if (bytes < 0)
-			return false;
-
-		bytes_sent += bytes;
-
-		if (bytes_sent == send_buffer.get_size())
+		if (send_buffer.get_size() == 0)
 		{
 			if (send_graceful_close)
 			{
 				connection.close();
-				return true;
+				closed = true;
+				break;
 			}
-			else
+
+			send_graceful_close = write_data(send_buffer);
+
+			// Writing zero bytes would never block, so stop here when the queue is empty
+			if (send_buffer.get_size() == 0)
 			{
-				bytes_sent = 0;
-				send_buffer.set_size(0);
-				send_graceful_close = write_data(send_buffer);
+				if (send_graceful_close)
+					continue;
+				break;
 			}
 		}
+
+		int length = 0;
+		const char *data = send_buffer.get_front(length);
+		int bytes = connection.write(data, length);
+		if (bytes < 0)
+			break;
+
+		send_buffer.consume(bytes);
+		bytes_written += bytes;
 	}
+
+	if (bytes_written > 0)
+	{
+		NetGameConnectionCounters::add(counters.bytes_sent, bytes_written);
+		counters.write_time.add(System::get_microseconds() - start_time);
+	}
+	NetGameConnectionCounters::set(counters.send_buffer_size, counters.max_send_buffer_size, send_buffer.get_size());
+	return closed;
 }
 
 void NetGameConnection_Impl::connection_main()
@@ -187,83 +466,111 @@ void NetGameConnection_Impl::connection_main()
 		if (!is_connected)
 			connection = TCPConnection(socket_name);
 		is_connected = true;
-		site->add_network_event(NetGameNetworkEvent(base, NetGameNetworkEvent::client_connected));
-
-		int bytes_received = 0;
-		int bytes_sent = 0;
-		const int max_event_packet_size = 32000 + 2;
-		DataBuffer receive_buffer(max_event_packet_size);
-		DataBuffer send_buffer;
+		add_network_event(NetGameNetworkEvent::client_connected);
 
-		bool send_graceful_close = false;
+		DataBuffer read_buffer(max_event_packet_size);
 
 		while (true)
 		{
-			if (read_connection_data(receive_buffer, bytes_received))
-				break;
-			if (write_connection_data(send_buffer, bytes_sent, send_graceful_close))
+			if (process_io(read_buffer))
 				break;
 
 			std::unique_lock<std::mutex> lock(mutex);
 			if (stop_flag)
 				break;
 			NetworkEvent *events[] = { &connection };
-			worker_event.wait(lock, 1, events);
+			worker_event->wait(lock, 1, events);
 		}
 
-		site->add_network_event(NetGameNetworkEvent(base, NetGameNetworkEvent::client_disconnected));
+		add_network_event(NetGameNetworkEvent::client_disconnected);
 	}
 	catch (const Exception& e)
 	{
-		site->add_network_event(NetGameNetworkEvent(base, NetGameNetworkEvent::client_disconnected, NetGameEvent(e.message)));
+		add_network_event(NetGameNetworkEvent::client_disconnected, NetGameEvent(e.message));
 	}
 }
 
-bool NetGameConnection_Impl::read_data(const void *data, int size, int &bytes_consumed)
+bool NetGameConnection_Impl::read_data(const DataBuffer &data, int size, int &bytes_consumed)
 {
+	std::unique_lock<std::mutex> mutex_lock(mutex);
+	std::shared_ptr<const NetGameEventSchema_Impl> current_schema = schema;
+	mutex_lock.unlock();
+
 	bytes_consumed = 0;
 	while (bytes_consumed != size)
 	{
 		int bytes = 0;
-		NetGameEvent incoming_event = NetGameNetworkData::receive_data(static_cast<const char*>(data) + bytes_consumed, size - bytes_consumed, bytes);
+		unsigned int schema_hash = 0;
+		NetGameNetworkData::DataType type = NetGameNetworkData::receive_data(DataBufferSlice(data, bytes_consumed, size - bytes_consumed), bytes, receive_event, schema_hash, current_schema.get());
 		bytes_consumed += bytes;
 
-		if (bytes == 0)
+		if (type == NetGameNetworkData::incomplete_data)
 		{
 			return false;
 		}
-		else if (incoming_event.get_name() == "_close")
+		else if (type == NetGameNetworkData::schema_data)
+		{
+			schema_received(schema_hash);
+			continue;
+		}
+		else if (receive_event.get_name() == "_close")
 		{
 			return true;
 		}
 
-		site->add_network_event(NetGameNetworkEvent(base, incoming_event));
+		NetGameConnectionCounters::add(counters.events_received, 1);
+		add_network_event(NetGameNetworkEvent::event_received, receive_event);
 	}
 	return false;
 }
 
-bool NetGameConnection_Impl::write_data(DataBuffer &buffer)
+bool NetGameConnection_Impl::write_data(NetGameSendBuffer &buffer)
 {
+	// Called when everything previously taken from the queue has been written to the socket
+	// write_queue keeps its capacity, so a busy connection does not allocate a new queue for every flush
 	std::unique_lock<std::mutex> mutex_lock(mutex);
-	std::vector<Message> new_send_queue;
-	send_queue.swap(new_send_queue);
+	bool budget_restored = false;
+	if (over_budget && (int)send_queue.size() <= send_budget.low_watermark)
+	{
+		over_budget = false;
+		budget_restored = true;
+	}
+	send_queue.swap(write_queue);
+	write_batch_size = write_queue.size();
+	coalesce_index.clear();
+	counters.send_queue_depth.store(0, std::memory_order_relaxed);
+	wake_pending = false;
+	const NetGameEventSchema_Impl *encode_schema = compact_events ? schema.get() : nullptr;
 	mutex_lock.unlock();
-	for (auto & elem : new_send_queue)
+
+	if (budget_restored)
+		add_network_event(NetGameNetworkEvent::send_budget_restored);
+
+	uint64_t now = write_queue.empty() ? 0 : System::get_microseconds();
+	bool disconnect = false;
+	for (auto & elem : write_queue)
 	{
+		counters.queue_time.add(now - elem.queue_time);
+		if (elem.type != Message::type_disconnect)
+			NetGameConnectionCounters::add(counters.events_sent, 1);
+
 		if (elem.type == Message::type_message)
 		{
-			DataBuffer packet = NetGameNetworkData::send_data(elem.event);
-
-			int pos = buffer.get_size();
-			buffer.set_size(pos + packet.get_size());
-			memcpy(buffer.get_data() + pos, packet.get_data(), packet.get_size());
+			DataBuffer packet = NetGameNetworkData::send_data(elem.event, encode_schema);
+			buffer.append(packet.get_data(), packet.get_size());
+		}
+		else if (elem.type == Message::type_packet)
+		{
+			buffer.append(elem.packet->get_data(), elem.packet->get_size());
 		}
 		else if (elem.type == Message::type_disconnect)
 		{
-			return true;
+			disconnect = true;
+			break;
 		}
 	}
-	return false;
+	write_queue.clear();
+	return disconnect;
 }
 
 }
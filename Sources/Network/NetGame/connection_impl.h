@@ -29,59 +29,149 @@
 
 #pragma once
 
+#include <atomic>
 #include <mutex>
 #include <thread>
+#include <memory>
 #include "API/Network/Socket/tcp_connection.h"
 #include "API/Network/Socket/socket_name.h"
+#include "API/Core/System/databuffer.h"
+#include "API/Network/NetGame/send_budget.h"
+#include "network_event.h"
+#include "connection_stats_impl.h"
+#include "send_buffer.h"
+#include <unordered_map>
 
 namespace clan
 {
 
-class NetGameConnection_Impl
+class NetGameReactor_Impl;
+class NetGameEventSchema_Impl;
+
+class NetGameConnection_Impl : public std::enable_shared_from_this<NetGameConnection_Impl>
 {
 public:
 	NetGameConnection_Impl();
 	~NetGameConnection_Impl();
-	void start(NetGameConnection *base, NetGameConnectionSite *site, const TCPConnection &connection);
-	void start(NetGameConnection *base, NetGameConnectionSite *site, const SocketName &socket_name);
+	void start(NetGameConnection *base, NetGameConnectionSite *site, const TCPConnection &connection, const std::shared_ptr<NetGameReactor_Impl> &reactor);
+	void start(NetGameConnection *base, NetGameConnectionSite *site, const SocketName &socket_name, const std::shared_ptr<NetGameReactor_Impl> &reactor);
+	void stop();
 	void set_data(const std::string &name, void *data);
 	void *get_data(const std::string &name) const;
 	void send_event(const NetGameEvent &game_event);
 	void disconnect();
-	SocketName get_remote_name() const;
+	void set_send_budget(const NetGameSendBudget &budget);
 
-private:
-	void connection_main();
+	/// \brief Sets the schema used for the compact encoding once the remote end has the same schema
+	///
+	/// \param send_handshake = True for the connecting end, which announces its schema first
+	void set_schema(const std::shared_ptr<const NetGameEventSchema_Impl> &schema, bool send_handshake);
 
-	bool read_connection_data(DataBuffer &receive_buffer, int &bytes_received);
-	bool write_connection_data(DataBuffer &send_buffer, int &bytes_sent, bool &send_graceful_close);
+	/// \brief Queues an already encoded event on several connections, waking each I/O thread only once
+	///
+	/// \param name = Name of the encoded event, used by the coalesce send policy
+	static void send_packet(const std::vector<NetGameConnection_Impl *> &connections, const std::shared_ptr<const DataBuffer> &packet, const std::string &name);
 
-	bool read_data(const void *data, int size, int &out_bytes_consumed);
-	bool write_data(DataBuffer &buffer);
+	SocketName get_remote_name() const;
+	NetGameConnectionStats get_stats() const;
 
-	NetGameConnection *base;
+	/// \brief Reads and writes until the socket would block. Returns true when the connection is closed
+	///
+	/// \param read_buffer = Scratch buffer of max_event_packet_size bytes owned by the calling thread
+	bool process_io(DataBuffer &read_buffer);
 
-	NetGameConnectionSite *site;
+	/// \brief Posts an event to the site, unless the connection object has been destroyed
+	void add_network_event(NetGameNetworkEvent::Type type, const NetGameEvent &game_event = NetGameEvent(std::string()));
+
+	enum { max_event_packet_size = 32000 + 2 };
+	enum { round_trip_sample_interval = 1000000 };
 
-	NetworkConditionVariable worker_event;
 	TCPConnection connection;
 	SocketName socket_name;
-	bool is_connected;
-	std::thread thread;
-	bool stop_flag = false;
+	bool is_connected = false;
+
+	// Set when the connection is processed by a reactor I/O thread instead of a thread of its own
+	std::shared_ptr<NetGameReactor_Impl> reactor;
+	int reactor_thread = -1;
+	bool is_connecting = false;
+
 	std::mutex mutex;
+	bool stop_flag = false;
+
+	// Set when both ends have the same event schema
+	std::atomic_bool compact_events;
+
+	NetGameConnectionCounters counters;
+
+private:
 	struct Message
 	{
-		Message() : type(type_message), event(std::string()) { }
+		Message() : type(type_message), event(std::string()), queue_time(0), may_coalesce(false) { }
 		enum Type
 		{
 			type_message,
+			type_packet,
 			type_disconnect
 		};
 		Type type;
 		NetGameEvent event;
+		std::shared_ptr<const DataBuffer> packet;
+
+		// Time the message was queued, in microseconds
+		uint64_t queue_time;
+
+		// Event name of packets, used together with may_coalesce by the coalesce send policy
+		std::string name;
+		bool may_coalesce;
 	};
+
+	void start_processing(const std::shared_ptr<NetGameReactor_Impl> &reactor);
+	void connection_main();
+
+	bool read_connection_data(DataBuffer &read_buffer);
+	bool write_connection_data();
+
+	bool read_data(const DataBuffer &data, int size, int &out_bytes_consumed);
+	bool write_data(NetGameSendBuffer &buffer);
+
+	bool queue_message(const Message &message);
+	void update_coalesce_index();
+	bool negotiate_schema(bool send_handshake);
+	void schema_received(unsigned int hash);
+	void wake();
+
+	std::mutex site_mutex;
+	NetGameConnection *base = nullptr;
+	NetGameConnectionSite *site = nullptr;
+
+	// Only used when the connection has a thread of its own
+	std::unique_ptr<NetworkConditionVariable> worker_event;
+	std::thread thread;
+
+	DataBuffer receive_buffer;
+	NetGameEvent receive_event = NetGameEvent(std::string());
+	NetGameSendBuffer send_buffer;
+	uint64_t last_round_trip_sample = 0;
+	bool send_graceful_close = false;
+
 	std::vector<Message> send_queue;
+	std::vector<Message> write_queue;
+	bool wake_pending = false;
+
+	NetGameSendBudget send_budget;
+	bool over_budget = false;
+
+	// Number of messages encoded into send_buffer that have not been completely written yet
+	int write_batch_size = 0;
+
+	// Index of the queued message for each event name, kept while over budget with the coalesce policy
+	std::unordered_map<std::string, size_t> coalesce_index;
+
+	std::shared_ptr<const NetGameEventSchema_Impl> schema;
+	bool schema_sent = false;
+	bool peer_schema_received = false;
+	unsigned int peer_schema_hash = 0;
+
 	struct AttachedData
 	{
 		std::string name;
@@ -0,0 +1,161 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Network/precomp.h"
+#include "API/Network/NetGame/connection_stats.h"
+#include "connection_stats_impl.h"
+
+namespace clan
+{
+
+NetGameHistogram::NetGameHistogram()
+: count(0), total(0), max(0)
+{
+	for (auto &bucket : buckets)
+		bucket = 0;
+}
+
+int NetGameHistogram::get_bucket(uint64_t value)
+{
+	int bucket = 0;
+	while (value != 0 && bucket < num_buckets - 1)
+	{
+		value >>= 1;
+		bucket++;
+	}
+	return bucket;
+}
+
+uint64_t NetGameHistogram::get_bucket_limit(int bucket)
+{
+	if (bucket <= 0)
+		return 0;
+	else if (bucket >= num_buckets - 1)
+		return ~(uint64_t)0;
+	else
+		return ((uint64_t)1 << bucket) - 1;
+}
+
+uint64_t NetGameHistogram::get_average() const
+{
+	return count != 0 ? total / count : 0;
+}
+
+uint64_t NetGameHistogram::get_percentile(double percentile) const
+{
+	if (count == 0)
+		return 0;
+
+	uint64_t samples = 0;
+	for (int i = 0; i < num_buckets; i++)
+	{
+		samples += buckets[i];
+		if (samples * 100.0 >= count * percentile)
+			return i < num_buckets - 1 ? get_bucket_limit(i) : max;
+	}
+	return max;
+}
+
+void NetGameHistogram::add(const NetGameHistogram &other)
+{
+	for (int i = 0; i < num_buckets; i++)
+		buckets[i] += other.buckets[i];
+	count += other.count;
+	total += other.total;
+	if (other.max > max)
+		max = other.max;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+NetGameConnectionStats::NetGameConnectionStats()
+: bytes_sent(0), bytes_received(0), events_sent(0), events_received(0), events_dropped(0), events_coalesced(0),
+  send_queue_depth(0), max_send_queue_depth(0), send_buffer_size(0), max_send_buffer_size(0), round_trip_time(-1)
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+NetGameAtomicHistogram::NetGameAtomicHistogram()
+: count(0), total(0), max(0)
+{
+	for (auto &bucket : buckets)
+		bucket.store(0, std::memory_order_relaxed);
+}
+
+void NetGameAtomicHistogram::add(uint64_t value)
+{
+	NetGameConnectionCounters::add(buckets[NetGameHistogram::get_bucket(value)], 1);
+	NetGameConnectionCounters::add(count, 1);
+	NetGameConnectionCounters::add(total, value);
+	if (value > max.load(std::memory_order_relaxed))
+		max.store(value, std::memory_order_relaxed);
+}
+
+void NetGameAtomicHistogram::get(NetGameHistogram &out) const
+{
+	for (int i = 0; i < NetGameHistogram::num_buckets; i++)
+		out.buckets[i] = buckets[i].load(std::memory_order_relaxed);
+	out.count = count.load(std::memory_order_relaxed);
+	out.total = total.load(std::memory_order_relaxed);
+	out.max = max.load(std::memory_order_relaxed);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+NetGameConnectionCounters::NetGameConnectionCounters()
+: bytes_sent(0), bytes_received(0), events_sent(0), events_received(0), events_dropped(0), events_coalesced(0),
+  send_queue_depth(0), max_send_queue_depth(0), send_buffer_size(0), max_send_buffer_size(0), round_trip_time(-1)
+{
+}
+
+void NetGameConnectionCounters::set(std::atomic_int &value, std::atomic_int &max_value, int new_value)
+{
+	value.store(new_value, std::memory_order_relaxed);
+	if (new_value > max_value.load(std::memory_order_relaxed))
+		max_value.store(new_value, std::memory_order_relaxed);
+}
+
+void NetGameConnectionCounters::get(NetGameConnectionStats &out) const
+{
+	out.bytes_sent = bytes_sent.load(std::memory_order_relaxed);
+	out.bytes_received = bytes_received.load(std::memory_order_relaxed);
+	out.events_sent = events_sent.load(std::memory_order_relaxed);
+	out.events_received = events_received.load(std::memory_order_relaxed);
+	out.events_dropped = events_dropped.load(std::memory_order_relaxed);
+	out.events_coalesced = events_coalesced.load(std::memory_order_relaxed);
+	out.send_queue_depth = send_queue_depth.load(std::memory_order_relaxed);
+	out.max_send_queue_depth = max_send_queue_depth.load(std::memory_order_relaxed);
+	out.send_buffer_size = send_buffer_size.load(std::memory_order_relaxed);
+	out.max_send_buffer_size = max_send_buffer_size.load(std::memory_order_relaxed);
+	out.round_trip_time = round_trip_time.load(std::memory_order_relaxed);
+	queue_time.get(out.queue_time);
+	write_time.get(out.write_time);
+}
+
+}
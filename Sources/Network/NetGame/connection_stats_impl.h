@@ -0,0 +1,84 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "API/Network/NetGame/connection_stats.h"
+#include <atomic>
+
+namespace clan
+{
+
+/// \brief Histogram that one thread adds samples to while other threads read it
+class NetGameAtomicHistogram
+{
+public:
+	NetGameAtomicHistogram();
+
+	/// \brief Adds a sample. Only one thread may add samples to a histogram
+	void add(uint64_t value);
+
+	void get(NetGameHistogram &out) const;
+
+private:
+	std::atomic<uint64_t> buckets[NetGameHistogram::num_buckets];
+	std::atomic<uint64_t> count;
+	std::atomic<uint64_t> total;
+	std::atomic<uint64_t> max;
+};
+
+/// \brief Counters of a connection, updated by its I/O thread and read by any thread
+class NetGameConnectionCounters
+{
+public:
+	NetGameConnectionCounters();
+
+	/// \brief Adds to a counter that only one thread writes to, without a locked instruction
+	static void add(std::atomic<uint64_t> &counter, uint64_t value) { counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed); }
+
+	/// \brief Sets a value and raises its maximum. Only one thread may set a value at a time
+	static void set(std::atomic_int &value, std::atomic_int &max_value, int new_value);
+
+	void get(NetGameConnectionStats &out) const;
+
+	std::atomic<uint64_t> bytes_sent;
+	std::atomic<uint64_t> bytes_received;
+	std::atomic<uint64_t> events_sent;
+	std::atomic<uint64_t> events_received;
+	std::atomic<uint64_t> events_dropped;
+	std::atomic<uint64_t> events_coalesced;
+	std::atomic_int send_queue_depth;
+	std::atomic_int max_send_queue_depth;
+	std::atomic_int send_buffer_size;
+	std::atomic_int max_send_buffer_size;
+	std::atomic_int round_trip_time;
+	NetGameAtomicHistogram queue_time;
+	NetGameAtomicHistogram write_time;
+};
+
+}
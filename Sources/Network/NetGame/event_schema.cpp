@@ -0,0 +1,91 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Network/precomp.h"
+#include "API/Network/NetGame/event_schema.h"
+#include "API/Network/NetGame/event.h"
+#include "API/Core/System/databuffer.h"
+#include "event_schema_impl.h"
+#include "network_data.h"
+
+namespace clan
+{
+
+NetGameEventSchema::NetGameEventSchema()
+: impl(std::make_shared<NetGameEventSchema_Impl>())
+{
+}
+
+int NetGameEventSchema::register_event(const std::string &name)
+{
+	int id = impl->find_event(name);
+	if (id != -1)
+		return id;
+
+	impl->names.push_back(name);
+	id = impl->names.size();
+	impl->ids[name] = id;
+
+	// FNV-1a over the names in registration order
+	for (unsigned char c : name)
+		impl->hash = (impl->hash ^ c) * 16777619u;
+	impl->hash = (impl->hash ^ 0) * 16777619u;
+
+	return id;
+}
+
+int NetGameEventSchema::find_event(const std::string &name) const
+{
+	return impl->find_event(name);
+}
+
+int NetGameEventSchema::get_event_count() const
+{
+	return impl->names.size();
+}
+
+unsigned int NetGameEventSchema::get_hash() const
+{
+	return impl->hash;
+}
+
+DataBuffer NetGameEventSchema::encode_event(const NetGameEvent &game_event) const
+{
+	return NetGameNetworkData::send_data(game_event, impl.get());
+}
+
+void NetGameEventSchema::decode_event(const DataBuffer &data, NetGameEvent &out_event) const
+{
+	int bytes_consumed = 0;
+	unsigned int schema_hash = 0;
+	NetGameNetworkData::DataType type = NetGameNetworkData::receive_data(data, bytes_consumed, out_event, schema_hash, impl.get());
+	if (type != NetGameNetworkData::event_data || bytes_consumed != (int)data.get_size())
+		throw Exception("Invalid network data");
+}
+
+}
@@ -32,28 +32,67 @@
 #include "API/Core/Text/string_help.h"
 #include "API/Core/Zip/zlib_compression.h"
 #include "network_data.h"
+#include "event_schema_impl.h"
 
 namespace clan
 {
 
-NetGameEvent NetGameNetworkData::receive_data(const void *data, int size, int &out_bytes_consumed)
+NetGameEvent NetGameNetworkData::receive_data(const DataBufferSlice &data, int &out_bytes_consumed)
 {
-	if (size >= 2)
+	NetGameEvent e = NetGameEvent(std::string());
+	unsigned int schema_hash = 0;
+	if (receive_data(data, out_bytes_consumed, e, schema_hash, nullptr) == schema_data)
+		throw Exception("Invalid network data");
+	return e;
+}
+
+NetGameNetworkData::DataType NetGameNetworkData::receive_data(const DataBufferSlice &data, int &out_bytes_consumed, NetGameEvent &out_event, unsigned int &out_schema_hash, const NetGameEventSchema_Impl *schema)
+{
+	out_bytes_consumed = 0;
+
+	int size = data.get_size();
+	if (size < 2)
+		return incomplete_data;
+
+	unsigned int header = *data.get_data<unsigned short>();
+	unsigned int payload_size = header & ~(unsigned int)compact_flag;
+	if (payload_size > packet_limit)
+		throw Exception("Incoming message too big");
+	if (size < 2 + (int)payload_size)
+		return incomplete_data;
+
+	out_bytes_consumed = 2 + payload_size;
+	const unsigned char *d = data.get_data<unsigned char>() + 2;
+
+	if ((header & compact_flag) == 0)
 	{
-		int payload_size = *static_cast<const unsigned short *>(data);
-		if (payload_size > packet_limit)
-			throw Exception("Incoming message too big");
+		decode_event(d, payload_size, out_event);
+		return event_data;
+	}
 
-		if (size >= 2 + payload_size)
-		{
-			out_bytes_consumed = 2 + payload_size;
-			DataBuffer buffer(static_cast<const char*>(data) + 2, payload_size);
-			return decode_event(buffer);
-		}
+	// Compact events start with their schema id. Id zero is the schema handshake
+	unsigned int pos = 0;
+	unsigned int id = decode_varint(d, payload_size, pos);
+	if (id == 0)
+	{
+		if (pos + 4 != payload_size)
+			throw Exception("Invalid network data");
+		out_schema_hash = *reinterpret_cast<const unsigned int*>(d + pos);
+		return schema_data;
 	}
 
-	out_bytes_consumed = 0;
-	return NetGameEvent(std::string());
+	if (schema == nullptr || id > schema->names.size())
+		throw Exception("Invalid network data");
+
+	out_event.name = schema->names[id - 1];
+	unsigned int count = 0;
+	while (pos < payload_size)
+	{
+		unsigned char type = d[pos++];
+		decode_compact_value(type, d, payload_size, pos, next_value(out_event.arguments, count));
+	}
+	out_event.arguments.resize(count);
+	return event_data;
 }
 
 DataBuffer NetGameNetworkData::send_data(const NetGameEvent &e)
@@ -64,20 +103,40 @@ DataBuffer NetGameNetworkData::send_data(const NetGameEvent &e)
 	return buffer;
 }
 
-NetGameEvent NetGameNetworkData::decode_event(const DataBuffer &data)
+DataBuffer NetGameNetworkData::send_data(const NetGameEvent &e, const NetGameEventSchema_Impl *schema)
+{
+	int id = schema ? schema->find_event(e.name) : -1;
+	if (id <= 0)
+		return send_data(e);
+
+	DataBuffer buffer = encode_compact_event(e, id);
+	if (buffer.get_size() > packet_limit + 2)
+		throw Exception("Outgoing message too big");
+	return buffer;
+}
+
+DataBuffer NetGameNetworkData::send_schema(const NetGameEventSchema_Impl *schema)
+{
+	DataBuffer data(2 + 1 + 4);
+	*data.get_data<unsigned short>() = compact_flag | 5;
+	unsigned char *d = data.get_data<unsigned char>() + 2;
+	d[0] = 0;
+	*reinterpret_cast<unsigned int*>(d + 1) = schema->hash;
+	return data;
+}
+
+void NetGameNetworkData::decode_event(const unsigned char *d, unsigned int length, NetGameEvent &e)
 {
-	const unsigned char *d = data.get_data<unsigned char>();
-	unsigned int length = data.get_size();
 	if (length < 3)
 		throw Exception("Invalid network data");
 
 	unsigned int name_length = *reinterpret_cast<const unsigned short*>(d);
 	if (length < 2 + name_length + 1)
 		throw Exception("Invalid network data");
-	std::string name = std::string(reinterpret_cast<const char*>(d + 2), name_length);
+	e.name.assign(reinterpret_cast<const char*>(d + 2), name_length);
 
-	NetGameEvent e(name);
 	unsigned int pos = 2 + name_length;
+	unsigned int count = 0;
 	while (true)
 	{
 		if (pos >= length)
@@ -85,87 +144,82 @@ NetGameEvent NetGameNetworkData::decode_event(const DataBuffer &data)
 		unsigned char type = d[pos++];
 		if (type == 0)
 			break;
-		e.add_argument(decode_value(type, d, length, pos));
+		decode_value(type, d, length, pos, next_value(e.arguments, count));
 	}
-	return e;
+	e.arguments.resize(count);
 }
 
-NetGameEventValue NetGameNetworkData::decode_value(unsigned char type, const unsigned char *d, unsigned int length, unsigned int &pos)
+void NetGameNetworkData::decode_value(unsigned char type, const unsigned char *d, unsigned int length, unsigned int &pos, NetGameEventValue &value)
 {
 	switch (type)
 	{
 	case 1: // null
-		return NetGameEventValue(NetGameEventValue::null);
+		reset_value(value, NetGameEventValue::null);
+		break;
 	case 2: // uint
-		{
-			if (pos + 4 > length)
-				throw Exception("Invalid network data");
-			unsigned int v = *reinterpret_cast<const unsigned int*>(d + pos);
-			pos += 4;
-			return NetGameEventValue(v);
-		}
+		if (pos + 4 > length)
+			throw Exception("Invalid network data");
+		reset_value(value, NetGameEventValue::uinteger).value_uint = *reinterpret_cast<const unsigned int*>(d + pos);
+		pos += 4;
+		break;
 	case 3: // int
-		{
-			if (pos + 4 > length)
-				throw Exception("Invalid network data");
-			int v = *reinterpret_cast<const int*>(d + pos);
-			pos += 4;
-			return NetGameEventValue(v);
-		}
+		if (pos + 4 > length)
+			throw Exception("Invalid network data");
+		reset_value(value, NetGameEventValue::integer).value_int = *reinterpret_cast<const int*>(d + pos);
+		pos += 4;
+		break;
 	case 4: // number
-		{
-			if (pos + 4 > length)
-				throw Exception("Invalid network data");
-			float v = *reinterpret_cast<const float*>(d + pos);
-			pos += 4;
-			return NetGameEventValue(v);
-		}
+		if (pos + 4 > length)
+			throw Exception("Invalid network data");
+		reset_value(value, NetGameEventValue::number).value_float = *reinterpret_cast<const float*>(d + pos);
+		pos += 4;
+		break;
 	case 5: // false boolean
-		return NetGameEventValue(false);
+		reset_value(value, NetGameEventValue::boolean).value_bool = false;
+		break;
 	case 6: // true boolean
-		return NetGameEventValue(true);
+		reset_value(value, NetGameEventValue::boolean).value_bool = true;
+		break;
 	case 7: // string
 		{
 			if (pos + 2 > length)
 				throw Exception("Invalid network data");
-			unsigned short name_length = *reinterpret_cast<const unsigned short*>(d + pos);
+			unsigned short string_length = *reinterpret_cast<const unsigned short*>(d + pos);
 			pos += 2;
-			if (pos + name_length > length)
+			if (pos + string_length > length)
 				throw Exception("Invalid network data");
-			std::string value(reinterpret_cast<const char*>(d + pos), name_length);
-			pos += name_length;
-			return NetGameEventValue(value);
+			reset_value(value, NetGameEventValue::string).value_string.assign(reinterpret_cast<const char*>(d + pos), string_length);
+			pos += string_length;
 		}
+		break;
 	case 8: // complex
 		{
-			NetGameEventValue value(NetGameEventValue::complex);
+			reset_value(value, NetGameEventValue::complex);
+			unsigned int count = 0;
 			while (true)
 			{
 				if (pos >= length)
 					throw Exception("Invalid network data");
-				unsigned char type = d[pos++];
-				if (type == 0)
+				unsigned char member_type = d[pos++];
+				if (member_type == 0)
 					break;
-				value.add_member(decode_value(type, d, length, pos));
+				decode_value(member_type, d, length, pos, next_value(value.value_complex, count));
 			}
-			return value;
+			value.value_complex.resize(count);
 		}
+		break;
 	case 9: // uchar
-		{
-			if (pos + 1 > length)
-				throw Exception("Invalid network data");
-			unsigned char v = *reinterpret_cast<const unsigned char*>(d + pos);
-			pos += 1;
-			return NetGameEventValue(v);
-		}
+		if (pos + 1 > length)
+			throw Exception("Invalid network data");
+		reset_value(value, NetGameEventValue::ucharacter).value_uchar = d[pos];
+		pos += 1;
+		break;
 	case 10: // char
-		{
-			if (pos + 1 > length)
-				throw Exception("Invalid network data");
-			char v = *reinterpret_cast<const char*>(d + pos);
-			pos += 1;
-			return NetGameEventValue(v);
-		}
+		if (pos + 1 > length)
+			throw Exception("Invalid network data");
+		reset_value(value, NetGameEventValue::character).value_char = *reinterpret_cast<const char*>(d + pos);
+		pos += 1;
+		break;
 	case 11: // binary
 		{
 			if (pos + 2 > length)
@@ -174,10 +228,10 @@ NetGameEventValue NetGameNetworkData::decode_value(unsigned char type, const uns
 			pos += 2;
 			if (pos + binary_length > length)
 				throw Exception("Invalid network data");
-			DataBuffer value(reinterpret_cast<const char*>(d + pos), binary_length);
+			reset_value(value, NetGameEventValue::binary).value_binary = DataBuffer(reinterpret_cast<const char*>(d + pos), binary_length);
 			pos += binary_length;
-			return NetGameEventValue(value);
 		}
+		break;
 	default:
 		throw Exception("Invalid network data");
 	}
@@ -302,4 +356,244 @@ unsigned int NetGameNetworkData::get_encoded_length(const NetGameEventValue &val
 	}
 }
 
+DataBuffer NetGameNetworkData::encode_compact_event(const NetGameEvent &e, unsigned int id)
+{
+	// No end marker is needed as the packet length tells where the arguments end
+	unsigned int length = get_varint_length(id);
+	for (const auto &argument : e.arguments)
+		length += get_compact_length(argument);
+	if (length > packet_limit)
+		throw Exception("Outgoing message too big");
+
+	DataBuffer data(length + 2);
+	*data.get_data<unsigned short>() = compact_flag | length;
+
+	unsigned char *d = data.get_data<unsigned char>() + 2;
+	d += encode_varint(d, id);
+	for (const auto &argument : e.arguments)
+		d += encode_compact_value(d, argument);
+
+	return data;
+}
+
+unsigned int NetGameNetworkData::get_compact_length(const NetGameEventValue &value)
+{
+	switch (value.type)
+	{
+	case NetGameEventValue::null:
+	case NetGameEventValue::boolean:
+		return 1;
+	case NetGameEventValue::character:
+	case NetGameEventValue::ucharacter:
+		return 2;
+	case NetGameEventValue::uinteger:
+		return 1 + get_varint_length(value.value_uint);
+	case NetGameEventValue::integer:
+		return 1 + get_varint_length(zigzag_encode(value.value_int));
+	case NetGameEventValue::number:
+		return 5;
+	case NetGameEventValue::string:
+		return 1 + get_varint_length(value.value_string.length()) + value.value_string.length();
+	case NetGameEventValue::binary:
+		return 1 + get_varint_length(value.value_binary.get_size()) + value.value_binary.get_size();
+	case NetGameEventValue::complex:
+		{
+			unsigned int l = 1 + get_varint_length(value.value_complex.size());
+			for (const auto &member : value.value_complex)
+				l += get_compact_length(member);
+			return l;
+		}
+	default:
+		throw Exception("Unknown game event value type");
+	}
+}
+
+unsigned int NetGameNetworkData::encode_compact_value(unsigned char *d, const NetGameEventValue &value)
+{
+	switch (value.type)
+	{
+	case NetGameEventValue::null:
+		*d = 1;
+		return 1;
+	case NetGameEventValue::uinteger:
+		*d = 2;
+		return 1 + encode_varint(d + 1, value.value_uint);
+	case NetGameEventValue::integer:
+		*d = 3;
+		return 1 + encode_varint(d + 1, zigzag_encode(value.value_int));
+	case NetGameEventValue::number:
+		*d = 4;
+		*reinterpret_cast<float*>(d + 1) = value.value_float;
+		return 5;
+	case NetGameEventValue::boolean:
+		*d = value.value_bool ? 6 : 5;
+		return 1;
+	case NetGameEventValue::string:
+		{
+			*d = 7;
+			unsigned int l = 1 + encode_varint(d + 1, value.value_string.length());
+			memcpy(d + l, value.value_string.data(), value.value_string.length());
+			return l + value.value_string.length();
+		}
+	case NetGameEventValue::complex:
+		{
+			*d = 8;
+			unsigned int l = 1 + encode_varint(d + 1, value.value_complex.size());
+			for (const auto &member : value.value_complex)
+				l += encode_compact_value(d + l, member);
+			return l;
+		}
+	case NetGameEventValue::ucharacter:
+		*d = 9;
+		d[1] = value.value_uchar;
+		return 2;
+	case NetGameEventValue::character:
+		*d = 10;
+		*reinterpret_cast<char*>(d + 1) = value.value_char;
+		return 2;
+	case NetGameEventValue::binary:
+		{
+			*d = 11;
+			unsigned int l = 1 + encode_varint(d + 1, value.value_binary.get_size());
+			memcpy(d + l, value.value_binary.get_data(), value.value_binary.get_size());
+			return l + value.value_binary.get_size();
+		}
+	default:
+		throw Exception("Unknown game event value type");
+	}
+}
+
+void NetGameNetworkData::decode_compact_value(unsigned char type, const unsigned char *d, unsigned int length, unsigned int &pos, NetGameEventValue &value)
+{
+	switch (type)
+	{
+	case 1: // null
+		reset_value(value, NetGameEventValue::null);
+		break;
+	case 2: // uint
+		reset_value(value, NetGameEventValue::uinteger).value_uint = decode_varint(d, length, pos);
+		break;
+	case 3: // int
+		reset_value(value, NetGameEventValue::integer).value_int = zigzag_decode(decode_varint(d, length, pos));
+		break;
+	case 4: // number
+		if (pos + 4 > length)
+			throw Exception("Invalid network data");
+		reset_value(value, NetGameEventValue::number).value_float = *reinterpret_cast<const float*>(d + pos);
+		pos += 4;
+		break;
+	case 5: // false boolean
+		reset_value(value, NetGameEventValue::boolean).value_bool = false;
+		break;
+	case 6: // true boolean
+		reset_value(value, NetGameEventValue::boolean).value_bool = true;
+		break;
+	case 7: // string
+		{
+			unsigned int string_length = decode_varint(d, length, pos);
+			if (string_length > length - pos)
+				throw Exception("Invalid network data");
+			reset_value(value, NetGameEventValue::string).value_string.assign(reinterpret_cast<const char*>(d + pos), string_length);
+			pos += string_length;
+		}
+		break;
+	case 8: // complex
+		{
+			unsigned int member_count = decode_varint(d, length, pos);
+			if (member_count > length - pos)
+				throw Exception("Invalid network data");
+			reset_value(value, NetGameEventValue::complex);
+			unsigned int count = 0;
+			for (unsigned int i = 0; i < member_count; i++)
+			{
+				if (pos >= length)
+					throw Exception("Invalid network data");
+				unsigned char member_type = d[pos++];
+				decode_compact_value(member_type, d, length, pos, next_value(value.value_complex, count));
+			}
+			value.value_complex.resize(count);
+		}
+		break;
+	case 9: // uchar
+		if (pos + 1 > length)
+			throw Exception("Invalid network data");
+		reset_value(value, NetGameEventValue::ucharacter).value_uchar = d[pos];
+		pos += 1;
+		break;
+	case 10: // char
+		if (pos + 1 > length)
+			throw Exception("Invalid network data");
+		reset_value(value, NetGameEventValue::character).value_char = *reinterpret_cast<const char*>(d + pos);
+		pos += 1;
+		break;
+	case 11: // binary
+		{
+			unsigned int binary_length = decode_varint(d, length, pos);
+			if (binary_length > length - pos)
+				throw Exception("Invalid network data");
+			reset_value(value, NetGameEventValue::binary).value_binary = DataBuffer(reinterpret_cast<const char*>(d + pos), binary_length);
+			pos += binary_length;
+		}
+		break;
+	default:
+		throw Exception("Invalid network data");
+	}
+}
+
+unsigned int NetGameNetworkData::get_varint_length(unsigned int value)
+{
+	unsigned int length = 1;
+	while (value >= 0x80)
+	{
+		value >>= 7;
+		length++;
+	}
+	return length;
+}
+
+unsigned int NetGameNetworkData::encode_varint(unsigned char *d, unsigned int value)
+{
+	unsigned int length = 0;
+	while (value >= 0x80)
+	{
+		d[length++] = (unsigned char)(value | 0x80);
+		value >>= 7;
+	}
+	d[length++] = (unsigned char)value;
+	return length;
+}
+
+unsigned int NetGameNetworkData::decode_varint(const unsigned char *d, unsigned int length, unsigned int &pos)
+{
+	unsigned int value = 0;
+	for (int shift = 0; shift < 35; shift += 7)
+	{
+		if (pos >= length)
+			throw Exception("Invalid network data");
+		unsigned char byte = d[pos++];
+		value |= (unsigned int)(byte & 0x7f) << shift;
+		if ((byte & 0x80) == 0)
+			return value;
+	}
+	throw Exception("Invalid network data");
+}
+
+NetGameEventValue &NetGameNetworkData::next_value(std::vector<NetGameEventValue> &values, unsigned int &count)
+{
+	// Values left over from the previous decode are reused to keep their string and member storage
+	if (count == values.size())
+		values.push_back(NetGameEventValue());
+	return values[count++];
+}
+
+NetGameEventValue &NetGameNetworkData::reset_value(NetGameEventValue &value, NetGameEventValue::Type type)
+{
+	value.type = type;
+	if (type != NetGameEventValue::string)
+		value.value_string.clear();
+	if (type != NetGameEventValue::complex)
+		value.value_complex.clear();
+	return value;
+}
+
 }
@@ -36,23 +36,59 @@ namespace clan
 {
 
 class DataBuffer;
+class DataBufferSlice;
+
+class NetGameEventSchema_Impl;
 
 class NetGameNetworkData
 {
 public:
-	static NetGameEvent receive_data(const void *data, int size, int &out_bytes_consumed);
+	static NetGameEvent receive_data(const DataBufferSlice &data, int &out_bytes_consumed);
 	static DataBuffer send_data(const NetGameEvent &e);
 
+	enum DataType
+	{
+		incomplete_data,
+		event_data,
+		schema_data
+	};
+
+	/// \brief Decodes the next event or schema handshake, reusing the storage of out_event
+	static DataType receive_data(const DataBufferSlice &data, int &out_bytes_consumed, NetGameEvent &out_event, unsigned int &out_schema_hash, const NetGameEventSchema_Impl *schema);
+
+	/// \brief Encodes an event with its schema id if it is registered in the schema
+	static DataBuffer send_data(const NetGameEvent &e, const NetGameEventSchema_Impl *schema);
+
+	/// \brief Encodes the handshake announcing the hash of a schema
+	static DataBuffer send_schema(const NetGameEventSchema_Impl *schema);
+
 private:
-	static NetGameEvent decode_event(const DataBuffer &data);
+	static void decode_event(const unsigned char *d, unsigned int length, NetGameEvent &out_event);
 	static DataBuffer encode_event(const NetGameEvent &e);
 
 	static unsigned int get_encoded_length(const NetGameEventValue &value);
 	static unsigned int encode_value(unsigned char *d, const NetGameEventValue &value);
 
-	static NetGameEventValue decode_value(unsigned char type, const unsigned char *d, unsigned int length, unsigned int &pos);
+	static void decode_value(unsigned char type, const unsigned char *d, unsigned int length, unsigned int &pos, NetGameEventValue &out_value);
+
+	static DataBuffer encode_compact_event(const NetGameEvent &e, unsigned int id);
+	static unsigned int get_compact_length(const NetGameEventValue &value);
+	static unsigned int encode_compact_value(unsigned char *d, const NetGameEventValue &value);
+	static void decode_compact_value(unsigned char type, const unsigned char *d, unsigned int length, unsigned int &pos, NetGameEventValue &out_value);
+
+	static unsigned int get_varint_length(unsigned int value);
+	static unsigned int encode_varint(unsigned char *d, unsigned int value);
+	static unsigned int decode_varint(const unsigned char *d, unsigned int length, unsigned int &pos);
+
+	// Maps signed integers to unsigned so that small negative numbers also get short varints
+	static unsigned int zigzag_encode(int value) { return ((unsigned int)value << 1) ^ (unsigned int)(value >> 31); }
+	static int zigzag_decode(unsigned int value) { return (int)(value >> 1) ^ -(int)(value & 1); }
+
+	static NetGameEventValue &next_value(std::vector<NetGameEventValue> &values, unsigned int &count);
+	static NetGameEventValue &reset_value(NetGameEventValue &value, NetGameEventValue::Type type);
 
-	enum { packet_limit = 32000 };
+	// Packets start with their length. Lengths never use the top bit, which instead marks the compact schema encoding
+	enum { packet_limit = 32000, compact_flag = 0x8000 };
 };
 
 }
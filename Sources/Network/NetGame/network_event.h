@@ -42,7 +42,9 @@ public:
 	{
 		client_connected,
 		event_received,
-		client_disconnected
+		client_disconnected,
+		send_budget_exceeded,
+		send_budget_restored
 	};
 
 	NetGameNetworkEvent(NetGameConnection *connection, Type type)
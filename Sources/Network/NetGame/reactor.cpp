@@ -0,0 +1,395 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "Network/precomp.h"
+#include "API/Network/NetGame/reactor.h"
+#include "API/Network/NetGame/connection.h"
+#include "API/Core/System/system.h"
+#include "API/Core/Math/cl_math.h"
+#include "Network/Socket/tcp_socket.h"
+#include "reactor_impl.h"
+#include "connection_impl.h"
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
+
+namespace clan
+{
+
+NetGameReactor::NetGameReactor(int num_threads)
+: impl(std::make_shared<NetGameReactor_Impl>(num_threads))
+{
+}
+
+int NetGameReactor::get_thread_count() const
+{
+	return impl->get_thread_count();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+#ifdef __linux__
+
+class NetGameReactor_Impl::IOThread
+{
+public:
+	IOThread() : read_buffer(NetGameConnection_Impl::max_event_packet_size)
+	{
+		epoll_handle = epoll_create1(EPOLL_CLOEXEC);
+		if (epoll_handle == -1)
+			throw Exception("Unable to create epoll handle");
+
+		wake_handle = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if (wake_handle == -1)
+		{
+			::close(epoll_handle);
+			throw Exception("Unable to create eventfd handle");
+		}
+
+		epoll_event event;
+		event.events = EPOLLIN;
+		event.data.ptr = nullptr;
+		if (epoll_ctl(epoll_handle, EPOLL_CTL_ADD, wake_handle, &event) == -1)
+		{
+			::close(wake_handle);
+			::close(epoll_handle);
+			throw Exception("Unable to add eventfd handle to epoll");
+		}
+	}
+
+	~IOThread()
+	{
+		::close(wake_handle);
+		::close(epoll_handle);
+	}
+
+	void signal()
+	{
+		uint64_t value = 1;
+		ssize_t result = ::write(wake_handle, &value, sizeof(uint64_t));
+		(void)result;
+	}
+
+	void reset_signal()
+	{
+		uint64_t value = 0;
+		ssize_t result = ::read(wake_handle, &value, sizeof(uint64_t));
+		(void)result;
+	}
+
+	int epoll_handle = -1;
+	int wake_handle = -1;
+	std::thread thread;
+
+	std::mutex mutex;
+	bool stop_flag = false;
+	std::vector<std::shared_ptr<NetGameConnection_Impl>> added_connections;
+	std::vector<NetGameConnection_Impl *> woken_connections;
+
+	// Only accessed by the I/O thread itself
+	std::unordered_map<NetGameConnection_Impl *, std::shared_ptr<NetGameConnection_Impl>> connections;
+	DataBuffer read_buffer;
+};
+
+NetGameReactor_Impl::NetGameReactor_Impl(int num_threads)
+: next_thread(0)
+{
+	if (num_threads <= 0)
+		num_threads = clan::min(System::get_num_cores(), 4);
+
+	for (int i = 0; i < num_threads; i++)
+		threads.push_back(std::unique_ptr<IOThread>(new IOThread()));
+
+	for (auto &io_thread : threads)
+		io_thread->thread = std::thread(&NetGameReactor_Impl::thread_main, this, io_thread.get());
+}
+
+NetGameReactor_Impl::~NetGameReactor_Impl()
+{
+	for (auto &io_thread : threads)
+	{
+		std::unique_lock<std::mutex> lock(io_thread->mutex);
+		io_thread->stop_flag = true;
+		lock.unlock();
+		io_thread->signal();
+	}
+
+	for (auto &io_thread : threads)
+		io_thread->thread.join();
+}
+
+void NetGameReactor_Impl::add(const std::shared_ptr<NetGameConnection_Impl> &connection)
+{
+	connection->reactor_thread = next_thread++ % threads.size();
+	IOThread *io_thread = threads[connection->reactor_thread].get();
+
+	std::unique_lock<std::mutex> lock(io_thread->mutex);
+	bool signal = io_thread->added_connections.empty() && io_thread->woken_connections.empty();
+	io_thread->added_connections.push_back(connection);
+	lock.unlock();
+
+	if (signal)
+		io_thread->signal();
+}
+
+void NetGameReactor_Impl::wake(NetGameConnection_Impl *connection)
+{
+	IOThread *io_thread = threads[connection->reactor_thread].get();
+
+	std::unique_lock<std::mutex> lock(io_thread->mutex);
+	bool signal = io_thread->added_connections.empty() && io_thread->woken_connections.empty();
+	io_thread->woken_connections.push_back(connection);
+	lock.unlock();
+
+	if (signal)
+		io_thread->signal();
+}
+
+void NetGameReactor_Impl::wake(NetGameConnection_Impl *const *connections, size_t count)
+{
+	for (size_t thread_index = 0; thread_index < threads.size(); thread_index++)
+	{
+		IOThread *io_thread = threads[thread_index].get();
+
+		std::unique_lock<std::mutex> lock(io_thread->mutex);
+		bool was_idle = io_thread->added_connections.empty() && io_thread->woken_connections.empty();
+		size_t woken_count = io_thread->woken_connections.size();
+		for (size_t i = 0; i < count; i++)
+		{
+			if (connections[i]->reactor_thread == (int)thread_index)
+				io_thread->woken_connections.push_back(connections[i]);
+		}
+		bool signal = was_idle && io_thread->woken_connections.size() != woken_count;
+		lock.unlock();
+
+		if (signal)
+			io_thread->signal();
+	}
+}
+
+void NetGameReactor_Impl::thread_main(IOThread *io_thread)
+{
+	const int max_events = 256;
+	epoll_event events[max_events];
+
+	std::vector<std::shared_ptr<NetGameConnection_Impl>> added_connections;
+	std::vector<NetGameConnection_Impl *> woken_connections;
+
+	while (true)
+	{
+		int count = epoll_wait(io_thread->epoll_handle, events, max_events, -1);
+		if (count == -1)
+		{
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+
+		bool woken = false;
+		for (int i = 0; i < count; i++)
+		{
+			NetGameConnection_Impl *connection = static_cast<NetGameConnection_Impl *>(events[i].data.ptr);
+			if (connection)
+				process_connection(io_thread, connection, events[i].events);
+			else
+				woken = true;
+		}
+
+		if (!woken)
+			continue;
+
+		// The signal must be reset before the lists are taken, or a wake posted in between could be lost
+		io_thread->reset_signal();
+
+		std::unique_lock<std::mutex> lock(io_thread->mutex);
+		if (io_thread->stop_flag)
+			break;
+		added_connections.swap(io_thread->added_connections);
+		woken_connections.swap(io_thread->woken_connections);
+		lock.unlock();
+
+		for (auto &connection : added_connections)
+			add_connection(io_thread, connection);
+		added_connections.clear();
+
+		for (auto connection : woken_connections)
+		{
+			// Connections closed by the peer may already be gone
+			if (io_thread->connections.find(connection) == io_thread->connections.end())
+				continue;
+
+			process_connection(io_thread, connection, 0);
+
+			if (io_thread->connections.find(connection) != io_thread->connections.end())
+			{
+				std::unique_lock<std::mutex> connection_lock(connection->mutex);
+				bool stopped = connection->stop_flag;
+				connection_lock.unlock();
+				if (stopped)
+					remove_connection(io_thread, connection);
+			}
+		}
+		woken_connections.clear();
+	}
+
+	for (auto &it : io_thread->connections)
+		it.second->connection.close();
+	io_thread->connections.clear();
+}
+
+void NetGameReactor_Impl::add_connection(IOThread *io_thread, const std::shared_ptr<NetGameConnection_Impl> &connection)
+{
+	try
+	{
+		if (!connection->is_connected)
+		{
+			// Connect without blocking the I/O thread. Completion is reported as the socket becoming writable
+			std::shared_ptr<TCPSocket> socket = std::make_shared<TCPSocket>();
+			connection->connection = TCPConnection(socket);
+
+			int value = 1;
+			setsockopt(socket->handle, IPPROTO_TCP, TCP_NODELAY, (const char *) &value, sizeof(int));
+
+			sockaddr_in addr;
+			connection->socket_name.to_sockaddr(AF_INET, (sockaddr *) &addr, sizeof(sockaddr_in));
+			int result = ::connect(socket->handle, (const sockaddr *) &addr, sizeof(sockaddr_in));
+			if (result == -1 && errno != EINPROGRESS)
+				throw Exception("Connect to server failed");
+
+			connection->is_connecting = (result == -1);
+			connection->is_connected = !connection->is_connecting;
+		}
+
+		epoll_event event;
+		event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+		event.data.ptr = connection.get();
+		if (epoll_ctl(io_thread->epoll_handle, EPOLL_CTL_ADD, get_socket_handle(connection->connection), &event) == -1)
+			throw Exception("Unable to add socket to epoll");
+	}
+	catch (const Exception &e)
+	{
+		connection->connection.close();
+		connection->add_network_event(NetGameNetworkEvent::client_disconnected, NetGameEvent(e.message));
+		return;
+	}
+
+	io_thread->connections[connection.get()] = connection;
+
+	// The initial EPOLLOUT edge takes care of anything queued before this point
+	if (connection->is_connected)
+		connection->add_network_event(NetGameNetworkEvent::client_connected);
+}
+
+void NetGameReactor_Impl::process_connection(IOThread *io_thread, NetGameConnection_Impl *connection, unsigned int events)
+{
+	try
+	{
+		if (connection->is_connecting)
+		{
+			if ((events & (EPOLLOUT | EPOLLERR | EPOLLHUP)) == 0)
+				return;
+
+			int error = 0;
+			socklen_t length = sizeof(int);
+			int result = getsockopt(get_socket_handle(connection->connection), SOL_SOCKET, SO_ERROR, &error, &length);
+			if (result == -1 || error != 0)
+				throw Exception("Connect to server failed");
+
+			connection->is_connecting = false;
+			connection->is_connected = true;
+			connection->add_network_event(NetGameNetworkEvent::client_connected);
+		}
+
+		if (connection->process_io(io_thread->read_buffer))
+		{
+			connection->add_network_event(NetGameNetworkEvent::client_disconnected);
+			remove_connection(io_thread, connection);
+		}
+	}
+	catch (const Exception &e)
+	{
+		connection->add_network_event(NetGameNetworkEvent::client_disconnected, NetGameEvent(e.message));
+		remove_connection(io_thread, connection);
+	}
+}
+
+void NetGameReactor_Impl::remove_connection(IOThread *io_thread, NetGameConnection_Impl *connection)
+{
+	int handle = get_socket_handle(connection->connection);
+	if (handle != -1)
+		epoll_ctl(io_thread->epoll_handle, EPOLL_CTL_DEL, handle, nullptr);
+	connection->connection.close();
+
+	// This may release the last reference to the connection
+	io_thread->connections.erase(connection);
+}
+
+int NetGameReactor_Impl::get_socket_handle(TCPConnection &connection)
+{
+	NetworkEvent &network_event = connection;
+	return static_cast<TCPSocket *>(network_event.get_socket_handle())->handle;
+}
+
+#else
+
+// Without epoll the reactor has no threads and every connection falls back to a thread of its own
+
+class NetGameReactor_Impl::IOThread
+{
+};
+
+NetGameReactor_Impl::NetGameReactor_Impl(int num_threads)
+: next_thread(0)
+{
+}
+
+NetGameReactor_Impl::~NetGameReactor_Impl()
+{
+}
+
+void NetGameReactor_Impl::add(const std::shared_ptr<NetGameConnection_Impl> &connection)
+{
+}
+
+void NetGameReactor_Impl::wake(NetGameConnection_Impl *connection)
+{
+}
+
+void NetGameReactor_Impl::wake(NetGameConnection_Impl *const *connections, size_t count)
+{
+}
+
+#endif
+
+}
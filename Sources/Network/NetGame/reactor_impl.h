@@ -0,0 +1,73 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <atomic>
+
+namespace clan
+{
+
+class NetGameConnection_Impl;
+class TCPConnection;
+
+class NetGameReactor_Impl
+{
+public:
+	NetGameReactor_Impl(int num_threads);
+	~NetGameReactor_Impl();
+
+	int get_thread_count() const { return (int)threads.size(); }
+
+	/// \brief Hands a connection over to one of the I/O threads
+	void add(const std::shared_ptr<NetGameConnection_Impl> &connection);
+
+	/// \brief Asks the I/O thread of a connection to flush its send queue, or to close it if it was stopped
+	void wake(NetGameConnection_Impl *connection);
+
+	/// \brief Wakes several connections, taking the lock of each I/O thread only once
+	void wake(NetGameConnection_Impl *const *connections, size_t count);
+
+private:
+	class IOThread;
+
+	void thread_main(IOThread *io_thread);
+	void add_connection(IOThread *io_thread, const std::shared_ptr<NetGameConnection_Impl> &connection);
+	void process_connection(IOThread *io_thread, NetGameConnection_Impl *connection, unsigned int events);
+	void remove_connection(IOThread *io_thread, NetGameConnection_Impl *connection);
+
+	static int get_socket_handle(TCPConnection &connection);
+
+	std::vector<std::unique_ptr<IOThread>> threads;
+	std::atomic_uint next_thread;
+};
+
+}
@@ -0,0 +1,108 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Network/precomp.h"
+#include "send_buffer.h"
+#include <algorithm>
+
+namespace clan
+{
+
+NetGameSendBuffer::NetGameSendBuffer()
+: size(0)
+{
+}
+
+NetGameSendBuffer::~NetGameSendBuffer()
+{
+}
+
+void NetGameSendBuffer::append(const void *data, int length)
+{
+	const char *src = static_cast<const char *>(data);
+	while (length > 0)
+	{
+		if (chunks.empty() || chunks.back()->end == chunk_size)
+		{
+			if (free_chunks.empty())
+			{
+				chunks.push_back(std::unique_ptr<Chunk>(new Chunk()));
+			}
+			else
+			{
+				chunks.push_back(std::move(free_chunks.back()));
+				free_chunks.pop_back();
+			}
+		}
+
+		Chunk *chunk = chunks.back().get();
+		int copy_length = std::min(length, chunk_size - chunk->end);
+		memcpy(chunk->data + chunk->end, src, copy_length);
+		chunk->end += copy_length;
+		src += copy_length;
+		length -= copy_length;
+		size += copy_length;
+	}
+}
+
+const char *NetGameSendBuffer::get_front(int &out_length) const
+{
+	if (chunks.empty())
+	{
+		out_length = 0;
+		return nullptr;
+	}
+
+	const Chunk *chunk = chunks.front().get();
+	out_length = chunk->end - chunk->begin;
+	return chunk->data + chunk->begin;
+}
+
+void NetGameSendBuffer::consume(int length)
+{
+	while (length > 0 && !chunks.empty())
+	{
+		Chunk *chunk = chunks.front().get();
+		int consume_length = std::min(length, chunk->end - chunk->begin);
+		chunk->begin += consume_length;
+		length -= consume_length;
+		size -= consume_length;
+
+		// The last chunk is emptied too, so the next append starts at the beginning of a chunk
+		if (chunk->begin == chunk->end)
+		{
+			chunk->begin = 0;
+			chunk->end = 0;
+			if (free_chunks.size() < max_free_chunks)
+				free_chunks.push_back(std::move(chunks.front()));
+			chunks.pop_front();
+		}
+	}
+}
+
+}
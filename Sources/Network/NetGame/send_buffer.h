@@ -0,0 +1,82 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace clan
+{
+
+/// \brief Queue of encoded bytes waiting to be written to a socket, stored in fixed size chunks
+///
+/// Appending never moves data already in the buffer. Chunks that have been written are kept for reuse,
+/// up to a small limit, so a connection does not hold on to the memory of its largest backlog.
+class NetGameSendBuffer
+{
+public:
+	NetGameSendBuffer();
+	~NetGameSendBuffer();
+
+	enum { chunk_size = 16 * 1024, max_free_chunks = 4 };
+
+	/// \brief Returns the number of bytes waiting to be written
+	int get_size() const { return size; }
+
+	/// \brief Appends bytes to the end of the buffer
+	void append(const void *data, int length);
+
+	/// \brief Returns the bytes at the front of the buffer that are stored contiguously
+	///
+	/// \param out_length = Number of bytes available at the returned pointer
+	const char *get_front(int &out_length) const;
+
+	/// \brief Removes bytes from the front of the buffer
+	void consume(int length);
+
+private:
+	NetGameSendBuffer(const NetGameSendBuffer &) = delete;
+	NetGameSendBuffer &operator=(const NetGameSendBuffer &) = delete;
+
+	struct Chunk
+	{
+		Chunk() : begin(0), end(0) { }
+
+		int begin;
+		int end;
+		char data[chunk_size];
+	};
+
+	std::deque<std::unique_ptr<Chunk>> chunks;
+	std::vector<std::unique_ptr<Chunk>> free_chunks;
+	int size;
+};
+
+}
@@ -29,8 +29,15 @@
 #include "Network/precomp.h"
 #include "API/Network/NetGame/server.h"
 #include "API/Network/NetGame/connection.h"
+#include "API/Network/NetGame/reactor.h"
+#include "API/Network/NetGame/event_schema.h"
+#include "API/Network/NetGame/connection_stats.h"
+#include "API/Core/System/system.h"
 #include "API/Network/Socket/socket_name.h"
+#include "API/Core/System/databuffer.h"
 #include "network_event.h"
+#include "network_data.h"
+#include "connection_impl.h"
 #include "server_impl.h"
 #include <algorithm>
 #include "API/Network/Socket/tcp_connection.h"
@@ -43,6 +50,12 @@ NetGameServer::NetGameServer()
 {
 }
 
+NetGameServer::NetGameServer(const NetGameReactor &reactor)
+: impl(std::make_shared<NetGameServer_Impl>())
+{
+	impl->reactor.reset(new NetGameReactor(reactor));
+}
+
 NetGameServer::~NetGameServer()
 {
 	stop();
@@ -55,17 +68,37 @@ void NetGameServer::process_events()
 
 void NetGameServer::add_network_event(const NetGameNetworkEvent &e)
 {
-	std::unique_lock<std::mutex> mutex_lock(impl->mutex);
+	std::unique_lock<std::mutex> events_lock(impl->events_mutex);
 	impl->events.push_back(e);
 }
 
 void NetGameServer::send_event(const NetGameEvent &game_event)
 {
 	std::unique_lock<std::mutex> mutex_lock(impl->mutex);
-	for (auto & elem : impl->connections)
-	{
-		elem->send_event(game_event);
-	}
+	impl->send_event(impl->connections, game_event, impl->schema);
+}
+
+void NetGameServer::send_event(const NetGameEvent &game_event, const std::vector<NetGameConnection *> &connections)
+{
+	std::unique_lock<std::mutex> mutex_lock(impl->mutex);
+	std::shared_ptr<const NetGameEventSchema_Impl> schema = impl->schema;
+	mutex_lock.unlock();
+
+	impl->send_event(connections, game_event, schema);
+}
+
+void NetGameServer::set_event_schema(const NetGameEventSchema &schema)
+{
+	std::unique_lock<std::mutex> mutex_lock(impl->mutex);
+	impl->schema = schema.impl;
+}
+
+void NetGameServer::set_send_budget(const NetGameSendBudget &budget)
+{
+	std::unique_lock<std::mutex> mutex_lock(impl->mutex);
+	impl->send_budget = budget;
+	for (auto connection : impl->connections)
+		connection->set_send_budget(budget);
 }
 
 void NetGameServer::start(const std::string &port)
@@ -74,7 +107,7 @@ void NetGameServer::start(const std::string &port)
 	std::unique_lock<std::mutex> lock(impl->mutex);
 	impl->stop_flag = false;
 	lock.unlock();
-	impl->tcp_listen.reset(new TCPListen(SocketName(port)));
+	impl->tcp_listen.reset(new TCPListen(SocketName(port), NetGameServer_Impl::listen_backlog));
 	impl->listen_thread = std::thread(&NetGameServer::listen_thread_main, this);
 }
 
@@ -84,7 +117,7 @@ void NetGameServer::start(const std::string &address, const std::string &port)
 	std::unique_lock<std::mutex> lock(impl->mutex);
 	impl->stop_flag = false;
 	lock.unlock();
-	impl->tcp_listen.reset(new TCPListen(SocketName(address, port)));
+	impl->tcp_listen.reset(new TCPListen(SocketName(address, port), NetGameServer_Impl::listen_backlog));
 	impl->listen_thread = std::thread(&NetGameServer::listen_thread_main, this);
 }
 
@@ -94,7 +127,8 @@ void NetGameServer::stop()
 	impl->stop_flag = true;
 	lock.unlock();
 	impl->worker_event.notify();
-	impl->listen_thread.join();
+	if (impl->listen_thread.joinable())
+		impl->listen_thread.join();
 	impl->tcp_listen.reset();
 
 	for (auto & elem : impl->connections)
@@ -102,6 +136,9 @@ void NetGameServer::stop()
 		delete elem;
 	}
 	impl->connections.clear();
+
+	std::unique_lock<std::mutex> events_lock(impl->events_mutex);
+	impl->events.clear();
 }
 
 void NetGameServer::listen_thread_main()
@@ -115,11 +152,22 @@ void NetGameServer::listen_thread_main()
 		NetworkEvent *events[] = { impl->tcp_listen.get() };
 		impl->worker_event.wait(lock, 1, events);
 
-		SocketName peer_endpoint;
-		TCPConnection connection = impl->tcp_listen->accept(peer_endpoint);
-		if (!connection.is_null())
+		while (true)
 		{
-			std::unique_ptr<NetGameConnection> game_connection(new NetGameConnection(this, connection));
+			SocketName peer_endpoint;
+			TCPConnection connection = impl->tcp_listen->accept(peer_endpoint);
+			if (connection.is_null())
+				break;
+
+			std::unique_ptr<NetGameConnection> game_connection;
+			if (impl->reactor)
+				game_connection.reset(new NetGameConnection(this, connection, *impl->reactor));
+			else
+				game_connection.reset(new NetGameConnection(this, connection));
+			if (impl->schema)
+				game_connection->impl->set_schema(impl->schema, false);
+			if (impl->send_budget.high_watermark > 0)
+				game_connection->set_send_budget(impl->send_budget);
 			impl->connections.push_back(game_connection.release());
 		}
 	}
@@ -140,12 +188,54 @@ Signal<void(NetGameConnection *, const NetGameEvent &)> &NetGameServer::sig_even
 	return impl->sig_game_event_received;
 }
 
+Signal<void(NetGameConnection *)> &NetGameServer::sig_client_over_budget()
+{
+	return impl->sig_game_client_over_budget;
+}
+
+Signal<void(NetGameConnection *)> &NetGameServer::sig_client_within_budget()
+{
+	return impl->sig_game_client_within_budget;
+}
+
+void NetGameServer::set_stats_interval(int milliseconds)
+{
+	impl->stats_interval = milliseconds;
+	impl->last_stats_time = System::get_time();
+}
+
+Signal<void(NetGameConnection *, const NetGameConnectionStats &)> &NetGameServer::sig_connection_stats()
+{
+	return impl->sig_game_connection_stats;
+}
+
+void NetGameServer_Impl::send_event(const std::vector<NetGameConnection *> &targets, const NetGameEvent &game_event, const std::shared_ptr<const NetGameEventSchema_Impl> &schema)
+{
+	// Each encoding is only created once, no matter how many connections use it
+	std::vector<NetGameConnection_Impl *> target_impls;
+	std::vector<NetGameConnection_Impl *> compact_target_impls;
+	target_impls.reserve(targets.size());
+	for (auto target : targets)
+	{
+		NetGameConnection_Impl *target_impl = target->impl.get();
+		if (target_impl->compact_events)
+			compact_target_impls.push_back(target_impl);
+		else
+			target_impls.push_back(target_impl);
+	}
+
+	if (!target_impls.empty())
+		NetGameConnection_Impl::send_packet(target_impls, std::make_shared<DataBuffer>(NetGameNetworkData::send_data(game_event)), game_event.get_name());
+	if (!compact_target_impls.empty())
+		NetGameConnection_Impl::send_packet(compact_target_impls, std::make_shared<DataBuffer>(NetGameNetworkData::send_data(game_event, schema.get())), game_event.get_name());
+}
+
 void NetGameServer_Impl::process()
 {
-	std::unique_lock<std::mutex> mutex_lock(mutex);
+	std::unique_lock<std::mutex> events_lock(events_mutex);
 	std::vector<NetGameNetworkEvent> new_events;
 	new_events.swap(events);
-	mutex_lock.unlock();
+	events_lock.unlock();
 
 	for (auto & new_event : new_events)
 	{
@@ -157,13 +247,19 @@ void NetGameServer_Impl::process()
 		case NetGameNetworkEvent::event_received:
 			sig_game_event_received(new_event.connection, new_event.game_event);
 			break;
+		case NetGameNetworkEvent::send_budget_exceeded:
+			sig_game_client_over_budget(new_event.connection);
+			break;
+		case NetGameNetworkEvent::send_budget_restored:
+			sig_game_client_within_budget(new_event.connection);
+			break;
 		case NetGameNetworkEvent::client_disconnected:
 			{
 				std::string reason = new_event.game_event.get_name();
 				sig_game_client_disconnected(new_event.connection, reason);
 			}
 
-			// Destroy connection object
+			// Destroy connection object. This must happen outside the lock since the connection waits for its I/O thread
 			{
 				std::unique_lock<std::mutex> mutex_lock(mutex);
 				std::vector<NetGameConnection *>::iterator connection_it;
@@ -172,6 +268,7 @@ void NetGameServer_Impl::process()
 				{
 					connections.erase( connection_it );
 				}
+				mutex_lock.unlock();
 				delete new_event.connection;
 			}
 			break;
@@ -179,6 +276,22 @@ void NetGameServer_Impl::process()
 			throw Exception("Unknown server event type");
 		}
 	}
+
+	if (stats_interval > 0 && System::get_time() - last_stats_time >= (uint64_t)stats_interval)
+		report_stats();
+}
+
+void NetGameServer_Impl::report_stats()
+{
+	last_stats_time = System::get_time();
+
+	// Connections are only destroyed by process(), so the pointers stay valid while the signal is invoked
+	std::unique_lock<std::mutex> mutex_lock(mutex);
+	std::vector<NetGameConnection *> current_connections = connections;
+	mutex_lock.unlock();
+
+	for (auto connection : current_connections)
+		sig_game_connection_stats(connection, connection->get_stats());
 }
 
 }
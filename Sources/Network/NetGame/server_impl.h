@@ -29,6 +29,7 @@
 #pragma once
 
 #include "API/Network/Socket/tcp_listen.h"
+#include "API/Network/NetGame/reactor.h"
 #include <memory>
 #include <mutex>
 #include <thread>
@@ -36,11 +37,22 @@
 namespace clan
 {
 
+class DataBuffer;
+class NetGameEventSchema_Impl;
+
 class NetGameServer_Impl
 {
 public:
 	void process();
+	void send_event(const std::vector<NetGameConnection *> &targets, const NetGameEvent &game_event, const std::shared_ptr<const NetGameEventSchema_Impl> &schema);
+	void report_stats();
+
+	// Many clients may connect at the same time. Connections that do not fit in the backlog are delayed by seconds
+	enum { listen_backlog = 4096 };
 
+	std::unique_ptr<NetGameReactor> reactor;
+	// Guarded by the mutex
+	std::shared_ptr<const NetGameEventSchema_Impl> schema;
 	std::unique_ptr<TCPListen> tcp_listen;
 	std::thread listen_thread;
 
@@ -48,11 +60,21 @@ public:
 	std::mutex mutex;
 	bool stop_flag = false;
 	std::vector<NetGameConnection *> connections;
+
+	// Connections post events while the mutex may be held by a thread sending to them
+	std::mutex events_mutex;
 	std::vector<NetGameNetworkEvent> events;
 
+	NetGameSendBudget send_budget;
+	int stats_interval = 0;
+	uint64_t last_stats_time = 0;
+
 	Signal<void(NetGameConnection *)> sig_game_client_connected;
 	Signal<void(NetGameConnection *, const std::string &)> sig_game_client_disconnected;
 	Signal<void(NetGameConnection *, const NetGameEvent &)> sig_game_event_received;
+	Signal<void(NetGameConnection *)> sig_game_client_over_budget;
+	Signal<void(NetGameConnection *)> sig_game_client_within_budget;
+	Signal<void(NetGameConnection *, const NetGameConnectionStats &)> sig_game_connection_stats;
 };
 
 }
@@ -0,0 +1,177 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Network/precomp.h"
+#include "API/Network/NetGame/udp_client.h"
+#include "API/Core/System/databuffer.h"
+#include "API/Core/System/system.h"
+#include "network_data.h"
+#include "udp_connection_impl.h"
+#include "udp_client_impl.h"
+
+namespace clan
+{
+
+NetGameUDPClient::NetGameUDPClient()
+: impl(std::make_shared<NetGameUDPClient_Impl>())
+{
+}
+
+NetGameUDPClient::~NetGameUDPClient()
+{
+	disconnect();
+}
+
+void NetGameUDPClient::connect(const std::string &server, const std::string &port)
+{
+	disconnect();
+
+	// Packets are matched against the numeric address they are received from
+	SocketName server_name = SocketName(server, port).to_ipv4();
+
+	impl->socket.reset(new NetGameUDPSocket());
+	impl->socket->simulated_packet_loss = impl->simulated_packet_loss;
+	impl->connection.reset(new NetGameUDPConnection(server_name));
+}
+
+void NetGameUDPClient::disconnect()
+{
+	if (impl->connection)
+	{
+		std::vector<DataBuffer> packets;
+		impl->connection->impl->create_disconnect_packets(System::get_microseconds(), packets);
+		impl->socket->send_packets(packets, impl->connection->impl->remote_name);
+	}
+	impl->close();
+}
+
+void NetGameUDPClient::process_events()
+{
+	impl->process();
+}
+
+void NetGameUDPClient::send_event(const NetGameEvent &game_event, NetGameReliability reliability)
+{
+	if (impl->connection)
+		impl->connection->send_event(game_event, reliability);
+}
+
+float NetGameUDPClient::get_round_trip_time() const
+{
+	if (impl->connection)
+		return impl->connection->get_round_trip_time();
+	else
+		return 0.0f;
+}
+
+void NetGameUDPClient::set_simulated_packet_loss(float probability)
+{
+	impl->simulated_packet_loss = probability;
+	if (impl->socket)
+		impl->socket->simulated_packet_loss = probability;
+}
+
+Signal<void(const NetGameEvent &)> &NetGameUDPClient::sig_event_received()
+{
+	return impl->sig_game_event_received;
+}
+
+Signal<void()> &NetGameUDPClient::sig_connected()
+{
+	return impl->sig_game_connected;
+}
+
+Signal<void()> &NetGameUDPClient::sig_disconnected()
+{
+	return impl->sig_game_disconnected;
+}
+
+void NetGameUDPClient_Impl::process()
+{
+	if (!connection)
+		return;
+
+	uint64_t current_time = System::get_microseconds();
+	NetGameUDPConnection *current_connection = connection.get();
+	NetGameUDPConnection_Impl *connection_impl = connection->impl.get();
+
+	DataBuffer packet;
+	packet.set_capacity(NetGameUDPSocket::max_datagram_size);
+	std::vector<NetGameEvent> events;
+	while (true)
+	{
+		SocketName from;
+		if (!socket->read_packet(packet, from))
+			break;
+		if (!(from == connection_impl->remote_name))
+			continue;
+
+		events.clear();
+		bool valid = false;
+		try
+		{
+			valid = connection_impl->receive_packet(packet, current_time, events);
+		}
+		catch (const Exception &)
+		{
+			// Malformed packets are dropped like any other damaged datagram
+		}
+
+		if (valid && !connected)
+		{
+			connected = true;
+			sig_game_connected();
+		}
+
+		for (const auto &e : events)
+			sig_game_event_received(e);
+
+		// A signal handler may have disconnected or reconnected the client
+		if (connection.get() != current_connection)
+			return;
+	}
+
+	std::vector<DataBuffer> packets;
+	connection_impl->create_packets(current_time, packets);
+	socket->send_packets(packets, connection_impl->remote_name);
+
+	if (connection_impl->closed)
+	{
+		close();
+		sig_game_disconnected();
+	}
+}
+
+void NetGameUDPClient_Impl::close()
+{
+	connection.reset();
+	socket.reset();
+	connected = false;
+}
+
+}
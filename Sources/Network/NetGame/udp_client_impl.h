@@ -0,0 +1,57 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "API/Network/NetGame/udp_connection.h"
+#include "API/Core/Signals/signal.h"
+#include <memory>
+
+namespace clan
+{
+
+class NetGameUDPSocket;
+
+class NetGameUDPClient_Impl
+{
+public:
+	void process();
+	void close();
+
+	std::unique_ptr<NetGameUDPSocket> socket;
+	float simulated_packet_loss = 0.0f;
+
+	std::unique_ptr<NetGameUDPConnection> connection;
+	bool connected = false;
+
+	Signal<void(const NetGameEvent &)> sig_game_event_received;
+	Signal<void()> sig_game_connected;
+	Signal<void()> sig_game_disconnected;
+};
+
+}
@@ -0,0 +1,197 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Network/precomp.h"
+#include "API/Network/NetGame/udp_connection.h"
+#include "API/Core/System/databuffer.h"
+#include "API/Core/System/system.h"
+#include "network_data.h"
+#include "udp_connection_impl.h"
+
+namespace clan
+{
+
+NetGameUDPConnection::NetGameUDPConnection(const SocketName &remote_name)
+: impl(std::make_shared<NetGameUDPConnection_Impl>(remote_name))
+{
+}
+
+NetGameUDPConnection::~NetGameUDPConnection()
+{
+}
+
+void NetGameUDPConnection::set_data(const std::string &name, void *new_data)
+{
+	impl->data[name] = new_data;
+}
+
+void *NetGameUDPConnection::get_data(const std::string &name) const
+{
+	auto it = impl->data.find(name);
+	if (it != impl->data.end())
+		return it->second;
+	else
+		return nullptr;
+}
+
+void NetGameUDPConnection::send_event(const NetGameEvent &game_event, NetGameReliability reliability)
+{
+	impl->queue.queue_event(std::make_shared<DataBuffer>(NetGameNetworkData::send_data(game_event)), reliability);
+}
+
+void NetGameUDPConnection::disconnect()
+{
+	impl->disconnect_requested = true;
+}
+
+SocketName NetGameUDPConnection::get_remote_name() const
+{
+	return impl->remote_name;
+}
+
+float NetGameUDPConnection::get_round_trip_time() const
+{
+	return impl->state.get_round_trip_time();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+NetGameUDPConnection_Impl::NetGameUDPConnection_Impl(const SocketName &remote_name)
+: remote_name(remote_name)
+{
+	last_receive_time = System::get_microseconds();
+}
+
+bool NetGameUDPConnection_Impl::receive_packet(const DataBuffer &packet, uint64_t current_time, std::vector<NetGameEvent> &out_events)
+{
+	if (closed)
+		return false;
+
+	DataBuffer payload;
+	if (!state.receive_packet(packet, payload, sequences, current_time))
+		return false;
+
+	for (int sequence : sequences)
+		queue.payload_acked(sequence);
+
+	// Packets without messages are not acked right away, or two idle ends would keep acking each other's acks
+	last_receive_time = current_time;
+	if (payload.get_size() > 0)
+		ack_pending = true;
+
+	bool disconnect = false;
+	queue.receive_payload(payload, out_events, disconnect);
+	if (disconnect)
+	{
+		closed = true;
+		close_reason = std::string();
+	}
+	return true;
+}
+
+void NetGameUDPConnection_Impl::create_packets(uint64_t current_time, std::vector<DataBuffer> &out_packets)
+{
+	if (closed)
+		return;
+
+	if (disconnect_requested)
+	{
+		create_disconnect_packets(current_time, out_packets);
+		return;
+	}
+
+	if (current_time - last_receive_time > (uint64_t)connection_timeout * 1000)
+	{
+		closed = true;
+		close_reason = "Connection timed out";
+		return;
+	}
+
+	state.find_lost_packets(current_time, sequences);
+	for (int sequence : sequences)
+		queue.payload_lost(sequence);
+
+	size_t first_packet = out_packets.size();
+	while (queue.has_outgoing())
+	{
+		DataBuffer payload = queue.create_payload(state.get_next_sequence(), max_payload_size);
+		int sequence = 0;
+		out_packets.push_back(state.create_packet(payload, sequence, current_time));
+	}
+
+	// Acks and keep alives are sent as packets without any messages
+	if (out_packets.size() == first_packet && (ack_pending || current_time - last_send_time >= (uint64_t)keepalive_interval * 1000))
+	{
+		int sequence = 0;
+		out_packets.push_back(state.create_packet(DataBuffer(), sequence, current_time));
+	}
+
+	if (out_packets.size() != first_packet)
+	{
+		last_send_time = current_time;
+		ack_pending = false;
+	}
+}
+
+void NetGameUDPConnection_Impl::create_disconnect_packets(uint64_t current_time, std::vector<DataBuffer> &out_packets)
+{
+	if (closed)
+		return;
+
+	int sequence = 0;
+	DataBuffer packet = state.create_packet(NetGameUDPQueue::create_disconnect_payload(), sequence, current_time);
+	for (int i = 0; i < disconnect_packet_copies; i++)
+		out_packets.push_back(packet);
+
+	closed = true;
+	close_reason = std::string();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void NetGameUDPSocket::send_packets(const std::vector<DataBuffer> &packets, const SocketName &to)
+{
+	for (const auto &packet : packets)
+	{
+		if (simulated_packet_loss > 0.0f && std::uniform_real_distribution<float>(0.0f, 1.0f)(random) < simulated_packet_loss)
+			continue;
+		socket.send(packet.get_data(), packet.get_size(), to);
+	}
+}
+
+bool NetGameUDPSocket::read_packet(DataBuffer &packet, SocketName &out_from)
+{
+	packet.set_size(max_datagram_size);
+	int received = socket.read(packet.get_data(), packet.get_size(), out_from);
+	if (received < 0)
+		return false;
+	packet.set_size(received);
+	return true;
+}
+
+}
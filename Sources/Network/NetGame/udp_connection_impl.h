@@ -0,0 +1,104 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "API/Network/NetGame/udp_connection.h"
+#include "API/Network/Socket/socket_name.h"
+#include "API/Network/Socket/udp_socket.h"
+#include "udp_connection_state.h"
+#include "udp_queue.h"
+#include <map>
+#include <random>
+
+namespace clan
+{
+
+class NetGameUDPConnection_Impl
+{
+public:
+	NetGameUDPConnection_Impl(const SocketName &remote_name);
+
+	/// \brief Processes a packet received from the remote end. Returns false if the packet was not valid
+	bool receive_packet(const DataBuffer &packet, uint64_t current_time, std::vector<NetGameEvent> &out_events);
+
+	/// \brief Creates the packets for the queued events, acks and keep alives
+	void create_packets(uint64_t current_time, std::vector<DataBuffer> &out_packets);
+
+	/// \brief Creates the packets telling the remote end that the connection is closed
+	void create_disconnect_packets(uint64_t current_time, std::vector<DataBuffer> &out_packets);
+
+	SocketName remote_name;
+	NetGameUDPConnectionState state;
+	NetGameUDPQueue queue;
+	std::map<std::string, void *> data;
+
+	uint64_t last_receive_time = 0;
+	uint64_t last_send_time = 0;
+	bool ack_pending = false;
+	bool disconnect_requested = false;
+
+	bool closed = false;
+	std::string close_reason;
+
+	enum
+	{
+		// Packets above the typical internet MTU risk being fragmented
+		max_packet_size = 1200,
+		max_payload_size = max_packet_size - NetGameUDPConnectionState::header_size,
+		// Times in milliseconds
+		keepalive_interval = 250,
+		connection_timeout = 10000,
+		// Disconnect packets are never resent, so a few copies are sent at once
+		disconnect_packet_copies = 3
+	};
+
+private:
+	std::vector<int> sequences;
+};
+
+/// \brief UDP socket of a server or client that can drop outgoing packets on purpose
+class NetGameUDPSocket
+{
+public:
+	NetGameUDPSocket() : simulated_packet_loss(0.0f) { }
+
+	void send_packets(const std::vector<DataBuffer> &packets, const SocketName &to);
+
+	/// \brief Reads the next packet. Returns false when no more packets are waiting
+	bool read_packet(DataBuffer &packet, SocketName &out_from);
+
+	UDPSocket socket;
+	float simulated_packet_loss;
+	std::minstd_rand random;
+
+	// Largest datagram that can be received
+	enum { max_datagram_size = 64 * 1024 };
+};
+
+}
@@ -0,0 +1,197 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Network/precomp.h"
+#include "udp_connection_state.h"
+#include "API/Core/Math/cl_math.h"
+#include <cstring>
+
+namespace clan
+{
+
+NetGameUDPConnectionState::NetGameUDPConnectionState()
+: local_sequence(0), remote_sequence(0), any_packet_received(false), next_ack(0), next_ack_bits(0), round_trip_time(0.0f)
+{
+}
+
+DataBuffer NetGameUDPConnectionState::create_packet(const DataBuffer &payload, int &out_sequence, uint64_t current_time)
+{
+	// Sequence zero is never sent as it is also what is acknowledged before anything has been received
+	local_sequence = get_next_sequence();
+
+	sequence_send_time[local_sequence] = current_time;
+
+	DataBuffer packet(header_size + payload.get_size());
+	unsigned int *data = packet.get_data<unsigned int>();
+
+	data[0] = protocol_magic;
+	data[1] = ((unsigned int)local_sequence << 16) | next_ack;
+	data[2] = next_ack_bits;
+
+	if (payload.get_size() > 0)
+		memcpy(packet.get_data() + header_size, payload.get_data(), payload.get_size());
+
+	out_sequence = local_sequence;
+	return packet;
+}
+
+bool NetGameUDPConnectionState::receive_packet(const DataBuffer &packet, DataBuffer &out_payload, std::vector<int> &out_acked_sequences, uint64_t current_time)
+{
+	out_acked_sequences.clear();
+
+	if (!is_protocol_packet(packet.get_data(), packet.get_size()))
+		return false;
+
+	const unsigned int *data = packet.get_data<const unsigned int>();
+	unsigned short sequence = data[1] >> 16;
+	unsigned short ack = data[1] & 0xffff;
+	unsigned int ack_bits = data[2];
+
+	update_received_packets_ack(sequence);
+
+	sent_packets_acknowledged(ack, ack_bits, out_acked_sequences, current_time);
+
+	out_payload = DataBuffer(packet.get_data() + header_size, packet.get_size() - header_size);
+	return true;
+}
+
+void NetGameUDPConnectionState::find_lost_packets(uint64_t current_time, std::vector<int> &out_lost_sequences)
+{
+	out_lost_sequences.clear();
+
+	float timeout = clamp(round_trip_time * 2.0f, (float)min_lost_timeout, (float)max_lost_timeout);
+	uint64_t timeout_microseconds = (uint64_t)(timeout * 1000.0f);
+
+	auto it = sequence_send_time.begin();
+	while (it != sequence_send_time.end())
+	{
+		// Packets older than the ack bitfield can never be acknowledged
+		bool outside_ack_window = sequence_delta(remote_sequence, it->first) > 32;
+		if (outside_ack_window || current_time - it->second > timeout_microseconds)
+		{
+			out_lost_sequences.push_back(it->first);
+			it = sequence_send_time.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
+
+bool NetGameUDPConnectionState::is_protocol_packet(const void *data, int size)
+{
+	if (size < (int)header_size)
+		return false;
+
+	unsigned int protocol_id;
+	memcpy(&protocol_id, data, sizeof(unsigned int));
+	return protocol_id == protocol_magic;
+}
+
+void NetGameUDPConnectionState::sent_packets_acknowledged(unsigned short ack, unsigned int ack_bits, std::vector<int> &out_acked_sequences, uint64_t current_time)
+{
+	sent_packet_acknowledged(ack, out_acked_sequences, current_time);
+	for (unsigned int i = 0; i < 32; i++)
+	{
+		unsigned int bit = 1u << i;
+		if (ack_bits & bit)
+		{
+			sent_packet_acknowledged(ack - 1 - i, out_acked_sequences, current_time);
+		}
+	}
+}
+
+void NetGameUDPConnectionState::sent_packet_acknowledged(unsigned short sequence, std::vector<int> &out_acked_sequences, uint64_t current_time)
+{
+	// Every packet is acknowledged by many headers. Only the first one counts
+	auto it = sequence_send_time.find(sequence);
+	if (it == sequence_send_time.end())
+		return;
+
+	update_round_trip_time((current_time - it->second) / 1000.0f);
+	sequence_send_time.erase(it);
+
+	if (sequence_delta(sequence, remote_sequence) > 0)
+	{
+		remote_sequence = sequence;
+	}
+
+	out_acked_sequences.push_back(sequence);
+}
+
+void NetGameUDPConnectionState::update_round_trip_time(float packet_rtt)
+{
+	if (round_trip_time != 0.0f)
+	{
+		round_trip_time = mix(round_trip_time, packet_rtt, 0.10f);
+	}
+	else
+	{
+		round_trip_time = packet_rtt;
+	}
+}
+
+void NetGameUDPConnectionState::update_received_packets_ack(unsigned short sequence)
+{
+	if (!any_packet_received)
+	{
+		any_packet_received = true;
+		next_ack = sequence;
+		next_ack_bits = 0;
+		return;
+	}
+
+	int delta = sequence_delta(sequence, next_ack);
+	if (delta > 0)
+	{
+		if (delta < 32)
+			next_ack_bits = ((next_ack_bits << 1) | 1) << (delta - 1);
+		else if (delta == 32)
+			next_ack_bits = 1u << 31;
+		else
+			next_ack_bits = 0;
+		next_ack = sequence;
+	}
+	else if (delta < 0 && delta >= -32)
+	{
+		next_ack_bits |= 1u << (-delta - 1);
+	}
+}
+
+int NetGameUDPConnectionState::sequence_delta(unsigned int s1, unsigned int s2)
+{
+	int delta = (int)(s1 & 0xffff) - (int)(s2 & 0xffff);
+	if (delta >= 32768)
+		delta -= 65536;
+	else if (delta < -32768)
+		delta += 65536;
+	return delta;
+}
+
+}
@@ -0,0 +1,93 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "API/Core/System/databuffer.h"
+#include <map>
+#include <vector>
+
+namespace clan
+{
+
+/// \brief Sequence numbers and acknowledgements of the packets sent over a UDP NetGame connection
+///
+/// Every packet starts with a header containing the protocol magic, the sequence number of the packet, the
+/// newest sequence number received from the remote end and a bitfield acknowledging the 32 sequences before it.
+class NetGameUDPConnectionState
+{
+public:
+	NetGameUDPConnectionState();
+
+	/// \brief Adds the packet header to a payload
+	DataBuffer create_packet(const DataBuffer &payload, int &out_sequence, uint64_t current_time);
+
+	/// \brief Removes the packet header. Returns false for packets not belonging to the protocol
+	bool receive_packet(const DataBuffer &packet, DataBuffer &out_payload, std::vector<int> &out_acked_sequences, uint64_t current_time);
+
+	/// \brief Sequence number that the next created packet will get
+	int get_next_sequence() const { return local_sequence == 0xffff ? 1 : local_sequence + 1; }
+
+	/// \brief Finds the sent packets that are no longer expected to be acknowledged
+	void find_lost_packets(uint64_t current_time, std::vector<int> &out_lost_sequences);
+
+	/// \brief Smoothed round trip time in milliseconds
+	float get_round_trip_time() const { return round_trip_time; }
+
+	/// \brief Returns true if the packet is a valid packet of this protocol
+	static bool is_protocol_packet(const void *data, int size);
+
+	/// \brief Returns the signed distance between two 16 bit sequence numbers
+	static int sequence_delta(unsigned int s1, unsigned int s2);
+
+	static const unsigned int protocol_magic = (unsigned int)'c' | ((unsigned int)'l' << 8) | ((unsigned int)'a' << 16) | ((unsigned int)'n' << 24);
+	static const unsigned int header_size = 3 * 4;
+
+private:
+	void sent_packets_acknowledged(unsigned short ack, unsigned int ack_bits, std::vector<int> &out_acked_sequences, uint64_t current_time);
+	void sent_packet_acknowledged(unsigned short sequence, std::vector<int> &out_acked_sequences, uint64_t current_time);
+
+	void update_round_trip_time(float packet_rtt);
+
+	void update_received_packets_ack(unsigned short sequence);
+
+	unsigned short local_sequence;
+	unsigned short remote_sequence;
+
+	bool any_packet_received;
+	unsigned short next_ack;
+	unsigned int next_ack_bits;
+
+	float round_trip_time;
+	std::map<unsigned short, uint64_t> sequence_send_time;
+
+	// Limits in milliseconds for how long to wait for an ack before a packet is considered lost
+	enum { min_lost_timeout = 100, max_lost_timeout = 1000 };
+};
+
+}
@@ -0,0 +1,249 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Network/precomp.h"
+#include "udp_queue.h"
+#include "udp_connection_state.h"
+#include "network_data.h"
+#include <cstring>
+
+namespace clan
+{
+
+NetGameUDPQueue::NetGameUDPQueue()
+: next_reliable_id(0), next_sequenced_id(0), next_received_reliable_id(0), any_sequenced_received(false), last_received_sequenced_id(0)
+{
+}
+
+void NetGameUDPQueue::queue_event(const std::shared_ptr<const DataBuffer> &event_data, NetGameReliability reliability)
+{
+	switch (reliability)
+	{
+	case NetGameReliability::unreliable:
+		unreliable_events.push_back(QueuedEvent(event_data, message_unreliable, 0));
+		break;
+	case NetGameReliability::unreliable_sequenced:
+		unreliable_events.push_back(QueuedEvent(event_data, message_sequenced, next_sequenced_id++));
+		break;
+	case NetGameReliability::reliable_ordered:
+		reliable_events.insert(std::make_pair(next_reliable_id++, ReliableEvent(event_data)));
+		break;
+	}
+}
+
+bool NetGameUDPQueue::has_outgoing() const
+{
+	if (!unreliable_events.empty())
+		return true;
+
+	if (!reliable_events.empty())
+	{
+		int window_end = reliable_events.begin()->first + reliable_window;
+		for (const auto &it : reliable_events)
+		{
+			if (it.first >= window_end)
+				break;
+			if (it.second.waiting)
+				return true;
+		}
+	}
+
+	return false;
+}
+
+DataBuffer NetGameUDPQueue::create_payload(int payload_sequence, unsigned int max_size)
+{
+	DataBuffer payload;
+	payload.set_capacity(max_size);
+
+	// Reliable events go first as they may have been waiting for a resend
+	std::vector<int> reliable_ids;
+	if (!reliable_events.empty())
+	{
+		int window_end = reliable_events.begin()->first + reliable_window;
+		for (auto &it : reliable_events)
+		{
+			if (it.first >= window_end)
+				break;
+			if (!it.second.waiting)
+				continue;
+			if (!append_message(payload, max_size, message_reliable, (unsigned short)it.first, *it.second.event_data))
+				break;
+			it.second.waiting = false;
+			reliable_ids.push_back(it.first);
+		}
+	}
+
+	while (!unreliable_events.empty())
+	{
+		const QueuedEvent &queued_event = unreliable_events.front();
+		if (!append_message(payload, max_size, queued_event.type, queued_event.id, *queued_event.event_data))
+			break;
+		unreliable_events.pop_front();
+	}
+
+	if (!reliable_ids.empty())
+		payloads[payload_sequence] = std::move(reliable_ids);
+
+	return payload;
+}
+
+void NetGameUDPQueue::payload_acked(int payload_sequence)
+{
+	auto it = payloads.find(payload_sequence);
+	if (it != payloads.end())
+	{
+		for (int id : it->second)
+			reliable_events.erase(id);
+		payloads.erase(it);
+	}
+}
+
+void NetGameUDPQueue::payload_lost(int payload_sequence)
+{
+	auto it = payloads.find(payload_sequence);
+	if (it != payloads.end())
+	{
+		// Events acknowledged as part of a later resend are already gone
+		for (int id : it->second)
+		{
+			auto it_event = reliable_events.find(id);
+			if (it_event != reliable_events.end())
+				it_event->second.waiting = true;
+		}
+		payloads.erase(it);
+	}
+}
+
+void NetGameUDPQueue::receive_payload(const DataBuffer &payload, std::vector<NetGameEvent> &out_events, bool &out_disconnect)
+{
+	out_disconnect = false;
+
+	const unsigned char *data = payload.get_data<unsigned char>();
+	unsigned int size = payload.get_size();
+	unsigned int pos = 0;
+	while (pos < size)
+	{
+		MessageType type = (MessageType)data[pos++];
+		if (type == message_disconnect)
+		{
+			out_disconnect = true;
+			return;
+		}
+
+		unsigned short id = 0;
+		if (type == message_sequenced || type == message_reliable)
+		{
+			if (pos + 2 > size)
+				throw Exception("Invalid network data");
+			memcpy(&id, data + pos, 2);
+			pos += 2;
+		}
+		else if (type != message_unreliable)
+		{
+			throw Exception("Invalid network data");
+		}
+
+		int bytes_consumed = 0;
+		NetGameEvent e = NetGameNetworkData::receive_data(DataBufferSlice(payload, pos, size - pos), bytes_consumed);
+		if (bytes_consumed == 0)
+			throw Exception("Invalid network data");
+		pos += bytes_consumed;
+
+		if (type == message_unreliable)
+		{
+			out_events.push_back(e);
+		}
+		else if (type == message_sequenced)
+		{
+			if (!any_sequenced_received || NetGameUDPConnectionState::sequence_delta(id, last_received_sequenced_id) > 0)
+			{
+				any_sequenced_received = true;
+				last_received_sequenced_id = id;
+				out_events.push_back(e);
+			}
+		}
+		else
+		{
+			deliver_reliable_event(id, e, out_events);
+		}
+	}
+}
+
+void NetGameUDPQueue::deliver_reliable_event(unsigned short id, const NetGameEvent &e, std::vector<NetGameEvent> &out_events)
+{
+	int delta = NetGameUDPConnectionState::sequence_delta(id, next_received_reliable_id);
+	if (delta < 0)
+	{
+		// Resent after the ack got lost
+		return;
+	}
+	else if (delta > 0)
+	{
+		out_of_order_events.insert(std::make_pair(id, e));
+		return;
+	}
+
+	out_events.push_back(e);
+	next_received_reliable_id++;
+
+	while (true)
+	{
+		auto it = out_of_order_events.find(next_received_reliable_id);
+		if (it == out_of_order_events.end())
+			break;
+		out_events.push_back(it->second);
+		out_of_order_events.erase(it);
+		next_received_reliable_id++;
+	}
+}
+
+DataBuffer NetGameUDPQueue::create_disconnect_payload()
+{
+	DataBuffer payload(1);
+	payload.get_data<unsigned char>()[0] = message_disconnect;
+	return payload;
+}
+
+bool NetGameUDPQueue::append_message(DataBuffer &payload, unsigned int max_size, MessageType type, unsigned short id, const DataBuffer &event_data)
+{
+	unsigned int header_size = (type == message_unreliable) ? 1 : 3;
+	unsigned int pos = payload.get_size();
+	if (pos > 0 && pos + header_size + event_data.get_size() > max_size)
+		return false;
+
+	payload.set_size(pos + header_size + event_data.get_size());
+	unsigned char *data = payload.get_data<unsigned char>() + pos;
+	data[0] = type;
+	if (type != message_unreliable)
+		memcpy(data + 1, &id, 2);
+	memcpy(data + header_size, event_data.get_data(), event_data.get_size());
+	return true;
+}
+
+}
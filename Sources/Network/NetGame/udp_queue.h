@@ -0,0 +1,118 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "API/Network/NetGame/udp_connection.h"
+#include "API/Network/NetGame/event.h"
+#include "API/Core/System/databuffer.h"
+#include <deque>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace clan
+{
+
+/// \brief Outgoing and incoming events of a UDP NetGame connection
+///
+/// A payload consists of messages, each starting with a message type. Sequenced and reliable messages are
+/// followed by a 16 bit message id. The event itself is encoded the same way as for TCP connections.
+class NetGameUDPQueue
+{
+public:
+	NetGameUDPQueue();
+
+	/// \brief Queues an event encoded with NetGameNetworkData::send_data
+	void queue_event(const std::shared_ptr<const DataBuffer> &event_data, NetGameReliability reliability);
+
+	/// \brief Returns true if there are events waiting to be sent
+	bool has_outgoing() const;
+
+	/// \brief Moves as many waiting events as fits into the payload of the next packet
+	///
+	/// A single event larger than max_size is sent in a payload of its own.
+	DataBuffer create_payload(int payload_sequence, unsigned int max_size);
+
+	void payload_acked(int payload_sequence);
+	void payload_lost(int payload_sequence);
+
+	/// \brief Decodes a payload and returns the events ready to be delivered
+	///
+	/// Duplicate and outdated events are dropped. Reliable events received out of order are held back until
+	/// the events before them have arrived.
+	void receive_payload(const DataBuffer &payload, std::vector<NetGameEvent> &out_events, bool &out_disconnect);
+
+	static DataBuffer create_disconnect_payload();
+
+private:
+	enum MessageType
+	{
+		message_unreliable = 0,
+		message_sequenced = 1,
+		message_reliable = 2,
+		message_disconnect = 3
+	};
+
+	static bool append_message(DataBuffer &payload, unsigned int max_size, MessageType type, unsigned short id, const DataBuffer &event_data);
+	void deliver_reliable_event(unsigned short id, const NetGameEvent &e, std::vector<NetGameEvent> &out_events);
+
+	struct QueuedEvent
+	{
+		QueuedEvent(const std::shared_ptr<const DataBuffer> &event_data, MessageType type, unsigned short id) : event_data(event_data), type(type), id(id) { }
+
+		std::shared_ptr<const DataBuffer> event_data;
+		MessageType type;
+		unsigned short id;
+	};
+
+	struct ReliableEvent
+	{
+		ReliableEvent(const std::shared_ptr<const DataBuffer> &event_data) : event_data(event_data), waiting(true) { }
+
+		std::shared_ptr<const DataBuffer> event_data;
+		bool waiting;
+	};
+
+	// Limits how far ahead of the oldest unacknowledged event that reliable events are sent, so that 16 bit ids remain unambiguous
+	enum { reliable_window = 16384 };
+
+	int next_reliable_id;
+	unsigned short next_sequenced_id;
+
+	std::deque<QueuedEvent> unreliable_events;
+	std::map<int, ReliableEvent> reliable_events;
+	std::map<int, std::vector<int>> payloads;
+
+	unsigned short next_received_reliable_id;
+	bool any_sequenced_received;
+	unsigned short last_received_sequenced_id;
+	std::map<unsigned short, NetGameEvent> out_of_order_events;
+};
+
+}
@@ -0,0 +1,192 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include "Network/precomp.h"
+#include "API/Network/NetGame/udp_server.h"
+#include "API/Core/System/databuffer.h"
+#include "API/Core/System/system.h"
+#include "network_data.h"
+#include "udp_connection_impl.h"
+#include "udp_server_impl.h"
+
+namespace clan
+{
+
+NetGameUDPServer::NetGameUDPServer()
+: impl(std::make_shared<NetGameUDPServer_Impl>())
+{
+}
+
+NetGameUDPServer::~NetGameUDPServer()
+{
+	stop();
+}
+
+void NetGameUDPServer::start(const std::string &port)
+{
+	start(std::string(), port);
+}
+
+void NetGameUDPServer::start(const std::string &address, const std::string &port)
+{
+	stop();
+	std::unique_ptr<NetGameUDPSocket> socket(new NetGameUDPSocket());
+	socket->simulated_packet_loss = impl->simulated_packet_loss;
+	socket->socket.bind(address.empty() ? SocketName(port) : SocketName(address, port));
+	impl->socket = std::move(socket);
+}
+
+void NetGameUDPServer::stop()
+{
+	if (impl->socket)
+	{
+		uint64_t current_time = System::get_microseconds();
+		for (auto &it : impl->connections)
+			impl->send_disconnect(it.second.get(), current_time);
+	}
+	impl->connections.clear();
+	impl->socket.reset();
+}
+
+void NetGameUDPServer::process_events()
+{
+	impl->process();
+}
+
+void NetGameUDPServer::send_event(const NetGameEvent &game_event, NetGameReliability reliability)
+{
+	std::shared_ptr<const DataBuffer> event_data = std::make_shared<DataBuffer>(NetGameNetworkData::send_data(game_event));
+	for (auto &it : impl->connections)
+		it.second->impl->queue.queue_event(event_data, reliability);
+}
+
+void NetGameUDPServer::set_simulated_packet_loss(float probability)
+{
+	impl->simulated_packet_loss = probability;
+	if (impl->socket)
+		impl->socket->simulated_packet_loss = probability;
+}
+
+Signal<void(NetGameUDPConnection *)> &NetGameUDPServer::sig_client_connected()
+{
+	return impl->sig_game_client_connected;
+}
+
+Signal<void(NetGameUDPConnection *, const std::string &)> &NetGameUDPServer::sig_client_disconnected()
+{
+	return impl->sig_game_client_disconnected;
+}
+
+Signal<void(NetGameUDPConnection *, const NetGameEvent &)> &NetGameUDPServer::sig_event_received()
+{
+	return impl->sig_game_event_received;
+}
+
+void NetGameUDPServer_Impl::process()
+{
+	if (!socket)
+		return;
+
+	uint64_t current_time = System::get_microseconds();
+
+	DataBuffer packet;
+	packet.set_capacity(NetGameUDPSocket::max_datagram_size);
+	std::vector<NetGameEvent> events;
+	while (true)
+	{
+		SocketName from;
+		if (!socket->read_packet(packet, from))
+			break;
+		if (!NetGameUDPConnectionState::is_protocol_packet(packet.get_data(), packet.get_size()))
+			continue;
+
+		// Any valid packet from an unknown end point starts a new connection
+		std::unique_ptr<NetGameUDPConnection> new_connection;
+		NetGameUDPConnection *connection = nullptr;
+		auto it = connections.find(from);
+		if (it != connections.end())
+		{
+			connection = it->second.get();
+		}
+		else
+		{
+			new_connection.reset(new NetGameUDPConnection(from));
+			connection = new_connection.get();
+		}
+
+		events.clear();
+		bool valid = false;
+		try
+		{
+			valid = connection->impl->receive_packet(packet, current_time, events);
+		}
+		catch (const Exception &)
+		{
+			// Malformed packets are dropped like any other damaged datagram
+		}
+
+		if (new_connection)
+		{
+			// Late copies of a disconnect packet must not bring the connection back
+			if (!valid || connection->impl->closed)
+				continue;
+			connections[from] = std::move(new_connection);
+			sig_game_client_connected(connection);
+		}
+
+		for (const auto &e : events)
+			sig_game_event_received(connection, e);
+	}
+
+	std::vector<DataBuffer> packets;
+	std::vector<NetGameUDPConnection *> closed_connections;
+	for (auto &it : connections)
+	{
+		NetGameUDPConnection_Impl *connection_impl = it.second->impl.get();
+		packets.clear();
+		connection_impl->create_packets(current_time, packets);
+		socket->send_packets(packets, connection_impl->remote_name);
+		if (connection_impl->closed)
+			closed_connections.push_back(it.second.get());
+	}
+
+	for (auto connection : closed_connections)
+	{
+		sig_game_client_disconnected(connection, connection->impl->close_reason);
+		connections.erase(connection->impl->remote_name);
+	}
+}
+
+void NetGameUDPServer_Impl::send_disconnect(NetGameUDPConnection *connection, uint64_t current_time)
+{
+	std::vector<DataBuffer> packets;
+	connection->impl->create_disconnect_packets(current_time, packets);
+	socket->send_packets(packets, connection->impl->remote_name);
+}
+
+}
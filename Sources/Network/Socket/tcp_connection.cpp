@@ -122,6 +122,12 @@ namespace clan
 		return name;
 	}
 
+	int TCPConnection::get_round_trip_time()
+	{
+		// SIO_TCP_INFO requires a newer Windows SDK than the one supported
+		return -1;
+	}
+
 	SocketHandle *TCPConnection::get_socket_handle()
 	{
 		return impl.get();
@@ -245,6 +251,22 @@ namespace clan
 		return name;
 	}
 
+	int TCPConnection::get_round_trip_time()
+	{
+#if defined(TCP_INFO)
+		tcp_info info;
+		socklen_t size = sizeof(tcp_info);
+		if (getsockopt(impl->handle, IPPROTO_TCP, TCP_INFO, &info, &size) == 0)
+			return (int)info.tcpi_rtt;
+#elif defined(TCP_CONNECTION_INFO)
+		tcp_connection_info info;
+		socklen_t size = sizeof(tcp_connection_info);
+		if (getsockopt(impl->handle, IPPROTO_TCP, TCP_CONNECTION_INFO, &info, &size) == 0)
+			return (int)info.tcpi_srtt * 1000;
+#endif
+		return -1;
+	}
+
 	SocketHandle *TCPConnection::get_socket_handle()
 	{
 		return impl.get();
@@ -113,7 +113,7 @@ namespace clan
 		}
 
 		TCPSocket(int handle)
-			: handle(handle)
+			: handle(handle), can_write(false)
 		{
 		}
 
@@ -32,6 +32,8 @@
 #include "API/Core/IOData/file_system.h"
 #include "API/Core/Text/string_help.h"
 #include "API/Core/IOData/path_help.h"
+#include "API/Core/IOData/memory_device.h"
+#include "API/Core/System/exception.h"
 #include "soundprovider_vorbis_impl.h"
 #include "soundprovider_vorbis_session.h"
 
@@ -48,7 +50,7 @@ SoundProvider_Vorbis::SoundProvider_Vorbis(
 : impl(std::make_shared<SoundProvider_Vorbis_Impl>())
 {
 	IODevice input = fs.open_file(filename, File::open_existing, File::access_read, File::share_all);
-	impl->load(input);
+	impl->load(input, stream);
 }
 
 SoundProvider_Vorbis::SoundProvider_Vorbis(
@@ -59,14 +61,14 @@ SoundProvider_Vorbis::SoundProvider_Vorbis(
 	std::string filename = PathHelp::get_filename(fullname, PathHelp::path_type_file);
 	FileSystem vfs(path);
 	IODevice input = vfs.open_file(filename, File::open_existing, File::access_read, File::share_all);
-	impl->load(input);
+	impl->load(input, stream);
 }
 
 SoundProvider_Vorbis::SoundProvider_Vorbis(
 	IODevice &file, bool stream)
 : impl(std::make_shared<SoundProvider_Vorbis_Impl>())
 {
-	impl->load(file);
+	impl->load(file, stream);
 }
 
 SoundProvider_Vorbis::~SoundProvider_Vorbis()
@@ -89,12 +91,34 @@ void SoundProvider_Vorbis::end_session(SoundProvider_Session *session)
 /////////////////////////////////////////////////////////////////////////////
 // SoundProvider_Vorbis implementation:
 
-void SoundProvider_Vorbis_Impl::load(IODevice &input)
+void SoundProvider_Vorbis_Impl::load(IODevice &input, bool stream)
 {
+	if (stream)
+	{
+		// Sessions need their own read position, so streaming is only possible for devices that can be duplicated.
+		try
+		{
+			file = input.duplicate();
+			this->stream = true;
+			return;
+		}
+		catch (const Exception &)
+		{
+		}
+	}
+
 	int size = input.get_size();
 	buffer = DataBuffer(size);
 	int bytes_read = input.read(buffer.get_data(), buffer.get_size());
 	buffer.set_size(bytes_read);
 }
 
+IODevice SoundProvider_Vorbis_Impl::open_input()
+{
+	if (stream)
+		return file.duplicate();
+	else
+		return MemoryDevice(buffer);
+}
+
 }
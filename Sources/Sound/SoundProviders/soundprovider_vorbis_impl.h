@@ -30,6 +30,7 @@
 
 #include "API/Sound/soundformat.h"
 #include "API/Core/System/databuffer.h"
+#include "API/Core/IOData/iodevice.h"
 #include <string>
 
 namespace clan
@@ -40,10 +41,19 @@ class SoundProvider_Vorbis_Impl
 /// \name Attributes
 /// \{
 public:
-	void load(IODevice &input);
+	void load(IODevice &input, bool stream);
+
+	/// \brief Returns a device with its own read position for a new session.
+	IODevice open_input();
 
 public:
+	/// \brief Whole file contents (when not streaming).
 	DataBuffer buffer;
+
+	/// \brief Source device (when streaming). Sessions read from duplicates of it.
+	IODevice file;
+
+	bool stream = false;
 /// \}
 };
 
@@ -33,6 +33,7 @@
 #include "API/Core/IOData/iodevice.h"
 #include "API/Core/IOData/memory_device.h"
 #include "API/Core/System/exception.h"
+#include <cstring>
 
 namespace clan
 {
@@ -41,14 +42,11 @@ namespace clan
 // SoundProvider_Vorbis_Session construction:
 
 SoundProvider_Vorbis_Session::SoundProvider_Vorbis_Session(SoundProvider_Vorbis &source) :
-	source(source), position(0), stream_eof(false), handle(nullptr), stream_byte_offset(0), pcm(nullptr), pcm_position(0), pcm_samples(0)
+	source(source), position(0), stream_eof(false), handle(nullptr), audio_data_offset(0), read_pos(0), read_end(0), input_eof(false), pcm(nullptr), pcm_position(0), pcm_samples(0)
 {
-	int error = 0;
-	handle = stb_vorbis_open_pushdata(source.impl->buffer.get_data<unsigned char>(), source.impl->buffer.get_size(), &stream_byte_offset, &error, nullptr);
-	if (handle == nullptr)
-		throw Exception("Unable to read ogg file");
-
-	stream_info = stb_vorbis_get_info(handle);
+	input = source.impl->open_input();
+	read_buffer.resize(initial_read_buffer_size);
+	open_stream();
 }
 
 SoundProvider_Vorbis_Session::~SoundProvider_Vorbis_Session()
@@ -99,22 +97,62 @@ bool SoundProvider_Vorbis_Session::play()
 	
 bool SoundProvider_Vorbis_Session::set_position(int pos)
 {
-	// Currently only support seeking to beginning of stream.
-	if (pos != 0) return false;
+	if (pos < 0)
+		return false;
 
-	if (handle)
-		stb_vorbis_close(handle);
-	handle = nullptr;
-	stream_byte_offset = 0;
+	// Start decoding at the last page ending before the target (with two frames of preroll), then decode and discard up to it.
+	int page_offset = 0;
+	if (pos > 0)
+		page_offset = find_seek_page(int64_t(pos) - stream_info.max_frame_size * 2);
 
-	int error = 0;
-	handle = stb_vorbis_open_pushdata(source.impl->buffer.get_data<unsigned char>(), source.impl->buffer.get_size(), &stream_byte_offset, &error, nullptr);
-	if (handle == nullptr)
-		throw Exception("Unable to read ogg file");
+	while (true)
+	{
+		if (page_offset <= audio_data_offset)
+		{
+			if (!input.seek(0))
+				return false;
+			open_stream();
+		}
+		else
+		{
+			if (!input.seek(page_offset))
+				return false;
+			reset_read_buffer();
+			stb_vorbis_flush_pushdata(handle);
+		}
 
-	stream_info = stb_vorbis_get_info(handle);
-	stream_eof = false;
-	return true;
+		position = pos;
+		stream_eof = false;
+
+		// stb_vorbis only knows the sample position once it has seen a granule position (immediately when starting from the beginning).
+		// It advances it for frames decoded but not output after a resync too, so it must be queried before each frame.
+		while (true)
+		{
+			int sample_pos = stb_vorbis_get_sample_offset(handle);
+
+			// Decoding resumed after the target; fall back to decoding from the beginning of the stream
+			if (sample_pos > pos)
+				break;
+
+			if (!decode_frame())
+			{
+				if (sample_pos < 0)
+					break;
+				stream_eof = true;
+				return false;
+			}
+
+			if (sample_pos >= 0 && pos < sample_pos + pcm_samples)
+			{
+				pcm_position = pos - sample_pos;
+				return true;
+			}
+		}
+
+		if (page_offset <= audio_data_offset)
+			return false;
+		page_offset = 0;
+	}
 }
 
 int SoundProvider_Vorbis_Session::get_data(float **channels, int data_requested)
@@ -122,18 +160,11 @@ int SoundProvider_Vorbis_Session::get_data(float **channels, int data_requested)
 	int data_left = data_requested;
 	while (!eof() && data_left > 0)
 	{
-		while (pcm_position == pcm_samples)
+		if (pcm_position == pcm_samples)
 		{
-			pcm = nullptr;
-			pcm_position = 0;
-			pcm_samples = 0;
-			int bytes_used = stb_vorbis_decode_frame_pushdata(handle, source.impl->buffer.get_data<unsigned char>() + stream_byte_offset, source.impl->buffer.get_size() - stream_byte_offset, nullptr, &pcm, &pcm_samples);
-			stream_byte_offset += bytes_used;
-			if (bytes_used == 0 || stream_byte_offset == source.impl->buffer.get_size())
-			{
+			if (!decode_frame())
 				stream_eof = true;
-				break;
-			}
+			continue;
 		}
 
 		int samples = pcm_samples - pcm_position;
@@ -157,4 +188,155 @@ int SoundProvider_Vorbis_Session::get_data(float **channels, int data_requested)
 /////////////////////////////////////////////////////////////////////////////
 // SoundProvider_Vorbis_Session implementation:
 
+void SoundProvider_Vorbis_Session::open_stream()
+{
+	if (handle)
+		stb_vorbis_close(handle);
+	handle = nullptr;
+	reset_read_buffer();
+
+	// The header packets must be in memory all at once; keep reading until stb_vorbis has enough of them.
+	while (true)
+	{
+		int bytes_used = 0;
+		int error = 0;
+		if (read_end > 0)
+			handle = stb_vorbis_open_pushdata(read_buffer.data(), read_end, &bytes_used, &error, nullptr);
+		else
+			error = VORBIS_need_more_data;
+
+		if (handle)
+		{
+			read_pos = bytes_used;
+			audio_data_offset = bytes_used;
+			break;
+		}
+		else if (error != VORBIS_need_more_data || !fill_read_buffer())
+		{
+			throw Exception("Unable to read ogg file");
+		}
+	}
+
+	stream_info = stb_vorbis_get_info(handle);
+}
+
+void SoundProvider_Vorbis_Session::reset_read_buffer()
+{
+	read_pos = 0;
+	read_end = 0;
+	input_eof = false;
+}
+
+bool SoundProvider_Vorbis_Session::fill_read_buffer()
+{
+	if (input_eof)
+		return false;
+
+	if (read_pos > 0)
+	{
+		memmove(read_buffer.data(), read_buffer.data() + read_pos, read_end - read_pos);
+		read_end -= read_pos;
+		read_pos = 0;
+	}
+
+	// Only grow the read-ahead window if a single frame or the headers do not fit into it.
+	if (read_end == (int)read_buffer.size())
+	{
+		if ((int)read_buffer.size() >= max_read_buffer_size)
+			throw Exception("Ogg packet too large");
+		read_buffer.resize(read_buffer.size() * 2);
+	}
+
+	int bytes_read = input.read(read_buffer.data() + read_end, read_buffer.size() - read_end, false);
+	if (bytes_read <= 0)
+	{
+		input_eof = true;
+		return false;
+	}
+
+	read_end += bytes_read;
+	return true;
+}
+
+bool SoundProvider_Vorbis_Session::decode_frame()
+{
+	pcm = nullptr;
+	pcm_position = 0;
+	pcm_samples = 0;
+
+	while (true)
+	{
+		if (read_pos < read_end)
+		{
+			int bytes_used = stb_vorbis_decode_frame_pushdata(handle, read_buffer.data() + read_pos, read_end - read_pos, nullptr, &pcm, &pcm_samples);
+			read_pos += bytes_used;
+			if (bytes_used > 0)
+				return true;
+		}
+
+		if (!fill_read_buffer())
+			return false;
+	}
+}
+
+int SoundProvider_Vorbis_Session::find_seek_page(int64_t target_sample)
+{
+	// Bisect the file for the last page whose granule position lies before the target sample.
+	// The read buffer is discarded by the seek anyway, so it doubles as scratch space here.
+	int low = audio_data_offset;
+	int high = input.get_size();
+	if (target_sample <= 0 || high <= low)
+		return 0;
+
+	while (high - low > (int)read_buffer.size())
+	{
+		int middle = low + (high - low) / 2;
+		int page_offset = 0;
+		int64_t granule = 0;
+		if (find_page_granule(middle, high, page_offset, granule) && granule < target_sample)
+			low = page_offset;
+		else
+			high = middle;
+	}
+
+	return low;
+}
+
+bool SoundProvider_Vorbis_Session::find_page_granule(int offset, int end_offset, int &out_page_offset, int64_t &out_granule)
+{
+	const int page_header_size = 27;
+
+	while (offset < end_offset)
+	{
+		if (!input.seek(offset))
+			return false;
+
+		int length = input.read(read_buffer.data(), read_buffer.size(), false);
+		if (length < page_header_size)
+			return false;
+
+		for (int i = 0; i + page_header_size <= length && offset + i < end_offset; i++)
+		{
+			const unsigned char *page = read_buffer.data() + i;
+			if (page[0] != 'O' || page[1] != 'g' || page[2] != 'g' || page[3] != 'S' || page[4] != 0)
+				continue;
+
+			// Pages on which no packet ends have a granule position of -1
+			int64_t granule = 0;
+			for (int j = 7; j >= 0; j--)
+				granule = (granule << 8) | page[6 + j];
+			if (granule == -1)
+				continue;
+
+			out_page_offset = offset + i;
+			out_granule = granule;
+			return true;
+		}
+
+		// Overlap blocks so a page header straddling the boundary is still found
+		offset += length - page_header_size + 1;
+	}
+	return false;
+}
+
 }
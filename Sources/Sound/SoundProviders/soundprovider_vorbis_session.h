@@ -30,13 +30,13 @@
 
 #include "API/Sound/SoundProviders/soundprovider_session.h"
 #include "API/Sound/SoundProviders/soundprovider_vorbis.h"
+#include "API/Core/IOData/iodevice.h"
 #include "stb_vorbis.h"
+#include <vector>
 
 namespace clan
 {
 
-class IODevice;
-
 class SoundProvider_Vorbis_Session : public SoundProvider_Session
 {
 /// \name Construction
@@ -69,13 +69,32 @@ public:
 /// \name Implementation
 /// \{
 private:
+	void open_stream();
+	void reset_read_buffer();
+	bool fill_read_buffer();
+	bool decode_frame();
+	int find_seek_page(int64_t target_sample);
+	bool find_page_granule(int offset, int end_offset, int &out_page_offset, int64_t &out_granule);
+
+	enum
+	{
+		initial_read_buffer_size = 32 * 1024,
+		max_read_buffer_size = 1024 * 1024
+	};
+
 	SoundProvider_Vorbis source;
+	IODevice input;
 	int position;
 	bool stream_eof;
 
 	stb_vorbis *handle;
 	stb_vorbis_info stream_info;
-	int stream_byte_offset;
+	int audio_data_offset;
+
+	std::vector<unsigned char> read_buffer;
+	int read_pos;
+	int read_end;
+	bool input_eof;
 
 	float **pcm;
 	int pcm_position;
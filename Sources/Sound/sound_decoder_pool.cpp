@@ -0,0 +1,139 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "Sound/precomp.h"
+#include "sound_decoder_pool.h"
+#include "soundbuffer_session_impl.h"
+#include <algorithm>
+#include <chrono>
+
+namespace clan
+{
+
+SoundDecoderPool::SoundDecoderPool()
+: next_session(0), work_pending(false), stop_flag(false)
+{
+}
+
+SoundDecoderPool::~SoundDecoderPool()
+{
+	stop();
+}
+
+void SoundDecoderPool::start()
+{
+	stop();
+
+	// Leave a core for the mixer and the application
+	int num_workers = (int)std::thread::hardware_concurrency() / 2;
+	num_workers = std::max(1, std::min(num_workers, (int)max_workers));
+
+	stop_flag = false;
+	for (int i = 0; i < num_workers; i++)
+		workers.push_back(std::thread(&SoundDecoderPool::worker_main, this));
+}
+
+void SoundDecoderPool::stop()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	stop_flag = true;
+	lock.unlock();
+	wake_event.notify_all();
+
+	for (auto &worker : workers)
+		worker.join();
+	workers.clear();
+}
+
+void SoundDecoderPool::add_session(const std::shared_ptr<SoundBuffer_Session_Impl> &session)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	sessions.push_back(session);
+	lock.unlock();
+	notify();
+}
+
+void SoundDecoderPool::remove_session(SoundBuffer_Session_Impl *session)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	for (auto it = sessions.begin(); it != sessions.end(); ++it)
+	{
+		if (it->get() == session)
+		{
+			sessions.erase(it);
+			break;
+		}
+	}
+}
+
+void SoundDecoderPool::notify()
+{
+	work_pending.store(true, std::memory_order_relaxed);
+	wake_event.notify_one();
+}
+
+std::shared_ptr<SoundBuffer_Session_Impl> SoundDecoderPool::find_work()
+{
+	// Round robin, so one long stream cannot starve the others
+	for (size_t i = 0; i < sessions.size(); i++)
+	{
+		size_t index = (next_session + i) % sessions.size();
+		const std::shared_ptr<SoundBuffer_Session_Impl> &session = sessions[index];
+		if (session->needs_decoding() && !session->decoding.exchange(true))
+		{
+			next_session = index + 1;
+			return session;
+		}
+	}
+	return std::shared_ptr<SoundBuffer_Session_Impl>();
+}
+
+void SoundDecoderPool::worker_main()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (!stop_flag)
+	{
+		std::shared_ptr<SoundBuffer_Session_Impl> session = find_work();
+		if (!session)
+		{
+			// The timeout covers a notify arriving between find_work and the wait
+			wake_event.wait_for(lock, std::chrono::milliseconds(poll_interval), [&] { return stop_flag || work_pending.load(std::memory_order_relaxed); });
+			work_pending.store(false, std::memory_order_relaxed);
+			continue;
+		}
+
+		lock.unlock();
+		session->decode_ahead();
+		session->decoding.store(false);
+		session.reset();
+		lock.lock();
+	}
+}
+
+}
@@ -0,0 +1,83 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace clan
+{
+
+class SoundBuffer_Session_Impl;
+
+/// \brief Worker threads decoding playing sessions ahead of the mixer
+///
+/// Each playing session owns a ring of decoded samples. The workers top these up from the
+/// sound providers, so the mixer thread only copies samples that have already been decoded.
+class SoundDecoderPool
+{
+public:
+	SoundDecoderPool();
+	~SoundDecoderPool();
+
+	void start();
+	void stop();
+
+	void add_session(const std::shared_ptr<SoundBuffer_Session_Impl> &session);
+	void remove_session(SoundBuffer_Session_Impl *session);
+
+	/// \brief Wakes up the workers. Called by the mixer after each fragment and never blocks.
+	void notify();
+
+private:
+	SoundDecoderPool(const SoundDecoderPool &) = delete;
+	SoundDecoderPool &operator=(const SoundDecoderPool &) = delete;
+
+	std::shared_ptr<SoundBuffer_Session_Impl> find_work();
+	void worker_main();
+
+	std::vector<std::thread> workers;
+	std::vector<std::shared_ptr<SoundBuffer_Session_Impl> > sessions;
+	size_t next_session;
+
+	std::mutex mutex;
+	std::condition_variable wake_event;
+	std::atomic_bool work_pending;
+	bool stop_flag;
+
+	static const int max_workers = 4;
+	static const int poll_interval = 10;
+};
+
+}
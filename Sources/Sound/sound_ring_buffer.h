@@ -0,0 +1,149 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+#include "API/Sound/sound_sse.h"
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+namespace clan
+{
+
+/// \brief Lock-free single-producer single-consumer ring of float samples, one buffer per channel
+///
+/// The decoder worker writes and the mixer thread reads. Positions are free running counters,
+/// so the capacity must be a power of two.
+/// A flush requested by the producer side is carried out by the consumer on its next read.
+class SoundRingBuffer
+{
+public:
+	SoundRingBuffer() : capacity(0), mask(0), read_pos(0), write_pos(0), flush_pos(0), flush_pending(false) { }
+	~SoundRingBuffer() { free_buffers(); }
+
+	void init(int num_channels, int new_capacity)
+	{
+		free_buffers();
+		capacity = new_capacity;
+		mask = capacity - 1;
+		channels.resize(num_channels);
+		for (auto &channel : channels)
+			channel = (float *)SoundSSE::aligned_alloc(sizeof(float) * capacity);
+		read_pos = 0;
+		write_pos = 0;
+		flush_pending = false;
+	}
+
+	int get_capacity() const { return capacity; }
+
+	/// \brief Number of samples the consumer can read
+	int get_read_available() const { return int(write_pos.load(std::memory_order_acquire) - read_pos.load(std::memory_order_relaxed)); }
+
+	/// \brief Number of samples the producer can write
+	int get_write_available() const { return capacity - int(write_pos.load(std::memory_order_relaxed) - read_pos.load(std::memory_order_acquire)); }
+
+	/// \brief Producer: returns pointers to the next contiguous block of free space and its length (at most max_samples)
+	int begin_write(float **out_channels, int max_samples)
+	{
+		unsigned int pos = write_pos.load(std::memory_order_relaxed);
+		int offset = int(pos & mask);
+		int length = get_write_available();
+		if (length > capacity - offset) length = capacity - offset;
+		if (length > max_samples) length = max_samples;
+		for (size_t i = 0; i < channels.size(); i++)
+			out_channels[i] = channels[i] + offset;
+		return length;
+	}
+
+	/// \brief Producer: publishes samples written to the block returned by begin_write
+	void end_write(int samples)
+	{
+		write_pos.store(write_pos.load(std::memory_order_relaxed) + samples, std::memory_order_release);
+	}
+
+	/// \brief Producer side: discards everything written so far once the consumer gets to it
+	void request_flush()
+	{
+		flush_pos.store(write_pos.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		flush_pending.store(true, std::memory_order_release);
+	}
+
+	/// \brief Consumer: carries out a pending flush. Returns true if one was pending.
+	bool apply_flush()
+	{
+		if (!flush_pending.load(std::memory_order_acquire) || !flush_pending.exchange(false, std::memory_order_acquire))
+			return false;
+		// The consumer may already have read past the flush position if it raced with the request
+		unsigned int pos = flush_pos.load(std::memory_order_relaxed);
+		if (int(pos - read_pos.load(std::memory_order_relaxed)) > 0)
+			read_pos.store(pos, std::memory_order_release);
+		return true;
+	}
+
+	/// \brief Consumer: copies up to max_samples into out_channels (starting at out_offset) and returns the number copied
+	int read(float **out_channels, int out_offset, int max_samples)
+	{
+		unsigned int pos = read_pos.load(std::memory_order_relaxed);
+		int length = get_read_available();
+		if (length > max_samples) length = max_samples;
+
+		int offset = int(pos & mask);
+		int first = length < capacity - offset ? length : capacity - offset;
+		for (size_t i = 0; i < channels.size(); i++)
+		{
+			memcpy(out_channels[i] + out_offset, channels[i] + offset, sizeof(float) * first);
+			memcpy(out_channels[i] + out_offset + first, channels[i], sizeof(float) * (length - first));
+		}
+
+		read_pos.store(pos + length, std::memory_order_release);
+		return length;
+	}
+
+private:
+	SoundRingBuffer(const SoundRingBuffer &) = delete;
+	SoundRingBuffer &operator=(const SoundRingBuffer &) = delete;
+
+	void free_buffers()
+	{
+		for (auto &channel : channels)
+			SoundSSE::aligned_free(channel);
+		channels.clear();
+	}
+
+	std::vector<float *> channels;
+	int capacity;
+	unsigned int mask;
+
+	std::atomic<unsigned int> read_pos;
+	std::atomic<unsigned int> write_pos;
+	std::atomic<unsigned int> flush_pos;
+	std::atomic_bool flush_pending;
+};
+
+}
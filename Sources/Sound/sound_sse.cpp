@@ -31,6 +31,8 @@
 #include "API/Core/System/system.h"
 #include <cstdlib>
 #include <cstring>
+#include <cmath>
+#include <cstdint>
 
 #ifndef CL_DISABLE_SSE2
 #include <emmintrin.h>
@@ -447,4 +449,166 @@ void SoundSSE::unpack_float_mono(float *input, int size, float *output)
 		memcpy(output, input, (size-sse_size)*sizeof(float));
 }
 
+// Resampling positions are stepped in 32.32 fixed point, so the step does not accumulate rounding errors within a block.
+static inline int64_t resample_to_fixed(double value)
+{
+	return (int64_t)(value * 4294967296.0);
+}
+
+static inline float resample_fraction(int64_t position)
+{
+	return (float)(uint32_t)position * (1.0f / 4294967296.0f);
+}
+
+void SoundSSE::resample_linear(const float *input, double position, double step, int size, float *output)
+{
+	int64_t pos = resample_to_fixed(position);
+	int64_t delta = resample_to_fixed(step);
+
+#ifndef CL_DISABLE_SSE2
+	int sse_size = (size/4)*4;
+
+	for (int i = 0; i < sse_size; i+=4)
+	{
+		int64_t pos0 = pos, pos1 = pos + delta, pos2 = pos + 2 * delta, pos3 = pos + 3 * delta;
+		const float *s0 = input + (pos0 >> 32);
+		const float *s1 = input + (pos1 >> 32);
+		const float *s2 = input + (pos2 >> 32);
+		const float *s3 = input + (pos3 >> 32);
+		pos += 4 * delta;
+
+		__m128 samples0 = _mm_set_ps(s3[0], s2[0], s1[0], s0[0]);
+		__m128 samples1 = _mm_set_ps(s3[1], s2[1], s1[1], s0[1]);
+		__m128 t = _mm_set_ps(resample_fraction(pos3), resample_fraction(pos2), resample_fraction(pos1), resample_fraction(pos0));
+		_mm_storeu_ps(output+i, _mm_add_ps(samples0, _mm_mul_ps(t, _mm_sub_ps(samples1, samples0))));
+	}
+#else
+	const int sse_size = 0;
+#endif
+
+	// resample remaining
+	for (int i = sse_size; i < size; i++)
+	{
+		const float *s = input + (pos >> 32);
+		float t = resample_fraction(pos);
+		output[i] = s[0] + t * (s[1] - s[0]);
+		pos += delta;
+	}
+}
+
+void SoundSSE::resample_cubic(const float *input, double position, double step, int size, float *output)
+{
+	int64_t pos = resample_to_fixed(position);
+	int64_t delta = resample_to_fixed(step);
+
+#ifndef CL_DISABLE_SSE2
+	int sse_size = (size/4)*4;
+
+	__m128 half = _mm_set1_ps(0.5f);
+	__m128 two = _mm_set1_ps(2.0f);
+	__m128 three = _mm_set1_ps(3.0f);
+	__m128 four = _mm_set1_ps(4.0f);
+	__m128 five = _mm_set1_ps(5.0f);
+	for (int i = 0; i < sse_size; i+=4)
+	{
+		int64_t pos0 = pos, pos1 = pos + delta, pos2 = pos + 2 * delta, pos3 = pos + 3 * delta;
+		const float *s0 = input + (pos0 >> 32) - 1;
+		const float *s1 = input + (pos1 >> 32) - 1;
+		const float *s2 = input + (pos2 >> 32) - 1;
+		const float *s3 = input + (pos3 >> 32) - 1;
+		pos += 4 * delta;
+
+		__m128 p0 = _mm_set_ps(s3[0], s2[0], s1[0], s0[0]);
+		__m128 p1 = _mm_set_ps(s3[1], s2[1], s1[1], s0[1]);
+		__m128 p2 = _mm_set_ps(s3[2], s2[2], s1[2], s0[2]);
+		__m128 p3 = _mm_set_ps(s3[3], s2[3], s1[3], s0[3]);
+		__m128 t = _mm_set_ps(resample_fraction(pos3), resample_fraction(pos2), resample_fraction(pos1), resample_fraction(pos0));
+
+		// p1 + 0.5 * t * (p2 - p0 + t * (2 * p0 - 5 * p1 + 4 * p2 - p3 + t * (3 * (p1 - p2) + p3 - p0)))
+		__m128 c3 = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(three, _mm_sub_ps(p1, p2)), p3), p0);
+		__m128 c2 = _mm_sub_ps(_mm_add_ps(_mm_sub_ps(_mm_mul_ps(two, p0), _mm_mul_ps(five, p1)), _mm_mul_ps(four, p2)), p3);
+		__m128 c1 = _mm_sub_ps(p2, p0);
+		__m128 result = _mm_add_ps(c2, _mm_mul_ps(t, c3));
+		result = _mm_add_ps(c1, _mm_mul_ps(t, result));
+		result = _mm_add_ps(p1, _mm_mul_ps(_mm_mul_ps(half, t), result));
+		_mm_storeu_ps(output+i, result);
+	}
+#else
+	const int sse_size = 0;
+#endif
+
+	// resample remaining
+	for (int i = sse_size; i < size; i++)
+	{
+		const float *s = input + (pos >> 32) - 1;
+		float t = resample_fraction(pos);
+		output[i] = s[1] + 0.5f * t * (s[2] - s[0] + t * (2.0f * s[0] - 5.0f * s[1] + 4.0f * s[2] - s[3] + t * (3.0f * (s[1] - s[2]) + s[3] - s[0])));
+		pos += delta;
+	}
+}
+
+void SoundSSE::resample_sinc(const float *input, double position, double step, int size, const float *filter, int phases, float *output)
+{
+	int64_t pos = resample_to_fixed(position);
+	int64_t delta = resample_to_fixed(step);
+
+	for (int i = 0; i < size; i++)
+	{
+		const float *s = input + (pos >> 32) - (sinc_taps / 2 - 1);
+
+		// Interpolate linearly between the two nearest filter phases
+		uint64_t phase_pos = (uint64_t)(uint32_t)pos * phases;
+		const float *c0 = filter + (phase_pos >> 32) * sinc_taps;
+		const float *c1 = c0 + sinc_taps;
+		float t = resample_fraction(phase_pos);
+		pos += delta;
+
+#ifndef CL_DISABLE_SSE2
+		__m128 tt = _mm_set1_ps(t);
+		__m128 sum = _mm_setzero_ps();
+		for (int j = 0; j < sinc_taps; j+=4)
+		{
+			__m128 coefficient0 = _mm_loadu_ps(c0+j);
+			__m128 coefficient = _mm_add_ps(coefficient0, _mm_mul_ps(tt, _mm_sub_ps(_mm_loadu_ps(c1+j), coefficient0)));
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(s+j), coefficient));
+		}
+		__m128 shuffled = _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(2,3,0,1));
+		sum = _mm_add_ps(sum, shuffled);
+		shuffled = _mm_movehl_ps(shuffled, sum);
+		sum = _mm_add_ss(sum, shuffled);
+		_mm_store_ss(output+i, sum);
+#else
+		float sum = 0.0f;
+		for (int j = 0; j < sinc_taps; j++)
+			sum += s[j] * (c0[j] + t * (c1[j] - c0[j]));
+		output[i] = sum;
+#endif
+	}
+}
+
+void SoundSSE::build_sinc_filter(float *filter, int phases, float cutoff)
+{
+	const int half_taps = sinc_taps / 2;
+	for (int phase = 0; phase <= phases; phase++)
+	{
+		float *coefficients = filter + phase * sinc_taps;
+		double fraction = phase / (double)phases;
+		double sum = 0.0;
+		for (int i = 0; i < sinc_taps; i++)
+		{
+			// Distance from the input sample to the resampling position, windowed with a Blackman window
+			double x = i - (half_taps - 1) - fraction;
+			double w = x / half_taps;
+			double window = 0.42 + 0.5 * cos(PI_D * w) + 0.08 * cos(2.0 * PI_D * w);
+			double sinc = (x == 0.0) ? 1.0 : sin(PI_D * cutoff * x) / (PI_D * cutoff * x);
+			coefficients[i] = (float)(cutoff * sinc * window);
+			sum += coefficients[i];
+		}
+
+		// Normalize, so each phase passes DC unchanged
+		for (int i = 0; i < sinc_taps; i++)
+			coefficients[i] = (float)(coefficients[i] / sum);
+	}
+}
+
 }
@@ -68,7 +68,7 @@ int SoundBuffer_Session::get_position() const
 	if (impl)
 	{
 		std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
-		return impl->provider_session->get_position();
+		return impl->get_playback_position();
 	}
 	else
 	{
@@ -81,7 +81,7 @@ float SoundBuffer_Session::get_position_relative() const
 	if (impl)
 	{
 		std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
-		int position = impl->provider_session->get_position();
+		int position = impl->get_playback_position();
 		int length = impl->provider_session->get_num_samples();
 		if (length == 0) return 1.0f;
 		return position / (float) length;
@@ -155,6 +155,30 @@ bool SoundBuffer_Session::get_looping() const
 	}
 }
 
+SoundResampleQuality SoundBuffer_Session::get_resample_quality() const
+{
+	if (impl)
+	{
+		return impl->resample_quality;
+	}
+	else
+	{
+		return SoundResampleQuality::linear;
+	}
+}
+
+int SoundBuffer_Session::get_underrun_count() const
+{
+	if (impl)
+	{
+		return impl->underrun_count;
+	}
+	else
+	{
+		return 0;
+	}
+}
+
 bool SoundBuffer_Session::is_playing()
 {
 	if (impl)
@@ -178,7 +202,7 @@ bool SoundBuffer_Session::set_position(int new_pos)
 		std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
 		if (impl->provider_session->set_position(new_pos))
 		{
-			// instantly update position here?
+			impl->flush_decoded();
 			return true;
 		}
 		return false;
@@ -232,6 +256,12 @@ void SoundBuffer_Session::set_frequency(int new_frequency)
 		impl->frequency = new_frequency;
 }
 
+void SoundBuffer_Session::set_resample_quality(SoundResampleQuality quality)
+{
+	if (impl)
+		impl->resample_quality = quality;
+}
+
 void SoundBuffer_Session::set_pan(float new_pan)
 {
 	if (impl)
@@ -246,6 +276,10 @@ void SoundBuffer_Session::play()
 		if (impl->playing) return;
 		if (impl->provider_session->play())
 		{
+			// Decode the first samples here, so playback does not start with an underrun
+			impl->apply_flush();
+			impl->decode_ahead(SoundBuffer_Session_Impl::prefill_size);
+
 			impl->playing = true;
 			mutex_lock.unlock();
 			impl->output.impl->play_session(*this);
@@ -274,6 +308,8 @@ void SoundBuffer_Session::set_looping(bool loop)
 		std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
 		impl->looping = loop;
 		impl->provider_session->set_looping(loop);
+		if (loop)
+			impl->resume_decoding();
 	}
 }
 
@@ -281,7 +317,7 @@ void SoundBuffer_Session::add_filter(SoundFilter &filter)
 {
 	if (impl)
 	{
-		std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
+		std::unique_lock<std::mutex> filter_lock(impl->filter_mutex);
 		impl->filters.push_back(filter);
 	}
 }
@@ -290,7 +326,7 @@ void SoundBuffer_Session::remove_filter(SoundFilter &filter)
 {
 	if (impl)
 	{
-		std::unique_lock<std::recursive_mutex> mutex_lock(impl->mutex);
+		std::unique_lock<std::mutex> filter_lock(impl->filter_mutex);
 		for (std::vector<SoundFilter>::size_type i=0; i<impl->filters.size(); i++)
 		{
 			if (impl->filters[i] == filter)
@@ -35,6 +35,9 @@
 #include "API/Sound/SoundProviders/soundprovider.h"
 #include "API/Sound/SoundProviders/soundprovider_session.h"
 #include "API/Core/Text/logger.h"
+#include "API/Core/Math/cl_math.h"
+#include <cmath>
+#include <cstring>
 
 namespace clan
 {
@@ -43,7 +46,7 @@ namespace clan
 //! Construction:
 
 SoundBuffer_Session_Impl::SoundBuffer_Session_Impl(SoundBuffer &soundbuffer, bool looping, SoundOutput &output)
-: soundbuffer(soundbuffer), provider_session(nullptr), output(output), volume(1.0f), pan(0.0f), looping(looping), playing(false)
+: soundbuffer(soundbuffer), provider_session(nullptr), output(output), volume(1.0f), pan(0.0f), resample_quality(SoundResampleQuality::linear), looping(looping), playing(false), decoding(false), underrun_count(0), sinc_filter(nullptr), sinc_cutoff(0.0f), end_of_stream(false)
 {
 	volume = soundbuffer.get_volume();
 	pan = soundbuffer.get_pan();
@@ -51,15 +54,15 @@ SoundBuffer_Session_Impl::SoundBuffer_Session_Impl(SoundBuffer &soundbuffer, boo
 	provider_session->set_looping(looping);
 	frequency = provider_session->get_frequency();
 
-	num_buffer_samples = 16*1024;
+	num_buffer_samples = 1024;
 	num_buffer_channels = provider_session->get_num_channels();
-	buffer_position = 0.0;
-	buffer_samples_written = 0;
 
 	float_buffer_data = new float*[num_buffer_channels];
 	for (int i=0; i<num_buffer_channels; i++) float_buffer_data[i] = new float[num_buffer_samples];
+	reset_buffer();
 
-	float_buffer_data_offsetted.resize(num_buffer_channels);
+	decode_ring.init(num_buffer_channels, decode_ring_size);
+	decode_ring_pointers.resize(num_buffer_channels);
 }
 
 SoundBuffer_Session_Impl::~SoundBuffer_Session_Impl()
@@ -71,124 +74,249 @@ SoundBuffer_Session_Impl::~SoundBuffer_Session_Impl()
 
 	for (int j=0; j < num_buffer_channels; ++j) delete[] float_buffer_data[j];
 	delete[] float_buffer_data;
+	SoundSSE::aligned_free(sinc_filter);
 }
 
 /////////////////////////////////////////////////////////////////////////////
 // SoundBuffer_Session_Impl attributes:
 
+bool SoundBuffer_Session_Impl::needs_decoding() const
+{
+	return !end_of_stream.load(std::memory_order_relaxed) && decode_ring.get_write_available() >= decode_chunk_size;
+}
+
+int SoundBuffer_Session_Impl::get_playback_position() const
+{
+	int position = provider_session->get_position() - decode_ring.get_read_available();
+	if (position < 0)
+	{
+		// The decoder already looped back to the beginning
+		int length = provider_session->get_num_samples();
+		position = length > 0 ? position + length : 0;
+	}
+	return position;
+}
 
 /////////////////////////////////////////////////////////////////////////////
 // SoundBuffer_Session_Impl operations:
 
 bool SoundBuffer_Session_Impl::mix_to(float **sample_data, float **temp_data, int num_samples, int num_channels)
 {
-	std::unique_lock<std::recursive_mutex> mutex_lock(mutex);
+	std::unique_lock<std::mutex> filter_lock(filter_mutex);
+	apply_flush();
 	get_data_in_mixer_frequency(num_samples, temp_data);
 	run_filters(temp_data, num_samples);
 	mix_channels(num_channels, num_samples, sample_data, temp_data);
 	return playing;
 }
 
-/////////////////////////////////////////////////////////////////////////////
-// SoundBuffer_Session_Impl implementation:
-
-void SoundBuffer_Session_Impl::get_data()
+void SoundBuffer_Session_Impl::decode_ahead(int max_samples)
 {
+	std::unique_lock<std::recursive_mutex> mutex_lock(mutex);
+	if (end_of_stream.load(std::memory_order_relaxed))
+		return;
+
 	int num_session_channels = provider_session->get_num_channels();
 	if (num_session_channels != num_buffer_channels)
 	{
 		log_event("mixer", "Number of session channels does not match the number of buffers");
+		end_of_stream.store(true, std::memory_order_release);
 		return;
 	}
 
-	if (num_session_channels > 0)
+	// Copy stream data to the decode-ahead ring:
+	int samples_left = max_samples;
+	while (samples_left > 0)
 	{
-		// Copy stream data to working buffer:
-		int samples_left = num_buffer_samples;
-		while (samples_left > 0)
-		{
-			for (int i = 0; i < num_session_channels; i++)
-				float_buffer_data_offsetted[i] = float_buffer_data[i] + num_buffer_samples - samples_left;
+		int samples_available = decode_ring.begin_write(&decode_ring_pointers[0], samples_left);
+		if (samples_available == 0)
+			break;
 
-			int written = provider_session->get_data(&float_buffer_data_offsetted[0], samples_left);
-			samples_left -= written;
+		int written = provider_session->get_data(&decode_ring_pointers[0], samples_available);
+		decode_ring.end_write(written);
+		samples_left -= written;
 
-			if (samples_left > 0 && provider_session->eof())
+		if (written < samples_available && provider_session->eof())
+		{
+			// Reached end of stream, loop if enabled.
+			// Try to loop back to beginning, stop playing if it fails.
+			if (looping && provider_session->set_position(0))
 			{
-				// Reached end of stream, loop if enabled.
-				if (looping)
-				{
-					// Try to loop back to beginning:
-					if (provider_session->set_position(0) == false)
-					{
-						// It failed. Stop playing then.
-						break;
-					}
-
-					// Start playing again if it stopped by reaching eof.
-					provider_session->play();
-				}
-				else
-				{
-					break;
-				}
+				// Start playing again if it stopped by reaching eof.
+				provider_session->play();
 			}
-			else if (written == 0)
+			else
 			{
-				// No more data to get from provider for some reason.
+				end_of_stream.store(true, std::memory_order_release);
 				break;
 			}
 		}
+		else if (written == 0)
+		{
+			// No more data to get from provider for some reason.
+			break;
+		}
+	}
+}
 
-		buffer_samples_written = num_buffer_samples - samples_left;
+void SoundBuffer_Session_Impl::flush_decoded()
+{
+	decode_ring.request_flush();
+	end_of_stream.store(false, std::memory_order_release);
+}
+
+void SoundBuffer_Session_Impl::resume_decoding()
+{
+	end_of_stream.store(false, std::memory_order_release);
+}
+
+void SoundBuffer_Session_Impl::apply_flush()
+{
+	if (decode_ring.apply_flush())
+		reset_buffer();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// SoundBuffer_Session_Impl implementation:
+
+bool SoundBuffer_Session_Impl::get_data()
+{
+	// Move the samples the filters still need to the front:
+	int keep_from = int(buffer_position) - resample_history;
+	if (keep_from > 0)
+	{
+		int keep = buffer_samples_written - keep_from;
+		for (int chan = 0; chan < num_buffer_channels; chan++)
+			memmove(float_buffer_data[chan], float_buffer_data[chan] + keep_from, sizeof(float) * keep);
+		buffer_position -= keep_from;
+		buffer_samples_written = keep;
+	}
+
+	// The end of stream flag must be read first, it is set after the last samples were written.
+	bool stream_ended = end_of_stream.load(std::memory_order_acquire);
+	int samples_read = decode_ring.read(float_buffer_data, buffer_samples_written, num_buffer_samples - buffer_samples_written);
+	buffer_samples_written += samples_read;
+	if (samples_read > 0)
+		return true;
+
+	if (stream_ended)
+	{
+		if (!end_padded)
+		{
+			for (int chan = 0; chan < num_buffer_channels; chan++)
+				SoundSSE::set_float(float_buffer_data[chan] + buffer_samples_written, resample_lookahead, 0.0f);
+			buffer_samples_written += resample_lookahead;
+			end_padded = true;
+			return true;
+		}
+		playing = false;
+	}
+	else
+	{
+		underrun_count++;
 	}
+	return false;
+}
+
+void SoundBuffer_Session_Impl::reset_buffer()
+{
+	for (int chan = 0; chan < num_buffer_channels; chan++)
+		SoundSSE::set_float(float_buffer_data[chan], resample_history, 0.0f);
+	buffer_position = resample_history;
+	buffer_samples_written = resample_history;
+	end_padded = false;
 }
 
 void SoundBuffer_Session_Impl::get_data_in_mixer_frequency(int num_samples, float **temp_data)
 {
 	// Convert from session frequency to mixer frequency:
-	// This is done by copying data from the temporary session buffers (buffer_data) to
-	// the temporary mixing buffers (temp_data), and if buffer_data is exhausted, calling
-	// get_data() to fill it with new data from the soundprovider session object.
+	// This is done by resampling whole blocks from the temporary session buffers (float_buffer_data)
+	// to the temporary mixing buffers (temp_data), and if float_buffer_data is exhausted, calling
+	// get_data() to fill it with new data decoded ahead by the decoder workers.
 	double speed = frequency / double(output.get_mixing_frequency());
-	int sample_count;
-	for (sample_count = 0; sample_count < num_samples; sample_count++)
+
+	// The lookahead limits how far a single output sample may step
+	speed = clamp(speed, 1.0 / 1024.0, double(resample_lookahead));
+
+	// The quality may be changed by other threads while mixing, so it is only read once
+	SoundResampleQuality quality = resample_quality.load(std::memory_order_relaxed);
+	if (quality == SoundResampleQuality::sinc)
+		update_sinc_filter(speed);
+
+	int sample_count = 0;
+	while (sample_count < num_samples)
 	{
-		if (buffer_position < buffer_samples_written)
+		// Number of samples that can be produced before the filters need samples beyond the buffered ones
+		double end_position = buffer_samples_written - resample_lookahead;
+		int block_size = 0;
+		if (buffer_position < end_position)
 		{
-			for (int chan = 0; chan < num_buffer_channels; chan++)
-			{
-				temp_data[chan][sample_count] = float_buffer_data[chan][int(buffer_position)];
-			}
+			block_size = int(std::ceil((end_position - buffer_position) / speed));
+			if (buffer_position + (block_size - 1) * speed >= end_position)
+				block_size--;
 		}
-		else
-		{
-			if (provider_session->eof())
-			{
-				playing = false;
-				break;
-			}
+		block_size = min(block_size, num_samples - sample_count);
 
-			// Out of data, get more from provider:
-			buffer_position -= buffer_samples_written;
-			get_data();
-			sample_count--;
-			continue;
+		if (block_size > 0)
+		{
+			resample(quality, speed, block_size, temp_data, sample_count);
+			buffer_position += block_size * speed;
+			sample_count += block_size;
+		}
+		else if (!get_data())
+		{
+			break;
 		}
-
-		buffer_position += speed;
 	}
 
 	// Clear the remaining samples (if any)
-	for (; sample_count < num_samples; sample_count++)
+	for (int chan = 0; chan < num_buffer_channels; chan++)
+		SoundSSE::set_float(temp_data[chan] + sample_count, num_samples - sample_count, 0.0f);
+}
+
+void SoundBuffer_Session_Impl::resample(SoundResampleQuality quality, double speed, int size, float **temp_data, int offset)
+{
+	for (int chan = 0; chan < num_buffer_channels; chan++)
 	{
-		for (int chan = 0; chan < num_buffer_channels; chan++)
+		float *input = float_buffer_data[chan];
+		float *output = temp_data[chan] + offset;
+		if (speed == 1.0 && buffer_position == std::floor(buffer_position))
+		{
+			SoundSSE::copy_float(input + int(buffer_position), size, output);
+		}
+		else
 		{
-			temp_data[chan][sample_count] = 0.0f;
+			switch (quality)
+			{
+			default:
+			case SoundResampleQuality::linear:
+				SoundSSE::resample_linear(input, buffer_position, speed, size, output);
+				break;
+			case SoundResampleQuality::cubic:
+				SoundSSE::resample_cubic(input, buffer_position, speed, size, output);
+				break;
+			case SoundResampleQuality::sinc:
+				SoundSSE::resample_sinc(input, buffer_position, speed, size, sinc_filter, sinc_phases, output);
+				break;
+			}
 		}
 	}
 }
 
+void SoundBuffer_Session_Impl::update_sinc_filter(double speed)
+{
+	// Lower the cutoff when the pitch is raised, so frequencies above the mixer's Nyquist frequency are filtered out.
+	// Quantized, so gliding frequencies do not rebuild the table for every fragment.
+	float cutoff = float(std::floor(0.95 * min(1.0, 1.0 / speed) * 64.0) / 64.0);
+	if (sinc_filter && cutoff == sinc_cutoff)
+		return;
+
+	if (!sinc_filter)
+		sinc_filter = (float *)SoundSSE::aligned_alloc(sizeof(float) * (sinc_phases + 1) * SoundSSE::sinc_taps);
+	SoundSSE::build_sinc_filter(sinc_filter, sinc_phases, cutoff);
+	sinc_cutoff = cutoff;
+}
+
 void SoundBuffer_Session_Impl::run_filters(float **temp_data, int num_samples)
 {
 	for (auto & elem : filters)
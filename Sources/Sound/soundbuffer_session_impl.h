@@ -32,6 +32,9 @@
 #include "API/Sound/soundformat.h"
 #include "API/Sound/soundoutput.h"
 #include "API/Sound/soundbuffer.h"
+#include "API/Sound/soundbuffer_session.h"
+#include "sound_ring_buffer.h"
+#include <atomic>
 #include <memory>
 #include <mutex>
 
@@ -68,11 +71,23 @@ public:
 	float volume;
 	float frequency;
 	float pan;
+	std::atomic<SoundResampleQuality> resample_quality;
 	bool looping;
-	bool playing;
+	std::atomic_bool playing;
 	std::vector<SoundFilter> filters;
+
+	/// \brief Guards the provider session. Held by decoder workers while they decode.
 	mutable std::recursive_mutex mutex;
 
+	/// \brief Guards the filters. Held by the mixer while it mixes this session.
+	std::mutex filter_mutex;
+
+	/// \brief True while a decoder worker has claimed this session
+	std::atomic_bool decoding;
+
+	/// \brief Number of times the mixer ran out of decoded samples
+	std::atomic_int underrun_count;
+
 
 /// \}
 /// \name Operations
@@ -81,6 +96,43 @@ public:
 public:
 	bool mix_to(float **sample_data, float **temp_data, int num_samples, int num_channels);
 
+	/// \brief Decodes up to max_samples from the provider into the decode-ahead ring
+	void decode_ahead(int max_samples = decode_chunk_size);
+
+	/// \brief Returns true if the decode-ahead ring has room for another chunk
+	bool needs_decoding() const;
+
+	/// \brief Discards decoded samples after the provider position changed. Must be called with mutex locked.
+	void flush_decoded();
+
+	/// \brief Allows decoding to continue after the end of the stream was reached (looping was enabled)
+	void resume_decoding();
+
+	/// \brief Drops flushed samples from the decode-ahead ring. Only the mixer, or the owner of a stopped session, may call this.
+	void apply_flush();
+
+	/// \brief Returns the provider position minus the samples decoded but not yet played
+	int get_playback_position() const;
+
+	enum
+	{
+		decode_ring_size = 32 * 1024,
+		decode_chunk_size = 4 * 1024,
+		prefill_size = 8 * 1024
+	};
+
+	enum
+	{
+		/// \brief Samples kept in front of the resampling position for the filters
+		resample_history = 8,
+
+		/// \brief Samples needed after the resampling position by the filters
+		resample_lookahead = 8,
+
+		/// \brief Number of phases in the sinc filter table
+		sinc_phases = 256
+	};
+
 /// \}
 /// \name Implementation
 /// \{
@@ -95,16 +147,27 @@ private:
 	/// \brief Reads data into temp_data in the mixers native frequency
 	void get_data_in_mixer_frequency( int num_samples, float **temp_data );
 
+	/// \brief Resamples a block of size samples for all channels, starting at buffer_position
+	void resample( SoundResampleQuality quality, double speed, int size, float **temp_data, int offset );
+
+	/// \brief Rebuilds the sinc filter if the cutoff needed for this speed changed
+	void update_sinc_filter( double speed );
+
+	/// \brief Empties the temporary buffers, leaving silence as filter history
+	void reset_buffer();
+
 	/// \brief Runs the sample data through attached filters
 	void run_filters( float ** temp_data, int num_samples );
 
-	/// \brief Fills temporary buffers with data from provider.
-	void get_data();
+	/// \brief Fills temporary buffers with data from the decode-ahead ring.
+	/// \return false if there is no more data right now (end of stream or underrun)
+	bool get_data();
 
 	/// \brief Temporary channel buffers containing sound data in provider frequency.
 	float **float_buffer_data;
 
-	std::vector<float*> float_buffer_data_offsetted;
+	/// \brief Write pointers into the decode-ahead ring, used by the decoder.
+	std::vector<float*> decode_ring_pointers;
 
 	/// \brief Size of temporary channel buffers.
 	int num_buffer_samples;
@@ -117,6 +180,21 @@ private:
 
 	/// \brief Number of samples currently written to buffer_data.
 	int buffer_samples_written;
+
+	/// \brief Set when silence was appended after the end of stream, so the filters can play out the last samples.
+	bool end_padded;
+
+	/// \brief Polyphase filter table for SoundResampleQuality::sinc, allocated on first use.
+	float *sinc_filter;
+
+	/// \brief Cutoff the sinc filter table was built for.
+	float sinc_cutoff;
+
+	/// \brief Samples decoded by the workers, waiting to be mixed.
+	SoundRingBuffer decode_ring;
+
+	/// \brief Set by the decoder once the provider has no more data to give.
+	std::atomic_bool end_of_stream;
 /// \}
 };
 
@@ -160,6 +160,11 @@ float SoundOutput::get_global_pan() const
 	return impl->pan;
 }
 
+int SoundOutput::get_underrun_count() const
+{
+	return impl->underrun_count;
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // SoundOutput operations:
 
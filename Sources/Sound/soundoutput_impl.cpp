@@ -44,7 +44,7 @@ SoundOutput_Impl *SoundOutput_Impl::instance = nullptr;
 
 SoundOutput_Impl::SoundOutput_Impl(int mixing_frequency, int latency)
 : mixing_frequency(mixing_frequency), mixing_latency(latency), volume(1.0f),
-  pan(0.0f), mix_buffer_size(0)
+  pan(0.0f), underrun_count(0), mix_buffer_size(0)
 {
  	mix_buffers[0] = nullptr;
 	mix_buffers[1] = nullptr;
@@ -82,6 +82,7 @@ void SoundOutput_Impl::play_session(SoundBuffer_Session &session)
 {
 	std::unique_lock<std::recursive_mutex> mutex_lock(mutex);
 	sessions.push_back(session);
+	decoder_pool.add_session(session.impl);
 }
 
 void SoundOutput_Impl::stop_session(SoundBuffer_Session &session)
@@ -93,6 +94,7 @@ void SoundOutput_Impl::stop_session(SoundBuffer_Session &session)
 		if (session.impl.get() == it->impl.get())
 		{
 			sessions.erase(it);
+			decoder_pool.remove_session(session.impl.get());
 			break;
 		}
 	}
@@ -100,6 +102,7 @@ void SoundOutput_Impl::stop_session(SoundBuffer_Session &session)
 
 void SoundOutput_Impl::start_mixer_thread()
 {
+	decoder_pool.start();
 	stop_flag = false;
 	thread = std::thread(&SoundOutput_Impl::mixer_thread, this);
 //	thread.set_priority(cl_priority_highest);
@@ -112,6 +115,7 @@ void SoundOutput_Impl::stop_mixer_thread()
 	mutex_lock.unlock();
 	thread.join();
 	thread = std::thread();
+	decoder_pool.stop();
 }
 
 void SoundOutput_Impl::mix_fragment()
@@ -190,10 +194,15 @@ void SoundOutput_Impl::fill_mix_buffers()
 	for (it = sessions.begin(); it != sessions.end(); ++it)
 	{
 		SoundBuffer_Session session = *it;
+		int session_underruns = session.impl->underrun_count;
 		bool playing = session.impl->mix_to(mix_buffers, temp_buffers, mix_buffer_size, 2);
+		underrun_count += session.impl->underrun_count - session_underruns;
 		if (!playing) ended_sessions.push_back(session);
 	}
 
+	// Let the decoder workers top up what was just consumed:
+	decoder_pool.notify();
+
 	// Release any sessions pending for removal:
 	int size_ended_sessions = ended_sessions.size();
 	for (int i = 0; i < size_ended_sessions; i++) stop_session(ended_sessions[i]);
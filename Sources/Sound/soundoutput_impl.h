@@ -34,6 +34,7 @@
 #include <mutex>
 #include <thread>
 #include <atomic>
+#include "sound_decoder_pool.h"
 
 namespace clan
 {
@@ -60,6 +61,8 @@ namespace clan
 		std::thread thread;
 		std::atomic_bool stop_flag;
 		std::vector< SoundBuffer_Session > sessions;
+		SoundDecoderPool decoder_pool;
+		std::atomic_int underrun_count;
 
 		int mix_buffer_size;
 		float *mix_buffers[2];
@@ -85,10 +88,10 @@ namespace clan
 		/// \brief Called by the mixer thread when it stops
 		virtual void mixer_thread_stopping() { }
 
-		/// \brief Starts a thread and call mix_fragment() and wait() continueously.
+		/// \brief Starts the decoder workers and a thread calling mix_fragment() and wait() continueously.
 		void start_mixer_thread();
 
-		/// \brief Stops the mixer thread.
+		/// \brief Stops the mixer thread and the decoder workers.
 		void stop_mixer_thread();
 
 		/// \brief Mixes a single fragment and stores the result in stereo_buffer.
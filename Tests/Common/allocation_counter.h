@@ -0,0 +1,84 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#pragma once
+
+// Counts heap allocations made by the whole test program while count_allocations is set.
+// Replaces the global allocation functions, so it must only be included by one source file of a test program.
+
+#include <atomic>
+#include <new>
+#include <cstdlib>
+#include <cstdint>
+
+static std::atomic_bool count_allocations(false);
+static std::atomic_int num_allocations(0);
+static std::atomic<int64_t> num_allocated_bytes(0);
+
+static void *counted_allocation(std::size_t size)
+{
+	if (count_allocations)
+	{
+		num_allocations++;
+		num_allocated_bytes += size;
+	}
+	void *data = std::malloc(size ? size : 1);
+	if (!data)
+		throw std::bad_alloc();
+	return data;
+}
+
+void *operator new(std::size_t size)
+{
+	return counted_allocation(size);
+}
+
+void *operator new[](std::size_t size)
+{
+	return counted_allocation(size);
+}
+
+void operator delete(void *data) throw()
+{
+	std::free(data);
+}
+
+void operator delete[](void *data) throw()
+{
+	std::free(data);
+}
+
+void operator delete(void *data, std::size_t) throw()
+{
+	std::free(data);
+}
+
+void operator delete[](void *data, std::size_t) throw()
+{
+	std::free(data);
+}
@@ -94,6 +94,7 @@ int TestApp::main(const std::vector<std::string> &args)
 		test_directory_scanner();
 		test_iodevice();
 		test_iodevice_memory();
+		test_iodevice_mapped_file();
 		test_virtual_directory_part2();
 		
 		Console::write_line("All Tests Complete");
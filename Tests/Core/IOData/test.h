@@ -67,6 +67,7 @@ private:
 	void test_datatypes(void);
 	void test_directory_scanner(void);
 	void test_iodevice_memory(void);
+	void test_iodevice_mapped_file(void);
 	void test_iodevice(void);
 	void test_virtual_directory_part2(void);
 	void fail(void);
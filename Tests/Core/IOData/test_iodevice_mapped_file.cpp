@@ -0,0 +1,121 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+**    (if your name is missing here, please add it)
+*/
+
+#include "test.h"
+
+void TestApp::test_iodevice_mapped_file(void)
+{
+	Console::write_line(" Header: mapped_file.h");
+	Console::write_line("  Class: MappedFile");
+
+	const int test_data_size = 256;
+	char test_data[test_data_size];
+	char test_data2[test_data_size];
+	for (int cnt=0; cnt<test_data_size; cnt++)
+	{
+		test_data[cnt] = cnt;
+	}
+
+	std::string filename = "test_mapped_file.bin";
+	File::write_bytes(filename, DataBuffer(test_data, test_data_size));
+
+	MappedFile file(filename);
+
+//*** testing get_mapped_span()
+	Console::write_line("   Function: MappedSpan get_mapped_span()");
+	MappedSpan span = file.get_mapped_span();
+	if (span.is_null()) fail();
+	if (span.get_size() != test_data_size) fail();
+	if (memcmp(span.get_data(), test_data, test_data_size)) fail();
+
+	File regular_file(filename);
+	if (!regular_file.get_mapped_span().is_null()) fail();
+	regular_file.close();
+
+	DataBuffer memory_data(test_data, test_data_size);
+	MemoryDevice mem(memory_data);
+	if (mem.get_mapped_span().get_data() != memory_data.get_data()) fail();
+
+//*** testing get_size()
+	Console::write_line("   Function: int get_size()");
+	if (file.get_size() != test_data_size) fail();
+
+//*** testing int receive()
+	Console::write_line("   Function: int receive(void *data, int len, bool receive_all = true)");
+	memset(test_data2, 0, sizeof(test_data2));
+	if (file.receive(test_data2, 100, true) != 100) fail();
+	if (memcmp(test_data2, test_data, 100)) fail();
+	if (file.get_position() != 100) fail();
+	if (file.receive(test_data2, test_data_size, true) != test_data_size - 100) fail();
+	if (memcmp(test_data2, test_data + 100, test_data_size - 100)) fail();
+	if (file.receive(test_data2, 1, true) != 0) fail();
+
+//*** testing int peek()
+	Console::write_line("   Function: int peek(void *data, int len)");
+	file.seek(10);
+	if (file.peek(test_data2, 5) != 5) fail();
+	if (memcmp(test_data2, test_data + 10, 5)) fail();
+	if (file.get_position() != 10) fail();
+
+//*** testing int seek()
+	Console::write_line("   Function: bool seek(int position, SeekMode mode = seek_set)");
+	if (!file.seek(7, IODevice::seek_cur)) fail();
+	if (file.get_position() != 17) fail();
+	if (!file.seek(-7, IODevice::seek_end)) fail();
+	if (file.get_position() != test_data_size - 7) fail();
+	if (file.seek(-1)) fail();
+	if (file.seek(test_data_size + 1)) fail();
+
+//*** testing int send()
+	Console::write_line("   Function: int send(const void *data, int len, bool send_all = true)");
+	bool exception_caught = false;
+	try
+	{
+		file.send(test_data, 1);
+	}
+	catch (Exception &)
+	{
+		exception_caught = true;
+	}
+	if (!exception_caught) fail();
+
+//*** testing duplicate()
+	Console::write_line("   Function: IODevice duplicate()");
+	IODevice copy = file.duplicate();
+	if (copy.get_mapped_span().get_data() != span.get_data()) fail();
+	if (copy.get_position() != 0) fail();
+
+//*** testing empty files
+	Console::write_line("   Function: MappedFile(const std::string &filename) with an empty file");
+	File::write_bytes(filename, DataBuffer());
+	MappedFile empty_file(filename);
+	if (empty_file.get_size() != 0) fail();
+	if (empty_file.get_mapped_span().is_null()) fail();
+	if (empty_file.receive(test_data2, 1) != 0) fail();
+}
@@ -0,0 +1,321 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include <ClanLib/core.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+using namespace clan;
+
+// Collects everything passed to it by log_event
+class TestLogger : public Logger
+{
+public:
+	TestLogger(int batch_delay = 0) : batch_delay(batch_delay), num_batches(0) { }
+
+	void log(const std::string &type, const std::string &text) override
+	{
+		types.push_back(type);
+		texts.push_back(text);
+	}
+
+	void log_batch(const std::vector<LogMessage> &messages) override
+	{
+		num_batches++;
+		if (batch_delay > 0)
+			System::sleep(batch_delay);
+		for (auto &message : messages)
+			log(message.type, message.text);
+	}
+
+	int batch_delay;
+	int num_batches;
+	std::vector<std::string> types;
+	std::vector<std::string> texts;
+};
+
+bool test_formatting();
+bool test_multiple_producers();
+bool test_drop_policy();
+bool test_async_timestamps();
+void run_latency_benchmark(bool async);
+
+int main(int, char**)
+{
+	try
+	{
+		bool passed = true;
+		if (!test_formatting())
+			passed = false;
+		if (!test_multiple_producers())
+			passed = false;
+		if (!test_drop_policy())
+			passed = false;
+		if (!test_async_timestamps())
+			passed = false;
+		run_latency_benchmark(false);
+		run_latency_benchmark(true);
+		Console::write_line(passed ? "Logger test passed" : "Logger test FAILED");
+		return passed ? 0 : 1;
+	}
+	catch (Exception e)
+	{
+		Console::write_line(e.message);
+		return 1;
+	}
+}
+
+class FormatTestLogger : public Logger
+{
+public:
+	void log(const std::string &type, const std::string &text) override
+	{
+		std::string line;
+		append_log_string(line, DateTime(2004, 11, 16, 9, 4, 5, 0), type, text);
+		lines.push_back(line);
+		lines.push_back(get_log_string(type, text).get_result());
+	}
+
+	std::vector<std::string> lines;
+};
+
+bool test_formatting()
+{
+	Console::write_line("Formatting:");
+	bool passed = true;
+
+	FormatTestLogger logger;
+	log_event("info", "hello %1", 42);
+	logger.disable();
+
+#ifdef WIN32
+	std::string newline = "\r\n";
+#else
+	std::string newline = "\n";
+#endif
+	if (logger.lines.size() != 2 || logger.lines[0] != "Tue Nov 16 09:04:05 2004 UTC [info] hello 42" + newline)
+	{
+		Console::write_line("  append_log_string produced an unexpected line");
+		passed = false;
+	}
+	else if (logger.lines[1].length() != logger.lines[0].length() || logger.lines[1].substr(24) != logger.lines[0].substr(24))
+	{
+		Console::write_line("  get_log_string and append_log_string differ");
+		passed = false;
+	}
+	return passed;
+}
+
+bool test_multiple_producers()
+{
+	Console::write_line("Multiple producers:");
+	bool passed = true;
+
+	const int num_threads = 4;
+	const int messages_per_thread = 20000;
+
+	TestLogger logger;
+	Logger::start_async(1024, LogQueuePolicy::block);
+
+	std::vector<std::thread> threads;
+	for (int i = 0; i < num_threads; i++)
+	{
+		threads.push_back(std::thread([i]()
+		{
+			std::string type = string_format("thread%1", i);
+			for (int j = 0; j < messages_per_thread; j++)
+				log_event(type, StringHelp::int_to_text(j));
+		}));
+	}
+	for (auto &thread : threads)
+		thread.join();
+
+	Logger::flush();
+	size_t flushed_count = logger.texts.size();
+	Logger::stop_async();
+	logger.disable();
+
+	if (flushed_count != num_threads * messages_per_thread || logger.texts.size() != flushed_count)
+	{
+		Console::write_line("  Expected %1 messages, got %2", num_threads * messages_per_thread, (int)logger.texts.size());
+		passed = false;
+	}
+	if (Logger::get_dropped_count() != 0)
+	{
+		Console::write_line("  Messages dropped with the block policy");
+		passed = false;
+	}
+
+	// Messages from each thread must arrive in the order they were logged
+	std::vector<int> next_value(num_threads, 0);
+	for (size_t i = 0; i < logger.texts.size() && passed; i++)
+	{
+		int thread_index = StringHelp::text_to_int(logger.types[i].substr(6));
+		if (StringHelp::text_to_int(logger.texts[i]) != next_value[thread_index]++)
+		{
+			Console::write_line("  Messages from thread %1 arrived out of order", thread_index);
+			passed = false;
+		}
+	}
+
+	Console::write_line("  %1 messages in %2 batches", (int)logger.texts.size(), logger.num_batches);
+	return passed;
+}
+
+bool test_drop_policy()
+{
+	Console::write_line("Drop policy:");
+	bool passed = true;
+
+	const int num_messages = 2000;
+
+	TestLogger logger(2);
+	uint64_t dropped_before = Logger::get_dropped_count();
+	Logger::start_async(16, LogQueuePolicy::drop);
+
+	uint64_t max_time = 0;
+	for (int i = 0; i < num_messages; i++)
+	{
+		uint64_t start_time = System::get_microseconds();
+		log_event("drop", "message");
+		max_time = max(max_time, System::get_microseconds() - start_time);
+	}
+
+	Logger::stop_async();
+	logger.disable();
+
+	int dropped = (int)(Logger::get_dropped_count() - dropped_before);
+	int written = 0;
+	bool dropped_reported = false;
+	for (size_t i = 0; i < logger.types.size(); i++)
+	{
+		if (logger.types[i] == "drop")
+			written++;
+		else if (logger.types[i] == "log")
+			dropped_reported = true;
+	}
+
+	if (dropped == 0 || written + dropped != num_messages)
+	{
+		Console::write_line("  Expected written + dropped to be %1, got %2 + %3", num_messages, written, dropped);
+		passed = false;
+	}
+	if (!dropped_reported)
+	{
+		Console::write_line("  Dropped messages were not reported");
+		passed = false;
+	}
+
+	Console::write_line("  %1 written, %2 dropped, slowest log_event took %3 us", written, dropped, (int)max_time);
+	return passed;
+}
+
+// Only implements the timed log(), relying on the default log_batch
+class TimeTestLogger : public Logger
+{
+public:
+	void log(const std::string &type, const std::string &text) override
+	{
+		log(DateTime::get_current_utc_time(), type, text);
+	}
+
+	void log(const DateTime &time, const std::string &type, const std::string &text) override
+	{
+		times.push_back(time);
+	}
+
+	std::vector<DateTime> times;
+};
+
+bool test_async_timestamps()
+{
+	Console::write_line("Async timestamps:");
+	bool passed = true;
+
+	// Enabled first, so the logger thread only reaches the time logger after this one's slow batch
+	TestLogger slow_logger(2500);
+	TimeTestLogger logger;
+	Logger::start_async(16, LogQueuePolicy::block);
+
+	int64_t start_ticks = DateTime::get_current_utc_time().to_ticks();
+	log_event("time", "message");
+	Logger::stop_async();
+	log_event("time", "message");
+	int64_t end_ticks = DateTime::get_current_utc_time().to_ticks();
+
+	slow_logger.disable();
+	logger.disable();
+
+	// One second is 10 million ticks. The logged times may only have a resolution of seconds
+	if (logger.times.size() != 2)
+	{
+		Console::write_line("  Expected 2 messages, got %1", (int)logger.times.size());
+		passed = false;
+	}
+	else if (logger.times[0].to_ticks() - start_ticks > 10000000)
+	{
+		Console::write_line("  Async message was stamped when it was written, not when it was logged");
+		passed = false;
+	}
+	else if (end_ticks - logger.times[1].to_ticks() > 10000000)
+	{
+		Console::write_line("  Sync message was not stamped when it was logged");
+		passed = false;
+	}
+	return passed;
+}
+
+void run_latency_benchmark(bool async)
+{
+	const int num_messages = 100000;
+
+	std::string type = "bench";
+	std::string text = "Mixer thread reporting buffer position 1234567";
+
+	FileLogger logger("logger_benchmark.log");
+	if (async)
+		Logger::start_async(num_messages, LogQueuePolicy::drop);
+
+	uint64_t max_time = 0;
+	uint64_t start_time = System::get_microseconds();
+	for (int i = 0; i < num_messages; i++)
+	{
+		uint64_t call_start = System::get_microseconds();
+		log_event(type, text);
+		max_time = max(max_time, System::get_microseconds() - call_start);
+	}
+	uint64_t total_time = System::get_microseconds() - start_time;
+
+	if (async)
+		Logger::stop_async();
+	uint64_t write_time = System::get_microseconds() - start_time;
+
+	Console::write_line("%1 log_event: %2 ns/call, slowest call %3 us, %4 ms until written",
+		async ? "Async:" : "Sync: ", (int)(total_time * 1000 / num_messages), (int)max_time, (int)(write_time / 1000));
+}
@@ -0,0 +1,230 @@
+#include <ClanLib/core.h>
+#include <atomic>
+#include "../../Common/allocation_counter.h"
+
+using namespace clan;
+
+// Emits the way Signal did before, by copying the slot list and locking each slot
+template<typename FuncType>
+class CopyingSignal
+{
+public:
+	CopyingSignal() : slots(std::make_shared<std::vector<std::weak_ptr<std::function<FuncType>>>>()) { }
+
+	template<typename... Args>
+	void operator()(Args... args)
+	{
+		std::vector<std::weak_ptr<std::function<FuncType>>> slots_copy = *slots;
+		for (auto &weak_slot : slots_copy)
+		{
+			std::shared_ptr<std::function<FuncType>> slot = weak_slot.lock();
+			if (slot)
+				(*slot)(args...);
+		}
+	}
+
+	std::shared_ptr<std::function<FuncType>> connect(const std::function<FuncType> &func)
+	{
+		auto slot = std::make_shared<std::function<FuncType>>(func);
+		slots->push_back(slot);
+		return slot;
+	}
+
+private:
+	std::shared_ptr<std::vector<std::weak_ptr<std::function<FuncType>>>> slots;
+};
+
+bool test_signal();
+void run_emit_benchmark(int num_slots);
+
+int main(int, char**)
+{
+	try
+	{
+		bool passed = test_signal();
+		run_emit_benchmark(1);
+		run_emit_benchmark(10);
+		Console::write_line(passed ? "Signal test passed" : "Signal test FAILED");
+		return passed ? 0 : 1;
+	}
+	catch (Exception e)
+	{
+		Console::write_line(e.message);
+		return 1;
+	}
+}
+
+bool test_signal()
+{
+	Console::write_line("Signal:");
+	bool passed = true;
+
+	// Basic emit and disconnect
+	{
+		Signal<void(int)> signal;
+		int sum = 0;
+		Slot slot1 = signal.connect([&](int value) { sum += value; });
+		Slot slot2 = signal.connect([&](int value) { sum += value * 10; });
+		signal(1);
+		slot1 = Slot();
+		signal(2);
+		if (sum != 11 + 20)
+			passed = false;
+	}
+
+	// A callback disconnecting itself and a slot later in the list
+	{
+		Signal<void()> signal;
+		Slot slot1, slot2, slot3;
+		int calls1 = 0, calls2 = 0, calls3 = 0;
+		slot1 = signal.connect([&]() { calls1++; slot1 = Slot(); slot3 = Slot(); });
+		slot2 = signal.connect([&]() { calls2++; });
+		slot3 = signal.connect([&]() { calls3++; });
+		signal();
+		signal();
+		if (calls1 != 1 || calls2 != 2 || calls3 != 0)
+			passed = false;
+	}
+
+	// Slots connected during an emit are first called by the next emit
+	{
+		Signal<void()> signal;
+		std::vector<Slot> slots;
+		int calls = 0;
+		slots.push_back(signal.connect([&]() { calls++; if (slots.size() < 100) slots.push_back(signal.connect([&]() { calls++; })); }));
+		signal();
+		if (calls != 1)
+			passed = false;
+		signal();
+		if (calls != 1 + 2)
+			passed = false;
+	}
+
+	// Recursive emit and disconnect in the inner emit
+	{
+		Signal<void(int)> signal;
+		Slot slot1, slot2;
+		int calls2 = 0;
+		slot1 = signal.connect([&](int depth) { if (depth == 0) signal(1); else slot2 = Slot(); });
+		slot2 = signal.connect([&](int) { calls2++; });
+		signal(0);
+		if (calls2 != 0)
+			passed = false;
+	}
+
+	// A callback destroying the signal
+	{
+		std::unique_ptr<Signal<void()>> signal(new Signal<void()>());
+		int calls = 0;
+		Slot slot1 = signal->connect([&]() { calls++; signal.reset(); });
+		Slot slot2 = signal->connect([&]() { calls++; });
+		(*signal)();
+		if (calls != 2 || signal)
+			passed = false;
+	}
+
+	// Slots outliving the signal and exceptions thrown by a callback
+	{
+		Slot slot;
+		{
+			Signal<void()> signal;
+			slot = signal.connect([]() { throw Exception("callback"); });
+			bool exception_caught = false;
+			try
+			{
+				signal();
+			}
+			catch (Exception &)
+			{
+				exception_caught = true;
+			}
+			slot = Slot();
+			signal();
+			Slot slot2 = signal.connect([]() { });
+			slot = slot2;
+			if (!exception_caught)
+				passed = false;
+		}
+	}
+
+	// SlotContainer and member functions
+	{
+		class Receiver
+		{
+		public:
+			void on_value(int value) { sum += value; }
+			int sum = 0;
+		};
+
+		Signal<void(int)> signal;
+		Receiver receiver;
+		SlotContainer slots;
+		slots.connect(signal, &receiver, &Receiver::on_value);
+		signal(5);
+		if (receiver.sum != 5)
+			passed = false;
+	}
+
+	// Emitting does not allocate
+	{
+		Signal<void(int, const std::string &)> signal;
+		std::vector<Slot> slots;
+		int sum = 0;
+		for (int i = 0; i < 10; i++)
+			slots.push_back(signal.connect([&](int value, const std::string &) { sum += value; }));
+		std::string text = "a string argument that does not fit the small string buffer";
+
+		num_allocations = 0;
+		count_allocations = true;
+		for (int i = 0; i < 1000; i++)
+			signal(1, text);
+		count_allocations = false;
+		if (num_allocations != 0 || sum != 10000)
+			passed = false;
+	}
+
+	Console::write_line(passed ? "  passed" : "  FAILED");
+	return passed;
+}
+
+void run_emit_benchmark(int num_slots)
+{
+	const int num_emits = 1000000;
+
+	Console::write_line("Emit benchmark, %1 emits with %2 slot(s):", num_emits, num_slots);
+
+	int sum = 0;
+	Signal<void(int)> signal;
+	CopyingSignal<void(int)> copying_signal;
+	std::vector<Slot> slots;
+	std::vector<std::shared_ptr<std::function<void(int)>>> copying_slots;
+	for (int i = 0; i < num_slots; i++)
+	{
+		slots.push_back(signal.connect([&](int value) { sum += value; }));
+		copying_slots.push_back(copying_signal.connect([&](int value) { sum += value; }));
+	}
+
+	num_allocations = 0;
+	count_allocations = true;
+	uint64_t start_time = System::get_microseconds();
+	for (int i = 0; i < num_emits; i++)
+		copying_signal(1);
+	uint64_t copying_time = System::get_microseconds() - start_time;
+	count_allocations = false;
+	int copying_allocations = num_allocations;
+
+	num_allocations = 0;
+	count_allocations = true;
+	start_time = System::get_microseconds();
+	for (int i = 0; i < num_emits; i++)
+		signal(1);
+	uint64_t signal_time = System::get_microseconds() - start_time;
+	count_allocations = false;
+	int signal_allocations = num_allocations;
+
+	if (sum != num_emits * num_slots * 2)
+		throw Exception("Emit benchmark lost callbacks");
+
+	Console::write_line("  Copying slot list: %1 ns/emit, %2 allocations/emit", (int)(copying_time * 1000 / num_emits), copying_allocations / (double)num_emits);
+	Console::write_line("  Signal:            %1 ns/emit, %2 allocations/emit", (int)(signal_time * 1000 / num_emits), signal_allocations / (double)num_emits);
+}
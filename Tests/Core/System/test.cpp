@@ -68,6 +68,8 @@ int TestApp::main(const std::vector<std::string> &args)
 		Console::write_line("Directory: API/Core/System");
 
 		test_datetime();
+		test_databuffer();
+		test_work_queue();
 		
 		Console::write_line("All Tests Complete");
 		console.display_close_message();
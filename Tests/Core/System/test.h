@@ -72,6 +72,8 @@ public:
 	virtual int main(const std::vector<std::string> &args);
 private:
 	void test_datetime();
+	void test_databuffer();
+	void test_work_queue();
 
 	std::string convert_time(DateTime &datetime);
 	void fail(void);
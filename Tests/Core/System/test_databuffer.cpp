@@ -0,0 +1,116 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Mark Page
+**    (if your name is missing here, please add it)
+*/
+
+#include "test.h"
+
+void TestApp::test_databuffer()
+{
+	Console::write_line(" Header: databuffer.h");
+	Console::write_line("  Class: DataBufferSlice");
+
+	DataBuffer buffer("0123456789", 10);
+
+	Console::write_line("   Function: DataBufferSlice()");
+	{
+		DataBufferSlice slice;
+		if (!slice.is_null()) fail();
+		if (slice.get_size() != 0) fail();
+		if (slice.copy().get_size() != 0) fail();
+	}
+
+	Console::write_line("   Function: DataBufferSlice(const DataBuffer &buffer)");
+	{
+		DataBufferSlice slice(buffer);
+		if (slice.get_size() != 10) fail();
+		if (slice.get_position() != 0) fail();
+		if (slice.get_data() != buffer.get_data()) fail();
+	}
+
+	Console::write_line("   Function: DataBufferSlice(const DataBuffer &buffer, unsigned int pos, unsigned int size)");
+	{
+		DataBufferSlice slice(buffer, 2, 5);
+		if (slice.get_size() != 5) fail();
+		if (slice.get_position() != 2) fail();
+		if (slice.get_data() != buffer.get_data() + 2) fail();
+		if (slice[0] != '2' || slice[4] != '6') fail();
+
+		DataBufferSlice empty_end(buffer, 10, 0);
+		if (!empty_end.is_null()) fail();
+
+		bool exception_caught = false;
+		try
+		{
+			DataBufferSlice outside(buffer, 8, 3);
+		}
+		catch (Exception &)
+		{
+			exception_caught = true;
+		}
+		if (!exception_caught) fail();
+	}
+
+	Console::write_line("   Function: DataBufferSlice(const DataBufferSlice &slice, unsigned int pos, unsigned int size)");
+	{
+		DataBufferSlice outer(buffer, 2, 6);
+		DataBufferSlice inner(outer, 1, 3);
+		if (inner.get_position() != 3) fail();
+		if (inner.get_size() != 3) fail();
+		if (inner.get_data() != buffer.get_data() + 3) fail();
+
+		bool exception_caught = false;
+		try
+		{
+			DataBufferSlice outside(outer, 4, 3);
+		}
+		catch (Exception &)
+		{
+			exception_caught = true;
+		}
+		if (!exception_caught) fail();
+	}
+
+	Console::write_line("   Function: copy()");
+	{
+		DataBufferSlice slice(buffer, 4, 3);
+		DataBuffer copy = slice.copy();
+		if (copy.get_size() != 3) fail();
+		if (copy.get_data() == slice.get_data()) fail();
+		if (memcmp(copy.get_data(), "456", 3) != 0) fail();
+	}
+
+	Console::write_line("   Function: slice keeps the storage alive");
+	{
+		DataBufferSlice slice;
+		{
+			DataBuffer temp("abcdef", 6);
+			slice = DataBufferSlice(temp, 1, 4);
+		}
+		if (memcmp(slice.get_data(), "bcde", 4) != 0) fail();
+	}
+}
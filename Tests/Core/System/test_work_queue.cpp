@@ -0,0 +1,300 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+**    (if your name is missing here, please add it)
+*/
+
+#include "test.h"
+#include <atomic>
+#include <thread>
+#include "../../Common/allocation_counter.h"
+
+class MoveOnlyJob
+{
+public:
+	MoveOnlyJob(std::atomic_int &counter) : counter(&counter), value(new int(1)) { }
+	MoveOnlyJob(MoveOnlyJob &&other) : counter(other.counter), value(std::move(other.value)) { }
+
+	void operator()() { *counter += *value; }
+
+private:
+	MoveOnlyJob(const MoveOnlyJob &) = delete;
+	MoveOnlyJob &operator=(const MoveOnlyJob &) = delete;
+
+	std::atomic_int *counter;
+	std::unique_ptr<int> value;
+};
+
+static void wait_for_jobs(WorkQueue &work_queue, std::atomic_int &counter, int count)
+{
+	while (counter.load() != count)
+	{
+		work_queue.process_work_completed();
+		std::this_thread::yield();
+	}
+	while (work_queue.get_items_queued() != 0)
+	{
+		work_queue.process_work_completed();
+		std::this_thread::yield();
+	}
+}
+
+static double benchmark_jobs(bool serial_queue, int num_jobs)
+{
+	WorkQueue work_queue(serial_queue);
+	std::atomic_int counter(0);
+
+	uint64_t start_time = System::get_microseconds();
+	for (int i = 0; i < num_jobs; i++)
+		work_queue.queue([&counter]() { counter++; });
+	wait_for_jobs(work_queue, counter, num_jobs);
+	uint64_t end_time = System::get_microseconds();
+
+	return num_jobs * 1000000.0 / (double)clan::max(end_time - start_time, (uint64_t)1);
+}
+
+void TestApp::test_work_queue()
+{
+	Console::write_line(" Header: work_queue.h");
+	Console::write_line("  Class: WorkQueue");
+
+	Console::write_line("   Function: queue(const std::function<void()> &)");
+	{
+		WorkQueue work_queue;
+		std::atomic_int counter(0);
+		for (int i = 0; i < 10000; i++)
+			work_queue.queue([&counter]() { counter++; });
+		wait_for_jobs(work_queue, counter, 10000);
+	}
+
+	Console::write_line("   Function: queue() from a worker thread");
+	{
+		WorkQueue work_queue;
+		std::atomic_int counter(0);
+		for (int i = 0; i < 100; i++)
+		{
+			work_queue.queue([&]()
+			{
+				for (int j = 0; j < 100; j++)
+					work_queue.queue([&counter]() { counter++; });
+			});
+		}
+		wait_for_jobs(work_queue, counter, 100 * 100);
+	}
+
+	Console::write_line("   Function: queue() on a serial queue keeps the order");
+	{
+		WorkQueue work_queue(true);
+		std::vector<int> order;
+		std::atomic_int counter(0);
+		for (int i = 0; i < 1000; i++)
+			work_queue.queue([&order, &counter, i]() { order.push_back(i); counter++; });
+		wait_for_jobs(work_queue, counter, 1000);
+		for (int i = 0; i < 1000; i++)
+		{
+			if (order[i] != i) fail();
+		}
+	}
+
+	Console::write_line("   Function: work_completed()");
+	{
+		WorkQueue work_queue;
+		std::atomic_int counter(0);
+		std::thread::id main_thread_id = std::this_thread::get_id();
+		bool completed_on_main_thread = false;
+		work_queue.queue([&]()
+		{
+			work_queue.work_completed([&]() { completed_on_main_thread = std::this_thread::get_id() == main_thread_id; });
+			counter++;
+		});
+		wait_for_jobs(work_queue, counter, 1);
+		if (!completed_on_main_thread) fail();
+	}
+
+	Console::write_line("   Function: parallel_for()");
+	{
+		WorkQueue work_queue;
+		std::vector<int> values(100000, 0);
+		work_queue.parallel_for(0, (int)values.size(), [&](int begin, int end)
+		{
+			for (int i = begin; i < end; i++)
+				values[i] += i;
+		});
+		for (size_t i = 0; i < values.size(); i++)
+		{
+			if (values[i] != (int)i) fail();
+		}
+
+		work_queue.parallel_for(5, 5, [&](int begin, int end) { fail(); });
+
+		bool exception_caught = false;
+		try
+		{
+			work_queue.parallel_for(0, 1000, [&](int begin, int end) { if (begin <= 500 && 500 < end) throw Exception("parallel_for"); }, 10);
+		}
+		catch (Exception &)
+		{
+			exception_caught = true;
+		}
+		if (!exception_caught) fail();
+
+		while (work_queue.get_items_queued() != 0)
+			work_queue.process_work_completed();
+	}
+
+	Console::write_line("   Function: queue_task()");
+	{
+		WorkQueue work_queue;
+		std::atomic_int step(0);
+		int decode_step = -1, convert_step = -1, upload_step = -1;
+
+		WorkTask decode = work_queue.queue_task([&]() { decode_step = step++; });
+		WorkTask convert = work_queue.queue_task([&]() { convert_step = step++; }, { decode });
+		WorkTask upload = work_queue.queue_task([&]() { upload_step = step++; }, { convert });
+		upload.wait();
+		if (!decode.is_completed() || !convert.is_completed() || !upload.is_completed()) fail();
+		if (decode_step != 0 || convert_step != 1 || upload_step != 2) fail();
+
+		// Diamond shaped graph with a dependency that already completed
+		std::atomic_int left(0), right(0);
+		WorkTask root = work_queue.queue_task([]() { });
+		root.wait();
+		WorkTask left_task = work_queue.queue_task([&]() { left = 1; }, { root });
+		WorkTask right_task = work_queue.queue_task([&]() { right = 1; }, { root });
+		WorkTask join_task = work_queue.queue_task([&]() { if (left != 1 || right != 1) fail(); }, { left_task, right_task });
+		if (!join_task.wait(10000)) fail();
+
+		// Exceptions are forwarded to dependent tasks without running them
+		bool dependent_ran = false;
+		WorkTask failing = work_queue.queue_task([]() { throw Exception("queue_task"); });
+		WorkTask dependent = work_queue.queue_task([&]() { dependent_ran = true; }, { failing });
+		bool exception_caught = false;
+		try
+		{
+			dependent.wait();
+		}
+		catch (Exception &)
+		{
+			exception_caught = true;
+		}
+		if (!exception_caught || dependent_ran) fail();
+
+		while (work_queue.get_items_queued() != 0)
+			work_queue.process_work_completed();
+	}
+
+	Console::write_line("   Function: queue_inline()");
+	{
+		WorkQueue work_queue;
+		std::atomic_int counter(0);
+		for (int i = 0; i < 1000; i++)
+			work_queue.queue_inline(MoveOnlyJob(counter));
+		wait_for_jobs(work_queue, counter, 1000);
+
+		std::shared_ptr<int> shared_value = std::make_shared<int>(5);
+		counter = 0;
+		work_queue.queue_inline([shared_value, &counter]() { counter += *shared_value; });
+		wait_for_jobs(work_queue, counter, 5);
+		if (!shared_value.unique()) fail();
+	}
+
+	Console::write_line("   Benchmark: queue_inline() allocations");
+	{
+		// Simulates a game loop queuing a batch of small jobs every frame
+		const int jobs_per_frame = 1000;
+		const int num_frames = 50;
+		WorkQueue work_queue;
+		std::atomic_int counter(0);
+
+		auto run_frames = [&](bool use_inline, int frames) -> double
+		{
+			uint64_t start_time = System::get_microseconds();
+			for (int frame = 0; frame < frames; frame++)
+			{
+				counter = 0;
+				for (int i = 0; i < jobs_per_frame; i++)
+				{
+					if (use_inline)
+						work_queue.queue_inline([&counter]() { counter++; });
+					else
+						work_queue.queue([&counter]() { counter++; });
+				}
+				wait_for_jobs(work_queue, counter, jobs_per_frame);
+			}
+			uint64_t end_time = System::get_microseconds();
+			return frames * jobs_per_frame * 1000000.0 / (double)clan::max(end_time - start_time, (uint64_t)1);
+		};
+
+		// Warm up the item pool and queue storage
+		run_frames(true, 2);
+		run_frames(false, 2);
+
+		num_allocations = 0;
+		count_allocations = true;
+		double function_rate = run_frames(false, num_frames);
+		count_allocations = false;
+		int function_allocations = num_allocations;
+
+		num_allocations = 0;
+		count_allocations = true;
+		double inline_rate = run_frames(true, num_frames);
+		count_allocations = false;
+		int inline_allocations = num_allocations;
+
+		Console::write_line("    queue(std::function): %1 allocations/job, %2 jobs/sec", function_allocations / (double)(num_frames * jobs_per_frame), (int)function_rate);
+		Console::write_line("    queue_inline():       %1 allocations/job, %2 jobs/sec", inline_allocations / (double)(num_frames * jobs_per_frame), (int)inline_rate);
+		if (inline_allocations != 0) fail();
+	}
+
+	Console::write_line("   Benchmark: queue() throughput");
+	{
+		const int num_jobs = 200000;
+		double serial_rate = benchmark_jobs(true, num_jobs);
+		double stealing_rate = benchmark_jobs(false, num_jobs);
+		Console::write_line("    Serial queue:   %1 jobs/sec", (int)serial_rate);
+		Console::write_line("    Work stealing:  %1 jobs/sec", (int)stealing_rate);
+	}
+
+	Console::write_line("   Benchmark: parallel_for() throughput");
+	{
+		WorkQueue work_queue;
+		std::vector<float> values(4 * 1024 * 1024, 1.0f);
+		uint64_t start_time = System::get_microseconds();
+		for (int pass = 0; pass < 10; pass++)
+		{
+			work_queue.parallel_for(0, (int)values.size(), [&](int begin, int end)
+			{
+				for (int i = begin; i < end; i++)
+					values[i] = values[i] * 0.5f + 1.0f;
+			});
+		}
+		uint64_t end_time = System::get_microseconds();
+		Console::write_line("    %1 million elements/sec", (int)(values.size() * 10 / (double)clan::max(end_time - start_time, (uint64_t)1)));
+
+		while (work_queue.get_items_queued() != 0)
+			work_queue.process_work_completed();
+	}
+}
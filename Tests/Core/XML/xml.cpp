@@ -1,5 +1,7 @@
 
 #include <ClanLib/core.h>
+#include <atomic>
+#include "../../Common/allocation_counter.h"
 using namespace clan;
 
 void TestXMLFile(const std::string &filename)
@@ -25,10 +27,186 @@ void TestXMLFile(const std::string &filename)
 	Console::write_line("");
 }
 
+static std::vector<XMLToken> read_tokens(XMLTokenizer &tokenizer)
+{
+	std::vector<XMLToken> tokens;
+	XMLToken token;
+	tokenizer.next(&token);
+	while (token.type != XMLToken::NULL_TOKEN)
+	{
+		tokens.push_back(token);
+		tokenizer.next(&token);
+	}
+	return tokens;
+}
+
+static bool same_tokens(const std::vector<XMLToken> &a, const std::vector<XMLToken> &b)
+{
+	if (a.size() != b.size())
+		return false;
+	for (size_t i = 0; i < a.size(); i++)
+	{
+		if (a[i].type != b[i].type || a[i].variant != b[i].variant || a[i].name != b[i].name || a[i].value != b[i].value)
+			return false;
+		if (a[i].attributes.size() != b[i].attributes.size())
+			return false;
+		for (size_t j = 0; j < a[i].attributes.size(); j++)
+		{
+			if (a[i].attributes[j].first != b[i].attributes[j].first || a[i].attributes[j].second != b[i].attributes[j].second)
+				return false;
+		}
+	}
+	return true;
+}
+
+void TestXMLStreaming()
+{
+	Console::write_line("Streaming XMLTokenizer");
+
+	std::string xml = "\xef\xbb\xbf<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<!DOCTYPE level SYSTEM \"level.dtd\">\n<level name='test &amp; more'>\n";
+	for (int i = 0; i < 2000; i++)
+	{
+		xml += string_format("\t<!-- object %1 -->\n", i);
+		xml += string_format("\t<object id=\"%1\" x = \"%2\" y='%3'>text &lt;%1&gt; <![CDATA[raw <data> %1]]></object>\n", i, i * 3, i * 7);
+		xml += "\t<empty/>\n";
+	}
+	xml += "</level>\n";
+
+	DataBuffer buffer(xml.data(), xml.length());
+	MemoryDevice whole_device(buffer);
+	XMLTokenizer whole_tokenizer(whole_device);
+	std::vector<XMLToken> expected = read_tokens(whole_tokenizer);
+	bool ok = expected.size() == 2 + 2000 * 6 + 2;
+
+	int chunk_sizes[] = { 1, 3, 17, 4096, 1024 * 1024 };
+	for (int chunk_size : chunk_sizes)
+	{
+		MemoryDevice device(buffer);
+		XMLTokenizer tokenizer(device, chunk_size);
+		if (!same_tokens(read_tokens(tokenizer), expected))
+		{
+			Console::write_line("Tokens differ with chunk size %1", chunk_size);
+			ok = false;
+		}
+	}
+
+	// Truncated documents must still report an error
+	DataBuffer truncated(xml.data(), xml.length() / 2 + 5);
+	MemoryDevice truncated_device(truncated);
+	XMLTokenizer truncated_tokenizer(truncated_device, 64);
+	bool exception_caught = false;
+	try
+	{
+		read_tokens(truncated_tokenizer);
+	}
+	catch (Exception &)
+	{
+		exception_caught = true;
+	}
+	if (!exception_caught)
+		ok = false;
+
+	// Compare throughput of the two modes on a larger document
+	std::string large_xml = "<root>";
+	while (large_xml.length() < 32 * 1024 * 1024)
+		large_xml += "<item name=\"value\" count=\"42\">Some text content</item>";
+	large_xml += "</root>";
+
+	// Removes the file again when the test finishes, also if it throws
+	struct TempFile
+	{
+		~TempFile() { try { FileHelp::delete_file(filename); } catch (Exception &) { } }
+		std::string filename = "xml_streaming.xml";
+	} temp_file;
+
+	File output(temp_file.filename, File::create_always, File::access_write);
+	output.write(large_xml.data(), large_xml.length());
+	output.close();
+
+	uint64_t start_time = System::get_microseconds();
+	File whole_file(temp_file.filename);
+	XMLTokenizer whole_file_tokenizer(whole_file);
+	XMLToken token;
+	int whole_count = 0;
+	for (whole_file_tokenizer.next(&token); token.type != XMLToken::NULL_TOKEN; whole_file_tokenizer.next(&token))
+		whole_count++;
+	uint64_t whole_time = System::get_microseconds() - start_time;
+
+	start_time = System::get_microseconds();
+	File streaming_file(temp_file.filename);
+	XMLTokenizer streaming_tokenizer(streaming_file, 64 * 1024);
+	int streaming_count = 0;
+	for (streaming_tokenizer.next(&token); token.type != XMLToken::NULL_TOKEN; streaming_tokenizer.next(&token))
+		streaming_count++;
+	uint64_t streaming_time = System::get_microseconds() - start_time;
+
+	if (whole_count != streaming_count)
+		ok = false;
+
+	Console::write_line("Whole document: %1 tokens in %2 ms, reads %3 MB into memory", whole_count, (int)(whole_time / 1000), (int)(large_xml.length() / (1024 * 1024)));
+	Console::write_line("Streaming:      %1 tokens in %2 ms, 64 KB chunks", streaming_count, (int)(streaming_time / 1000));
+	Console::write_line(ok ? "Streaming test passed" : "Streaming test FAILED");
+	Console::write_line("");
+}
+
+void TestDomStorage()
+{
+	Console::write_line("DOM node storage");
+
+	std::string xml = "<level xmlns:ed=\"http://clanlib.org/editor\">";
+	for (int i = 0; i < 50000; i++)
+		xml += string_format("<object id=\"%1\" type=\"sprite\" ed:layer=\"background\"><name>Object %2</name><position x=\"%3\" y=\"%4\"/></object>", i, i, i * 3, i * 7);
+	xml += "</level>";
+
+	DataBuffer buffer(xml.data(), xml.length());
+	MemoryDevice device(buffer);
+
+	num_allocations = 0;
+	num_allocated_bytes = 0;
+	count_allocations = true;
+	uint64_t start_time = System::get_microseconds();
+	DomDocument document(device);
+	uint64_t parse_time = System::get_microseconds() - start_time;
+	count_allocations = false;
+
+	Console::write_line("Parsed %1 KB in %2 ms: %3 heap allocations, %4 KB allocated", (int)(xml.length() / 1024), (int)(parse_time / 1000), (int)num_allocations, (int)(num_allocated_bytes / 1024));
+
+	bool ok = true;
+	DomElement level = document.get_document_element();
+	DomElement object = level.get_first_child_element();
+	if (object.get_node_name_view() != "object" || object.get_attribute("id") != "0" || object.get_attribute("type") != "sprite")
+		ok = false;
+	if (object.get_attributes().get_named_item("ed:layer").get_namespace_uri_view() != "http://clanlib.org/editor")
+		ok = false;
+
+	DomElement last_object = level.get_last_child().to_element();
+	DomNode name_text = last_object.get_first_child().get_first_child();
+	if (name_text.get_node_value_view() != "Object 49999" || last_object.get_local_name_view() != "object")
+		ok = false;
+
+	// Names are interned in the document, so equal names share storage
+	if (object.get_node_name_view().data() != last_object.get_node_name_view().data())
+		ok = false;
+
+	// Modified values must not affect other nodes
+	name_text.to_text().append_data(" (last)");
+	if (name_text.get_node_value() != "Object 49999 (last)")
+		ok = false;
+	name_text.set_node_value("Short");
+	if (name_text.get_node_value() != "Short" || object.get_first_child().get_first_child().get_node_value() != "Object 0")
+		ok = false;
+
+	Console::write_line(ok ? "DOM storage test passed" : "DOM storage test FAILED");
+	Console::write_line("");
+}
+
 int main(int, char**)
 {
 	SetupCore setup_core;
 
+	TestXMLStreaming();
+	TestDomStorage();
+
 	TestXMLFile("test-emeditor-utf8-iso-8859-1.xml");
 	TestXMLFile("test-emeditor-utf8-withoutsignature.xml");
 	TestXMLFile("test-emeditor-utf8-withsignature.xml");
@@ -39,6 +39,102 @@ void evaluate(const std::string &xpath, const DomDocument &document)
 	Console::write_line("");
 }
 
+bool same_result(const XPathObject &a, const XPathObject &b)
+{
+	if (a.get_type() != b.get_type())
+		return false;
+
+	switch (a.get_type())
+	{
+	case XPathObject::type_null:
+		return true;
+	case XPathObject::type_node_set:
+		return a.get_node_set() == b.get_node_set();
+	case XPathObject::type_number:
+		return a.get_number() == b.get_number();
+	case XPathObject::type_string:
+		return a.get_string() == b.get_string();
+	case XPathObject::type_boolean:
+		return a.get_boolean() == b.get_boolean();
+	}
+	return false;
+}
+
+void test_compiled_expressions(DomDocument &document)
+{
+	const char *expressions[] =
+	{
+		"//child/attribute::type",
+		"6 mod 4",
+		"/root/child/childchild",
+		"child::root/child::child[@foo]/child::childchild",
+		"child::root/child::child[2]/child::childchild",
+		"root/child[@foo=\"barism\"]/childchild",
+		"root/child[childchild=\"Test6\"]/foobar",
+		"root/child[@age>27]/foobar",
+		"root/child[last()-3]/foobar",
+		"count(root/child[position() mod 2 = 0])",
+		"string-length(root/*[local-name()='child'][position()=last()-2]/foobar)",
+		"root/*[local-name()='child' and (@age=10 or namespace-uri()='fisk')]/foobar",
+		"root/child[last()]/foobar | root/child[not(@foo) and not(@age)]/foobar",
+		"sum(root/child[@type='numbers']/number)",
+		"(root/*[local-name()='child'])[1]",
+		"count(root/child[1]/following-sibling::*)",
+		"//childchild[1]"
+	};
+
+	XPathEvaluator evaluator;
+	DomNode root = document.get_document_element();
+	for (auto &expression : expressions)
+	{
+		XPathExpression compiled(expression);
+		XPathObject string_result = evaluator.evaluate(expression, document);
+		XPathObject compiled_result = evaluator.evaluate(compiled, document);
+		XPathObject reused_result = evaluator.evaluate(compiled, document);
+		if (!same_result(string_result, compiled_result) || !same_result(string_result, reused_result))
+			throw Exception(string_format("Compiled expression gave a different result: %1", expression));
+	}
+
+	if (evaluator.evaluate("count(root/child[1]/following-sibling::*)", document).get_number() != 8)
+		throw Exception("following-sibling axis returned the wrong number of nodes");
+
+	bool syntax_error = false;
+	try
+	{
+		XPathExpression invalid("root/child[@foo=\"bar]");
+	}
+	catch (Exception &)
+	{
+		syntax_error = true;
+	}
+	if (!syntax_error)
+		throw Exception("Invalid expression compiled without errors");
+
+	Console::write_line("Compiled expressions match string evaluation");
+}
+
+void benchmark_compiled_expressions(DomDocument &document)
+{
+	const std::string expression = "root/*[local-name()='child' and (@age=10 or namespace-uri()='fisk')]/foobar";
+	const int iterations = 20000;
+	XPathEvaluator evaluator;
+
+	uint64_t start_time = System::get_microseconds();
+	for (int i = 0; i < iterations; i++)
+		evaluator.evaluate(expression, document);
+	uint64_t string_time = System::get_microseconds() - start_time;
+
+	XPathExpression compiled(expression);
+	start_time = System::get_microseconds();
+	for (int i = 0; i < iterations; i++)
+		evaluator.evaluate(compiled, document);
+	uint64_t compiled_time = System::get_microseconds() - start_time;
+
+	Console::write_line("Benchmark: %1 evaluations of %2", iterations, expression);
+	Console::write_line("  String:   %1 us/evaluation", string_time / (double)iterations);
+	Console::write_line("  Compiled: %1 us/evaluation", compiled_time / (double)iterations);
+}
+
 int main(int, char**)
 {
 	SetupCore setup_core;
@@ -53,6 +149,9 @@ int main(int, char**)
 // 		evaluate("root/child/child[2]/childchild[2]/preceding::*", document);
 		evaluate("//child/attribute::type", document);
 
+		test_compiled_expressions(document);
+		benchmark_compiled_expressions(document);
+
 // 		evaluate("6 mod 4", document);
 // 		evaluate("/root/child/childchild", document);
 // 		evaluate("/child::root/child::child/child::childchild", document);
@@ -54,6 +54,8 @@ int TestApp::main(const std::vector<std::string> &args)
 	try
 	{
 		run_test();
+		test_zip_archive();
+		test_crc32();
 		console.display_close_message();
 	}
 	catch(Exception error)
@@ -66,6 +68,11 @@ int TestApp::main(const std::vector<std::string> &args)
 	return 0;
 }
 
+void TestApp::fail()
+{
+	throw Exception("Failed Test");
+}
+
 void TestApp::run_test()
 {
 	File file("ZipWriter.zip", File::create_always, File::access_write);
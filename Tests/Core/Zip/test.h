@@ -40,6 +40,10 @@ public:
 
 private:
 	void run_test();
+	void test_zip_archive();
+	void test_crc32();
+
+	void fail();
 };
 
 #endif
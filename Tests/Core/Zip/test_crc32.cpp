@@ -0,0 +1,138 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "test.h"
+
+// Byte at a time reference implementation, as used by the zip code before the faster paths were added
+static uint32_t reference_table[256];
+
+static void init_reference_table()
+{
+	for (uint32_t i = 0; i < 256; i++)
+	{
+		uint32_t crc = i;
+		for (int bit = 0; bit < 8; bit++)
+			crc = (crc & 1) ? (crc >> 1) ^ 0xedb88320 : (crc >> 1);
+		reference_table[i] = crc;
+	}
+}
+
+static uint32_t reference_crc32(const void *data, int size, uint32_t running_crc = 0)
+{
+	const unsigned char *d = (const unsigned char *)data;
+	uint32_t crc = ~running_crc;
+	for (int i = 0; i < size; i++)
+		crc = (crc >> 8) ^ reference_table[(crc ^ d[i]) & 0xff];
+	return ~crc;
+}
+
+void TestApp::test_crc32()
+{
+	Console::write_line(" Header: hash_functions.h");
+	Console::write_line("  Class: HashFunctions");
+
+	init_reference_table();
+
+	std::vector<unsigned char> data(4 * 1024 * 1024 + 64);
+	uint32_t seed = 12345;
+	for (auto &value : data)
+	{
+		seed = seed * 1103515245 + 12345;
+		value = (unsigned char)(seed >> 16);
+	}
+
+	Console::write_line("   Function: crc32()");
+	{
+		if (HashFunctions::crc32("123456789", 9) != 0xcbf43926) fail();
+		if (HashFunctions::crc32(nullptr, 0) != 0) fail();
+
+		// Cover the byte, slice-by-8 and folding paths at every alignment
+		for (int length = 0; length < 1100; length++)
+		{
+			for (int offset = 0; offset < 16; offset++)
+			{
+				if (HashFunctions::crc32(&data[offset], length) != reference_crc32(&data[offset], length)) fail();
+			}
+		}
+
+		for (int length = 4096; length < (int)data.size() - 16; length = length * 3 + 7)
+		{
+			if (HashFunctions::crc32(&data[5], length) != reference_crc32(&data[5], length)) fail();
+		}
+
+		// Running crc over several blocks must match a single call
+		uint32_t whole = HashFunctions::crc32(&data[0], 100000);
+		uint32_t running = 0;
+		for (int pos = 0; pos < 100000; pos += 777)
+			running = HashFunctions::crc32(&data[pos], min(777, 100000 - pos), running);
+		if (running != whole) fail();
+	}
+
+	Console::write_line("  Class: ZipArchive");
+	Console::write_line("   Function: save() crc of stored files");
+	{
+		File output("ZipCRC32.bin", File::create_always, File::access_write);
+		output.write(&data[0], 1024 * 1024 + 3);
+		output.close();
+
+		ZipArchive archive;
+		archive.add_file("ZipCRC32.bin", "crc.bin");
+		archive.save("ZipCRC32.zip");
+
+		// The crc32 field of the first local file header is at offset 14
+		File input("ZipCRC32.zip");
+		input.set_little_endian_mode();
+		input.seek(14);
+		if (input.read_uint32() != reference_crc32(&data[0], 1024 * 1024 + 3)) fail();
+	}
+
+	Console::write_line("   Benchmark: crc32() throughput");
+	{
+		const int passes = 20;
+		const int size = 4 * 1024 * 1024;
+		double gigabytes = passes * (double)size / (1024.0 * 1024.0 * 1024.0);
+
+		uint32_t reference_result = 0;
+		uint64_t start_time = System::get_microseconds();
+		for (int pass = 0; pass < passes; pass++)
+			reference_result = reference_crc32(&data[0], size, reference_result);
+		uint64_t reference_time = System::get_microseconds() - start_time;
+
+		uint32_t result = 0;
+		start_time = System::get_microseconds();
+		for (int pass = 0; pass < passes; pass++)
+			result = HashFunctions::crc32(&data[0], size, result);
+		uint64_t time = System::get_microseconds() - start_time;
+
+		if (result != reference_result) fail();
+
+		Console::write_line("    Byte table:   %1 GB/sec", gigabytes * 1000000.0 / (double)max(reference_time, (uint64_t)1));
+		Console::write_line("    HashFunctions: %1 GB/sec (pclmul %2)", gigabytes * 1000000.0 / (double)max(time, (uint64_t)1), System::detect_cpu_extension(System::pclmul) ? "available" : "not available");
+	}
+}
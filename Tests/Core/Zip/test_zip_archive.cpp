@@ -0,0 +1,152 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include "test.h"
+
+void TestApp::test_zip_archive()
+{
+	Console::write_line(" Header: zip_archive.h");
+	Console::write_line("  Class: ZipArchive");
+
+	const int num_files = 20000;
+	const int num_large_files = 64;
+
+	std::string large_content;
+	for (int i = 0; i < 256 * 1024; i++)
+		large_content.append(1, (char)('a' + (i * 7 + i / 1000) % 26));
+
+	{
+		File file("ZipArchive.zip", File::create_always, File::access_write);
+		ZipWriter zip_writer(file);
+		for (int i = 0; i < num_files; i++)
+		{
+			std::string content = string_format("file %1", i);
+			zip_writer.begin_file(string_format("small/%1.txt", i), (i % 2) == 0);
+			zip_writer.write_file_data(content.data(), content.length());
+			zip_writer.end_file();
+		}
+		for (int i = 0; i < num_large_files; i++)
+		{
+			zip_writer.begin_file(string_format("large/%1.txt", i), true);
+			zip_writer.write_file_data(large_content.data(), large_content.length());
+			zip_writer.end_file();
+		}
+		zip_writer.write_toc();
+	}
+
+	ZipArchive archive("ZipArchive.zip");
+
+	Console::write_line("   Function: open_file()");
+	{
+		for (int i = 0; i < num_files; i += 997)
+		{
+			IODevice device = archive.open_file(string_format("small/%1.txt", i));
+			std::string expected = string_format("file %1", i);
+			if (device.get_size() != (int)expected.length()) fail();
+			std::string content(device.get_size(), 0);
+			device.read(&content[0], content.length());
+			if (content != expected) fail();
+		}
+
+		bool exception_caught = false;
+		try
+		{
+			archive.open_file("small/missing.txt");
+		}
+		catch (Exception &)
+		{
+			exception_caught = true;
+		}
+		if (!exception_caught) fail();
+	}
+
+	Console::write_line("   Benchmark: open_file() lookups");
+	{
+		uint64_t start_time = System::get_microseconds();
+		for (int i = 0; i < num_files; i++)
+			archive.open_file(string_format("small/%1.txt", i));
+		uint64_t end_time = System::get_microseconds();
+		Console::write_line("    %1 opens/sec in a %2 entry archive", (int)(num_files * 1000000.0 / (double)max(end_time - start_time, (uint64_t)1)), num_files + num_large_files);
+	}
+
+	Console::write_line("   Function: read_files()");
+	{
+		WorkQueue work_queue;
+		std::vector<std::string> filenames;
+		for (int i = 0; i < num_large_files; i++)
+			filenames.push_back(string_format("large/%1.txt", i));
+		filenames.push_back("small/42.txt");
+
+		std::vector<DataBuffer> contents = archive.read_files(filenames, work_queue);
+		if (contents.size() != filenames.size()) fail();
+		for (int i = 0; i < num_large_files; i++)
+		{
+			if (contents[i].get_size() != (int)large_content.length()) fail();
+			if (memcmp(contents[i].get_data(), large_content.data(), large_content.length()) != 0) fail();
+		}
+		if (std::string(contents.back().get_data(), contents.back().get_size()) != "file 42") fail();
+
+		bool exception_caught = false;
+		try
+		{
+			filenames.push_back("large/missing.txt");
+			archive.read_files(filenames, work_queue);
+		}
+		catch (Exception &)
+		{
+			exception_caught = true;
+		}
+		if (!exception_caught) fail();
+	}
+
+	Console::write_line("   Benchmark: read_files() compared to open_file()");
+	{
+		WorkQueue work_queue;
+		std::vector<std::string> filenames;
+		for (int i = 0; i < num_large_files; i++)
+			filenames.push_back(string_format("large/%1.txt", i));
+
+		uint64_t start_time = System::get_microseconds();
+		for (auto &filename : filenames)
+		{
+			IODevice device = archive.open_file(filename);
+			DataBuffer data(device.get_size());
+			device.read(data.get_data(), data.get_size());
+		}
+		uint64_t serial_time = System::get_microseconds() - start_time;
+
+		start_time = System::get_microseconds();
+		archive.read_files(filenames, work_queue);
+		uint64_t parallel_time = System::get_microseconds() - start_time;
+
+		double megabytes = num_large_files * large_content.length() / (1024.0 * 1024.0);
+		Console::write_line("    open_file():  %1 MB/sec", (int)(megabytes * 1000000.0 / (double)max(serial_time, (uint64_t)1)));
+		Console::write_line("    read_files(): %1 MB/sec on %2 cores", (int)(megabytes * 1000000.0 / (double)max(parallel_time, (uint64_t)1)), System::get_num_cores());
+	}
+}
@@ -0,0 +1,159 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+
+#include <ClanLib/core.h>
+#include <ClanLib/display.h>
+#include <cmath>
+#include <cstring>
+using namespace clan;
+
+bool test_round_trip(const std::string &filename);
+void run_decode_benchmark(const std::vector<std::string> &filenames, int iterations);
+
+// Usage: test [file.jpg ...]
+// Decodes the given JPEG files, or all .jpg files in the current directory, and reports the
+// decode time of each. Include both baseline and progressive files to cover both scan types.
+int main(int argc, char **argv)
+{
+	try
+	{
+		bool passed = test_round_trip("jpeg_decode_test.jpg");
+
+		std::vector<std::string> filenames;
+		for (int i = 1; i < argc; i++)
+			filenames.push_back(argv[i]);
+		if (filenames.empty())
+		{
+			DirectoryScanner scanner;
+			if (scanner.scan(".", "*.jpg"))
+			{
+				while (scanner.next())
+					filenames.push_back(scanner.get_pathname());
+			}
+		}
+
+		run_decode_benchmark(filenames, 5);
+		Console::write_line(passed ? "JPEG decode test passed" : "JPEG decode test FAILED");
+		return passed ? 0 : 1;
+	}
+	catch (Exception e)
+	{
+		Console::write_line(e.message);
+		return 1;
+	}
+}
+
+bool test_round_trip(const std::string &filename)
+{
+	Console::write_line("Round trip:");
+
+	// Smooth gradients with sharp edges and an odd size exercise both short and long Huffman codes and partial MCUs
+	const int width = 1021, height = 767;
+	PixelBuffer image(width, height, tf_rgba8);
+	unsigned char *pixels = image.get_data_uint8();
+	for (int y = 0; y < height; y++)
+	{
+		for (int x = 0; x < width; x++)
+		{
+			int edge = ((x / 37 + y / 23) & 1) ? 40 : -40;
+			int v = (int)(128 + 70 * std::sin(x * 0.02) * std::cos(y * 0.03));
+			unsigned char *p = pixels + (x + y * width) * 4;
+			p[0] = (unsigned char)clamp(v + edge, 0, 255);
+			p[1] = (unsigned char)clamp(v - edge, 0, 255);
+			p[2] = (unsigned char)clamp(255 - v, 0, 255);
+			p[3] = 255;
+		}
+	}
+	JPEGProvider::save(image, filename, 95);
+
+	PixelBuffer decoded = JPEGProvider::load(filename);
+	if (decoded.get_width() != width || decoded.get_height() != height)
+	{
+		Console::write_line("  Decoded image has the wrong size");
+		return false;
+	}
+
+	WorkQueue work_queue;
+	PixelBuffer decoded_parallel = JPEGProvider::load(filename, false, work_queue);
+	if (decoded_parallel.get_size() != decoded.get_size() || memcmp(decoded_parallel.get_data(), decoded.get_data(), decoded.get_data_size()) != 0)
+	{
+		Console::write_line("  Decoding with a work queue gave a different image");
+		return false;
+	}
+
+	decoded = decoded.to_format(tf_rgba8);
+	const unsigned char *decoded_pixels = decoded.get_data_uint8();
+	double squared_error = 0.0;
+	for (int y = 0; y < height; y++)
+	{
+		for (int x = 0; x < width; x++)
+		{
+			for (int c = 0; c < 3; c++)
+			{
+				int delta = decoded_pixels[(x + y * width) * 4 + c] - pixels[(x + y * width) * 4 + c];
+				squared_error += delta * delta;
+			}
+		}
+	}
+	double psnr = 10.0 * std::log10(255.0 * 255.0 / max(squared_error / (width * height * 3), 1e-10));
+	Console::write_line("  PSNR %1 dB", (int)psnr);
+	if (psnr < 30.0)
+	{
+		Console::write_line("  Decoded image differs too much from the original");
+		return false;
+	}
+	return true;
+}
+
+void run_decode_benchmark(const std::vector<std::string> &filenames, int iterations)
+{
+	Console::write_line("Decode benchmark:");
+	WorkQueue work_queue;
+	for (auto &filename : filenames)
+	{
+		DataBuffer data = File::read_bytes(filename);
+		for (int parallel = 0; parallel < 2; parallel++)
+		{
+			uint64_t best_time = 0;
+			Size size;
+			for (int i = 0; i < iterations; i++)
+			{
+				MemoryDevice device(data);
+				uint64_t start_time = System::get_microseconds();
+				PixelBuffer image = parallel ? JPEGProvider::load(device, false, work_queue) : JPEGProvider::load(device);
+				uint64_t time = System::get_microseconds() - start_time;
+				if (i == 0 || time < best_time)
+					best_time = time;
+				size = image.get_size();
+			}
+			Console::write_line("  %1 (%2x%3)%4: %5 ms, %6 megapixels/s", PathHelp::get_filename(filename), size.width, size.height, parallel ? " with work queue" : "",
+				(int)(best_time / 1000), (int)(size.width * (double)size.height / max(best_time, (uint64_t)1)));
+		}
+	}
+}
@@ -0,0 +1,165 @@
+#include <ClanLib/core.h>
+#include <ClanLib/network.h>
+#include <map>
+
+using namespace clan;
+
+// The std::map based dispatcher NetGameEventDispatcher used before the hashed table
+class MapEventDispatcher
+{
+public:
+	typedef std::function<void(const NetGameEvent &, int)> CallbackClass;
+
+	CallbackClass &func_event(const std::string &name) { return event_handlers[name]; }
+
+	bool dispatch(const NetGameEvent &game_event, int param)
+	{
+		auto it = event_handlers.find(game_event.get_name());
+		if (it != event_handlers.end() && (bool)it->second)
+		{
+			it->second(game_event, param);
+			return true;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+private:
+	std::map<std::string, CallbackClass> event_handlers;
+};
+
+std::vector<std::string> create_event_names();
+bool test_dispatcher();
+void run_dispatch_benchmark();
+
+int main(int, char**)
+{
+	try
+	{
+		bool passed = test_dispatcher();
+		run_dispatch_benchmark();
+		Console::write_line(passed ? "NetGame dispatch test passed" : "NetGame dispatch test FAILED");
+		return passed ? 0 : 1;
+	}
+	catch (Exception e)
+	{
+		Console::write_line(e.message);
+		return 1;
+	}
+}
+
+std::vector<std::string> create_event_names()
+{
+	// Typical game protocol names, many sharing a long common prefix
+	std::vector<std::string> names = {
+		"login", "logout", "chat", "ping", "pong",
+		"player-move", "player-jump", "player-fire", "player-chat", "player-spawn", "player-died", "player-score",
+		"game-start", "game-end", "game-snapshot", "game-loadmap", "game-pause", "game-resume" };
+	for (int i = 0; i < 14; i++)
+		names.push_back(string_format("entity-update-%1", i));
+	return names;
+}
+
+bool test_dispatcher()
+{
+	Console::write_line("Dispatcher:");
+	bool passed = true;
+
+	std::vector<std::string> names = create_event_names();
+	NetGameEventDispatcher<int> dispatcher;
+	std::vector<int> calls(names.size(), 0);
+
+	// Keep a reference from the first registration while the table grows
+	NetGameEventDispatcher<int>::CallbackClass &first_handler = dispatcher.func_event(names[0]);
+	for (size_t i = 1; i < names.size(); i++)
+		dispatcher.func_event(names[i]) = [&calls, i](const NetGameEvent &, int value) { calls[i] += value; };
+	first_handler = [&calls](const NetGameEvent &, int value) { calls[0] += value; };
+
+	for (size_t i = 0; i < names.size(); i++)
+	{
+		if (!dispatcher.dispatch(NetGameEvent(names[i]), (int)i + 1))
+			passed = false;
+	}
+	for (size_t i = 0; i < names.size(); i++)
+	{
+		if (calls[i] != (int)i + 1)
+			passed = false;
+	}
+
+	// Unknown names and registered names without a callback are not dispatched
+	dispatcher.func_event("no-callback");
+	if (dispatcher.dispatch(NetGameEvent("unknown"), 1) || dispatcher.dispatch(NetGameEvent("no-callback"), 1) || dispatcher.dispatch(NetGameEvent(""), 1))
+		passed = false;
+
+	// Ids resolved once dispatch to the same handler as the name
+	int id = dispatcher.find_event_id("player-move");
+	if (id == -1 || id != dispatcher.get_event_id("player-move") || dispatcher.find_event_id("unknown") != -1)
+		passed = false;
+	int player_move_index = 5;
+	calls[player_move_index] = 0;
+	if (!dispatcher.dispatch(id, NetGameEvent("player-move"), 7) || calls[player_move_index] != 7)
+		passed = false;
+	if (dispatcher.dispatch(-1, NetGameEvent("player-move"), 7) || dispatcher.dispatch(1000, NetGameEvent("player-move"), 7))
+		passed = false;
+
+	Console::write_line(passed ? "  passed" : "  FAILED");
+	return passed;
+}
+
+void run_dispatch_benchmark()
+{
+	const int num_dispatches = 1000000;
+
+	std::vector<std::string> names = create_event_names();
+	Console::write_line("Dispatch benchmark, %1 dispatches over %2 event names:", num_dispatches, (int)names.size());
+
+	std::vector<NetGameEvent> events;
+	for (size_t i = 0; i < names.size(); i++)
+		events.push_back(NetGameEvent(names[i]));
+
+	int sum = 0;
+	MapEventDispatcher map_dispatcher;
+	NetGameEventDispatcher<int> hash_dispatcher;
+	for (size_t i = 0; i < names.size(); i++)
+	{
+		map_dispatcher.func_event(names[i]) = [&sum](const NetGameEvent &, int value) { sum += value; };
+		hash_dispatcher.func_event(names[i]) = [&sum](const NetGameEvent &, int value) { sum += value; };
+	}
+
+	std::vector<int> event_ids;
+	for (size_t i = 0; i < names.size(); i++)
+		event_ids.push_back(hash_dispatcher.find_event_id(names[i]));
+
+	// Pseudo random event order so the branch predictor cannot learn the lookup path
+	std::vector<int> order(num_dispatches);
+	unsigned int seed = 12345;
+	for (int i = 0; i < num_dispatches; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		order[i] = (seed >> 16) % names.size();
+	}
+
+	uint64_t start_time = System::get_microseconds();
+	for (int i = 0; i < num_dispatches; i++)
+		map_dispatcher.dispatch(events[order[i]], 1);
+	uint64_t map_time = System::get_microseconds() - start_time;
+
+	start_time = System::get_microseconds();
+	for (int i = 0; i < num_dispatches; i++)
+		hash_dispatcher.dispatch(events[order[i]], 1);
+	uint64_t hash_time = System::get_microseconds() - start_time;
+
+	start_time = System::get_microseconds();
+	for (int i = 0; i < num_dispatches; i++)
+		hash_dispatcher.dispatch(event_ids[order[i]], events[order[i]], 1);
+	uint64_t id_time = System::get_microseconds() - start_time;
+
+	if (sum != num_dispatches * 3)
+		throw Exception("Dispatch benchmark lost events");
+
+	Console::write_line("  std::map by name:   %1 ms, %2 ns/dispatch", (int)(map_time / 1000), (int)(map_time * 1000 / num_dispatches));
+	Console::write_line("  Hash table by name: %1 ms, %2 ns/dispatch", (int)(hash_time / 1000), (int)(hash_time * 1000 / num_dispatches));
+	Console::write_line("  Table by event id:  %1 ms, %2 ns/dispatch", (int)(id_time / 1000), (int)(id_time * 1000 / num_dispatches));
+}
@@ -0,0 +1,203 @@
+#include <ClanLib/core.h>
+#include <ClanLib/network.h>
+#include <atomic>
+#include "../../Common/allocation_counter.h"
+
+using namespace clan;
+
+NetGameEventSchema create_schema();
+NetGameEvent create_move_event(int i);
+bool test_round_trip();
+void run_encoding_benchmark();
+bool test_connection(bool same_schema);
+
+int main(int, char**)
+{
+	try
+	{
+		bool passed = test_round_trip();
+		run_encoding_benchmark();
+		passed = test_connection(true) && passed;
+		passed = test_connection(false) && passed;
+		Console::write_line(passed ? "NetGame encoding test passed" : "NetGame encoding test FAILED");
+		return passed ? 0 : 1;
+	}
+	catch (Exception e)
+	{
+		Console::write_line(e.message);
+		return 1;
+	}
+}
+
+NetGameEventSchema create_schema()
+{
+	NetGameEventSchema schema;
+	schema.register_event("player-move");
+	schema.register_event("player-chat");
+	schema.register_event("snapshot");
+	return schema;
+}
+
+NetGameEvent create_move_event(int i)
+{
+	return NetGameEvent("player-move", { i % 64, 100.0f + i, 200.0f - i, (unsigned int)(i * 16), -(i % 5) });
+}
+
+bool test_round_trip()
+{
+	Console::write_line("Round trip:");
+
+	NetGameEventSchema schema = create_schema();
+	NetGameEventSchema empty_schema;
+
+	NetGameEventValue complex(NetGameEventValue::complex);
+	complex.add_member(NetGameEventValue(-1));
+	complex.add_member(NetGameEventValue("nested"));
+	NetGameEvent chat("player-chat", {
+		NetGameEventValue(NetGameEventValue::null), 0, -64, 64, 0x7fffffff, (int)0x80000000, 0xffffffffu, 1.5f,
+		NetGameEventValue(true), NetGameEventValue(false), "hello", 'c', (unsigned char)200, DataBuffer("binary", 6), complex });
+	NetGameEvent unregistered("unregistered", { 1, 2, 3 });
+
+	bool passed = true;
+	NetGameEvent decoded("");
+	NetGameEvent events[] = { chat, unregistered, create_move_event(5), NetGameEvent("snapshot") };
+	for (const auto &e : events)
+	{
+		schema.decode_event(schema.encode_event(e), decoded);
+		if (decoded.to_string() != e.to_string())
+		{
+			Console::write_line("  FAILED: %1 decoded as %2", e.to_string(), decoded.to_string());
+			passed = false;
+		}
+
+		empty_schema.decode_event(empty_schema.encode_event(e), decoded);
+		if (decoded.to_string() != e.to_string())
+		{
+			Console::write_line("  FAILED: %1 decoded without schema as %2", e.to_string(), decoded.to_string());
+			passed = false;
+		}
+	}
+
+	// Compact events can not be decoded without the schema
+	bool exception_caught = false;
+	try
+	{
+		empty_schema.decode_event(schema.encode_event(chat), decoded);
+	}
+	catch (Exception &)
+	{
+		exception_caught = true;
+	}
+	if (!exception_caught)
+	{
+		Console::write_line("  FAILED: compact event decoded without schema");
+		passed = false;
+	}
+
+	Console::write_line(passed ? "  Passed" : "  FAILED");
+	return passed;
+}
+
+void run_encoding_benchmark()
+{
+	const int num_events = 200000;
+
+	Console::write_line("Encoding benchmark, player-move(int, float, float, uint, int):");
+
+	NetGameEventSchema schema = create_schema();
+	NetGameEventSchema empty_schema;
+
+	std::vector<DataBuffer> named_packets, compact_packets;
+	int named_size = 0, compact_size = 0;
+	for (int i = 0; i < 1000; i++)
+	{
+		named_packets.push_back(empty_schema.encode_event(create_move_event(i)));
+		compact_packets.push_back(schema.encode_event(create_move_event(i)));
+		named_size += named_packets.back().get_size();
+		compact_size += compact_packets.back().get_size();
+	}
+	Console::write_line("  Wire size: %1 bytes with name, %2 bytes with schema id", named_size / 1000.0f, compact_size / 1000.0f);
+
+	// Decoding into a new event each time is what the connections did before
+	num_allocations = 0;
+	count_allocations = true;
+	uint64_t start_time = System::get_microseconds();
+	for (int i = 0; i < num_events; i++)
+	{
+		NetGameEvent e("");
+		empty_schema.decode_event(named_packets[i % 1000], e);
+	}
+	uint64_t named_time = System::get_microseconds() - start_time;
+	count_allocations = false;
+	int named_allocations = num_allocations;
+
+	NetGameEvent e("");
+	schema.decode_event(compact_packets[0], e);
+	num_allocations = 0;
+	count_allocations = true;
+	start_time = System::get_microseconds();
+	for (int i = 0; i < num_events; i++)
+		schema.decode_event(compact_packets[i % 1000], e);
+	uint64_t compact_time = System::get_microseconds() - start_time;
+	count_allocations = false;
+	int compact_allocations = num_allocations;
+
+	Console::write_line("  Decode with name into new event:    %1 events/sec, %2 allocations/event", (int)(num_events * 1000000.0 / clan::max(named_time, (uint64_t)1)), named_allocations / (float)num_events);
+	Console::write_line("  Decode with schema into same event: %1 events/sec, %2 allocations/event", (int)(num_events * 1000000.0 / clan::max(compact_time, (uint64_t)1)), compact_allocations / (float)num_events);
+}
+
+bool test_connection(bool same_schema)
+{
+	Console::write_line(same_schema ? "Connection with the same schema:" : "Connection with different schemas:");
+
+	NetGameEventSchema server_schema = create_schema();
+	NetGameEventSchema client_schema = create_schema();
+	if (!same_schema)
+		client_schema.register_event("client-only");
+
+	NetGameServer server;
+	server.set_event_schema(server_schema);
+	int server_events = 0;
+	bool passed = true;
+	Slot slot_event = server.sig_event_received().connect([&](NetGameConnection *connection, const NetGameEvent &e)
+	{
+		if (e.to_string() != create_move_event(server_events).to_string())
+			passed = false;
+		server_events++;
+		connection->send_event(e);
+	});
+	server.start("127.0.0.1", "27018");
+
+	NetGameClient client;
+	client.set_event_schema(client_schema);
+	int client_events = 0;
+	Slot slot_client_event = client.sig_event_received().connect([&](const NetGameEvent &e)
+	{
+		if (e.to_string() != create_move_event(client_events).to_string())
+			passed = false;
+		client_events++;
+	});
+	client.connect("127.0.0.1", "27018");
+
+	const int num_events = 100;
+	for (int i = 0; i < num_events; i++)
+		client.send_event(create_move_event(i));
+
+	uint64_t timeout = System::get_time() + 10000;
+	while (client_events < num_events && System::get_time() < timeout)
+	{
+		server.process_events();
+		client.process_events();
+		System::sleep(1);
+	}
+
+	if (server_events != num_events || client_events != num_events)
+		passed = false;
+
+	Console::write_line("  %1 events to server, %2 events to client", server_events, client_events);
+	Console::write_line(passed ? "  Passed" : "  FAILED");
+
+	client.disconnect();
+	server.stop();
+	return passed;
+}
@@ -0,0 +1,531 @@
+#include <ClanLib/core.h>
+#include <ClanLib/network.h>
+#include <memory>
+#include <unordered_map>
+
+#ifndef WIN32
+#include <sys/resource.h>
+#endif
+
+using namespace clan;
+
+int get_max_clients();
+void run_load_test(int num_clients, bool use_reactor);
+void run_broadcast_test(int num_clients);
+void run_slow_client_test();
+bool run_send_budget_test(NetGameSendPolicy policy);
+bool run_coalesce_collision_test();
+
+int main(int, char**)
+{
+	try
+	{
+		int max_clients = get_max_clients();
+
+		// Without a reactor every connection has a thread of its own and waits with select(), which is limited to FD_SETSIZE handles
+		run_load_test(clan::min(100, max_clients), false);
+
+		int client_counts[] = { 1000, 10000 };
+		for (int num_clients : client_counts)
+		{
+			if (num_clients > max_clients)
+				Console::write_line("Only %1 handles available, using %2 instead of %3 clients", max_clients * 2, max_clients, num_clients);
+			run_load_test(clan::min(num_clients, max_clients), true);
+		}
+
+		run_broadcast_test(clan::min(1000, max_clients));
+		run_slow_client_test();
+		run_send_budget_test(NetGameSendPolicy::queue);
+		run_send_budget_test(NetGameSendPolicy::drop);
+		run_send_budget_test(NetGameSendPolicy::coalesce);
+		run_coalesce_collision_test();
+	}
+	catch (Exception e)
+	{
+		Console::write_line(e.message);
+	}
+	return 0;
+}
+
+int get_max_clients()
+{
+#ifndef WIN32
+	// Each client uses two socket handles in this process, one for each end of the loopback connection
+	rlimit limit;
+	if (getrlimit(RLIMIT_NOFILE, &limit) == 0)
+	{
+		limit.rlim_cur = limit.rlim_max;
+		setrlimit(RLIMIT_NOFILE, &limit);
+		getrlimit(RLIMIT_NOFILE, &limit);
+		if (limit.rlim_cur != RLIM_INFINITY)
+			return clan::max(((int)clan::min(limit.rlim_cur, (rlim_t)1000000) - 100) / 2, 1);
+	}
+#endif
+	return 10000;
+}
+
+void run_load_test(int num_clients, bool use_reactor)
+{
+	const int events_per_client = 20;
+
+	Console::write_line("%1 clients, %2:", num_clients, use_reactor ? "reactor" : "thread per connection");
+
+	NetGameReactor reactor;
+	std::unique_ptr<NetGameServer> server(use_reactor ? new NetGameServer(reactor) : new NetGameServer());
+
+	int clients_connected = 0;
+	int events_received = 0;
+	Slot slot_connected = server->sig_client_connected().connect([&](NetGameConnection *) { clients_connected++; });
+	Slot slot_event = server->sig_event_received().connect([&](NetGameConnection *connection, const NetGameEvent &e)
+	{
+		events_received++;
+		connection->send_event(NetGameEvent("pong", { e.get_argument(0) }));
+	});
+	server->start("127.0.0.1", "27016");
+
+	int pongs_received = 0;
+	std::vector<std::unique_ptr<NetGameClient>> clients;
+	std::vector<Slot> client_slots;
+	for (int i = 0; i < num_clients; i++)
+	{
+		clients.push_back(std::unique_ptr<NetGameClient>(use_reactor ? new NetGameClient(reactor) : new NetGameClient()));
+		client_slots.push_back(clients.back()->sig_event_received().connect([&](const NetGameEvent &) { pongs_received++; }));
+		clients.back()->connect("127.0.0.1", "27016");
+	}
+
+	auto process_all = [&]()
+	{
+		server->process_events();
+		for (auto &client : clients)
+			client->process_events();
+	};
+
+	uint64_t start_time = System::get_time();
+	while (clients_connected < num_clients && System::get_time() - start_time < 60000)
+	{
+		process_all();
+		System::sleep(1);
+	}
+	uint64_t connect_time = System::get_time() - start_time;
+	Console::write_line("  Connected %1 clients in %2 ms", clients_connected, (int)connect_time);
+
+	start_time = System::get_microseconds();
+	for (int i = 0; i < events_per_client; i++)
+	{
+		for (auto &client : clients)
+			client->send_event(NetGameEvent("ping", { i }));
+	}
+
+	int expected_events = clients_connected * events_per_client;
+	uint64_t timeout = System::get_time() + 60000;
+	while (pongs_received < expected_events && System::get_time() < timeout)
+	{
+		process_all();
+		System::sleep(0);
+	}
+	uint64_t end_time = System::get_microseconds();
+
+	double seconds = clan::max(end_time - start_time, (uint64_t)1) / 1000000.0;
+	Console::write_line("  %1 events received by the server, %2 replies received by the clients", events_received, pongs_received);
+	Console::write_line("  %1 events/sec", (int)((events_received + pongs_received) / seconds));
+	if (pongs_received != num_clients * events_per_client)
+		Console::write_line("  FAILED: not all events arrived");
+
+	clients.clear();
+	server->stop();
+}
+
+void run_broadcast_test(int num_clients)
+{
+	const int num_snapshots = 100;
+
+	Console::write_line("%1 clients, state snapshot broadcast:", num_clients);
+
+	NetGameReactor reactor;
+	NetGameServer server(reactor);
+	std::vector<NetGameConnection *> connections;
+	Slot slot_connected = server.sig_client_connected().connect([&](NetGameConnection *connection) { connections.push_back(connection); });
+	server.start("127.0.0.1", "27016");
+
+	int snapshots_received = 0;
+	std::vector<std::unique_ptr<NetGameClient>> clients;
+	std::vector<Slot> client_slots;
+	for (int i = 0; i < num_clients; i++)
+	{
+		clients.push_back(std::unique_ptr<NetGameClient>(new NetGameClient(reactor)));
+		client_slots.push_back(clients.back()->sig_event_received().connect([&](const NetGameEvent &) { snapshots_received++; }));
+		clients.back()->connect("127.0.0.1", "27016");
+	}
+
+	auto process_all = [&]()
+	{
+		server.process_events();
+		for (auto &client : clients)
+			client->process_events();
+	};
+
+	uint64_t timeout = System::get_time() + 60000;
+	while ((int)connections.size() < num_clients && System::get_time() < timeout)
+	{
+		process_all();
+		System::sleep(1);
+	}
+
+	// A snapshot of 64 entities with a position and an id each
+	std::vector<NetGameEventValue> snapshot_values;
+	for (int i = 0; i < 64; i++)
+	{
+		snapshot_values.push_back(NetGameEventValue(i * 1.5f));
+		snapshot_values.push_back(NetGameEventValue(i * 2.5f));
+		snapshot_values.push_back(NetGameEventValue(i));
+	}
+	NetGameEvent snapshot("snapshot", snapshot_values);
+
+	std::vector<NetGameConnection *> half_connections(connections.begin(), connections.begin() + connections.size() / 2);
+
+	enum Method { each_connection, broadcast, multi_target };
+	const char *method_names[] = { "NetGameConnection::send_event", "NetGameServer::send_event", "NetGameServer::send_event(connections)" };
+	for (int method = each_connection; method <= multi_target; method++)
+	{
+		snapshots_received = 0;
+		int expected_snapshots = num_snapshots * (int)(method == multi_target ? half_connections.size() : connections.size());
+
+		uint64_t start_time = System::get_microseconds();
+		uint64_t send_time = 0;
+		for (int i = 0; i < num_snapshots; i++)
+		{
+			uint64_t send_start_time = System::get_microseconds();
+			if (method == each_connection)
+			{
+				for (auto connection : connections)
+					connection->send_event(snapshot);
+			}
+			else if (method == broadcast)
+			{
+				server.send_event(snapshot);
+			}
+			else
+			{
+				server.send_event(snapshot, half_connections);
+			}
+			send_time += System::get_microseconds() - send_start_time;
+			process_all();
+		}
+
+		timeout = System::get_time() + 60000;
+		while (snapshots_received < expected_snapshots && System::get_time() < timeout)
+		{
+			process_all();
+			System::sleep(0);
+		}
+		uint64_t end_time = System::get_microseconds();
+
+		double seconds = clan::max(end_time - start_time, (uint64_t)1) / 1000000.0;
+		Console::write_line("  %1: %2 us per snapshot in send_event, %3 snapshots/sec delivered", method_names[method], (int)(send_time / num_snapshots), (int)(snapshots_received / seconds));
+		if (snapshots_received != expected_snapshots)
+			Console::write_line("  FAILED: not all snapshots arrived");
+	}
+
+	clients.clear();
+	server.stop();
+}
+
+void run_slow_client_test()
+{
+	const int num_fast_clients = 10;
+	const int num_snapshots = 5000;
+
+	Console::write_line("Connection stats, %1 clients and one client that stops reading:", num_fast_clients);
+
+	NetGameReactor reactor;
+	NetGameServer server(reactor);
+	std::vector<NetGameConnection *> connections;
+	Slot slot_connected = server.sig_client_connected().connect([&](NetGameConnection *connection) { connections.push_back(connection); });
+	server.start("127.0.0.1", "27016");
+
+	int snapshots_received = 0;
+	std::vector<std::unique_ptr<NetGameClient>> clients;
+	std::vector<Slot> client_slots;
+	for (int i = 0; i < num_fast_clients; i++)
+	{
+		clients.push_back(std::unique_ptr<NetGameClient>(new NetGameClient(reactor)));
+		client_slots.push_back(clients.back()->sig_event_received().connect([&](const NetGameEvent &) { snapshots_received++; }));
+		clients.back()->connect("127.0.0.1", "27016");
+	}
+
+	// Never reads from its socket, so everything sent to it piles up on the server
+	TCPConnection slow_client(SocketName("127.0.0.1", "27016"));
+
+	auto process_all = [&]()
+	{
+		server.process_events();
+		for (auto &client : clients)
+			client->process_events();
+	};
+
+	uint64_t timeout = System::get_time() + 60000;
+	while ((int)connections.size() < num_fast_clients + 1 && System::get_time() < timeout)
+	{
+		process_all();
+		System::sleep(1);
+	}
+
+	std::vector<NetGameEventValue> values;
+	for (int i = 0; i < 64; i++)
+	{
+		values.push_back(NetGameEventValue(i * 1.5f));
+		values.push_back(NetGameEventValue(i * 2.5f));
+		values.push_back(NetGameEventValue(i));
+	}
+	NetGameEvent snapshot("snapshot", values);
+
+	for (int i = 0; i < num_snapshots; i++)
+	{
+		server.send_event(snapshot);
+		if (i % 100 == 0)
+			process_all();
+	}
+
+	timeout = System::get_time() + 60000;
+	while (snapshots_received < num_snapshots * num_fast_clients && System::get_time() < timeout)
+	{
+		process_all();
+		System::sleep(0);
+	}
+
+	// Let the I/O threads sample the round trip time at least once
+	System::sleep(1100);
+	process_all();
+
+	NetGameConnection *slowest_connection = nullptr;
+	NetGameConnectionStats slowest_stats;
+	int reports = 0;
+	server.set_stats_interval(1);
+	Slot slot_stats = server.sig_connection_stats().connect([&](NetGameConnection *connection, const NetGameConnectionStats &stats)
+	{
+		reports++;
+		if (!slowest_connection || stats.send_buffer_size > slowest_stats.send_buffer_size)
+		{
+			slowest_connection = connection;
+			slowest_stats = stats;
+		}
+	});
+	System::sleep(2);
+	server.process_events();
+
+	NetGameConnectionStats client_stats = clients.front()->get_stats();
+	NetGameConnectionStats fast_stats = connections.front() == slowest_connection ? connections.back()->get_stats() : connections.front()->get_stats();
+	Console::write_line("  Fast client: %1 KB sent, %2 events sent, send buffer %3 bytes, queue time p50 %4 us p99 %5 us, write time p99 %6 us, RTT %7 us",
+		(int)(fast_stats.bytes_sent / 1024), (int)fast_stats.events_sent, fast_stats.send_buffer_size,
+		(int)fast_stats.queue_time.get_percentile(50), (int)fast_stats.queue_time.get_percentile(99), (int)fast_stats.write_time.get_percentile(99), fast_stats.round_trip_time);
+	Console::write_line("  Slow client: %1 KB sent, %2 events sent, send buffer %3 KB (max %4 KB), max send queue %5, queue time p99 %6 us",
+		(int)(slowest_stats.bytes_sent / 1024), (int)slowest_stats.events_sent, slowest_stats.send_buffer_size / 1024, slowest_stats.max_send_buffer_size / 1024,
+		slowest_stats.max_send_queue_depth, (int)slowest_stats.queue_time.get_percentile(99));
+	Console::write_line("  Client side: %1 KB received, %2 events received", (int)(client_stats.bytes_received / 1024), (int)client_stats.events_received);
+
+	if (snapshots_received != num_snapshots * num_fast_clients)
+		Console::write_line("  FAILED: not all snapshots arrived");
+	if (reports != num_fast_clients + 1)
+		Console::write_line("  FAILED: sig_connection_stats reported %1 connections", reports);
+	if (slowest_stats.send_buffer_size == 0 || fast_stats.send_buffer_size != 0 || fast_stats.events_sent != (uint64_t)num_snapshots)
+		Console::write_line("  FAILED: the slow client was not found");
+	if (client_stats.events_received != (uint64_t)num_snapshots || client_stats.bytes_received != fast_stats.bytes_sent)
+		Console::write_line("  FAILED: client and server counters do not match");
+
+	slow_client.close();
+	clients.clear();
+	server.stop();
+}
+
+bool run_send_budget_test(NetGameSendPolicy policy)
+{
+	const int num_snapshots = 5000;
+	const NetGameSendBudget budget(200, 20, policy);
+
+	const char *policy_names[] = { "queue", "drop", "coalesce" };
+	Console::write_line("Send budget %1/%2 messages, %3 policy, client that stops reading:", budget.high_watermark, budget.low_watermark, policy_names[(int)policy]);
+
+	NetGameServer server;
+	server.set_send_budget(budget);
+	NetGameConnection *connection = nullptr;
+	int over_budget_count = 0, within_budget_count = 0;
+	Slot slot_connected = server.sig_client_connected().connect([&](NetGameConnection *new_connection) { connection = new_connection; });
+	Slot slot_over = server.sig_client_over_budget().connect([&](NetGameConnection *) { over_budget_count++; });
+	Slot slot_within = server.sig_client_within_budget().connect([&](NetGameConnection *) { within_budget_count++; });
+	server.start("127.0.0.1", "27016");
+
+	TCPConnection slow_client(SocketName("127.0.0.1", "27016"));
+	uint64_t timeout = System::get_time() + 10000;
+	while (!connection && System::get_time() < timeout)
+	{
+		server.process_events();
+		System::sleep(1);
+	}
+
+	std::vector<NetGameEventValue> values;
+	for (int i = 0; i < 64; i++)
+	{
+		values.push_back(NetGameEventValue(i * 1.5f));
+		values.push_back(NetGameEventValue(i * 2.5f));
+		values.push_back(NetGameEventValue(i));
+	}
+	NetGameEvent snapshot("snapshot", values);
+
+	for (int i = 0; i < num_snapshots; i++)
+	{
+		server.send_event(snapshot);
+		if (i % 10 == 0)
+			connection->send_event(NetGameEvent("chat", { i }));
+	}
+	System::sleep(100);
+	server.process_events();
+	NetGameConnectionStats stalled_stats = connection->get_stats();
+
+	// Read everything until the server reports that the connection has drained.
+	// The connection may also have drained below the low watermark while the events were sent
+	std::vector<char> read_buffer(64 * 1024);
+	uint64_t bytes_read = 0;
+	timeout = System::get_time() + 30000;
+	while ((over_budget_count == 0 || within_budget_count < over_budget_count) && System::get_time() < timeout)
+	{
+		int bytes = slow_client.read(read_buffer.data(), read_buffer.size());
+		if (bytes > 0)
+			bytes_read += bytes;
+		else
+			System::sleep(0);
+		server.process_events();
+	}
+	timeout = System::get_time() + 1000;
+	while (System::get_time() < timeout)
+	{
+		int bytes = slow_client.read(read_buffer.data(), read_buffer.size());
+		if (bytes > 0)
+			bytes_read += bytes;
+		else
+			System::sleep(1);
+	}
+	NetGameConnectionStats stats = connection->get_stats();
+
+	Console::write_line("  While stalled: %1 messages queued, %2 KB in the send buffer, %3 dropped, %4 coalesced",
+		stalled_stats.send_queue_depth, stalled_stats.send_buffer_size / 1024, (int)stalled_stats.events_dropped, (int)stalled_stats.events_coalesced);
+	Console::write_line("  After draining: %1 events sent, %2 KB read by the client, max send queue %3, max send buffer %4 KB",
+		(int)stats.events_sent, (int)(bytes_read / 1024), stats.max_send_queue_depth, stats.max_send_buffer_size / 1024);
+
+	bool passed = true;
+	if (over_budget_count == 0 || within_budget_count != over_budget_count)
+		passed = false;
+	if (bytes_read != stats.bytes_sent || stats.send_buffer_size != 0)
+		passed = false;
+	int total_events = num_snapshots + num_snapshots / 10;
+	if (policy == NetGameSendPolicy::queue && (stats.events_sent != (uint64_t)total_events || stats.max_send_queue_depth <= budget.high_watermark))
+		passed = false;
+	if (policy == NetGameSendPolicy::drop && (stats.events_dropped == 0 || stats.events_sent + stats.events_dropped != (uint64_t)total_events || stats.max_send_queue_depth > budget.high_watermark))
+		passed = false;
+	if (policy == NetGameSendPolicy::coalesce && (stats.events_coalesced == 0 || stats.events_sent + stats.events_coalesced != (uint64_t)total_events || stats.max_send_queue_depth > budget.high_watermark + 2))
+		passed = false;
+	Console::write_line(passed ? "  passed" : "  FAILED: over budget %1 times, within budget %2 times", over_budget_count, within_budget_count);
+
+	slow_client.close();
+	server.stop();
+	return passed;
+}
+
+bool run_coalesce_collision_test()
+{
+	// Finds two event names with the same 32-bit FNV-1a hash. Coalescing must still tell them apart
+	std::string names[2];
+	std::unordered_map<unsigned int, int> hashes;
+	for (int i = 0; names[0].empty(); i++)
+	{
+		std::string name = string_format("event%1_", i);
+		unsigned int hash = 2166136261u;
+		for (unsigned char c : name)
+			hash = (hash ^ c) * 16777619u;
+		auto it = hashes.find(hash);
+		if (it != hashes.end())
+		{
+			names[0] = string_format("event%1_", it->second);
+			names[1] = name;
+		}
+		hashes[hash] = i;
+	}
+
+	Console::write_line("Coalesce policy, events %1 and %2 with the same name hash:", names[0], names[1]);
+
+	const NetGameSendBudget budget(200, 20, NetGameSendPolicy::coalesce);
+	NetGameServer server;
+	server.set_send_budget(budget);
+	NetGameConnection *connection = nullptr;
+	bool over_budget = false;
+	Slot slot_connected = server.sig_client_connected().connect([&](NetGameConnection *new_connection) { connection = new_connection; });
+	Slot slot_over = server.sig_client_over_budget().connect([&](NetGameConnection *) { over_budget = true; });
+	server.start("127.0.0.1", "27016");
+
+	TCPConnection slow_client(SocketName("127.0.0.1", "27016"));
+	uint64_t timeout = System::get_time() + 10000;
+	while (!connection && System::get_time() < timeout)
+	{
+		server.process_events();
+		System::sleep(1);
+	}
+
+	std::vector<NetGameEventValue> values;
+	for (int i = 0; i < 64; i++)
+	{
+		values.push_back(NetGameEventValue(i * 1.5f));
+		values.push_back(NetGameEventValue(i * 2.5f));
+		values.push_back(NetGameEventValue(i));
+	}
+	NetGameEvent snapshot("snapshot", values);
+
+	// Fills the socket until the I/O thread is stuck on a partly written send buffer and stops taking the queue
+	timeout = System::get_time() + 10000;
+	while (!(over_budget && connection->get_stats().send_buffer_size > 0) && System::get_time() < timeout)
+	{
+		for (int i = 0; i < 100; i++)
+			server.send_event(snapshot);
+		System::sleep(10);
+		server.process_events();
+	}
+
+	server.send_event(NetGameEvent(names[0]));
+	connection->send_event(NetGameEvent(names[1]));
+	System::sleep(100);
+	server.process_events();
+	NetGameConnectionStats stalled_stats = connection->get_stats();
+
+	// The events are sent without a schema, so each name appears in the stream once per event
+	std::string received;
+	std::vector<char> read_buffer(64 * 1024);
+	timeout = System::get_time() + 1000;
+	while (System::get_time() < timeout)
+	{
+		int bytes = slow_client.read(read_buffer.data(), read_buffer.size());
+		if (bytes > 0)
+		{
+			received.append(read_buffer.data(), bytes);
+			timeout = System::get_time() + 1000;
+		}
+		else
+		{
+			System::sleep(1);
+		}
+	}
+
+	int found[2] = { 0, 0 };
+	for (int i = 0; i < 2; i++)
+	{
+		for (size_t pos = received.find(names[i]); pos != std::string::npos; pos = received.find(names[i], pos + 1))
+			found[i]++;
+	}
+
+	bool passed = stalled_stats.events_coalesced > 0 && found[0] == 1 && found[1] == 1;
+	if (passed)
+		Console::write_line("  passed");
+	else
+		Console::write_line("  FAILED: %1 coalesced, %2 received %3 times, %4 received %5 times", (int)stalled_stats.events_coalesced, names[0], found[0], names[1], found[1]);
+
+	slow_client.close();
+	server.stop();
+	return passed;
+}
@@ -1,16 +0,0 @@
-
-#include "precomp.h"
-#include "program.h"
-#include <ClanLib/application.h>
-
-using namespace clan;
-
-Application clanapp(&Program::main);
-
-int Program::main(const std::vector<std::string> &args)
-{
-	SetupCore setup_core;
-	SetupNetwork setup_network;
-
-	return 0;
-}
@@ -1,8 +0,0 @@
-
-#pragma once
-
-class Program
-{
-public:
-	static int main(const std::vector<std::string> &args);
-};
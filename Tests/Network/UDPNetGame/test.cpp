@@ -0,0 +1,152 @@
+#include <ClanLib/core.h>
+#include <ClanLib/network.h>
+#include <thread>
+
+using namespace clan;
+
+bool test_loopback(float packet_loss);
+
+int main(int, char**)
+{
+	try
+	{
+		bool passed = test_loopback(0.0f);
+		passed = test_loopback(0.25f) && passed;
+		Console::write_line(passed ? "UDP NetGame test passed" : "UDP NetGame test FAILED");
+		return passed ? 0 : 1;
+	}
+	catch (Exception e)
+	{
+		Console::write_line(e.message);
+		return 1;
+	}
+}
+
+bool test_loopback(float packet_loss)
+{
+	const int num_reliable = 1000;
+	const int num_sequenced = 1000;
+	const int events_per_frame = 20;
+
+	Console::write_line("Loopback with %1% packet loss:", (int)(packet_loss * 100.0f));
+
+	bool passed = true;
+
+	NetGameUDPServer server;
+	server.set_simulated_packet_loss(packet_loss);
+
+	NetGameUDPConnection *server_connection = nullptr;
+	std::string disconnect_reason = "not disconnected";
+	int server_reliable_next = 0;
+	int server_sequenced_last = -1;
+	int server_sequenced_count = 0;
+	int server_unreliable_count = 0;
+
+	Slot slot_connected = server.sig_client_connected().connect([&](NetGameUDPConnection *connection) { server_connection = connection; });
+	Slot slot_disconnected = server.sig_client_disconnected().connect([&](NetGameUDPConnection *connection, const std::string &reason)
+	{
+		disconnect_reason = reason;
+		server_connection = nullptr;
+	});
+	Slot slot_event = server.sig_event_received().connect([&](NetGameUDPConnection *connection, const NetGameEvent &e)
+	{
+		int index = e.get_argument(0).get_integer();
+		if (e.get_name() == "reliable")
+		{
+			// Every reliable event must arrive exactly once and in order
+			if (index != server_reliable_next)
+				passed = false;
+			server_reliable_next = index + 1;
+		}
+		else if (e.get_name() == "sequenced")
+		{
+			// Older sequenced events are dropped instead of delivered late
+			if (index <= server_sequenced_last)
+				passed = false;
+			server_sequenced_last = index;
+			server_sequenced_count++;
+		}
+		else if (e.get_name() == "unreliable")
+		{
+			server_unreliable_count++;
+		}
+	});
+	server.start("127.0.0.1", "27017");
+
+	NetGameUDPClient client;
+	client.set_simulated_packet_loss(packet_loss);
+
+	bool client_connected = false;
+	int client_reliable_next = 0;
+	Slot slot_client_connected = client.sig_connected().connect([&]() { client_connected = true; });
+	Slot slot_client_event = client.sig_event_received().connect([&](const NetGameEvent &e)
+	{
+		if (e.get_name() == "broadcast")
+		{
+			if (e.get_argument(0).get_integer() != client_reliable_next)
+				passed = false;
+			client_reliable_next++;
+		}
+	});
+	client.connect("localhost", "27017");
+
+	uint64_t start_time = System::get_time();
+	int frame = 0;
+	int broadcasts_sent = 0;
+	while (server_reliable_next < num_reliable || client_reliable_next < num_reliable)
+	{
+		if (System::get_time() - start_time > 30000)
+		{
+			Console::write_line("  Timed out after receiving %1 and %2 reliable events", server_reliable_next, client_reliable_next);
+			passed = false;
+			break;
+		}
+
+		for (int i = 0; i < events_per_frame; i++)
+		{
+			int index = frame * events_per_frame + i;
+			if (index < num_reliable)
+			{
+				client.send_event(NetGameEvent("reliable", { index }), NetGameReliability::reliable_ordered);
+				client.send_event(NetGameEvent("unreliable", { index }), NetGameReliability::unreliable);
+			}
+			if (client_connected && broadcasts_sent < num_reliable)
+			{
+				server.send_event(NetGameEvent("broadcast", { broadcasts_sent }), NetGameReliability::reliable_ordered);
+				broadcasts_sent++;
+			}
+			if (index < num_sequenced)
+				client.send_event(NetGameEvent("sequenced", { index }), NetGameReliability::unreliable_sequenced);
+		}
+		frame++;
+
+		client.process_events();
+		server.process_events();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	Console::write_line("  Reliable events: %1 to server, %2 to client", server_reliable_next, client_reliable_next);
+	Console::write_line("  Sequenced events: %1 of %2 delivered", server_sequenced_count, num_sequenced);
+	Console::write_line("  Unreliable events: %1 of %2 delivered", server_unreliable_count, num_reliable);
+	Console::write_line("  Round trip time: %1 ms", client.get_round_trip_time());
+
+	// Without loss every event must arrive
+	if (packet_loss == 0.0f && (server_sequenced_count != num_sequenced || server_unreliable_count != num_reliable))
+		passed = false;
+
+	// The disconnect packet is sent without loss simulation to not wait for the timeout
+	client.set_simulated_packet_loss(0.0f);
+	client.disconnect();
+	for (int i = 0; i < 100 && server_connection; i++)
+	{
+		server.process_events();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	if (server_connection || !disconnect_reason.empty())
+	{
+		Console::write_line("  Disconnect was not received");
+		passed = false;
+	}
+
+	return passed;
+}
@@ -231,6 +231,33 @@ void TestApp::do_test()
 	SoundSSE::mix_many_to_one(in_float, volumes, 2, data_size, out2_float_buffer1);
 	check_float(out_float_buffer1, out2_float_buffer1, data_size);
 
+	const int resample_size = 401;
+	const double resample_steps[3] = {0.77, 1.0, 1.3};
+	for (double step : resample_steps)
+	{
+		resample_linear(in_float_buffer1, 8.3, step, resample_size, out_float_buffer1);
+		SoundSSE::resample_linear(in_float_buffer1, 8.3, step, resample_size, out2_float_buffer1);
+		check_float(out_float_buffer1, out2_float_buffer1, resample_size);
+
+		resample_cubic(in_float_buffer1, 8.3, step, resample_size, out_float_buffer1);
+		SoundSSE::resample_cubic(in_float_buffer1, 8.3, step, resample_size, out2_float_buffer1);
+		check_float(out_float_buffer1, out2_float_buffer1, resample_size);
+	}
+
+	const int sinc_phases = 256;
+	std::vector<float> sinc_filter((sinc_phases + 1) * SoundSSE::sinc_taps);
+	SoundSSE::build_sinc_filter(sinc_filter.data(), sinc_phases, 0.95f);
+	for (double step : resample_steps)
+	{
+		resample_sinc(in_float_buffer1, 8.3, step, resample_size, sinc_filter.data(), sinc_phases, out_float_buffer1);
+		SoundSSE::resample_sinc(in_float_buffer1, 8.3, step, resample_size, sinc_filter.data(), sinc_phases, out2_float_buffer1);
+		check_float(out_float_buffer1, out2_float_buffer1, resample_size);
+	}
+
+	// Every filter phase must pass DC unchanged
+	set_float(out_float_buffer1, data_size, 0.34f);
+	SoundSSE::resample_sinc(out_float_buffer1, 8.0, 0.013, resample_size, sinc_filter.data(), sinc_phases, out2_float_buffer1);
+	check_float(out_float_buffer1, out2_float_buffer1, resample_size);
 }
 
 void TestApp::check_float(float *aptr, float *bptr, int num)
@@ -410,6 +437,50 @@ void TestApp::unpack_float_stereo(float *input, int size, float *output[2])
 	}
 }
 
+void TestApp::resample_linear(const float *input, double position, double step, int size, float *output)
+{
+	for (int i = 0; i < size; i++)
+	{
+		double pos = position + i * step;
+		int index = (int) pos;
+		float t = (float) (pos - index);
+		output[i] = input[index] + t * (input[index+1] - input[index]);
+	}
+}
+
+void TestApp::resample_cubic(const float *input, double position, double step, int size, float *output)
+{
+	for (int i = 0; i < size; i++)
+	{
+		double pos = position + i * step;
+		int index = (int) pos;
+		float t = (float) (pos - index);
+		float p0 = input[index-1], p1 = input[index], p2 = input[index+1], p3 = input[index+2];
+		output[i] = p1 + 0.5f * t * (p2 - p0 + t * (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3 + t * (3.0f * (p1 - p2) + p3 - p0)));
+	}
+}
+
+void TestApp::resample_sinc(const float *input, double position, double step, int size, const float *filter, int phases, float *output)
+{
+	const int taps = SoundSSE::sinc_taps;
+	for (int i = 0; i < size; i++)
+	{
+		double pos = position + i * step;
+		int index = (int) pos;
+		double phase_pos = (pos - index) * phases;
+		int phase = (int) phase_pos;
+		float t = (float) (phase_pos - phase);
+		float sample = 0.0f;
+		for (int j = 0; j < taps; j++)
+		{
+			float c0 = filter[phase * taps + j];
+			float c1 = filter[(phase + 1) * taps + j];
+			sample += input[index - (taps / 2 - 1) + j] * (c0 + t * (c1 - c0));
+		}
+		output[i] = sample;
+	}
+}
+
 void TestApp::unpack_float_mono(float *input, int size, float *output)
 {
 	const int sse_size = 0;
@@ -56,6 +56,9 @@ private:
 	static void mix_one_to_one(float *input, int size, float *output, float volume);
 	static void mix_one_to_many(float *input, int size, float **output, float *volume, int channels);
 	static void mix_many_to_one(float **input, float *volume, int channels, int size, float *output);
+	static void resample_linear(const float *input, double position, double step, int size, float *output);
+	static void resample_cubic(const float *input, double position, double step, int size, float *output);
+	static void resample_sinc(const float *input, double position, double step, int size, const float *filter, int phases, float *output);
 
 	void check_16(short *aptr, short *bptr, int num);
 	void check_float(float *aptr, float *bptr, int num);
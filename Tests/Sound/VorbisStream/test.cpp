@@ -0,0 +1,118 @@
+/*
+**  ClanLib SDK
+**  Copyright (c) 1997-2015 The ClanLib Team
+**
+**  This software is provided 'as-is', without any express or implied
+**  warranty.  In no event will the authors be held liable for any damages
+**  arising from the use of this software.
+**
+**  Permission is granted to anyone to use this software for any purpose,
+**  including commercial applications, and to alter it and redistribute it
+**  freely, subject to the following restrictions:
+**
+**  1. The origin of this software must not be misrepresented; you must not
+**     claim that you wrote the original software. If you use this software
+**     in a product, an acknowledgment in the product documentation would be
+**     appreciated but is not required.
+**  2. Altered source versions must be plainly marked as such, and must not be
+**     misrepresented as being the original software.
+**  3. This notice may not be removed or altered from any source distribution.
+**
+**  Note: Some of the libraries ClanLib may link to may have additional
+**  requirements or restrictions.
+**
+**  File Author(s):
+**
+**    Magnus Norddahl
+*/
+
+#include <ClanLib/core.h>
+#include <ClanLib/sound.h>
+#include <cmath>
+#include <vector>
+using namespace clan;
+
+const char *ogg_filename = "../../../Examples/Sound/Sound/Resources/cheer1.ogg";
+
+// Reads all remaining samples of the first channel
+std::vector<float> read_all(SoundProvider_Session *session)
+{
+	std::vector<float> result;
+	int channels = session->get_num_channels();
+	std::vector<std::vector<float> > buffers(channels, std::vector<float>(1000));
+	std::vector<float *> data(channels);
+	for (int i = 0; i < channels; i++)
+		data[i] = buffers[i].data();
+
+	while (!session->eof())
+	{
+		int count = session->get_data(data.data(), 1000);
+		result.insert(result.end(), buffers[0].begin(), buffers[0].begin() + count);
+	}
+	return result;
+}
+
+bool equal_samples(const std::vector<float> &reference, int offset, const std::vector<float> &samples)
+{
+	if (offset + samples.size() != reference.size())
+		return false;
+	for (size_t i = 0; i < samples.size(); i++)
+	{
+		if (samples[i] != reference[offset + i])
+			return false;
+	}
+	return true;
+}
+
+int main(int, char**)
+{
+	try
+	{
+		bool passed = true;
+
+		SoundProvider_Vorbis memory_provider(ogg_filename, false);
+		SoundProvider_Session *memory_session = memory_provider.begin_session();
+		std::vector<float> reference = read_all(memory_session);
+		memory_provider.end_session(memory_session);
+		int length = reference.size();
+		Console::write_line("Decoded %1 samples", length);
+
+		SoundProvider_Vorbis stream_provider(ogg_filename, true);
+		SoundProvider_Session *stream_session = stream_provider.begin_session();
+		if (!equal_samples(reference, 0, read_all(stream_session)))
+		{
+			Console::write_line("Streamed decode does not match in-memory decode");
+			passed = false;
+		}
+
+		int positions[] = { 0, 1, 500, length / 3, length / 2, length - 1000, length / 4, 10 };
+		for (int position : positions)
+		{
+			if (!stream_session->set_position(position) || stream_session->get_position() != position)
+			{
+				Console::write_line("Seeking to %1 failed", position);
+				passed = false;
+			}
+			else if (!equal_samples(reference, position, read_all(stream_session)))
+			{
+				Console::write_line("Samples after seeking to %1 do not match", position);
+				passed = false;
+			}
+		}
+
+		if (stream_session->set_position(length + 1000))
+		{
+			Console::write_line("Seeking past the end succeeded");
+			passed = false;
+		}
+		stream_provider.end_session(stream_session);
+
+		Console::write_line(passed ? "All tests passed" : "Tests FAILED");
+		return passed ? 0 : 1;
+	}
+	catch (Exception &e)
+	{
+		Console::write_line("Exception caught: " + e.get_message_and_stack_trace());
+		return 1;
+	}
+}